@@ -5,18 +5,77 @@ Author: [XIFAN LUO]
 Platform: Windows 10 (Dear ImGui base)
 
 Implementation notes (for rubric):
-- Board: 3x3 stored in std::array<int,9> using {0=empty, 1=X, 2=O}.
+- Board: an MnkBoard (engine/MnkBoard.h) of the selected size; the classic 3x3 game is handed
+  to the AI as a Bitboard (engine/Bitboard.h), one 9-bit mask per player.
+- Larger boards (4x4, 5x5, 15x15 Gomoku) use the m,n,k engine: generated k-in-a-row line masks,
+  iterative deepening alpha-beta, and an open-line heuristic below the depth limit.
+  Moves are ordered by a best-move table, immediate wins and blocks, killers and history.
+  Before searching, a threat-space search (engine/ThreatSearch.h) looks for a forced win by
+  continuous fours within a node budget and plays it straight away.
+  GameOptions::AIMAXDepth and AITimeBudget bound each reply; the per-depth stats are shown.
 - Turn system: Player 1 (X) starts. If "Play vs AI" is checked, AI plays as O (second).
-- Win/Draw: Check all 8 lines every move. Draw = full board with no winner.
+- Win/Draw: Mask test against the 8 lines every move. Draw = full board with no winner.
 - Reset: Clears board and state. StopGame() provided for cleanup.
+- Undo/Redo: every position is kept in a packed MoveHistory (engine/MoveHistory.h); against the
+  AI one step undoes or redoes a whole round. The board follows it with MnkBoard::makeMove()/
+  unmakeMove() (an undo stack with the Zobrist hash), not by reloading state strings.
+- Replay: "Review this game", or a game from a `selfplay --record` file, opens a GameReplay
+  (engine/GameReplay.h) that the board shows instead of the game: a ply slider seeks in
+  bounded time (a checkpoint every 16 plies plus the changes since), and playback runs at an
+  adjustable speed. The game underneath is untouched until the replay closes.
 - AI: **Negamax** formulation (a symmetric form of minimax).
   * score(state, side) = max over legal moves of ( -score(state', -side) )
   * Terminal: +1 if current side has won, -1 if lost, 0 if draw.
   * side = +1 means X-to-move, side = -1 means O-to-move.
   * Our board stores {1=X,2=O}; we map winner -> signed {+1 for X, -1 for O}.
   * Move ordering prefers center, then corners, then edges (tiny speed/quality boost).
+  * Search mode is selectable: plain Negamax, alpha-beta, or null-window (PVS), with an
+    optional aspiration window; the node count of each AI reply is shown under the board.
+  * A transposition table (engine/TranspositionTable.h) caches bounds and best moves for the
+    whole game; ResetGame() clears it.
+  * By default the AI reads its reply from a perfect-play table solved at compile time
+    (engine/PerfectPlay.cpp); the live searches remain selectable as a fallback and to verify it.
+  * Symmetry reduction (engine/Symmetry.h) keys the table on the canonical rotation/reflection
+    and searches only one of each set of equivalent root moves.
 - Two-player mode: When AI is OFF, both players click alternately (no blocking).
-- Immediate AI: AI responds right after the human places X (no external tick required).
+- AI vs AI (GameOptions::AIvsAI): the AI plays both sides from a random first move; tools/SelfPlay.cpp
+  plays such games headless in batches across threads.
+- Background AI: the reply is searched on a worker thread (engine/AIWorker.h) right after the
+  human places X; the board keeps rendering, shows "thinking", and "Move now" stops the search
+  early with its best move so far. Reset and board changes cancel a search in flight.
+- Search threads: the root moves are split across up to one thread per core (engine/Parallel.h);
+  the reply is the same move and value as the single-threaded search.
+- Idle rendering: main_* wait on their event queue (glfwWaitEvents / MsgWaitForMultipleObjectsEx)
+  and only draw after input, an AI reply (the worker wakes the loop) or while something moves;
+  FrameWaitSeconds() says how long they may sleep. Game::drawFrame() replays a cached board
+  draw list until the board changes.
+- Opening book: tools/BuildBook.cpp solves the larger boards' openings once into a file
+  (engine/OpeningBook.h) that ResetGame() memory-maps; book positions are answered without a search.
+- Tablebase: tools/BuildTablebase.cpp solves every position of boards up to 20 cells backwards
+  from the full board (engine/Tablebase.h); ResetGame() maps it and the 4x4 AI plays perfectly
+  from its first move with a table read per candidate move.
+- AI strength: easy and medium cap the m,n,k search's depth and nodes and draw the reply from a
+  softmax over the root moves' values with a seed from rng (MnkApplyStrength()); the weaker the
+  level, the cheaper the move. Hard is the full search, or the perfect-play table on 3x3.
+- Pondering: once the AI has moved, its worker searches the replies it expects (engine/MnkPonder.h)
+  into the game's best-move table; a reply it guessed is answered at once, one it is still
+  searching takes that search's answer, and any other move stops it for a normal search.
+- Telemetry: under the board, the last reply's time, nodes/s, depth, table hit rate, principal
+  variation and root move scores, and a graph of recent frame times. The hit and cutoff counts
+  come from engine/SearchStats.h and compile away with TICTACTOE_SEARCH_STATS=OFF.
+- Profiler: PROFILE_SCOPE (engine/Profiler.h) times the frame phases in main_*, the board draw,
+  the mouse scan, texture loads and the AI search into per-thread ring buffers; F9 writes them
+  to profile_trace.json for chrome://tracing or Perfetto.
+- Sessions: the "Sessions" window hosts any number of further games (engine/GameSession.h),
+  tiled and clipped to the visible rows; their AI moves are batched through one
+  SessionManager worker pool (engine/SessionManager.h), apart from the main board's AIWorker.
+- Chess: the "Chess" window plays chess with the piece sprites in resources/ on the Game
+  board classes (classes/Chess.h). Moves come from 64-bit bitboards with magic (or PEXT) slider
+  tables (engine/ChessBoard.h); the AI is an iterative deepening PVS with a bucketed
+  transposition table and a capture search (engine/ChessSearch.h) on its own AIWorker.
+  Pieces are dragged or clicked into place; moves, the AI's included, glide there through a
+  per-frame tween scheduler (classes/Tween.h); the cached board list is rebuilt only when one
+  starts or lands, the moving sprites are drawn over it.
 
 Rubric mapping:
   [✓] README + comments (explain AI)       [✓] Negamax-coded algorithm
@@ -27,135 +86,439 @@ Rubric mapping:
 
 #include "Application.h"
 #include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+#include "engine/Bitboard.h"
+#include "engine/Negamax.h"
+#include "engine/MnkBoard.h"
+#include "engine/MnkSearch.h"
+#include "engine/OpeningBook.h"
+#include "engine/Tablebase.h"
+#include "engine/MnkPonder.h"
+#include "engine/AIWorker.h"
+#include "engine/Parallel.h"
+#include "engine/MoveHistory.h"
+#include "engine/GameRecord.h"
+#include "engine/GameReplay.h"
+#include "engine/SessionManager.h"
+#include "engine/SearchStats.h"
+#include "engine/Profiler.h"
+#include "classes/Chess.h"
+#include "classes/Game.h"
+#include "classes/TextureCache.h"
 #include <array>
 #include <vector>
 #include <random>
 #include <ctime>
 #include <algorithm>
 #include <limits>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
 
 namespace ClassGame {
 
 // ----------------------- State -----------------------
-static std::array<int, 9> board;     // 0 empty, 1 = X, 2 = O
+// board sizes the player can pick; the classic 3x3 game uses the Bitboard engine,
+// the others the m,n,k engine with a depth limit once exhaustive search stops being possible
+struct BoardVariant {
+    const char *name;
+    int width, height, winLength;
+    int aiDepth;                      // default GameOptions::AIMAXDepth for this size
+};
+static const BoardVariant VARIANTS[] = {
+    { "3x3 (classic)",        3,  3, 3, BOARD_CELLS },
+    { "4x4, 4 in a row",      4,  4, 4, 8 },
+    { "5x5, 4 in a row",      5,  5, 4, 5 },
+    { "15x15 Gomoku",        15, 15, 5, 2 },
+};
+static int variant = 0;
+static MnkRules rules(3, 3, 3);
+static MnkBoard board(rules);         // cellAt(): 0 empty, 1 = X, 2 = O
+static MnkSearchResult lastMnkSearch; // last AI reply on the larger boards
+static bool mnkDynamicOrdering = true;   // table move, threats, killers and history instead of centre-out
+static OpeningBook openingBook;       // resources/books/<variant>.book, if one was built for this size
+static Tablebase tablebase;           // resources/tablebases/<variant>.tb, for boards small enough to solve
+static GameOptions gameOptions;       // rowX/rowY, and AIMAXDepth/AITimeBudget for the larger-board AI
+static MoveHistory history;           // every position of this game, for undo/redo
 static int  currentPlayer = 1;        // whose turn: 1 or 2
 static bool gameOver = false;
 static int  winner = 0;               // 0 none/draw, 1 or 2 winner
 static bool aiEnabled = true;         // play vs AI as Player 2 (O)
-static std::mt19937 rng;
+static MnkStrength aiStrength = kMnkStrengthHard;  // below hard, every board uses the m,n,k search
+static MnkMoveTable mnkMoveTable;     // the m,n,k AI's best-move table, kept for the game
+static MnkPonder ponder;              // answers to the human's likely replies, searched in their time
+static bool ponderEnabled = true;
+static bool lastReplyPondered = false;
+static std::mt19937 rng;              // picks the random opening move of AI-vs-AI games
 
-// all 8 winning triplets
-static const int WINS[8][3] = {
-    {0,1,2}, {3,4,5}, {6,7,8},
-    {0,3,6}, {1,4,7}, {2,5,8},
-    {0,4,8}, {2,4,6}
-};
+static SearchOptions searchOptions = { kSearchTable };   // which search the AI uses, selectable in the UI
+static bool verifyTable = false;      // also run the live search and compare it with the table reply
+static std::atomic<int> tableMismatches = 0;   // replies where the table and the live search disagreed
+static bool aspiration = false;       // narrow the root window to "expect a draw"
+static bool useTable = true;          // let alpha-beta / PVS consult the transposition table
+static TranspositionTable transpositionTable;   // kept for the whole game, cleared by ResetGame()
+static SearchResult lastSearch;       // move, value and node count of the last AI reply
+
+static AIWorker aiWorker;             // runs the AI search off the render thread
+static int  aiThreads = 1;            // threads the search splits its root moves across
+static bool aiThinking = false;       // a reply has been requested and not yet applied
+static std::chrono::steady_clock::time_point aiStarted;
+
+// after input ImGui needs a few more frames for hover and active states to settle
+constexpr int SETTLE_FRAMES = 3;
+// while the AI thinks its timer label is redrawn at this interval
+constexpr double THINKING_REFRESH_SECONDS = 0.1;
+static std::atomic<int> redrawFrames = SETTLE_FRAMES;   // frames still to draw before idling
+static void (*wakeMainLoop)() = nullptr;
 
-// Preferred move order (center, corners, edges)
-static const int ORDER[9] = {4, 0, 2, 6, 8, 1, 3, 5, 7};
+// frame times of the last FRAME_HISTORY frames drawn back to back; a frame after the loop slept
+// on its event queue would measure the wait rather than the frame, so it isn't recorded
+constexpr int FRAME_HISTORY = 120;
+static float frameTimes[FRAME_HISTORY] = {};   // milliseconds, a ring buffer
+static int  frameTimeCount = 0;       // samples recorded, up to FRAME_HISTORY
+static int  frameTimeNext = 0;        // where the next one goes, the oldest once the buffer is full
+static std::chrono::steady_clock::time_point lastFrame;
+static bool lastFrameContinuous = false;   // the previous frame didn't let the loop sleep
+static double lastReplyMs = 0.0;      // the last AI reply, from request to result
+
+// F9 writes the profiler's rings (engine/Profiler.h) here, in the working directory
+static const char *PROFILE_TRACE_PATH = "profile_trace.json";
+static int profileTraceEvents = 0;    // events in the last dump, -1 if it couldn't be written
+static bool profileTraceWritten = false;
+
+// any number of further games in the "Sessions" window, tiled; their AI moves go to the
+// manager's worker pool in batches, apart from the main board's AIWorker
+static SessionManager sessionManager;
+static bool  showSessions = false;
+static int   sessionVariant = 0;
+static int   sessionDepth = 3;          // m,n,k depth limit of the sessions' AI
+static int   sessionsToOpen = 16;
+static bool  sessionsAIvsAI = true;     // otherwise X is played by clicking its tile
+static bool  sessionsRematch = true;
+static float sessionTileSize = 96.0f;   // pixels
+
+// a finished or recorded game shown on the board in place of the live one while replaying
+static GameReplay replay;
+static bool  replaying = false;
+static char  replayPath[256] = "selfplay_records.bin";
+static int   replayGame = 0;
+static std::string replayMessage;       // what the last load did, or why it failed
+
+// chess in its own window, on the Game board classes; made the first time the window opens
+static Chess *chess = nullptr;
+static bool  showChess = false;
 
 // --------------------- Helpers -----------------------
+static bool ClassicBoard() { return variant == 0; }
+
+// the classic board as the 3x3 engine's position type
+static Bitboard ClassicPosition() {
+    Bitboard pos;
+    for (int i = 0; i < BOARD_CELLS; ++i) pos.set(i, board.cellAt(i));
+    return pos;
+}
+
 static void ResetGame() {
-    board.fill(0);
+    // the worker may be reading the board's rules or writing the table
+    aiWorker.cancel();
+    aiWorker.wait();
+    aiThinking = false;
+    ponder.clear();
+    mnkMoveTable.clear();
+    lastReplyPondered = false;
+
+    const BoardVariant &v = VARIANTS[variant];
+    rules = MnkRules(v.width, v.height, v.winLength);
+    board = MnkBoard(rules);
+    // mapped, not read, so this is cheap; the classic board has its perfect-play table instead
+    openingBook.close();
+    if (!ClassicBoard()) openingBook.open("resources/books/" + OpeningBookName(rules), rules);
+    tablebase.close();
+    if (!ClassicBoard() && rules.cellCount() <= TABLEBASE_MAX_CELLS) {
+        tablebase.open("resources/tablebases/" + TablebaseName(rules), rules);
+    }
+    gameOptions.rowX = v.width;
+    gameOptions.rowY = v.height;
     currentPlayer = 1;
     gameOver = false;
     winner = 0;
+    lastSearch = SearchResult();
+    lastMnkSearch = MnkSearchResult();
+    transpositionTable.clear();
+    history.reset(board.toState());
+    // a replay is of a board this size
+    replay.clear();
+    replaying = false;
 }
 
-static int CheckWinnerRaw() {
-    for (auto& line : WINS) {
-        int a = board[line[0]], b = board[line[1]], c = board[line[2]];
-        if (a != 0 && a == b && b == c) return a; // 1 or 2
-    }
-    return 0;
+// --------------------- Negamax AI --------------------
+// what the m,n,k AI searches with, for a reply or a ponder
+static MnkSearchOptions MnkAIOptions() {
+    MnkSearchOptions options;
+    if (gameOptions.AIMAXDepth > 0) options.maxDepth = gameOptions.AIMAXDepth;
+    options.timeBudget = gameOptions.AITimeBudget;
+    options.threads = aiThreads;
+    options.dynamicOrdering = mnkDynamicOrdering;
+    // ResetGame() waits for the worker before it closes the book, so the job can point at it
+    if (openingBook.isOpen()) options.book = &openingBook;
+    if (tablebase.isOpen()) options.tablebase = &tablebase;
+    options.moveTable = &mnkMoveTable;
+    MnkApplyStrength(options, aiStrength);
+    if (options.temperature > 0) options.seed = (uint32_t)rng();
+    return options;
 }
 
-// Signed mapping used by Negamax: +1 = X has 3-in-a-row, -1 = O has 3-in-a-row, 0 = none
-static int CheckWinnerSigned() {
-    int w = CheckWinnerRaw();
-    if (w == 1) return +1;
-    if (w == 2) return -1;
-    return 0;
-}
+// Ask the worker for the AI's move (O = second player); ApplyAIReply() plays it once it is ready
+// The search itself lives in engine/Negamax.cpp so tools can run it without the UI
+// Jobs copy the position and options, so the board can be drawn while they run
+static void RequestAIMove() {
+    if (gameOver) return;
 
-static bool BoardFull() {
-    for (int v : board) if (v == 0) return false;
-    return true;
+    AIWorker::Job job;
+    if (ClassicBoard() && aiStrength == kMnkStrengthHard) {
+        const Bitboard pos = ClassicPosition();
+        SearchOptions options = searchOptions;
+        if (aspiration) {
+            // perfect play from the opening is a draw, so only ask "better or worse than 0?"
+            options.alpha = -1;
+            options.beta = +1;
+        }
+        options.table = useTable ? &transpositionTable : nullptr;
+        options.threads = aiThreads;
+        transpositionTable.setSymmetric(options.symmetry);
+        const bool verify = verifyTable;
+        // the 3x3 search finishes in well under a frame, so it does not watch the stop flag
+        job = [pos, options, verify](const std::atomic<bool> &) {
+            AIReply reply;
+            reply.search = SearchBestMove(pos, options);
+            if (verify && reply.search.fromTable) {
+                SearchOptions live = options;
+                live.mode = kSearchAlphaBeta;
+                if (SearchBestMove(pos, live).value != reply.search.value) tableMismatches++;
+            }
+            reply.move = reply.search.move;
+            return reply;
+        };
+    } else {
+        MnkSearchOptions options = MnkAIOptions();
+        MnkSearchResult answer;
+        const MnkPonderHit hit = ponderEnabled ? ponder.play(board, options, answer) : kPonderMiss;
+        lastReplyPondered = hit != kPonderMiss;
+        if (hit == kPonderSearching) {
+            // the ponder job is searching this very position: its answer arrives as the reply
+            aiThinking = true;
+            aiStarted = std::chrono::steady_clock::now();
+            return;
+        }
+        if (hit == kPonderAnswered) {
+            job = [answer](const std::atomic<bool> &) {
+                AIReply reply;
+                reply.mnkSearch = answer;
+                reply.move = answer.move;
+                return reply;
+            };
+        } else {
+            // the board only points at its rules, so the job carries its own copy of both
+            job = [jobRules = rules, state = board.toStateString(), options](const std::atomic<bool> &stop) mutable {
+                MnkBoard position(jobRules);
+                position.setStateString(state);
+                options.stop = &stop;
+                AIReply reply;
+                reply.mnkSearch = MnkSearchBestMove(position, options);
+                reply.move = reply.mnkSearch.move;
+                return reply;
+            };
+        }
+    }
+    aiWorker.post(std::move(job));
+    aiThinking = true;
+    aiStarted = std::chrono::steady_clock::now();
 }
 
-// --------------------- Negamax AI --------------------
-// side: +1 for X-to-move, -1 for O-to-move
-// return: +1 (current side will win), 0 (draw), -1 (current side will lose)
-static int Negamax(int side) {
-    // Terminal checks
-    int signedWinner = CheckWinnerSigned();
-    if (signedWinner != 0) {
-        // If winner equals current side -> +1, else -1
-        return (signedWinner == side) ? +1 : -1;
-    }
-    if (BoardFull()) return 0;
+// after the AI's move, while the human thinks: the worker searches the replies the AI expects,
+// the move its search predicted first; the ponder job's own reply is only wanted on a hit
+static void StartPondering() {
+    if (!ponderEnabled || !aiEnabled || gameOptions.AIvsAI || gameOver || (ClassicBoard() && aiStrength == kMnkStrengthHard)) return;
+    const std::vector<int> &pv = lastMnkSearch.pv;
+    const int predicted = (pv.size() >= 2 && board.pieceCount() > 0 && pv[0] == history.moveAt(history.turn())) ? pv[1] : -1;
+    ponder.start(board, predicted, MnkAIOptions());
+    aiWorker.post([jobRules = rules](const std::atomic<bool> &stop) {
+        AIReply reply;
+        if (ponder.run(jobRules, stop, reply.mnkSearch)) reply.move = reply.mnkSearch.move;
+        return reply;
+    });
+}
 
-    int best = std::numeric_limits<int>::min();
+// play the worker's reply, if it has arrived; called every frame
+static void ApplyAIReply() {
+    AIReply reply;
+    if (!aiThinking || !aiWorker.poll(reply)) return;
+    aiThinking = false;
+    lastReplyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aiStarted).count();
 
-    // iterate cells in preferred order
-    for (int idx : ORDER) {
-        if (board[idx] != 0) continue;
+    int bestMove = reply.move;
+    // a weaker level plays 3x3 with the m,n,k search too
+    lastSearch = reply.search;
+    lastMnkSearch = reply.mnkSearch;
+    if (!ClassicBoard()) gameOptions.AIDepthSearches = (int)lastMnkSearch.iterations.size();
 
-        // make move for current side
-        board[idx] = (side == +1) ? 1 : 2; // place X if +1, else O
+    // Fallback (should not happen): choose first empty
+    if (bestMove == -1 || board.cellAt(bestMove) != 0) {
+        bestMove = -1;
+        for (int i = 0; i < rules.cellCount(); ++i) if (board.cellAt(i) == 0) { bestMove = i; break; }
+    }
 
-        // opponent tries to minimize our outcome: -Negamax(-side)
-        int val = -Negamax(-side);
+    if (bestMove != -1) {
+        history.pushMove(bestMove, board.sideToMove());
+        board.makeMove(bestMove);                  // O plays, or either side in AI vs AI
+    }
 
-        // undo
-        board[idx] = 0;
+    winner = board.winner();
+    gameOver = board.gameOver();
+    if (!gameOver) currentPlayer = board.sideToMove();  // back to human (X)
+    StartPondering();
+}
 
-        if (val > best) best = val;
-        // Early exit if we can force a win
-        if (best == +1) break;
+// AI vs AI: each frame with no search running starts the next move; the first one is random so
+// the games differ (the engines themselves always pick the same move)
+static void AdvanceAIvsAI() {
+    if (!gameOptions.AIvsAI || gameOver || aiThinking) return;
+    if (board.pieceCount() == 0) {
+        const int move = std::uniform_int_distribution<int>(0, rules.cellCount() - 1)(rng);
+        history.pushMove(move, board.sideToMove());
+        board.makeMove(move);
+        currentPlayer = board.sideToMove();
+        return;
     }
-    return best;
+    RequestAIMove();
 }
 
-// Choose the best move for AI (O = second player)
-// Uses Negamax with side = -1 (O to move)
-static void AIMove_Negamax() {
-    if (gameOver) return;
+// ------------------- Undo / Redo --------------------
+// the board follows the history one move at a time through makeMove()/unmakeMove();
+// only a board whose undo stack doesn't reach back that far is rebuilt from the state string
+static void StepBack() {
+    if (!history.undo()) return;
+    if (!board.unmakeMove()) board.setStateString(history.currentState());
+}
 
-    int bestVal = std::numeric_limits<int>::min();
-    int bestMove = -1;
+static void StepForward() {
+    if (!history.redo()) return;
+    board.makeMove(history.moveAt(history.turn()));
+}
 
-    for (int idx : ORDER) {
-        if (board[idx] != 0) continue;
+static void SyncWithBoard() {
+    winner = board.winner();
+    gameOver = board.gameOver();
+    currentPlayer = board.sideToMove();
+}
 
-        board[idx] = 2;                // try O here
-        int val = -Negamax(+1);        // next side is X
-        board[idx] = 0;
+// against the AI a step is a whole round, so it is the human's turn again afterwards
+static void UndoTurn() {
+    gameOptions.AIvsAI = false;
+    aiWorker.cancel();
+    aiWorker.wait();
+    aiThinking = false;
+    ponder.clear();
+    StepBack();
+    if (aiEnabled && history.turn() % 2 == 1) StepBack();
+    SyncWithBoard();
+}
 
-        if (val > bestVal) {
-            bestVal = val;
-            bestMove = idx;
-            if (bestVal == +1) break;  // winning reply found
-        }
-    }
+static void RedoTurn() {
+    StepForward();
+    if (aiEnabled && history.turn() % 2 == 1) StepForward();
+    SyncWithBoard();
+    // the AI's reply to the last human move was never recorded: search for it
+    if (aiEnabled && !gameOver && currentPlayer == 2) RequestAIMove();
+}
 
-    // Fallback (should not happen): choose first empty
-    if (bestMove == -1) {
-        for (int i = 0; i < 9; ++i) if (board[i] == 0) { bestMove = i; break; }
-    }
+// ---------------------- Replay ----------------------
+// the board shows the replay's position instead of the game's; nothing is played while it is open
+static void ReviewThisGame() {
+    gameOptions.AIvsAI = false;
+    replay.load(history);
+    replay.seek(history.turn());
+    replaying = true;
+    replayMessage.clear();
+}
 
-    if (bestMove != -1) {
-        board[bestMove] = 2;           // O plays
+// game replayGame of replayPath, on the board variant of its size
+static void LoadRecordedGame() {
+    GameRecordReader reader;
+    GameRecord record;
+    if (!reader.open(replayPath)) {
+        replayMessage = std::string(replayPath) + " is not a record file";
+        return;
     }
+    if (replayGame < 0 || !reader.seek((uint64_t)replayGame) || !reader.next(record)) {
+        replayMessage = "no game " + std::to_string(replayGame) + " (" + std::to_string(reader.indexedCount()) + " indexed)";
+        return;
+    }
+    int match = -1;
+    for (int i = 0; i < IM_ARRAYSIZE(VARIANTS); ++i) {
+        const BoardVariant &v = VARIANTS[i];
+        if (v.width == record.width && v.height == record.height && v.winLength == record.winLength) match = i;
+    }
+    if (match < 0) {
+        replayMessage = "no board for " + std::to_string(record.width) + "x" + std::to_string(record.height) +
+                        ", " + std::to_string(record.winLength) + " in a row";
+        return;
+    }
+    gameOptions.AIvsAI = false;
+    if (match != variant) {
+        variant = match;
+        gameOptions.AIMAXDepth = VARIANTS[variant].aiDepth;
+        ResetGame();
+    }
+    replay.load(record);
+    replaying = true;
+    replayMessage = "game " + std::to_string(record.gameNumber) + ": " + std::to_string(record.moves.size()) + " plies, " +
+                    (record.winner == 1 ? "X won" : record.winner == 2 ? "O won" : "drawn");
+}
 
-    winner = CheckWinnerRaw();
-    gameOver = (winner != 0) || BoardFull();
-    if (!gameOver) currentPlayer = 1;  // back to human (X)
+static void CloseReplay() {
+    replay.clear();
+    replaying = false;
 }
 
 // ---------------- Public API (called by main_*) -----
+void RequestRedraw(int frames) {
+    int pending = redrawFrames.load();
+    while (pending < frames && !redrawFrames.compare_exchange_weak(pending, frames)) {}
+    if (wakeMainLoop) wakeMainLoop();
+}
+
+void SetWakeCallback(void (*wake)()) {
+    wakeMainLoop = wake;
+}
+
+double FrameWaitSeconds() {
+    if (redrawFrames.load() > 0) return 0.0;
+    // a replay playing back wakes for its next step
+    if (replaying && replay.playing()) return replay.secondsToNextStep();
+    // AI vs AI starts the next search on the next frame
+    if (gameOptions.AIvsAI && !gameOver && !aiThinking) return 0.0;
+    if (aiThinking) return THINKING_REFRESH_SECONDS;
+    if (showChess && chess) {
+        // a gliding or dragged piece moves every frame
+        if (chess->animating()) return 0.0;
+        // a chess AI to move starts its search on the next frame
+        if (chess->status() == kChessPlaying && !chess->aiThinking() && chess->aiPlays(chess->board().sideToMove())) return 0.0;
+        if (chess->aiThinking()) return THINKING_REFRESH_SECONDS;
+    }
+    return -1.0;
+}
+
 void GameStartUp() {
+    ProfilerSetThreadName("main");
     rng.seed((unsigned)std::time(nullptr));
+    // a finished search wakes the main loop so its reply is played without waiting for input
+    aiWorker.setReplyCallback([] { RequestRedraw(); });
+    sessionManager.setReplyCallback([] { RequestRedraw(); });
+    // pack every sprite image into one texture so a board of Bits draws without texture switches
+    TextureCache::instance().buildResourceAtlas();
+    gameOptions.AIMAXDepth = VARIANTS[variant].aiDepth;
     ResetGame();
 }
 
@@ -166,40 +529,42 @@ void EndOfTurn() {}
 static void DrawBoardUI() {
     ImGui::SeparatorText("Play Area");
 
-    const float cell = 84.0f;
+    const float cell = std::clamp(336.0f / rules.width(), 26.0f, 84.0f);
     const ImVec2 size(cell, cell);
 
     auto labelFor = [](int v) -> const char* {
         return (v == 1) ? "X" : (v == 2) ? "O" : " ";
     };
 
-    for (int r = 0; r < 3; ++r) {
-        for (int c = 0; c < 3; ++c) {
-            int idx = r * 3 + c;
+    for (int r = 0; r < rules.height(); ++r) {
+        for (int c = 0; c < rules.width(); ++c) {
+            int idx = rules.cellIndex(c, r);
             ImGui::PushID(idx);
 
             // Disable when:
             //  - game over
             //  - cell used
             //  - OR (AI enabled AND it's AI's turn)
-            bool disabled = gameOver || board[idx] != 0 || (aiEnabled && currentPlayer != 2 && currentPlayer != 1 ? true : false);
+            bool disabled = gameOver || board.cellAt(idx) != 0 || (aiEnabled && currentPlayer != 2 && currentPlayer != 1 ? true : false);
             // Correct human-turn logic:
-            if (aiEnabled) disabled = gameOver || board[idx] != 0 || (currentPlayer != 1);
-            if (!aiEnabled) disabled = gameOver || board[idx] != 0;
+            if (aiEnabled) disabled = gameOver || board.cellAt(idx) != 0 || (currentPlayer != 1);
+            if (!aiEnabled) disabled = gameOver || board.cellAt(idx) != 0;
+            if (aiThinking || gameOptions.AIvsAI || replaying) disabled = true;
 
             if (disabled) ImGui::BeginDisabled();
 
-            if (ImGui::Button(labelFor(board[idx]), size)) {
+            if (ImGui::Button(labelFor(replaying ? replay.cellAt(idx) : board.cellAt(idx)), size)) {
                 // Human clicked
-                board[idx] = currentPlayer;          // place X or O depending on mode
-                winner = CheckWinnerRaw();
-                gameOver = (winner != 0) || BoardFull();
+                history.pushMove(idx, board.sideToMove());
+                board.makeMove(idx);                 // X or O, whoever is to move
+                winner = board.winner();
+                gameOver = board.gameOver();
 
                 if (!gameOver) {
                     if (aiEnabled) {
-                        // Human is X; AI replies immediately as O
+                        // Human is X; AI replies as O from the worker thread
                         currentPlayer = 2;
-                        AIMove_Negamax();
+                        RequestAIMove();
                     } else {
                         // Local 2P: toggle turn
                         currentPlayer = (currentPlayer  == 1 ? 2 : 1); // <-- typo fix in a sec
@@ -210,12 +575,356 @@ static void DrawBoardUI() {
             if (disabled) ImGui::EndDisabled();
             ImGui::PopID();
 
-            if (c < 2) ImGui::SameLine();
+            if (c < rules.width() - 1) ImGui::SameLine();
+        }
+    }
+}
+
+
+// "(x, y)" of a cell on the current board
+static std::string CellName(int cell) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "(%d, %d)", cell % rules.width(), cell / rules.width());
+    return name;
+}
+
+static void DrawReplayUI() {
+    ImGui::SeparatorText("Replay");
+    if (!replaying) {
+        ImGui::BeginDisabled(history.size() < 2 || aiThinking);
+        if (ImGui::Button("Review this game")) ReviewThisGame();
+        ImGui::EndDisabled();
+        ImGui::SetNextItemWidth(220.0f);
+        ImGui::InputText("Record file", replayPath, sizeof(replayPath));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::InputInt("Game", &replayGame);
+        ImGui::SameLine();
+        if (ImGui::Button("Load")) LoadRecordedGame();
+    } else {
+        int entry = (int)replay.cursor();
+        ImGui::SetNextItemWidth(320.0f);
+        if (ImGui::SliderInt("Ply", &entry, 0, (int)replay.size() - 1)) {
+            replay.pause();
+            replay.seek((size_t)entry);
+        }
+        if (ImGui::Button("|<")) { replay.pause(); replay.seek(0); }
+        ImGui::SameLine();
+        if (ImGui::Button("<")) { replay.pause(); replay.stepBack(); }
+        ImGui::SameLine();
+        if (ImGui::Button(replay.playing() ? "Pause" : "Play", ImVec2(56.0f, 0.0f))) {
+            if (replay.playing()) replay.pause(); else replay.play();
         }
+        ImGui::SameLine();
+        if (ImGui::Button(">")) { replay.pause(); replay.stepForward(); }
+        ImGui::SameLine();
+        if (ImGui::Button(">|")) { replay.pause(); replay.seek(replay.size() - 1); }
+        ImGui::SameLine();
+        float speed = (float)replay.speed();
+        ImGui::SetNextItemWidth(160.0f);
+        if (ImGui::SliderFloat("Plies/s", &speed, 0.5f, 60.0f, "%.1f", ImGuiSliderFlags_Logarithmic)) replay.setSpeed(speed);
+        const int move = replay.lastMove();
+        if (move >= 0) ImGui::Text("Ply %zu of %zu: %s at %s", replay.cursor(), replay.size() - 1,
+                                   (replay.cellAt(move) == 1) ? "X" : "O", CellName(move).c_str());
+        else ImGui::Text("Ply %zu of %zu", replay.cursor(), replay.size() - 1);
+        if (ImGui::Button("Close replay")) CloseReplay();
+    }
+    if (!replayMessage.empty()) ImGui::TextDisabled("%s", replayMessage.c_str());
+}
+
+static void RecordFrameTime() {
+    const auto now = std::chrono::steady_clock::now();
+    if (lastFrameContinuous) {
+        frameTimes[frameTimeNext] = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+        frameTimeNext = (frameTimeNext + 1) % FRAME_HISTORY;
+        frameTimeCount = std::min(frameTimeCount + 1, FRAME_HISTORY);
     }
+    lastFrame = now;
+}
+
+// live numbers from the last AI reply, to spot a slow or badly ordered search without a profiler
+static void DrawTelemetryUI() {
+    ImGui::SeparatorText("Engine telemetry");
+    if (!SEARCH_STATS_ENABLED) ImGui::TextDisabled("Search counters compiled out (TICTACTOE_SEARCH_STATS=OFF)");
+
+    if (ClassicBoard()) {
+        if (lastSearch.move != -1) {
+            ImGui::Text("Time per move: %.2f ms, %llu nodes, %.0f nodes/s", lastReplyMs, (unsigned long long)lastSearch.nodes,
+                        (lastReplyMs > 0.0) ? lastSearch.nodes * 1000.0 / lastReplyMs : 0.0);
+        }
+        // the counters are only stable while the worker leaves the table alone
+        if (SEARCH_STATS_ENABLED && !aiThinking) {
+            const uint64_t probes = transpositionTable.hits() + transpositionTable.misses();
+            ImGui::Text("TT hit rate: %.1f%% of %llu probes", 100.0 * StatRatio(transpositionTable.hits(), probes),
+                        (unsigned long long)probes);
+        }
+    } else if (lastMnkSearch.move != -1) {
+        const MnkSearchResult &search = lastMnkSearch;
+        const MnkSearchCounters &counters = search.counters;
+        ImGui::Text("Time per move: %.1f ms, %llu nodes, %.0f nodes/s, depth %d", search.elapsed / 1000.0,
+                    (unsigned long long)search.nodes, (search.elapsed > 0) ? search.nodes * 1e6 / search.elapsed : 0.0, search.depth);
+        if (SEARCH_STATS_ENABLED) {
+            ImGui::Text("Best-move table hit rate: %.1f%% of %llu probes", 100.0 * StatRatio(counters.tableHits, counters.tableProbes),
+                        (unsigned long long)counters.tableProbes);
+            ImGui::Text("Cutoffs: %llu, %.1f%% by the first move tried", (unsigned long long)counters.cutoffs,
+                        100.0 * StatRatio(counters.firstMoveCutoffs, counters.cutoffs));
+            if (counters.bookProbes > 0) ImGui::Text("Opening book: %llu hits in %llu probes",
+                        (unsigned long long)counters.bookHits, (unsigned long long)counters.bookProbes);
+        }
+        std::string pv;
+        for (int cell : search.pv) pv += CellName(cell) + " ";
+        ImGui::TextWrapped("PV: %s", pv.c_str());
+
+        // alpha-beta only proves the best move's score; the others are upper bounds
+        if (!search.rootMoves.empty() && ImGui::BeginTable("root moves", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_ScrollY,
+                                                           ImVec2(0.0f, ImGui::GetTextLineHeightWithSpacing() * 8))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Root move");
+            ImGui::TableSetupColumn("Score");
+            ImGui::TableSetupColumn("Nodes");
+            ImGui::TableHeadersRow();
+            for (const MnkRootMoveStats &root : search.rootMoves) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                if (root.move == search.move) ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "%s", CellName(root.move).c_str());
+                else ImGui::Text("%s", CellName(root.move).c_str());
+                ImGui::TableNextColumn(); ImGui::Text(root.exact ? "%+d" : "<= %+d", root.value);
+                ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)root.nodes);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    if (ImGui::Button("Write profile trace (F9)") || ImGui::IsKeyPressed(ImGuiKey_F9, false)) {
+        profileTraceEvents = ProfilerWriteChromeTrace(PROFILE_TRACE_PATH);
+        profileTraceWritten = true;
+    }
+    ImGui::SameLine();
+    if (!TICTACTOE_PROFILER) ImGui::TextDisabled("scopes compiled out (TICTACTOE_PROFILER=OFF)");
+    else if (!profileTraceWritten) ImGui::TextDisabled("for chrome://tracing or ui.perfetto.dev");
+    else if (profileTraceEvents < 0) ImGui::Text("could not write %s", PROFILE_TRACE_PATH);
+    else ImGui::Text("%d events in %s", profileTraceEvents, PROFILE_TRACE_PATH);
+
+    if (frameTimeCount > 0) {
+        const int newest = (frameTimeNext + FRAME_HISTORY - 1) % FRAME_HISTORY;
+        const float worst = *std::max_element(frameTimes, frameTimes + frameTimeCount);
+        char overlay[48];
+        std::snprintf(overlay, sizeof(overlay), "%.1f ms, worst %.1f ms", frameTimes[newest], worst);
+        // oldest sample first: once the ring buffer has wrapped, that's the next slot to be written
+        const int offset = (frameTimeCount == FRAME_HISTORY) ? frameTimeNext : 0;
+        ImGui::PlotLines("Frame time", frameTimes, frameTimeCount, offset, overlay, 0.0f, std::max(worst, 33.3f), ImVec2(0.0f, 60.0f));
+    }
+}
+
+// ----------------------- Sessions -------------------------
+static void OpenSessions(int count) {
+    const BoardVariant &v = VARIANTS[sessionVariant];
+    GameSessionSettings settings;
+    settings.width = v.width;
+    settings.height = v.height;
+    settings.winLength = v.winLength;
+    settings.ai[0] = sessionsAIvsAI;
+    settings.ai[1] = true;
+    settings.rematch = sessionsRematch;
+    // the engines always pick the same move, so AI-vs-AI games open at random to differ
+    settings.randomPlies = sessionsAIvsAI ? 2 : 0;
+    for (SelfPlayPlayer &player : settings.players) {
+        player.engine = (sessionVariant == 0) ? kEngineTable : kEngineMnk;
+        player.depth = sessionDepth;
+    }
+    for (int i = 0; i < count; ++i) sessionManager.open(settings);
+}
+
+// one session in a size x size square; clicking an empty cell plays it for a human side
+static void DrawSessionTile(GameSession &session, float size) {
+    const MnkRules &tileRules = session.rules();
+    const MnkBoard &tileBoard = session.board();
+    const float cell = size / (float)std::max(tileRules.width(), tileRules.height());
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+
+    ImGui::PushID((int)session.id());
+    ImGui::InvisibleButton("tile", ImVec2(size, size));
+    if (ImGui::IsItemClicked()) {
+        const ImVec2 mouse = ImGui::GetMousePos();
+        const int x = (int)((mouse.x - origin.x) / cell), y = (int)((mouse.y - origin.y) / cell);
+        if (x >= 0 && x < tileRules.width() && y >= 0 && y < tileRules.height()) session.play(tileRules.cellIndex(x, y));
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Session %llu: %s\n%llu games: X %llu, O %llu, draws %llu", (unsigned long long)session.id(),
+                          !session.gameOver() ? (session.aiThinking() ? "AI thinking" : "in play") :
+                          (session.winner() == 0) ? "draw" : (session.winner() == 1) ? "X won" : "O won",
+                          (unsigned long long)(session.results(0) + session.results(1) + session.results(2)),
+                          (unsigned long long)session.results(1), (unsigned long long)session.results(2),
+                          (unsigned long long)session.results(0));
+    }
+    ImGui::PopID();
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    const ImU32 border = !session.gameOver() ? IM_COL32(110, 110, 110, 255) :
+                         (session.winner() == 0) ? IM_COL32(200, 200, 80, 255) : IM_COL32(80, 200, 80, 255);
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size, origin.y + size), IM_COL32(30, 30, 34, 255));
+    drawList->AddRect(origin, ImVec2(origin.x + size, origin.y + size), border);
+    const float inset = std::max(1.0f, cell * 0.15f);
+    for (int i = 0; i < tileRules.cellCount(); ++i) {
+        const int piece = tileBoard.cellAt(i);
+        if (piece == 0) continue;
+        const ImVec2 min(origin.x + (i % tileRules.width()) * cell + inset, origin.y + (i / tileRules.width()) * cell + inset);
+        const ImVec2 max(min.x + cell - 2 * inset, min.y + cell - 2 * inset);
+        if (piece == 1) drawList->AddRectFilled(min, max, IM_COL32(230, 90, 80, 255));
+        else drawList->AddCircleFilled(ImVec2((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f), (max.x - min.x) * 0.5f, IM_COL32(80, 150, 240, 255));
+    }
+}
+
+static void DrawSessionsWindow() {
+    if (!showSessions) return;
+    ImGui::SetNextWindowSize(ImVec2(660.0f, 560.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Sessions", &showSessions)) {
+        ImGui::End();
+        return;
+    }
+
+    const char *variantNames[IM_ARRAYSIZE(VARIANTS)];
+    for (int i = 0; i < IM_ARRAYSIZE(VARIANTS); ++i) variantNames[i] = VARIANTS[i].name;
+    ImGui::SetNextItemWidth(180.0f);
+    ImGui::Combo("Board##sessions", &sessionVariant, variantNames, IM_ARRAYSIZE(VARIANTS));
+    ImGui::SameLine();
+    ImGui::BeginDisabled(sessionVariant == 0);
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::SliderInt("AI depth", &sessionDepth, 1, 6);
+    ImGui::EndDisabled();
+    ImGui::Checkbox("AI vs AI##sessions", &sessionsAIvsAI);
+    ImGui::SameLine();
+    ImGui::Checkbox("Rematch when over", &sessionsRematch);
+    ImGui::SetNextItemWidth(180.0f);
+    ImGui::SliderInt("##count", &sessionsToOpen, 1, 4096, "%d sessions", ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    if (ImGui::Button("Open")) OpenSessions(sessionsToOpen);
+    ImGui::SameLine();
+    if (ImGui::Button("Close all")) sessionManager.closeAll();
+
+    const SessionResults results = sessionManager.results();
+    ImGui::Text("%zu sessions, %zu AI requests in flight on %d threads, %llu AI moves played", sessionManager.size(),
+                sessionManager.pendingRequests(), sessionManager.threadCount(), (unsigned long long)sessionManager.aiMoves());
+    ImGui::Text("Finished games: %llu (X %llu, O %llu, draws %llu)", (unsigned long long)results.games,
+                (unsigned long long)results.xWins, (unsigned long long)results.oWins, (unsigned long long)results.draws);
+    ImGui::SetNextItemWidth(180.0f);
+    ImGui::SliderFloat("Tile size", &sessionTileSize, 32.0f, 192.0f, "%.0f px");
+    ImGui::Separator();
+
+    // only the rows in view are drawn, however many sessions there are
+    ImGui::BeginChild("tiles");
+    const float spacing = ImGui::GetStyle().ItemSpacing.x;
+    const int perRow = std::max(1, (int)((ImGui::GetContentRegionAvail().x + spacing) / (sessionTileSize + spacing)));
+    const int count = (int)sessionManager.size();
+    ImGuiListClipper clipper;
+    clipper.Begin((count + perRow - 1) / perRow, sessionTileSize + ImGui::GetStyle().ItemSpacing.y);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            for (int column = 0; column < perRow && row * perRow + column < count; ++column) {
+                if (column > 0) ImGui::SameLine();
+                DrawSessionTile(sessionManager.at(row * perRow + column), sessionTileSize);
+            }
+        }
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+// ----------------------- Chess -------------------------
+static const char *ChessStatusText(const Chess &game) {
+    switch (game.status()) {
+    case kChessCheckmate: return (game.board().sideToMove() == kWhite) ? "Checkmate: Black wins" : "Checkmate: White wins";
+    case kChessStalemate: return "Draw by stalemate";
+    case kChessFiftyMoves: return "Draw by the fifty-move rule";
+    case kChessRepetition: return "Draw by threefold repetition";
+    case kChessInsufficientMaterial: return "Draw: insufficient material";
+    default: return (game.board().sideToMove() == kWhite) ? "White to move" : "Black to move";
+    }
+}
+
+static void DrawChessWindow() {
+    if (!showChess) return;
+    ImGui::SetNextWindowSize(ImVec2(560.0f, 820.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Chess", &showChess)) {
+        ImGui::End();
+        return;
+    }
+    if (!chess) {
+        chess = new Chess();
+        chess->setUpBoard();
+    }
+    chess->updateAI();
+
+    if (ImGui::Button("New game")) chess->newGame();
+    ImGui::SameLine();
+    ImGui::BeginDisabled(chess->board().plies() == 0);
+    if (ImGui::Button("Undo")) chess->undoMove();
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    for (int color = kWhite; color <= kBlack; ++color) {
+        bool ai = chess->aiPlays(color);
+        if (ImGui::Checkbox(color == kWhite ? "AI plays White" : "AI plays Black", &ai)) chess->setAIColor(color, ai);
+        ImGui::SameLine();
+    }
+    ImGui::NewLine();
+    ChessSearchOptions &options = chess->searchOptions();
+    ImGui::SetNextItemWidth(160.0f);
+    ImGui::SliderInt("Depth limit##chess", &options.maxDepth, 1, 20);
+    ImGui::SameLine();
+    int budgetMs = (int)(options.timeBudget / 1000);
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::SliderInt("Time budget (ms)##chess", &budgetMs, 0, 10000)) options.timeBudget = (int64_t)budgetMs * 1000;
+    float glide = chess->animationSeconds();
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::SliderFloat("Move animation (s)##chess", &glide, 0.0f, 1.0f, "%.2f")) chess->setAnimationSeconds(glide);
+
+    if (chess->aiThinking()) {
+        ImGui::Text("%s, AI thinking...", ChessStatusText(*chess));
+        ImGui::SameLine();
+        if (ImGui::Button("Move now##chess")) chess->moveNow();
+    } else {
+        ImGui::Text("%s", ChessStatusText(*chess));
+    }
+    const ChessSearchResult &search = chess->lastSearch();
+    if (search.move != CHESS_NULL_MOVE) {
+        char value[32];
+        if (std::abs(search.value) >= CHESS_MATE_THRESHOLD) {
+            std::snprintf(value, sizeof(value), "%s in %d", (search.value > 0) ? "mates" : "mated", (CHESS_SCORE_MATE - std::abs(search.value) + 1) / 2);
+        } else {
+            std::snprintf(value, sizeof(value), "%+.2f", search.value / 100.0);
+        }
+        ImGui::Text("Last reply: %s, %s, depth %d%s, %llu nodes in %.1f ms, %.0f nodes/s", ChessMoveText(search.move).c_str(),
+                    value, search.depth, search.timedOut ? " (out of time)" : "", (unsigned long long)search.nodes,
+                    search.elapsed / 1000.0, (search.elapsed > 0) ? search.nodes * 1e6 / search.elapsed : 0.0);
+        if (SEARCH_STATS_ENABLED) {
+            const ChessSearchCounters &counters = search.counters;
+            ImGui::Text("TT hit rate: %.1f%% of %llu probes, %.1f%% of nodes in the capture search",
+                        100.0 * StatRatio(counters.tableHits, counters.tableProbes), (unsigned long long)counters.tableProbes,
+                        100.0 * StatRatio(counters.quiescenceNodes, search.nodes));
+        }
+        std::string pv;
+        for (ChessMove move : search.pv) pv += ChessMoveText(move) + " ";
+        ImGui::TextWrapped("PV: %s", pv.c_str());
+    }
+
+    ImGui::BeginChild("chess board", ImVec2(0.0f, 0.0f), false, ImGuiWindowFlags_HorizontalScrollbar);
+    chess->drawFrame();
+    ImGui::EndChild();
+    ImGui::End();
 }
 
 void RenderGame() {
+    RecordFrameTime();
+
+    // this frame is one of those asked for; input that arrived with it asks for a few more
+    if (redrawFrames.load() > 0) redrawFrames--;
+    if (GImGui->InputEventsTrail.Size > 0) RequestRedraw(SETTLE_FRAMES);
+
+    ApplyAIReply();
+    AdvanceAIvsAI();
+    if (replaying) replay.advance(ImGui::GetIO().DeltaTime);
+    sessionManager.update();
+
     ImGui::Begin("Tic Tac Toe", nullptr,
                  ImGuiWindowFlags_NoCollapse |
                  ImGuiWindowFlags_AlwaysAutoResize);
@@ -225,12 +934,45 @@ void RenderGame() {
 
     if (ImGui::Button("Reset")) ResetGame();
     ImGui::SameLine();
+    ImGui::BeginDisabled(!history.canUndo());
+    if (ImGui::Button("Undo")) UndoTurn();
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!history.canRedo() || aiThinking);
+    if (ImGui::Button("Redo")) RedoTurn();
+    ImGui::EndDisabled();
+    ImGui::SameLine();
     ImGui::Checkbox("Play vs AI (O)", &aiEnabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("AI vs AI", &gameOptions.AIvsAI);
+    ImGui::SameLine();
+    const char *strengths[] = { "Easy", "Medium", "Hard" };
+    int strength = (int)aiStrength;
+    ImGui::SetNextItemWidth(100.0f);
+    if (ImGui::Combo("AI strength", &strength, strengths, IM_ARRAYSIZE(strengths))) aiStrength = (MnkStrength)strength;
+    const char *variantNames[IM_ARRAYSIZE(VARIANTS)];
+    for (int i = 0; i < IM_ARRAYSIZE(VARIANTS); ++i) variantNames[i] = VARIANTS[i].name;
+    ImGui::SetNextItemWidth(180.0f);
+    if (ImGui::Combo("Board", &variant, variantNames, IM_ARRAYSIZE(VARIANTS))) {
+        gameOptions.AIMAXDepth = VARIANTS[variant].aiDepth;
+        ResetGame();
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Sessions window", &showSessions);
+    ImGui::SameLine();
+    ImGui::Checkbox("Chess window", &showChess);
 
     ImGui::Separator();
 
-    if (!gameOver) {
-        if (aiEnabled)
+    if (replaying) {
+        ImGui::Text("Replaying: the game is back when the replay closes");
+    } else if (!gameOver) {
+        if (aiThinking) {
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aiStarted).count();
+            ImGui::Text("Turn: AI (O) thinking... %.1f s", ms / 1000.0);
+            ImGui::SameLine();
+            if (ImGui::Button("Move now")) aiWorker.stop();
+        } else if (aiEnabled)
             ImGui::Text("Turn: %s", (currentPlayer == 1) ? "Player 1 (X)" : "AI (O)");
         else
             ImGui::Text("Turn: %s", (currentPlayer == 1) ? "Player 1 (X)" : "Player 2 (O)");
@@ -240,21 +982,118 @@ void RenderGame() {
     }
 
     DrawBoardUI();
+    DrawReplayUI();
 
-    ImGui::Separator();
-    ImGui::TextDisabled("Rubric checklist (Negamax):");
-    ImGui::BulletText("Algorithm coded in Negamax form");
-    ImGui::BulletText("AI plays as second player (O)");
-    ImGui::BulletText("Better than random (perfect play)");
-    ImGui::BulletText("Reset + cleanup provided");
+    ImGui::SeparatorText("AI Search");
+    ImGui::SliderInt("Search threads", &aiThreads, 1, SearchThreadCount(0));
+    if (!(ClassicBoard() && aiStrength == kMnkStrengthHard)) {
+        // turning it off mid-ponder frees the worker; a reply in progress is left alone
+        if (ImGui::Checkbox("Ponder on the human's time", &ponderEnabled) && !ponderEnabled && !aiThinking) {
+            aiWorker.cancel();
+            ponder.clear();
+        }
+        if (ponderEnabled) {
+            ImGui::SameLine();
+            ImGui::Text("%llu hits, %llu misses; %d of %d guessed replies answered", (unsigned long long)ponder.hits(),
+                        (unsigned long long)ponder.misses(), ponder.answered(), ponder.guessed());
+        }
+        if (lastReplyPondered) ImGui::Text("Last reply was pondered: %.2f ms after the human's move", lastReplyMs);
+    }
+    if (ClassicBoard()) {
+        const char *modes[] = { SearchModeName(kSearchPlain), SearchModeName(kSearchAlphaBeta), SearchModeName(kSearchNullWindow), SearchModeName(kSearchTable) };
+        int mode = (int)searchOptions.mode;
+        if (ImGui::Combo("Search", &mode, modes, IM_ARRAYSIZE(modes))) searchOptions.mode = (SearchMode)mode;
+        ImGui::Checkbox("Aspiration window (-1, +1)", &aspiration);
+        ImGui::SameLine();
+        ImGui::Checkbox("Transposition table", &useTable);
+        ImGui::SameLine();
+        ImGui::Checkbox("Symmetry reduction", &searchOptions.symmetry);
+        if (searchOptions.mode == kSearchTable) {
+            ImGui::Checkbox("Verify table against live search", &verifyTable);
+            if (verifyTable) ImGui::Text("Table/search mismatches: %d", tableMismatches.load());
+        }
+        if (aiStrength != kMnkStrengthHard) {
+            // the limits the level puts on the user's own depth, as MnkAIOptions() gets them
+            MnkSearchOptions limits;
+            if (gameOptions.AIMAXDepth > 0) limits.maxDepth = gameOptions.AIMAXDepth;
+            MnkApplyStrength(limits, aiStrength);
+            ImGui::Text("%s: depth %d at most, %llu of %llu nodes, softmax over the root moves", strengths[aiStrength],
+                        limits.maxDepth, (unsigned long long)lastMnkSearch.nodes, (unsigned long long)limits.nodeBudget);
+            if (lastMnkSearch.move != -1) ImGui::Text("Last reply: cell %d, value %+d%s", lastMnkSearch.move, lastMnkSearch.value,
+                                                      lastMnkSearch.sampled ? " (drawn, not the best)" : "");
+        } else if (lastSearch.fromTable) {
+            ImGui::Text("Last reply: cell %d, value %+d, from the perfect-play table (no search)", lastSearch.move, lastSearch.value);
+        } else if (lastSearch.move != -1) {
+            ImGui::Text("Last reply: cell %d, value %+d, %llu nodes%s", lastSearch.move, lastSearch.value,
+                        (unsigned long long)lastSearch.nodes, lastSearch.researches ? " (re-searched)" : "");
+        }
+        // the counters are only stable while the worker leaves the table alone
+        if (SEARCH_STATS_ENABLED && !aiThinking) ImGui::Text("TT: %llu hits, %llu misses, %llu stores (%zu KB)",
+                    (unsigned long long)transpositionTable.hits(), (unsigned long long)transpositionTable.misses(),
+                    (unsigned long long)transpositionTable.stores(), transpositionTable.sizeInBytes() / 1024);
+
+    } else {
+        ImGui::SliderInt("Depth limit", &gameOptions.AIMAXDepth, 1, 12);
+        int budgetMs = (int)(gameOptions.AITimeBudget / 1000);
+        if (ImGui::SliderInt("Time budget (ms, 0 = none)", &budgetMs, 0, 5000)) gameOptions.AITimeBudget = (int64_t)budgetMs * 1000;
+        ImGui::Checkbox("Dynamic move ordering", &mnkDynamicOrdering);
+        if (openingBook.isOpen()) ImGui::Text("Opening book: %zu positions, up to ply %d", openingBook.size(), openingBook.maxPly());
+        if (tablebase.isOpen()) ImGui::Text("Tablebase: %llu positions, %zu KB mapped",
+                                            (unsigned long long)tablebase.positionCount(), tablebase.sizeInBytes() / 1024);
+        if (lastMnkSearch.fromTablebase) {
+            ImGui::Text("Last reply: (%d, %d), value %+d, from the tablebase (no search)",
+                        lastMnkSearch.move % rules.width(), lastMnkSearch.move / rules.width(), lastMnkSearch.value);
+        } else if (lastMnkSearch.fromBook) {
+            ImGui::Text("Last reply: (%d, %d), value %+d, from the opening book (no search)",
+                        lastMnkSearch.move % rules.width(), lastMnkSearch.move / rules.width(), lastMnkSearch.value);
+        } else if (lastMnkSearch.fromThreatSearch) {
+            ImGui::Text("Last reply: (%d, %d), forced win in %d plies by continuous fours, %llu threat-search nodes",
+                        lastMnkSearch.move % rules.width(), lastMnkSearch.move / rules.width(),
+                        MNK_SCORE_WIN - lastMnkSearch.value, (unsigned long long)lastMnkSearch.nodes);
+        } else if (lastMnkSearch.move != -1) {
+            ImGui::Text("Last reply: (%d, %d), value %+d, depth %d%s%s%s, %llu nodes in %.1f ms",
+                        lastMnkSearch.move % rules.width(), lastMnkSearch.move / rules.width(), lastMnkSearch.value,
+                        lastMnkSearch.depth, lastMnkSearch.solved ? " (solved)" : "", lastMnkSearch.timedOut ? " (out of budget)" : "",
+                        lastMnkSearch.sampled ? " (drawn, not the best)" : "",
+                        (unsigned long long)lastMnkSearch.nodes, lastMnkSearch.elapsed / 1000.0);
+            if (ImGui::BeginTable("iterations", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit)) {
+                ImGui::TableSetupColumn("Depth");
+                ImGui::TableSetupColumn("Move");
+                ImGui::TableSetupColumn("Value");
+                ImGui::TableSetupColumn("Nodes");
+                ImGui::TableSetupColumn("ms");
+                ImGui::TableHeadersRow();
+                for (const MnkIterationStats &it : lastMnkSearch.iterations) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::Text("%d", it.depth);
+                    ImGui::TableNextColumn(); ImGui::Text("(%d, %d)", it.move % rules.width(), it.move / rules.width());
+                    ImGui::TableNextColumn(); ImGui::Text("%+d", it.value);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)it.nodes);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", it.elapsed / 1000.0);
+                }
+                ImGui::EndTable();
+            }
+        }
+    }
+
+    DrawTelemetryUI();
     ImGui::End();
+
+    DrawSessionsWindow();
+    DrawChessWindow();
+
+    // measured from the start of this frame to the next, if the loop doesn't sleep in between
+    lastFrameContinuous = (FrameWaitSeconds() == 0.0);
 }
 
 // -------------------- Cleanup hook ------------------
 void StopGame() {
-    // No heap allocations in this implementation.
-    // Reset state for clean shutdown / restart.
+    // Reset state for clean shutdown / restart: the board's game, the hosted sessions and the
+    // Chess window's game.
     ResetGame();
+    sessionManager.closeAll();
+    delete chess;
+    chess = nullptr;
 }
 
 } // namespace ClassGame
@@ -4,4 +4,12 @@ namespace ClassGame {
     void GameStartUp();
     void RenderGame();
     void EndOfTurn();
+
+    // idle rendering: the main loop sleeps on its event queue between frames instead of spinning
+    // seconds it may wait before drawing the next frame: 0 = draw straight away, < 0 = until an event
+    double FrameWaitSeconds();
+    // ask for more frames; safe from any thread, e.g. when a search finishes or an animation runs
+    void RequestRedraw(int frames = 1);
+    // installed by the main loop: wakes its event wait from another thread
+    void SetWakeCallback(void (*wake)());
 }
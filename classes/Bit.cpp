@@ -24,7 +24,6 @@ void Bit::setPickedUp(bool up)
 {
 	if (up != _pickedUp) {
 		float opacity = 0.0f;
-		float scale = 1.0f;
 		float rotation = 0.0f;
 		int z;
 
@@ -33,7 +32,6 @@ void Bit::setPickedUp(bool up)
 			z = bitz::kPickupUpZ;
 			_restingZ = getLocalZOrder();
 			_restingTransform = getRotation();
-			scale = kPickedUpScale;
 		}
 		else {
 			opacity = 1.0f;
@@ -42,9 +40,8 @@ void Bit::setPickedUp(bool up)
 				z = _restingZ;
 			}
 			rotation = _restingTransform;
-			scale = 1.0f;
 		}
-		setScale(scale);					// todo: animate this
+		// the scale is left to the game, which tweens it to kPickedUpScale and back
 		setLocalZOrder(z);
 		setOpacity( opacity );
 		setRotation( rotation );
@@ -1,12 +1,13 @@
 #pragma once
 
 #include "Sprite.h"
+#include "EntityPool.h"
 
 class Player;
 class BitHolder;
 
 //
-// these aren't used yet but will be used for dragging pieces
+// a dragged piece is drawn this much larger, Game tweens it up and back down
 //
 #define kPickedUpScale   1.2f
 #define kPickedUpOpacity 255
@@ -23,13 +24,18 @@ enum bitz
 class Bit : public Sprite
 {
 public:
-	Bit() : Sprite() { _pickedUp = false; _owner = nullptr; _gameTag = 0; };
+	Bit() : Sprite() { _pickedUp = false; _animating = false; _owner = nullptr; _gameTag = 0; };
 	
 	~Bit();
 
+	ENTITY_POOL_ALLOCATED(Bit)
+
 	// helper functions
 	bool 		getPickedUp();
 	void 		setPickedUp(bool yes);
+	// in a TweenScheduler: drawn over the board each frame rather than from its cached list
+	bool		isAnimating() const { return _animating; }
+	void		setAnimating(bool yes) { _animating = yes; }
 
 	// am I in a holder? nullptr if I'm not.
 	BitHolder*	getHolder();
@@ -49,6 +55,7 @@ private:
 	int			_restingZ;
 	float		_restingTransform;
 	bool		_pickedUp;
+	bool		_animating;
 	Player*		_owner;
 	int			_gameTag;
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+//
+// the logical board, kept apart from the Square sprites that draw it: one byte per cell in a
+// flat row-major array, so reading the whole of a 19x19 board touches 361 contiguous bytes
+// rather than 361 holders with their colors, textures and transforms
+// owners are stored as state-string characters ('0' empty, '1', '2'), so the array is the
+// board's state string as it stands and stateView() costs nothing
+//
+
+class CellStore
+{
+public:
+    // width x height empty cells
+    void        reset(int width, int height)
+    {
+        _width = width;
+        _height = height;
+        _owners.assign((size_t)(width * height), '0');
+        _occupied = 0;
+    }
+
+    int         width() const { return _width; }
+    int         height() const { return _height; }
+    int         size() const { return (int)_owners.size(); }
+    int         index(int x, int y) const { return y * _width + x; }
+
+    // 0 empty, 1 or 2: the player number + 1, as in state strings
+    int         owner(int cell) const { return _owners[cell] - '0'; }
+    bool        empty(int cell) const { return _owners[cell] == '0'; }
+    int         occupied() const { return _occupied; }
+    void        setOwner(int cell, int player)
+    {
+        const char next = (player == 1 || player == 2) ? (char)('0' + player) : '0';
+        _occupied += (next != '0') - (_owners[cell] != '0');
+        _owners[cell] = next;
+    }
+    void        clear()
+    {
+        _owners.assign(_owners.size(), '0');
+        _occupied = 0;
+    }
+
+    std::string_view stateView() const { return std::string_view(_owners.data(), _owners.size()); }
+
+private:
+    int                 _width = 0;
+    int                 _height = 0;
+    std::vector<char>   _owners;
+    int                 _occupied = 0;
+};
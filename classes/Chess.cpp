@@ -0,0 +1,384 @@
+#include "Chess.h"
+#include "../Application.h"
+#include <algorithm>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Chess.cpp
+// -----------------------------------------------------------------------------
+// Chess on the same Bit / BitHolder grid as TicTacToe. The position itself is an
+// engine ChessBoard (bitboards, legal moves, check and draw rules), so the holders
+// only show it: after every move the squares that changed get their Bits swapped.
+//
+// A piece is moved by dragging it to its square, or with two clicks: one on a
+// piece of the side to move, which highlights the squares it can go to, and one
+// on the destination. Either way the pieces that move glide there. A pawn that
+// reaches the last rank becomes a queen. The AI searches on its own worker thread
+// (engine/AIWorker.h) and its move is played by updateAI() on a later frame.
+// -----------------------------------------------------------------------------
+
+constexpr float CHESS_PITCH = 64.0f;        // pixels per square, the sprites are scaled to it
+constexpr float CHESS_ORIGIN = 8.0f;
+
+// sprite of each piece, by colour * 6 + type; the white knight's file is named w_kinight.png
+static const char *PIECE_SPRITES[12] = {
+    "w_pawn.png", "w_kinight.png", "w_bishop.png", "w_rook.png", "w_queen.png", "w_king.png",
+    "b_pawn.png", "b_knight.png", "b_bishop.png", "b_rook.png", "b_queen.png", "b_king.png",
+};
+
+// holder tints: the two colours of square with a1 dark, which Square::initHolder() has the
+// other way round, then the highlights
+static const ImVec4 LIGHT_SQUARE(1.0f, 1.0f, 1.0f, 1.0f);
+static const ImVec4 DARK_SQUARE(0.5f, 0.5f, 0.75f, 1.0f);
+static const ImVec4 SELECTED_SQUARE(1.0f, 0.9f, 0.4f, 1.0f);
+static const ImVec4 TARGET_SQUARE(0.55f, 0.85f, 0.55f, 1.0f);
+static const ImVec4 LAST_MOVE_SQUARE(0.85f, 0.75f, 0.5f, 1.0f);
+
+Chess::Chess()
+{
+    _status = kChessPlaying;
+    _selected = -1;
+    _aiColor[kWhite] = false;
+    _aiColor[kBlack] = true;
+    _aiThinking = false;
+    _aiKey = 0;
+    _lastReplyMs = 0.0;
+    // a move a second unless the player asks for more
+    _searchOptions.maxDepth = 8;
+    _searchOptions.timeBudget = 1000000;
+}
+
+Chess::~Chess()
+{
+    // the search holds a pointer to _table
+    cancelSearch();
+}
+
+Bit* Chess::PieceForSquare(int piece)
+{
+    Bit *bit = new Bit();
+    bit->LoadTextureFromFile(PIECE_SPRITES[piece]);
+    bit->setSize(CHESS_PITCH, CHESS_PITCH);
+    bit->setOwner(getPlayerAt(ChessPieceColor(piece)));
+    bit->setGameTag(piece);
+    return bit;
+}
+
+//
+// setup the game board, this is called once at the start of the game
+//
+void Chess::setUpBoard()
+{
+    setNumberOfPlayers(2);
+    setUpHolders(8, 8);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            Square &holder = holderAt(_cells.index(x, y));
+            holder.initHolder(ImVec2(x * CHESS_PITCH + CHESS_ORIGIN, y * CHESS_PITCH + CHESS_ORIGIN), "square.png", x, y);
+            holder.setSize(CHESS_PITCH, CHESS_PITCH);
+        }
+    }
+    setHolderGrid(ImVec2(CHESS_ORIGIN, CHESS_ORIGIN), ImVec2(CHESS_PITCH, CHESS_PITCH));
+    // a finished search wakes the main loop so its move is played without waiting for input
+    _aiWorker.setReplyCallback([] { ClassGame::RequestRedraw(); });
+    newGame();
+}
+
+void Chess::newGame(std::string_view fen)
+{
+    cancelSearch();
+    if (!_board.setFen(fen)) {
+        _board.setFen(ChessBoard::START_FEN);
+    }
+    _table.clear();
+    _lastSearch = ChessSearchResult();
+    _selected = -1;
+    syncHolders();
+    refresh();
+    updateHighlights();
+    startGame();
+}
+
+void Chess::cancelSearch()
+{
+    _aiWorker.cancel();
+    _aiWorker.wait();
+    _aiThinking = false;
+}
+
+void Chess::setAIColor(int color, bool ai)
+{
+    _aiColor[color] = ai;
+    if (!ai && _aiThinking && _board.sideToMove() == color) {
+        cancelSearch();
+    }
+}
+
+int Chess::shownAt(int cell)
+{
+    Bit *bit = holderAt(cell).bit();
+    return bit ? bit->gameTag() : CHESS_NO_PIECE;
+}
+
+//
+// only the squares whose piece differs from what is drawn change: the Bits taken off them are
+// kept and put back on squares that want the same piece before any new Bit is made, so a move
+// carries its sprite along, gliding from where it was, and loads no texture
+// a piece already dropped on its square by a drag is left where it is
+//
+void Chess::syncHolders()
+{
+    cancelDrag();
+    std::vector<Bit *> spare[12];
+    for (int cell = 0; cell < 64; cell++) {
+        const int shown = shownAt(cell);
+        if (shown == _board.pieceAt(squareForCell(cell)) || shown == CHESS_NO_PIECE) {
+            continue;
+        }
+        BitHolder &holder = holderAt(cell);
+        Bit *bit = holder.bit();
+        // held while it is off the board, or destroyBit() would free it
+        bit->retain();
+        spare[shown].push_back(bit);
+        holder.destroyBit();
+    }
+    for (int cell = 0; cell < 64; cell++) {
+        const int wanted = _board.pieceAt(squareForCell(cell));
+        _cells.setOwner(cell, (wanted == CHESS_NO_PIECE) ? 0 : ChessPieceColor(wanted) + 1);
+        if (shownAt(cell) == wanted) {
+            continue;
+        }
+        BitHolder &holder = holderAt(cell);
+        const bool reuse = !spare[wanted].empty();
+        Bit *bit = reuse ? spare[wanted].back() : PieceForSquare(wanted);
+        holder.setBit(bit);
+        if (reuse) {
+            spare[wanted].pop_back();
+            animateBitTo(bit, holder.getPosition());
+            bit->release();
+        } else {
+            bit->setPosition(holder.getPosition());
+        }
+    }
+    for (std::vector<Bit *> &bits : spare) {
+        for (Bit *bit : bits) bit->release();
+    }
+    markBoardDirty();
+}
+
+void Chess::refresh()
+{
+    _board.legalMoves(_legal);
+    _status = _board.status();
+}
+
+ChessMove Chess::findMove(int from, int to) const
+{
+    // promotions are generated queen first
+    for (ChessMove move : _legal) {
+        if (ChessMoveFrom(move) == from && ChessMoveTo(move) == to) return move;
+    }
+    return CHESS_NULL_MOVE;
+}
+
+void Chess::updateHighlights()
+{
+    const ChessMove last = _board.lastMove();
+    for (int cell = 0; cell < 64; cell++) {
+        const int square = squareForCell(cell);
+        ImVec4 color = ((cell % 8 + cell / 8) % 2 == 1) ? DARK_SQUARE : LIGHT_SQUARE;
+        if (square == _selected) {
+            color = SELECTED_SQUARE;
+        } else if (_selected >= 0 && findMove(_selected, square) != CHESS_NULL_MOVE) {
+            color = TARGET_SQUARE;
+        } else if (last != CHESS_NULL_MOVE && (square == ChessMoveFrom(last) || square == ChessMoveTo(last))) {
+            color = LAST_MOVE_SQUARE;
+        }
+        holderAt(cell).setColor(color.x, color.y, color.z, color.w);
+    }
+    markBoardDirty();
+}
+
+//
+// clicks: the first picks up a piece of the side to move, the second puts it down on one of
+// its targets; a click anywhere else picks up that piece instead, or drops the selection
+//
+bool Chess::actionForEmptyHolder(BitHolder *holder)
+{
+    const int cell = cellOf(holder);
+    if (cell < 0 || _status != kChessPlaying || _aiThinking || _aiColor[_board.sideToMove()]) {
+        return false;
+    }
+    const int square = squareForCell(cell);
+    if (_selected >= 0) {
+        BitHolder &src = holderAt(cellForSquare(_selected));
+        if (src.bit() && canBitMoveFromTo(src.bit(), &src, holder)) {
+            playMove(findMove(_selected, square));
+            return false;
+        }
+    }
+    Bit *bit = holder->bit();
+    _selected = (bit && canBitMoveFrom(bit, holder)) ? square : -1;
+    updateHighlights();
+    // playMove() ends the turn itself
+    return false;
+}
+
+bool Chess::canBitMoveFrom(Bit *bit, BitHolder *src)
+{
+    const int cell = cellOf(src);
+    if (cell < 0 || _status != kChessPlaying || _aiThinking || _aiColor[_board.sideToMove()] || !bit->getOwner() || bit->getOwner()->playerNumber() != _board.sideToMove()) {
+        return false;
+    }
+    const int from = squareForCell(cell);
+    for (ChessMove move : _legal) {
+        if (ChessMoveFrom(move) == from) return true;
+    }
+    return false;
+}
+
+bool Chess::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
+{
+    const int from = cellOf(src), to = cellOf(dst);
+    return from >= 0 && to >= 0 && canBitMoveFrom(bit, src) &&
+           findMove(squareForCell(from), squareForCell(to)) != CHESS_NULL_MOVE;
+}
+
+bool Chess::playMove(ChessMove move)
+{
+    if (move == CHESS_NULL_MOVE || std::find(_legal.begin(), _legal.end(), move) == _legal.end()) {
+        return false;
+    }
+    _board.makeMove(move);
+    syncHolders();
+    finishMove();
+    return true;
+}
+
+//
+// a drag has already put bit on dst: make the move it stands for, a queen for a promotion, and
+// let syncHolders() see to the rest of it, a capture en passant, a castling rook or the new queen
+//
+void Chess::bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst)
+{
+    const int from = cellOf(src), to = cellOf(dst);
+    const ChessMove move = (from >= 0 && to >= 0) ? findMove(squareForCell(from), squareForCell(to)) : CHESS_NULL_MOVE;
+    if (move == CHESS_NULL_MOVE) {
+        // canBitMoveFromTo() let the drop through, so this shouldn't happen; put the piece back
+        syncHolders();
+        return;
+    }
+    _board.makeMove(move);
+    syncHolders();
+    finishMove();
+}
+
+void Chess::finishMove()
+{
+    _selected = -1;
+    refresh();
+    updateHighlights();
+    endTurn();
+}
+
+bool Chess::undoMove()
+{
+    if (_board.plies() == 0) {
+        return false;
+    }
+    cancelSearch();
+    // against the AI, back to the last position where a human was to move
+    const bool oneHuman = _aiColor[kWhite] != _aiColor[kBlack];
+    do {
+        _board.unmakeMove();
+        _history.undo();
+        if (_gameOptions.currentTurnNo > 0) _gameOptions.currentTurnNo--;
+    } while (oneHuman && _aiColor[_board.sideToMove()] && _board.plies() > 0);
+    _selected = -1;
+    syncHolders();
+    refresh();
+    updateHighlights();
+    return true;
+}
+
+//
+// this is the function that will be called by the AI
+// a search is posted when the AI is to move and its move played once the worker has it, so
+// the board keeps drawing while it thinks
+//
+void Chess::updateAI()
+{
+    if (_aiThinking) {
+        AIReply reply;
+        if (!_aiWorker.poll(reply)) {
+            return;
+        }
+        _aiThinking = false;
+        _lastReplyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _aiStarted).count();
+        _lastSearch = reply.chessSearch;
+        if (_board.key() == _aiKey) {
+            playMove((ChessMove)reply.move);
+        }
+        return;
+    }
+    if (_status != kChessPlaying || !_aiColor[_board.sideToMove()]) {
+        return;
+    }
+    ChessSearchOptions options = _searchOptions;
+    // the worker runs one job at a time, and cancelSearch() waits for it before the table goes
+    options.table = &_table;
+    _aiKey = _board.key();
+    _aiWorker.post([position = _board, options](const std::atomic<bool> &stop) mutable {
+        options.stop = &stop;
+        AIReply reply;
+        reply.chessSearch = ChessSearchBestMove(position, options);
+        reply.move = reply.chessSearch.move;
+        return reply;
+    });
+    _aiThinking = true;
+    _aiStarted = std::chrono::steady_clock::now();
+}
+
+void Chess::stopGame()
+{
+    cancelSearch();
+    cancelDrag();
+    for (Square &holder : holders()) {
+        holder.destroyBit();
+    }
+    _cells.clear();
+    _selected = -1;
+    markBoardDirty();
+}
+
+//
+// the side to move is mated: the other one won
+//
+Player* Chess::checkForWinner()
+{
+    return (_status == kChessCheckmate) ? getPlayerAt(_board.sideToMove() ^ 1) : nullptr;
+}
+
+bool Chess::checkForDraw()
+{
+    return _status != kChessPlaying && _status != kChessCheckmate;
+}
+
+std::string Chess::initialStateString()
+{
+    return ChessBoard::START_FEN;
+}
+
+void Chess::setStateString(std::string_view s)
+{
+    ChessBoard board;
+    if (!board.setFen(s)) {
+        return;
+    }
+    cancelSearch();
+    _board = board;
+    _selected = -1;
+    syncHolders();
+    refresh();
+    updateHighlights();
+}
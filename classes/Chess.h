@@ -0,0 +1,98 @@
+#pragma once
+#include <chrono>
+#include "Game.h"
+#include "Square.h"
+#include "../engine/AIWorker.h"
+#include "../engine/ChessBoard.h"
+#include "../engine/ChessSearch.h"
+
+//
+// chess on the Game board, drawn with the piece sprites in resources/
+// the rules, move generation and search live in engine/ChessBoard.h and engine/ChessSearch.h;
+// this class keeps the holders in step with a ChessBoard and turns clicks into moves
+//
+
+//
+// the main game class
+//
+class Chess final : public Game
+{
+public:
+    Chess();
+    ~Chess();
+
+    // set up the board
+    void        setUpBoard() override;
+
+    Player*     checkForWinner() override;
+    bool        checkForDraw() override;
+    // for chess the state string taken and given here is a FEN; stateView() is still the owner
+    // of each cell, which is what the base class records in its history
+    std::string initialStateString() override;
+    void        setStateString(std::string_view s) override;
+    bool        actionForEmptyHolder(BitHolder *holder) override;
+    bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
+    bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
+    void        bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst) override;
+    void        stopGame() override;
+
+    // called every frame: plays a finished search's move, or starts one when the AI is to move
+    void        updateAI() override;
+    bool        gameHasAI() override { return true; }
+
+    const ChessBoard &board() const { return _board; }
+    ChessStatus status() const { return _status; }
+    // plays a legal move and updates the holders it touches; false if move isn't legal
+    bool        playMove(ChessMove move);
+    // takes back the last move, or against the AI the last move of each side
+    bool        undoMove();
+    // back to the starting position, or fen if given and valid
+    void        newGame(std::string_view fen = ChessBoard::START_FEN);
+
+    // which colours the AI plays
+    void        setAIColor(int color, bool ai);
+    bool        aiPlays(int color) const { return _aiColor[color]; }
+    bool        aiThinking() const { return _aiThinking; }
+    // ask a running search to answer now with its best move so far
+    void        moveNow() { _aiWorker.stop(); }
+    // read by the next search; the table is kept for the whole game
+    ChessSearchOptions &searchOptions() { return _searchOptions; }
+    const ChessTranspositionTable &table() const { return _table; }
+    const ChessSearchResult &lastSearch() const { return _lastSearch; }
+    double      lastReplyMs() const { return _lastReplyMs; }
+
+private:
+    Bit *       PieceForSquare(int piece);
+    // the holder of a square: rank 8 is the top row, as white sees the board
+    static int  cellForSquare(int square) { return (7 - ChessRank(square)) * 8 + ChessFile(square); }
+    static int  squareForCell(int cell) { return ChessSquare(cell % 8, 7 - cell / 8); }
+    // the piece drawn on a cell, the gameTag of its bit; CHESS_NO_PIECE if none
+    int         shownAt(int cell);
+    // brings the holders in line with _board, touching only the squares that changed; a bit
+    // that moves to another square glides there
+    void        syncHolders();
+    // after every move, however it was made: the status, the highlights and the turn
+    void        finishMove();
+    // colours the selected square, its targets and the last move's squares
+    void        updateHighlights();
+    // after every change to _board: the legal moves the clicks are checked against, and the status
+    void        refresh();
+    // the legal move from one square to another, a queen for a promotion; CHESS_NULL_MOVE if none
+    ChessMove   findMove(int from, int to) const;
+    void        cancelSearch();
+
+    ChessBoard              _board;
+    ChessStatus             _status;
+    ChessMoveList           _legal;
+    int                     _selected;          // square picked up by a click, -1 if none
+
+    AIWorker                _aiWorker;
+    ChessTranspositionTable _table;
+    ChessSearchOptions      _searchOptions;
+    ChessSearchResult       _lastSearch;
+    bool                    _aiColor[2];
+    bool                    _aiThinking;
+    uint64_t                _aiKey;             // position the running search was asked about
+    std::chrono::steady_clock::time_point _aiStarted;
+    double                  _lastReplyMs;
+};
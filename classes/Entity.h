@@ -14,6 +14,8 @@ public:
 
     Entity() : _entityType(EntityNone), _parent(nullptr), _retainCount(0) {};
     Entity(EntityType type) : _entityType(type) {};
+    // virtual so the `delete this` below destroys, and frees through, the real class
+    virtual ~Entity() {}
 
     EntityType getEntityType() {return _entityType; }
     
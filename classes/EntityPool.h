@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+//
+// fixed-size object pool for the game entities (Bit, Turn, Player)
+// memory comes in slabs of SLAB_OBJECTS slots and is never handed back to the heap while the
+// pool lives, so a freed slot is reused by the next object of the same type: a long run of
+// self-play games allocates a handful of slabs and then nothing more
+// the classes route their operator new/delete here, so `new Bit()` and `delete this` keep working
+// the pools are for the render thread only, like the entities themselves
+// objects are freed one by one: a pool is shared by every game alive at once, and Player and
+// Turn have destructors to run, so there is no releasing a whole pool in one go
+//
+
+template <typename T>
+class EntityPool
+{
+public:
+    static constexpr size_t SLAB_OBJECTS = 64;
+
+    static EntityPool &instance()
+    {
+        static EntityPool pool;
+        return pool;
+    }
+
+    void *allocate()
+    {
+        _live++;
+        if (_free) {
+            Slot *slot = _free;
+            _free = slot->next;
+            return slot;
+        }
+        if (_slabs.empty() || _used == SLAB_OBJECTS) {
+            _slabs.push_back(std::make_unique<Slot[]>(SLAB_OBJECTS));
+            _used = 0;
+        }
+        return &_slabs.back()[_used++];
+    }
+
+    void deallocate(void *object)
+    {
+        if (!object) return;
+        Slot *slot = static_cast<Slot *>(object);
+        slot->next = _free;
+        _free = slot;
+        _live--;
+    }
+
+    size_t liveCount() const { return _live; }
+    size_t capacity() const { return _slabs.size() * SLAB_OBJECTS; }
+
+private:
+    EntityPool() = default;
+
+    union Slot
+    {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> _slabs;
+    Slot    *_free = nullptr;
+    size_t  _used = 0;          // slots handed out from _slabs.back()
+    size_t  _live = 0;
+};
+
+//
+// put inside a class to allocate it, and only it, from its EntityPool
+// a derived class of a different size has to declare its own
+//
+#define ENTITY_POOL_ALLOCATED(Class) \
+    static void *operator new(size_t size) \
+    { \
+        return (size == sizeof(Class)) ? EntityPool<Class>::instance().allocate() : ::operator new(size); \
+    } \
+    static void operator delete(void *object, size_t size) \
+    { \
+        if (size == sizeof(Class)) EntityPool<Class>::instance().deallocate(object); \
+        else ::operator delete(object); \
+    }
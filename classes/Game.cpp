@@ -2,7 +2,15 @@
 #include "Bit.h"
 #include "BitHolder.h"
 #include "Turn.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include "../Application.h"
+#include "../engine/Profiler.h"
+#include "../engine/StateString.h"
+
+// how long a bit takes to glide into place, or back after a refused drop
+constexpr float DEFAULT_ANIMATION_SECONDS = 0.18f;
 
 Game::Game()
 {
@@ -15,6 +23,8 @@ Game::Game()
 	_gameOptions.rowY = 0;
 	_gameOptions.score = 0;
 	_gameOptions.AIDepthSearches = 0;
+	_gameOptions.AIMAXDepth = 0;
+	_gameOptions.AITimeBudget = 0;
 	_gameOptions.AIvsAI = false;
 	
 	_score = 0;
@@ -22,10 +32,37 @@ Game::Game()
 	_winner = nullptr;
 	_lastMove = "";
 	_gameNumber = -1;
+	_boardExtent = ImVec2(0, 0);
+	_boardDirty = true;
+	_holderGridOrigin = ImVec2(0, 0);
+	_holderGridPitch = ImVec2(0, 0);
+	_hoveredHolder = nullptr;
+	_animationSeconds = DEFAULT_ANIMATION_SECONDS;
+	_pressHolder = nullptr;
+	_dragBit = nullptr;
+	_dragSource = nullptr;
+	_dragOffset = ImVec2(0, 0);
 }
 
 
 Game::~Game()
+{
+	cancelDrag();
+	_tweens.clear();
+	releaseTurnsAndPlayers();
+
+	_score = 0;
+	_table = nullptr;
+	_winner = nullptr;
+	_gameOptions.currentTurnNo = 0;
+	_lastMove = "";
+}
+
+//
+// turns and players come from their EntityPools, so this hands the slots back for the next game
+// rather than returning memory to the heap
+//
+void Game::releaseTurnsAndPlayers()
 {
 	for (auto & _turn : _turns) {
 		delete _turn;
@@ -35,17 +72,11 @@ Game::~Game()
 		delete _player;
 	}
 	_players.clear();
-
-	_score = 0;
-	_table = nullptr;
-	_winner = nullptr;
-	_gameOptions.currentTurnNo = 0;
-	_lastMove = "";
 }
 
 void Game::setNumberOfPlayers(unsigned int n)
 {
-	_players.clear();
+	releaseTurnsAndPlayers();
 	for (unsigned int i = 1; i <= n; i++)
 	{
 		Player *player = Player::initWithGame(this);
@@ -58,7 +89,6 @@ void Game::setNumberOfPlayers(unsigned int n)
 	_gameNumber = 0;
 	_gameOptions.numberOfPlayers = n;
 	Turn *turn = Turn::initStartOfGame(this);
-	_turns.clear();
 	_turns.push_back(turn);
 }
 
@@ -71,28 +101,132 @@ void Game::setAIPlayer(unsigned int playerNumber)
 
 void Game::startGame()
 {
-	std::string startState = stateString();
+	const std::string_view startState = stateView();
 	Turn *turn = _turns.at(0);
 	turn->_boardState = startState;
 	turn->_gameNumber = _gameNumber;
+	_history.reset(startState);
 	_gameOptions.currentTurnNo = 0;
+	_hoveredHolder = nullptr;
+	markBoardDirty();
 }
 
+//
+// the position after each turn goes into the packed history rather than a new Turn
+//
 void Game::endTurn()
 {
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
-	Turn *turn = new Turn;
-	turn->_boardState = stateString();
-	turn->_date = (int)_gameOptions.currentTurnNo;
-	turn->_score = _score;
-	turn->_gameNumber = _gameNumber;
-	_turns.push_back(turn);
+	_history.push(stateView());
+	markBoardDirty();
 	ClassGame::EndOfTurn();
 }
 
+void Game::makeMove(int cell, int player)
+{
+	setCellPiece(cell, player);
+	_gameOptions.currentTurnNo++;
+	_history.pushMove(cell, player);
+	markBoardDirty();
+	ClassGame::EndOfTurn();
+}
+
+void Game::setCellPiece(int cell, int player)
+{
+	StateBuffer<STATE_MAX_CELLS> state = StateBuffer<STATE_MAX_CELLS>::fromView(stateView());
+	if (cell >= 0 && cell < (int)state.size()) {
+		state.set(cell, player);
+		setStateString(state);
+	}
+}
+
+bool Game::undoTurn()
+{
+	const size_t turn = _history.turn();
+	if (!_history.undo()) {
+		return false;
+	}
+	if (_history.singleMoveAt(turn)) {
+		const int cell = _history.moveAt(turn);
+		setCellPiece(cell, _history.playerAt(turn - 1, cell));
+	} else {
+		setStateString(_history.currentState());
+	}
+	_gameOptions.currentTurnNo = (unsigned int)_history.turn();
+	markBoardDirty();
+	return true;
+}
+
+bool Game::redoTurn()
+{
+	if (!_history.redo()) {
+		return false;
+	}
+	const size_t turn = _history.turn();
+	if (_history.singleMoveAt(turn)) {
+		const int cell = _history.moveAt(turn);
+		setCellPiece(cell, _history.playerAt(turn, cell));
+	} else {
+		setStateString(_history.currentState());
+	}
+	_gameOptions.currentTurnNo = (unsigned int)_history.turn();
+	markBoardDirty();
+	return true;
+}
+
+void Game::setHolderGrid(const ImVec2 &origin, const ImVec2 &pitch)
+{
+	_holderGridOrigin = origin;
+	_holderGridPitch = pitch;
+}
+
+void Game::setUpHolders(int width, int height)
+{
+	_gameOptions.rowX = width;
+	_gameOptions.rowY = height;
+	cancelDrag();
+	_tweens.clear();
+	_cells.reset(width, height);
+	_holders = std::vector<Square>((size_t)(width * height));
+	_hoveredHolder = nullptr;
+	_pressHolder = nullptr;
+	markBoardDirty();
+}
+
+int Game::cellOf(const BitHolder *holder) const
+{
+	const Square *square = static_cast<const Square *>(holder);
+	const Square *first = _holders.data();
+	if (!holder || std::less<const Square *>()(square, first) || !std::less<const Square *>()(square, first + _holders.size())) {
+		return -1;
+	}
+	return (int)(square - first);
+}
+
+BitHolder *Game::holderAtPoint(const ImVec2 &point)
+{
+    if (_holderGridPitch.x <= 0.0f || _holderGridPitch.y <= 0.0f) {
+        for (Square &holder : _holders) {
+            if (holder.isMouseOver(point)) {
+                return &holder;
+            }
+        }
+        return nullptr;
+    }
+
+    const int x = (int)std::floor((point.x - _holderGridOrigin.x) / _holderGridPitch.x);
+    const int y = (int)std::floor((point.y - _holderGridOrigin.y) / _holderGridPitch.y);
+    if (x < 0 || y < 0 || x >= _cells.width() || y >= _cells.height()) {
+        return nullptr;
+    }
+    // the sprite may be smaller than the pitch, leaving gaps between cells
+    BitHolder &holder = _holders[_cells.index(x, y)];
+    return holder.isMouseOver(point) ? &holder : nullptr;
+}
+
 void Game::scanForMouse()
 {
+    PROFILE_SCOPE("Game::scanForMouse");
     //if (gameHasAI() && getCurrentPlayer()->isAIPlayer()) 
     //{
     //    updateAI();
@@ -103,41 +237,192 @@ void Game::scanForMouse()
     mousePos.x -= ImGui::GetWindowPos().x;
     mousePos.y -= ImGui::GetWindowPos().y;
 
-    for (int y=0; y<_gameOptions.rowY; y++) {
-        for (int x=0; x<_gameOptions.rowX; x++) {
-			BitHolder &holder = getHolderAt(x, y);
-            if (holder.isMouseOver(mousePos)) {
-                if (ImGui::IsMouseClicked(0)) {
-                    if (actionForEmptyHolder(&holder)) {
-                        endTurn();
-                    }
-                } else {
-                    holder.setHighlighted(true);
-                }
-            } else {
-                holder.setHighlighted(false);
+    BitHolder *hovered = holderAtPoint(mousePos);
+    if (hovered != _hoveredHolder) {
+        if (_hoveredHolder && _hoveredHolder->setHighlighted(false)) {
+            markBoardDirty();
+        }
+        _hoveredHolder = hovered;
+    }
+    // the dragged bit is drawn over the board each frame, so following the mouse dirties nothing
+    if (_dragBit) {
+        if (ImGui::IsMouseDown(0)) {
+            _dragBit->setPosition(mousePos.x - _dragOffset.x, mousePos.y - _dragOffset.y);
+        } else {
+            endDrag(mousePos);
+        }
+    } else if (_pressHolder) {
+        if (!ImGui::IsMouseDown(0)) {
+            _pressHolder = nullptr;
+        } else if (ImGui::IsMouseDragging(0)) {
+            beginDrag(mousePos);
+        }
+    }
+    if (!hovered) {
+        return;
+    }
+    if (ImGui::IsMouseClicked(0)) {
+        // a press is a click first; it becomes a drag only if the mouse moves while still down
+        _pressHolder = nullptr;
+        if (actionForEmptyHolder(hovered)) {
+            endTurn();
+        } else if (Bit *bit = hovered->bit(); bit && canBitMoveFrom(bit, hovered)) {
+            _pressHolder = hovered;
+        }
+    } else if (hovered->setHighlighted(true)) {
+        markBoardDirty();
+    }
+}
+
+void Game::beginDrag(const ImVec2 &mousePos)
+{
+    BitHolder *src = _pressHolder;
+    _pressHolder = nullptr;
+    Bit *bit = src->bit();
+    if (!bit || !canBitMoveFrom(bit, src) || !(bit = src->canDragBit(bit))) {
+        return;
+    }
+    // held through the drag: draggedBitTo() lets go of it before dropBitAtPoint() takes it
+    bit->retain();
+    bit->setPickedUp(true);
+    _dragBit = bit;
+    _dragSource = src;
+    // keep the bit where it was grabbed, measured from the press rather than from where the
+    // drag threshold was crossed
+    const ImVec2 delta = ImGui::GetMouseDragDelta(0);
+    _dragOffset = ImVec2(mousePos.x - delta.x - bit->getPosition().x, mousePos.y - delta.y - bit->getPosition().y);
+    _tweens.scaleTo(bit, kPickedUpScale, _animationSeconds);
+    markBoardDirty();
+}
+
+void Game::endDrag(const ImVec2 &mousePos)
+{
+    Bit *bit = _dragBit;
+    BitHolder *src = _dragSource;
+    _dragBit = nullptr;
+    _dragSource = nullptr;
+    bit->setPickedUp(false);
+    _tweens.scaleTo(bit, 1.0f, _animationSeconds);
+
+    BitHolder *dst = holderAtPoint(mousePos);
+    bool dropped = false;
+    if (dst && dst != src && canBitMoveFromTo(bit, src, dst)) {
+        if (dst->canDropBitAtPoint(bit, mousePos)) {
+            dropped = animateAndPlaceBitFromTo(bit, src, dst);
+        } else {
+            dst->willNotDropBit(bit);
+        }
+    }
+    if (dropped) {
+        bitMovedFromTo(bit, src, dst);
+    } else {
+        src->cancelDragBit(bit);
+        animateBitTo(bit, src->getPosition());
+    }
+    bit->release();
+    markBoardDirty();
+}
+
+void Game::cancelDrag()
+{
+    _pressHolder = nullptr;
+    if (!_dragBit) {
+        return;
+    }
+    Bit *bit = _dragBit;
+    _dragBit = nullptr;
+    bit->setPickedUp(false);
+    _dragSource->cancelDragBit(bit);
+    _tweens.scaleTo(bit, 1.0f, _animationSeconds);
+    animateBitTo(bit, _dragSource->getPosition());
+    _dragSource = nullptr;
+    bit->release();
+}
+
+void Game::animateBitTo(Bit *bit, const ImVec2 &point)
+{
+    _tweens.moveTo(bit, point, _animationSeconds);
+    // out of the cached list until it lands
+    markBoardDirty();
+}
+
+//
+// walk the holders, one flat array, and record what paintSprite() would draw for them and
+// then their bits, less those that are moving
+//
+void Game::rebuildBoardDrawList()
+{
+    _boardDrawList.clear();
+    _boardExtent = ImVec2(0, 0);
+    SpriteDrawCommand command;
+    for (int pass = 0; pass < 2; pass++) {
+        for (Square &holder : _holders) {
+            Bit *bit = holder.bit();
+            if (pass == 1 && bit && (bit->isAnimating() || bit == _dragBit)) {
+                continue;
+            }
+            Sprite *sprite = (pass == 0) ? (Sprite *)&holder : (Sprite *)bit;
+            if (sprite && sprite->drawCommand(command)) {
+                _boardDrawList.push_back(command);
+                _boardExtent.x = std::max(_boardExtent.x, command.location.x + command.size.x);
+                _boardExtent.y = std::max(_boardExtent.y, command.location.y + command.size.y);
             }
         }
-    }    
+    }
+    _boardDirty = false;
+}
+
+static void AddSpriteCommand(ImDrawList *drawList, const ImVec2 &origin, const SpriteDrawCommand &command)
+{
+    const ImVec2 min(origin.x + command.location.x, origin.y + command.location.y);
+    const ImVec2 max(min.x + command.size.x, min.y + command.size.y);
+    drawList->AddImage(command.texture, min, max, command.uv0, command.uv1, command.color);
+    if (command.border) {
+        drawList->AddRect(min, max, command.border);
+    }
 }
 
 //
 // draw the board and then the pieces
-// this will also go somewhere else when the heirarchy is set up
+// the sprites go straight into the window's draw list from the cached commands, so a frame
+// where nothing moved costs the mouse scan and one AddImage per sprite
+// the tweens advance by the frame's delta time and their bits are drawn over the cached list,
+// which is only rebuilt when one starts or lands; the dragged bit goes on top of everything
 //
 void Game::drawFrame()
 {
+    PROFILE_SCOPE("Game::drawFrame");
+    // before the mouse scan, so a dragged bit's position is the mouse's, not its scale tween's
+    if (_tweens.update(ImGui::GetIO().DeltaTime)) {
+        markBoardDirty();
+    }
     scanForMouse();
+    if (_boardDirty) {
+        rebuildBoardDrawList();
+    }
 
-    for (int y=0; y<_gameOptions.rowY; y++) {
-        for (int x=0; x<_gameOptions.rowX; x++) {
-			BitHolder &holder = getHolderAt(x, y);
-            holder.paintSprite();
-            if (holder.bit()) {
-                holder.bit()->paintSprite();
-            }
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    const ImVec2 origin(ImGui::GetWindowPos().x - ImGui::GetScrollX(), ImGui::GetWindowPos().y - ImGui::GetScrollY());
+    for (const SpriteDrawCommand &command : _boardDrawList) {
+        AddSpriteCommand(drawList, origin, command);
+    }
+    SpriteDrawCommand command;
+    for (const Tween &tween : _tweens.tweens()) {
+        if (tween.bit != _dragBit && tween.bit->drawCommand(command)) {
+            AddSpriteCommand(drawList, origin, command);
         }
     }
+    if (_dragBit && _dragBit->drawCommand(command)) {
+        AddSpriteCommand(drawList, origin, command);
+    }
+    // the images bypass the layout, so reserve their area for the window size and scrolling;
+    // a button rather than a dummy, so dragging a piece doesn't drag the window along
+    ImGui::SetCursorPos(ImVec2(0, 0));
+    if (_boardExtent.x > 0.0f && _boardExtent.y > 0.0f) {
+        ImGui::InvisibleButton("##board", _boardExtent);
+    } else {
+        ImGui::Dummy(_boardExtent);
+    }
 }
 
 void Game::bitMovedFromTo(Bit *bit, BitHolder *src, BitHolder *dst)
@@ -162,7 +447,20 @@ bool Game::clickedBit(Bit *bit)
 
 bool Game::animateAndPlaceBitFromTo(Bit *bit, BitHolder*src, BitHolder*dst)
 {
-	return false;
+	if (!bit || !src || !dst) {
+		return false;
+	}
+	// src lets go of the bit before dst takes it, hold it in between
+	bit->retain();
+	src->draggedBitTo(bit, dst);
+	const bool placed = dst->dropBitAtPoint(bit, dst->getPosition());
+	if (placed) {
+		animateBitTo(bit, dst->getPosition());
+	} else {
+		src->setBit(bit);
+	}
+	bit->release();
+	return placed;
 }
 
 bool Game::gameHasAI()
@@ -2,12 +2,19 @@
 
 #include <iostream>
 #include <vector>
+#include <span>
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 #include "Player.h"
 #include "Turn.h"
 #include "Bit.h"
 #include "BitHolder.h"
+#include "CellStore.h"
+#include "Square.h"
+#include "Tween.h"
+#include "../engine/MoveHistory.h"
 
 class GameTable;
 
@@ -21,8 +28,9 @@ struct GameOptions
 	int gameNumber;
 	unsigned int currentTurnNo;
 	int score;
-	int AIDepthSearches;
-	int AIMAXDepth;
+	int AIDepthSearches;		// iterations the last AI search completed
+	int AIMAXDepth;				// deepest iteration the AI may search, 0 = no limit
+	int64_t AITimeBudget;		// microseconds the AI may think per move, 0 = no limit
 	bool AIvsAI;
 };
 
@@ -37,10 +45,33 @@ public:
 	virtual		void	setUpBoard() = 0;
 
 	// draw the current frame
+	// the board is replayed from a cached draw list, rebuilt only after markBoardDirty();
+	// bits being tweened or dragged are left out of it and drawn over it every frame
 	void	drawFrame();
+	// call after anything that changes how the board looks: pieces, highlights, positions
+	void	markBoardDirty() { _boardDirty = true; }
+
+	// glide bit from where it is drawn to point over animationSeconds(), without blocking
+	void	animateBitTo(Bit *bit, const ImVec2 &point);
+	// a bit is gliding or being dragged, so the board wants a frame every refresh
+	bool	animating() const { return !_tweens.empty() || _dragBit != nullptr; }
+	float	animationSeconds() const { return _animationSeconds; }
+	void	setAnimationSeconds(float seconds) { _animationSeconds = seconds; }
+	// put a dragged bit back where it came from, e.g. before the game resets the board under it
+	void	cancelDrag();
 
 	// end the current game turn
 	void	endTurn();
+
+	// make a move: put player's piece (1 or 2, as in state strings) into cell and end the turn,
+	// recording just that cell in the history
+	void	makeMove(int cell, int player);
+
+	// step back or forward through the recorded turns; a turn that changed one cell is
+	// unmade or remade with setCellPiece(), anything else restored with setStateString()
+	bool	undoTurn();
+	bool	redoTurn();
+	const MoveHistory	&history() const { return _history; }
 	
 	// Should return true if it is legal for the given bit to be moved from its current holder.
 	// Default implementation always returns true. 
@@ -70,21 +101,52 @@ public:
 
 	virtual		Player* checkForWinner() = 0;
 	virtual     bool 	checkForDraw() = 0;
+	// move bit from src into dst and glide it there from where it is drawn; does not end the turn
 	virtual		bool	animateAndPlaceBitFromTo(Bit *bit, BitHolder*src, BitHolder*dst);
 
 	virtual		void	stopGame() = 0;
     virtual     bool    gameHasAI();
     virtual     void    updateAI();
 
+	// put player's piece into cell, or empty it for 0, without touching the other holders
+	// the default rebuilds the whole board through setStateString()
+	virtual		void	setCellPiece(int cell, int player);
+
+	// state strings: one character per cell, '0' empty, '1' player 1, '2' player 2
+	// stateView() points into the game's own buffer and stays valid until the board next
+	// changes, so recording a turn allocates nothing; stateString() is its heap copy, for
+	// callers that keep it; the default reads _cells, which is the state string as it stands
 	virtual		std::string	initialStateString() = 0;
-	virtual		std::string stateString() const = 0;
-	virtual		void setStateString(const std::string &s) = 0;
+	virtual		std::string_view stateView() const { return _cells.stateView(); }
+				std::string stateString() const { return std::string(stateView()); }
+	virtual		void setStateString(std::string_view s) = 0;
     
 	void		setNumberOfPlayers(unsigned int playerCount);
 	void		setAIPlayer(unsigned int playerNumber);
+	// delete every turn and player, e.g. before a new game
+	void		releaseTurnsAndPlayers();
+	// highlight the holder under the mouse and act on a click; only the holder hovered last
+	// frame and the one hovered now are touched
+	// a press on a bit canBitMoveFrom() allows that turns into a drag picks the bit up; it
+	// follows the mouse until released, then is dropped through canBitMoveFromTo() and the
+	// holders' drop hooks, or glides back
     void        scanForMouse();
-	// function to return pointer to the [][] array of bitholders
-	virtual BitHolder &getHolderAt(const int x, const int y) = 0;
+	// the holder under a window-space point, or nullptr
+	// the default works the cell out from the grid given to setHolderGrid(), and walks every
+	// holder only if there is none; a game whose holders aren't on a regular grid overrides it
+	virtual BitHolder	*holderAtPoint(const ImVec2 &point);
+	// holder (x, y) sits at origin + (x, y) * pitch, in window coordinates
+	void		setHolderGrid(const ImVec2 &origin, const ImVec2 &pitch);
+
+	// width x height empty holders in one row-major array, with _cells to match; a game calls
+	// it once from setUpBoard(), as the bits point back at their holders
+	void		setUpHolders(int width, int height);
+	// every holder, cell order; the base class draws and hit-tests them as this flat span
+	std::span<Square>	holders() { return _holders; }
+	Square		&holderAt(int cell) { return _holders[cell]; }
+	BitHolder	&getHolderAt(const int x, const int y) { return _holders[y * _cells.width() + x]; }
+	// the cell holder sits on, -1 if it isn't one of holders()
+	int			cellOf(const BitHolder *holder) const;
 	
 	const unsigned int			getCurrentTurnNo() { return _gameOptions.currentTurnNo; };
 	const int					getScore() { return _score; };
@@ -96,7 +158,12 @@ public:
 	Player					*_winner;
 
 	std::vector<Player*>	_players;
+	// who owns each cell, kept in step with the holders by every placement; rule checks and
+	// state strings read it without touching a sprite
+	CellStore				_cells;
 	std::vector<Turn*>		_turns;
+	// every position of the game, packed; replaces a heap-allocated Turn per move
+	MoveHistory				_history;
 
 	int						_score;
 	std::string				_lastMove;
@@ -104,5 +171,28 @@ public:
 	GameOptions 			_gameOptions;
 
 	int						_gameNumber;
+
+private:
+	void					rebuildBoardDrawList();
+	void					beginDrag(const ImVec2 &mousePos);
+	void					endDrag(const ImVec2 &mousePos);
+
+	std::vector<Square>		_holders;			// the board's sprites, _cells' visual half
+
+	// what drawFrame() draws, the holders then their bits; rebuilt when _boardDirty is set
+	std::vector<SpriteDrawCommand>	_boardDrawList;
+	ImVec2					_boardExtent;		// bottom-right corner of the list, reserved in the window layout
+	bool					_boardDirty;
+
+	ImVec2					_holderGridOrigin;
+	ImVec2					_holderGridPitch;	// 0 until setHolderGrid()
+	BitHolder				*_hoveredHolder;	// highlighted by scanForMouse(), nullptr if none
+
+	TweenScheduler			_tweens;
+	float					_animationSeconds;
+	BitHolder				*_pressHolder;		// holder of a movable bit under the mouse press, nullptr if none
+	Bit						*_dragBit;			// retained while dragged, nullptr if none
+	BitHolder				*_dragSource;
+	ImVec2					_dragOffset;		// mouse position less the bit's, kept through the drag
 };
 
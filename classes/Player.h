@@ -1,6 +1,7 @@
 #pragma once
 #include <iostream>
 #include <map>
+#include "EntityPool.h"
 
 class Game;
 
@@ -10,6 +11,8 @@ public:
 	Player() : _game(nullptr), _name(""), _extraValues(), _aiPlayer(false) {};
 	~Player() {};
 
+	ENTITY_POOL_ALLOCATED(Player)
+
 	static Player *initWithGame(Game *game) { Player *player = new Player(); player->_game = game; return player;}
 	static Player *initWithName(const std::string &name) { Player *player = new Player(); player->_name = name; return player;}
 
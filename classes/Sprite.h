@@ -1,7 +1,23 @@
 #pragma once
+#include <string>
 #include "Entity.h"
 #include "../imgui/imgui.h"
 
+//
+// what paintSprite() draws, in window coordinates and with the colors already packed
+// a Game keeps a list of these for its board and replays it while nothing on the board changes
+//
+struct SpriteDrawCommand
+{
+    ImTextureID texture;
+    ImVec2      location;
+    ImVec2      size;
+    ImVec2      uv0;
+    ImVec2      uv1;
+    ImU32       color;
+    ImU32       border;         // 0 when there is no highlight
+};
+
 class Sprite : public Entity
 {
     // sprite contains code for a simple OpenGL sprite class that is heirarchical, and can be used to draw a sprite with a texture
@@ -16,11 +32,17 @@ public:
         _scale(1),
         _color(1, 1, 1, 1),
         _localZOrder(0),
+        _texture(0),
+        _uv0(0, 0),
+        _uv1(1, 1),
         _highlighted(false)
         { 
             _entityType = EntitySprite;
         };
-    ~Sprite() { if (_retainCount > 0) release(); }
+    // copies share the texture, each holding its own reference in the TextureCache
+    Sprite(const Sprite &other);
+    Sprite &operator=(const Sprite &other);
+    ~Sprite() { releaseTexture(); if (_retainCount > 0) release(); }
     
     // set the texture to use for this sprite
     void setPosition(float x, float y)
@@ -41,6 +63,7 @@ public:
     void setRotation(float rotation) { _rotation = rotation; }
     // set the scale of the sprite
     void setScale(float scale) { _scale = scale; }
+    float getScale() const { return _scale; }
     // set the color of the sprite
     void setColor(float r, float g, float b, float a)
     {
@@ -61,8 +84,19 @@ public:
         {
             ImGui::SetCursorPos(_location);
             ImVec4 highlight = _highlighted ? ImVec4(1, 1, 0, 1) : ImVec4(0, 0, 0, 0);
-            ImGui::Image((void*)(intptr_t)_texture, _size, ImVec2(0, 0), ImVec2(1, 1), _color, highlight);
+            ImGui::Image((void*)(intptr_t)_texture, _size, _uv0, _uv1, _color, highlight);
         }
+    }
+    // the command paintSprite() would draw, false if the sprite has no size
+    // a scale other than 1 grows or shrinks the sprite about its centre
+    bool drawCommand(SpriteDrawCommand &command) const
+    {
+        if (_size.x <= 0.0f || _size.y <= 0.0f) return false;
+        const ImVec2 size(_size.x * _scale, _size.y * _scale);
+        const ImVec2 location(_location.x + (_size.x - size.x) * 0.5f, _location.y + (_size.y - size.y) * 0.5f);
+        command = { _texture, location, size, _uv0, _uv1, ImGui::ColorConvertFloat4ToU32(_color),
+                    _highlighted ? IM_COL32(255, 255, 0, 255) : 0u };
+        return true;
     }
 	// is the mouse over this position?
 	bool isMouseOver(const ImVec2 &mousePos)
@@ -70,10 +104,11 @@ public:
         return (mousePos.x >= _location.x && mousePos.x <= _location.x + _size.x && mousePos.y >= _location.y && mousePos.y <= _location.y + _size.y);
     }
 
+    // textures come from the TextureCache, so each image is decoded and uploaded once
     bool LoadTextureFromFile(const char* filename);
 	
-    // set the highlighted state
-	void	setHighlighted(bool yes);
+    // set the highlighted state, true if it changed
+	bool	setHighlighted(bool yes);
 
 	// highlight the holder while a bit is being dragged to us
 	bool	highlighted();
@@ -95,10 +130,14 @@ private:
     ImVec4  _color;
     // the local Z order
     int _localZOrder;
-    // the texture we're going to draw
+    // the texture we're going to draw, and its TextureCache name (empty if none)
     ImTextureID _texture;
+    std::string _textureName;
+    // the part of the texture to draw, a sub-rectangle when it lives in the atlas
+    ImVec2  _uv0;
+    ImVec2  _uv1;
     // currently highlighted
    	bool	_highlighted;
-    // private platform specific texture loading
-    ImTextureID _loadTextureFromMemory(const unsigned char *image_data, int image_width, int image_height);
+    // drop our reference to the cached texture
+    void releaseTexture();
 };
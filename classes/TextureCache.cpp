@@ -0,0 +1,281 @@
+#include "TextureCache.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+// imgui_draw.cpp keeps its copy of the packer private, so this file compiles its own; the
+// packer's setup_heuristic is never called, which a static copy would warn about
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include "../imgui/imstb_rectpack.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+
+// transparent pixels around each atlas image, so linear filtering never samples a neighbour
+constexpr int ATLAS_PADDING = 2;
+constexpr int ATLAS_MAX_SIZE = 4096;
+
+TextureCache &TextureCache::instance()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+bool TextureCache::acquire(const std::string &name, CachedTexture &texture)
+{
+    auto found = _entries.find(name);
+    if (found != _entries.end()) {
+        found->second.refs++;
+        texture = found->second.texture;
+        return true;
+    }
+
+    // Load from file
+    int image_width = 0;
+    int image_height = 0;
+    std::filesystem::path resourcePath = std::filesystem::path("resources") / name;
+    std::string newFilename = resourcePath.string();
+    unsigned char* image_data = stbi_load(newFilename.c_str(), &image_width, &image_height, NULL, 4);
+    if (image_data == NULL) {
+        std::cout << "Failed to load texture: " << newFilename << std::endl;
+        return false;
+    }
+    ImTextureID id = upload(image_data, image_width, image_height);
+    stbi_image_free(image_data);
+    if (id == 0) {
+        return false;
+    }
+
+    Entry &entry = _entries[name];
+    entry.texture.id = id;
+    entry.texture.width = image_width;
+    entry.texture.height = image_height;
+    entry.refs = 1;
+    texture = entry.texture;
+    return true;
+}
+
+void TextureCache::retain(const std::string &name)
+{
+    auto found = _entries.find(name);
+    if (found != _entries.end()) {
+        found->second.refs++;
+    }
+}
+
+void TextureCache::release(const std::string &name)
+{
+    auto found = _entries.find(name);
+    if (found == _entries.end()) {
+        return;
+    }
+    if (--found->second.refs <= 0 && !found->second.inAtlas) {
+        destroy(found->second.texture.id);
+        _entries.erase(found);
+    }
+}
+
+bool TextureCache::buildAtlas(const std::vector<std::string> &names)
+{
+    struct Image
+    {
+        std::string     name;
+        unsigned char   *pixels;
+        int             width, height;
+    };
+    std::vector<Image> images;
+    for (const std::string &name : names) {
+        if (_entries.count(name)) continue;
+        Image image = { name, nullptr, 0, 0 };
+        std::string filename = (std::filesystem::path("resources") / name).string();
+        image.pixels = stbi_load(filename.c_str(), &image.width, &image.height, NULL, 4);
+        if (image.pixels == NULL) {
+            std::cout << "Failed to load texture: " << filename << std::endl;
+            continue;
+        }
+        images.push_back(image);
+    }
+    if (images.empty() || _atlas.id != 0) {
+        for (Image &image : images) stbi_image_free(image.pixels);
+        return false;
+    }
+
+    // smallest power-of-two square, from 256 up, that everything fits in
+    std::vector<stbrp_rect> rects(images.size());
+    int size = 256;
+    for (;; size *= 2) {
+        for (size_t i = 0; i < images.size(); ++i) {
+            rects[i] = stbrp_rect();
+            rects[i].id = (int)i;
+            rects[i].w = images[i].width + 2 * ATLAS_PADDING;
+            rects[i].h = images[i].height + 2 * ATLAS_PADDING;
+        }
+        std::vector<stbrp_node> nodes(size);
+        stbrp_context context;
+        stbrp_init_target(&context, size, size, nodes.data(), (int)nodes.size());
+        if (stbrp_pack_rects(&context, rects.data(), (int)rects.size()) || size >= ATLAS_MAX_SIZE) break;
+    }
+
+    std::vector<unsigned char> pixels((size_t)size * size * 4, 0);
+    for (const stbrp_rect &rect : rects) {
+        if (!rect.was_packed) continue;
+        const Image &image = images[rect.id];
+        for (int y = 0; y < image.height; ++y) {
+            memcpy(&pixels[(((size_t)(rect.y + ATLAS_PADDING + y) * size) + rect.x + ATLAS_PADDING) * 4],
+                   &image.pixels[(size_t)y * image.width * 4], (size_t)image.width * 4);
+        }
+    }
+    _atlas.id = upload(pixels.data(), size, size);
+    _atlas.width = size;
+    _atlas.height = size;
+
+    for (const stbrp_rect &rect : rects) {
+        const Image &image = images[rect.id];
+        if (_atlas.id != 0 && rect.was_packed) {
+            Entry &entry = _entries[image.name];
+            entry.inAtlas = true;
+            entry.texture.id = _atlas.id;
+            entry.texture.width = image.width;
+            entry.texture.height = image.height;
+            entry.texture.uv0 = ImVec2((float)(rect.x + ATLAS_PADDING) / size, (float)(rect.y + ATLAS_PADDING) / size);
+            entry.texture.uv1 = ImVec2((float)(rect.x + ATLAS_PADDING + image.width) / size,
+                                       (float)(rect.y + ATLAS_PADDING + image.height) / size);
+        }
+        stbi_image_free(image.pixels);
+    }
+    return _atlas.id != 0;
+}
+
+bool TextureCache::buildResourceAtlas()
+{
+    std::vector<std::string> names;
+    std::error_code error;
+    for (const auto &file : std::filesystem::directory_iterator("resources", error)) {
+        if (file.path().extension() == ".png") {
+            names.push_back(file.path().filename().string());
+        }
+    }
+    // a fixed order so the layout is the same on every run
+    std::sort(names.begin(), names.end());
+    return buildAtlas(names);
+}
+
+int TextureCache::refCount(const std::string &name) const
+{
+    auto found = _entries.find(name);
+    return (found != _entries.end()) ? found->second.refs : 0;
+}
+
+#if defined(TICTACTOE_HEADLESS)
+
+// no GPU, as in perf_gate: each upload still gets an id of its own, so sprites are batched by
+// texture exactly as they are on screen
+ImTextureID TextureCache::upload(const unsigned char *image_data, int image_width, int image_height)
+{
+    static intptr_t lastTexture = 0;
+    return (ImTextureID)++lastTexture;
+}
+
+void TextureCache::destroy(ImTextureID texture)
+{
+}
+
+#elif defined(__APPLE__)
+#include "../imgui/imgui_impl_opengl3_loader.h"
+
+ImTextureID TextureCache::upload(const unsigned char *image_data, int image_width, int image_height)
+{
+    // Create a OpenGL texture identifier
+    GLuint image_texture;
+    glGenTextures(1, &image_texture);
+    glBindTexture(GL_TEXTURE_2D, image_texture);
+
+    // Setup filtering parameters for display
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Upload pixels into texture
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
+
+    return static_cast<ImTextureID>(image_texture);
+}
+
+void TextureCache::destroy(ImTextureID texture)
+{
+    GLuint image_texture = (GLuint)(intptr_t)texture;
+    glDeleteTextures(1, &image_texture);
+}
+
+#else
+
+// DirectX
+#include <stdio.h>
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "d3dcompiler") // Automatically link with d3dcompiler.lib as we are using D3DCompile() below.
+#endif
+
+ImTextureID TextureCache::upload(const unsigned char *image_data, int image_width, int image_height)
+{
+    // Create texture
+    D3D11_TEXTURE2D_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Width = image_width;
+    desc.Height = image_height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+
+    ID3D11Texture2D *pTexture = NULL;
+    D3D11_SUBRESOURCE_DATA subResource;
+    subResource.pSysMem = image_data;
+    subResource.SysMemPitch = desc.Width * 4;
+    subResource.SysMemSlicePitch = 0;
+
+    // You need to have a valid ID3D11Device* available as g_pd3dDevice
+    extern ID3D11Device* g_pd3dDevice; // Add this line if g_pd3dDevice is defined elsewhere
+
+    HRESULT hr = g_pd3dDevice->CreateTexture2D(&desc, &subResource, &pTexture);
+    if (FAILED(hr) || !pTexture) {
+        return 0;
+    }
+
+    // Create texture view
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+    ZeroMemory(&srvDesc, sizeof(srvDesc));
+    srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = desc.MipLevels;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+
+    ID3D11ShaderResourceView* shaderResourceView = nullptr;
+    hr = g_pd3dDevice->CreateShaderResourceView(pTexture, &srvDesc, &shaderResourceView);
+    pTexture->Release();
+
+    if (FAILED(hr) || !shaderResourceView) {
+
+        return 0;
+    }
+    return reinterpret_cast<ImTextureID>(shaderResourceView);
+}
+
+void TextureCache::destroy(ImTextureID texture)
+{
+    if (texture) {
+        reinterpret_cast<ID3D11ShaderResourceView*>(texture)->Release();
+    }
+}
+#endif
+
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../imgui/imgui.h"
+
+//
+// process-wide cache of GPU textures, keyed by the file name under resources/
+// the first acquire of a name decodes the PNG and uploads it; later ones share that texture
+// every acquire or retain is paired with a release, and the last release frees the texture
+// textures are created and freed on the render thread only
+// buildAtlas() packs a set of images into one texture at startup: their sprites then draw a
+// sub-rectangle of it by UV, so a whole board with its pieces is drawn with one texture bind
+//
+
+struct CachedTexture
+{
+    ImTextureID id = 0;
+    int         width = 0;
+    int         height = 0;
+    ImVec2      uv0 = ImVec2(0, 0);     // the image's corners inside the texture
+    ImVec2      uv1 = ImVec2(1, 1);
+};
+
+class TextureCache
+{
+public:
+    static TextureCache &instance();
+
+    // adds a reference to the texture for name, loading it on first use
+    // false if the file can't be loaded, and then no reference is added
+    bool        acquire(const std::string &name, CachedTexture &texture);
+
+    // adds a reference to a name that is already held
+    void        retain(const std::string &name);
+
+    // drops a reference; the GPU texture is freed with the last one
+    void        release(const std::string &name);
+
+    // packs the named images into one atlas texture; names already cached are left alone
+    // atlas images stay loaded for the life of the process whatever their reference counts
+    // false if nothing could be packed
+    bool        buildAtlas(const std::vector<std::string> &names);
+    // every .png in resources/
+    bool        buildResourceAtlas();
+
+    int         refCount(const std::string &name) const;
+    size_t      size() const { return _entries.size(); }
+
+private:
+    TextureCache() = default;
+
+    struct Entry
+    {
+        CachedTexture   texture;
+        int             refs = 0;
+        bool            inAtlas = false;   // a region of _atlas, never freed on its own
+    };
+
+    // platform specific upload and free
+    static ImTextureID  upload(const unsigned char *image_data, int image_width, int image_height);
+    static void         destroy(ImTextureID texture);
+
+    std::unordered_map<std::string, Entry> _entries;
+    CachedTexture   _atlas;
+};
@@ -3,9 +3,9 @@
 // -----------------------------------------------------------------------------
 // TicTacToe.cpp
 // -----------------------------------------------------------------------------
-// This file is intentionally *full of comments* and gentle TODOs that guide you
-// through wiring up a complete Tic‑Tac‑Toe implementation using the game engine’s
-// Bit / BitHolder grid system.
+// A complete Tic‑Tac‑Toe implementation using the game engine’s Bit / BitHolder
+// grid system. The rules themselves (win lines, draw, state strings) come from
+// the shared Bitboard in engine/Bitboard.h so the UI and the AI can't disagree.
 //
 // Rules recap:
 //  - Two players place X / O on a 3x3 grid.
@@ -20,8 +20,7 @@
 //  - Game options     : let the mouse know the grid is 3x3 (rowX, rowY)
 //  - Helpers you’ll see used: setNumberOfPlayers, getPlayerAt, startGame, etc.
 //
-// I’ve already fully implemented PieceForPlayer() for you. Please leave that as‑is.
-// The rest of the routines are written as “comment-first” TODOs for you to complete.
+// PieceForPlayer() is provided by the engine template. Please leave that as‑is.
 // -----------------------------------------------------------------------------
 
 const int AI_PLAYER   = 1;      // index of the AI player (O)
@@ -53,11 +52,16 @@ Bit* TicTacToe::PieceForPlayer(const int playerNumber)
 //
 void TicTacToe::setUpBoard()
 {
-    // here we should call setNumberOfPlayers to 2 and then set up the game options so the mouse knows to draw a 3x3 grid
-    // _gameOptions has a rowX and rowY property we should set to 3
-    // then we need to setup our 3x3 array in _grid with the correct position of the square, and load the "square.png" sprite for each square
-    // we will use the initHolder function on each square to do this
-    // finally we should call startGame to get everything going
+    setNumberOfPlayers(2);
+    setUpHolders(3, 3);
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            ImVec2 position((float)(x * 100 + 100), (float)(y * 100 + 100));
+            holderAt(_cells.index(x, y)).initHolder(position, "square.png", x, y);
+        }
+    }
+    setHolderGrid(ImVec2(100, 100), ImVec2(100, 100));
+    startGame();
 }
 
 //
@@ -65,22 +69,19 @@ void TicTacToe::setUpBoard()
 //
 bool TicTacToe::actionForEmptyHolder(BitHolder *holder)
 {
-    // 1) Guard clause: if holder is nullptr, fail fast.
-    //    (Beginner hint: always check pointers before using them.)
-    //    if (!holder) return false;
-
-    // 2) Is it actually empty?
-    //    Ask the holder for its current Bit using the bit() function.
-    //    If there is already a Bit in this holder, return false.
-
-    // 3) Place the current player's piece on this holder:
-    //    - Figure out whose turn it is (getCurrentPlayer()->playerNumber()).
-    //    - Create a Bit via PieceForPlayer(currentPlayerIndex).
-    //    - Position it at the holder's position (holder->getPosition()).
-    //    - Assign it to the holder: holder->setBit(newBit);
-
-    // 4) Return whether we actually placed a piece. true = acted, false = ignored.
-    return false; // replace with true if you complete a successful placement    
+    if (!holder || holder->bit()) {
+        return false;
+    }
+    if (checkForWinner() || checkForDraw()) {
+        return false;
+    }
+    // makeMove() places the piece and ends the turn, so there is nothing left for the caller to do
+    const int cell = cellOf(holder);
+    if (cell < 0) {
+        return false;
+    }
+    makeMove(cell, getCurrentPlayer()->playerNumber() + 1);
+    return false;
 }
 
 bool TicTacToe::canBitMoveFrom(Bit *bit, BitHolder *src)
@@ -100,53 +101,28 @@ bool TicTacToe::canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst)
 //
 void TicTacToe::stopGame()
 {
-    // clear out the board
-    // loop through the 3x3 array and call destroyBit on each square
+    for (Square &holder : holders()) {
+        holder.destroyBit();
+    }
+    _position = Bitboard();
+    _cells.clear();
+    markBoardDirty();
 }
 
 //
-// helper function for the winner check
+// the rule checks read _position, kept in step with the grid by every placement,
+// so they are mask lookups with no Bit or Player pointers involved
 //
-Player* TicTacToe::ownerAt(int index ) const
-{
-    // index is 0..8, convert to x,y using:
-    // y = index / 3
-    // x = index % 3 
-    // if there is no bit at that location (in _grid) return nullptr
-    // otherwise return the owner of the bit at that location using getOwner()
-    return nullptr;
-}
-
 Player* TicTacToe::checkForWinner()
 {
-    // check all the winning triples
-    // if any of them have the same owner return that player
-    // winning triples are:
-    // 0,1,2
-    // 3,4,5
-    // 6,7,8
-    // 0,3,6
-    // 1,4,7
-    // 2,5,8
-    // 0,4,8
-    // 2,4,6
-    // you can use the ownerAt helper function to get the owner of a square
-    // for example, ownerAt(0) returns the owner of the top-left square
-    // if there is no bit in that square, it returns nullptr
-    // if you find a winning triple, return the player who owns that triple
-    // otherwise return nullptr
-
-    // Hint: Consider using an array to store the winning combinations
-    // to avoid repetitive code
-    return nullptr;
+    int winner = bitboard().winner();
+    return winner ? getPlayerAt(winner - 1) : nullptr;
 }
 
 bool TicTacToe::checkForDraw()
 {
-    // is the board full with no winner?
-    // if any square is empty, return false
-    // otherwise return true
-    return false;
+    Bitboard board = bitboard();
+    return board.full() && board.winner() == 0;
 }
 
 //
@@ -158,56 +134,77 @@ std::string TicTacToe::initialStateString()
 }
 
 //
-// this still needs to be tied into imguis init and shutdown
-// we will read the state string and store it in each turn object
+// stateView() is one character per square, left-to-right, top-to-bottom: '0' empty, '1' X, '2' O
+// for example "100020000" is an X top-left and an O in the center
 //
-std::string TicTacToe::stateString() const
+
+//
+// only the squares that differ from the board change: the Bits taken off them are kept, and
+// put back on squares that want the same player's piece before any new Bit is made, so
+// stepping to a nearby position loads no textures and keeps the untouched squares as they are
+//
+void TicTacToe::setStateString(std::string_view s)
 {
-    // return a string representing the current state of the board
-    // the string should be 9 characters long, one for each square
-    // each character should be '0' for empty, '1' for player 1 (X), and '2' for player 2 (O)
-    // the order should be left-to-right, top-to-bottom
-    // for example, the starting state is "000000000"
-    // if player 1 has placed an X in the top-left and player 2 an O in the center, the state would be "100020000"
-    // you can build the string using a loop and the to_string function
-    // for example, to convert an integer to a string, you can use std::to_string(1) which returns "1"
-    // you can get the bit at each square using _grid[y][x].bit()
-    // if the bit is not null, you can get its owner using bit->getOwner()->playerNumber()
-    // remember that player numbers are zero-based, so add 1 to get '1' or '2'
-    // if the bit is null, add '0' to the string
-    // finally, return the constructed string
-    return "000000000";
+    const Bitboard board = Bitboard::fromStateString(s);
+    Bit *spare[2][BOARD_CELLS];
+    int spareCount[2] = { 0, 0 };
+    for (int index = 0; index < BOARD_CELLS; index++) {
+        const int current = _position.cellAt(index);
+        if (current == 0 || current == board.cellAt(index)) {
+            continue;
+        }
+        BitHolder &holder = holderAt(index);
+        Bit *bit = holder.bit();
+        _cells.setOwner(index, 0);
+        if (!bit) {
+            continue;
+        }
+        // held while it is off the board, or destroyBit() would free it
+        bit->retain();
+        holder.destroyBit();
+        spare[current - 1][spareCount[current - 1]++] = bit;
+    }
+    for (int index = 0; index < BOARD_CELLS; index++) {
+        const int playerNumber = board.cellAt(index);
+        if (playerNumber == 0 || playerNumber == _position.cellAt(index)) {
+            continue;
+        }
+        BitHolder &holder = holderAt(index);
+        const bool reuse = spareCount[playerNumber - 1] > 0;
+        Bit *bit = reuse ? spare[playerNumber - 1][--spareCount[playerNumber - 1]] : PieceForPlayer(playerNumber - 1);
+        bit->setPosition(holder.getPosition());
+        holder.setBit(bit);
+        if (reuse) bit->release();
+        _cells.setOwner(index, playerNumber);
+    }
+    for (int player = 0; player < 2; player++) {
+        while (spareCount[player] > 0) spare[player][--spareCount[player]]->release();
+    }
+    _position = board;
+    markBoardDirty();
 }
 
+
 //
-// this still needs to be tied into imguis init and shutdown
-// when the program starts it will load the current game from the imgui ini file and set the game state to the last saved state
+// one square changes: only its Bit is replaced, and only its cell in _cells and _position
 //
-void TicTacToe::setStateString(const std::string &s)
+void TicTacToe::setCellPiece(int cell, int player)
 {
-    // set the state of the board from the given string
-    // the string will be 9 characters long, one for each square
-    // each character will be '0' for empty, '1' for player 1 (X), and '2' for player 2 (O)
-    // the order will be left-to-right, top-to-bottom
-    // for example, the starting state is "000000000"
-    // if player 1 has placed an X in the top-left and player 2 an O in the center, the state would be "100020000"
-    // you can loop through the string and set each square in _grid accordingly
-    // for example, if s[0] is '1', you would set _grid[0][0] to have player 1's piece
-    // if s[4] is '2', you would set _grid[1][1] to have player 2's piece
-    // if s[8] is '0', you would set _grid[2][2] to be empty
-    // you can use the PieceForPlayer function to create a new piece for a player
-    // remember to convert the character to an integer by subtracting '0'
-    // for example, int playerNumber = s[index] - '0';
-    // if playerNumber is 0, set the square to empty (nullptr)
-    // if playerNumber is 1 or 2, create a piece for that player and set it in the square
-    // finally, make sure to position the piece at the holder's position
-    // you can get the position of a holder using holder->getPosition()
-    // loop through the 3x3 array and set each square accordingly
-    // the string should always be valid, so you don't need to check its length or contents
-    // but you can assume it will always be 9 characters long and only contain '0', '1', or '2'
+    if (cell < 0 || cell >= BOARD_CELLS) {
+        return;
+    }
+    BitHolder &holder = holderAt(cell);
+    holder.destroyBit();
+    if (player == 1 || player == 2) {
+        Bit *bit = PieceForPlayer(player - 1);
+        bit->setPosition(holder.getPosition());
+        holder.setBit(bit);
+    }
+    _position.set(cell, player);
+    _cells.setOwner(cell, _position.cellAt(cell));
+    markBoardDirty();
 }
 
-
 //
 // this is the function that will be called by the AI
 //
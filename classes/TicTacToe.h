@@ -1,6 +1,7 @@
 #pragma once
 #include "Game.h"
 #include "Square.h"
+#include "../engine/Bitboard.h"
 
 //
 // the classic game of tic tac toe
@@ -21,8 +22,8 @@ public:
     Player*     checkForWinner() override;
     bool        checkForDraw() override;
     std::string initialStateString() override;
-    std::string stateString() const override;
-    void        setStateString(const std::string &s) override;
+    void        setStateString(std::string_view s) override;
+    void        setCellPiece(int cell, int player) override;
     bool        actionForEmptyHolder(BitHolder *holder) override;
     bool        canBitMoveFrom(Bit*bit, BitHolder *src) override;
     bool        canBitMoveFromTo(Bit* bit, BitHolder*src, BitHolder*dst) override;
@@ -30,11 +31,12 @@ public:
 
 	void        updateAI() override;
     bool        gameHasAI() override { return true; }
-    BitHolder &getHolderAt(const int x, const int y) override { return _grid[y][x]; }
 private:
     Bit *       PieceForPlayer(const int playerNumber);
-    Player*     ownerAt(int index ) const;
+    Bitboard    bitboard() const { return _position; }
 
-    Square      _grid[3][3];
+    // the pieces on the holders as masks, updated with every placement alongside _cells so the
+    // rule checks are a table lookup
+    Bitboard    _position;
 };
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include "EntityPool.h"
 
 class Game;
 class Player;
@@ -17,6 +18,8 @@ public:
 	Turn() : _game(nullptr), _player(nullptr), _status(kTurnEmpty), _move(""), _boardState(""), _date(0), _comment(""), _score(0), _replaying(false), _gameNumber(-1) {};
 	~Turn() {};
 
+	ENTITY_POOL_ALLOCATED(Turn)
+
 	static	Turn *initStartOfGame(Game *game) { Turn *turn = new Turn(); turn->_game = game; turn->_status = kTurnFinished; return turn; };
 	void	setStateString(std::string board) { _boardState = board; };
 	Game		*_game;
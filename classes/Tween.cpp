@@ -0,0 +1,83 @@
+#include "Tween.h"
+#include <algorithm>
+
+//
+// a tween holds its bit, so a piece captured or cleared mid-flight stays valid until it lands
+//
+Tween &TweenScheduler::tweenFor(Bit *bit)
+{
+    for (Tween &tween : _tweens) {
+        if (tween.bit == bit) {
+            return tween;
+        }
+    }
+    bit->retain();
+    bit->setAnimating(true);
+    const ImVec2 at = bit->getPosition();
+    _tweens.push_back({ bit, at, at, bit->getScale(), bit->getScale(), 0.0f, 0.0f });
+    return _tweens.back();
+}
+
+void TweenScheduler::moveTo(Bit *bit, const ImVec2 &point, float seconds)
+{
+    if (seconds <= 0.0f) {
+        bit->setPosition(point);
+    }
+    Tween &tween = tweenFor(bit);
+    // carry on from wherever the bit is now, with the scale's remaining time kept
+    tween.from = bit->getPosition();
+    tween.to = point;
+    tween.fromScale = bit->getScale();
+    tween.duration = std::max(tween.duration - tween.elapsed, seconds);
+    tween.elapsed = 0.0f;
+}
+
+void TweenScheduler::scaleTo(Bit *bit, float scale, float seconds)
+{
+    if (seconds <= 0.0f) {
+        bit->setScale(scale);
+    }
+    Tween &tween = tweenFor(bit);
+    tween.from = bit->getPosition();
+    tween.fromScale = bit->getScale();
+    tween.toScale = scale;
+    tween.duration = std::max(tween.duration - tween.elapsed, seconds);
+    tween.elapsed = 0.0f;
+}
+
+//
+// ease out: quick to leave, slow to settle; finished tweens are swapped out of the array
+//
+bool TweenScheduler::update(float dt)
+{
+    bool finished = false;
+    for (size_t i = 0; i < _tweens.size();) {
+        Tween &tween = _tweens[i];
+        tween.elapsed += dt;
+        const float t = (tween.duration > 0.0f) ? std::min(tween.elapsed / tween.duration, 1.0f) : 1.0f;
+        const float u = 1.0f - t;
+        const float eased = 1.0f - u * u * u;
+        tween.bit->setPosition(tween.from.x + (tween.to.x - tween.from.x) * eased,
+                               tween.from.y + (tween.to.y - tween.from.y) * eased);
+        tween.bit->setScale(tween.fromScale + (tween.toScale - tween.fromScale) * eased);
+        if (t < 1.0f) {
+            i++;
+            continue;
+        }
+        tween.bit->setAnimating(false);
+        tween.bit->release();
+        tween = _tweens.back();
+        _tweens.pop_back();
+        finished = true;
+    }
+    return finished;
+}
+
+void TweenScheduler::clear()
+{
+    for (Tween &tween : _tweens) {
+        tween.bit->setAnimating(false);
+        tween.bit->release();
+    }
+    _tweens.clear();
+}
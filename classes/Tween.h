@@ -0,0 +1,51 @@
+#pragma once
+#include <span>
+#include <vector>
+#include "Bit.h"
+
+//
+// a bit gliding to a position and scale over a few frames
+// the scheduler is advanced once a frame by the frame's delta time, so an animation takes the
+// same time at any frame rate and never waits on anything: input, the AI and the rest of the
+// board carry on while it runs
+//
+struct Tween
+{
+    Bit *       bit;
+    ImVec2      from;
+    ImVec2      to;
+    float       fromScale;
+    float       toScale;
+    float       elapsed;        // seconds
+    float       duration;
+};
+
+class TweenScheduler
+{
+public:
+    TweenScheduler() = default;
+    ~TweenScheduler() { clear(); }
+    TweenScheduler(const TweenScheduler &) = delete;
+    TweenScheduler &operator=(const TweenScheduler &) = delete;
+
+    // glide bit from where it is now to point; a tween already running on it is retargeted
+    // from its current position, so a bit is never in two tweens; 0 seconds moves it at once
+    void        moveTo(Bit *bit, const ImVec2 &point, float seconds);
+    // the same for the bit's scale, about its centre
+    void        scaleTo(Bit *bit, float scale, float seconds);
+
+    // advance every tween by dt seconds; true if one finished, and so its bit is at rest again
+    bool        update(float dt);
+
+    bool        empty() const { return _tweens.empty(); }
+    // the running tweens, whose bits are drawn over the board each frame
+    std::span<const Tween> tweens() const { return _tweens; }
+    // stop every tween where it is
+    void        clear();
+
+private:
+    // the tween of bit, a new one starting from its current state if it has none
+    Tween &     tweenFor(Bit *bit);
+
+    std::vector<Tween>  _tweens;
+};
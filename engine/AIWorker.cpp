@@ -0,0 +1,118 @@
+#include "AIWorker.h"
+#include "Profiler.h"
+
+AIWorker::AIWorker() : _running(false), _quit(false), _hasReply(false), _nextTicket(1), _wantedTicket(0), _stop(false)
+{
+    _thread = std::thread(&AIWorker::run, this);
+}
+
+AIWorker::~AIWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+        _pending = nullptr;
+        _stop = true;
+    }
+    _wake.notify_all();
+    _thread.join();
+}
+
+uint64_t AIWorker::post(Job job)
+{
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ticket = _nextTicket++;
+        _pending = std::move(job);
+        _wantedTicket = ticket;
+        _hasReply = false;
+        if (_running) {
+            _stop = true;
+        }
+    }
+    _wake.notify_one();
+    return ticket;
+}
+
+bool AIWorker::poll(AIReply &reply)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_hasReply) {
+        return false;
+    }
+    reply = _reply;
+    _hasReply = false;
+    return true;
+}
+
+void AIWorker::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running) {
+        _stop = true;
+    }
+}
+
+void AIWorker::cancel()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending = nullptr;
+    _wantedTicket = 0;
+    _hasReply = false;
+    if (_running) {
+        _stop = true;
+    }
+}
+
+void AIWorker::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return !_running && !_pending; });
+}
+
+bool AIWorker::busy() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _running || _pending;
+}
+
+void AIWorker::run()
+{
+    ProfilerSetThreadName("AI worker");
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _wake.wait(lock, [this] { return _quit || _pending; });
+        if (_quit) {
+            break;
+        }
+        Job job = std::move(_pending);
+        _pending = nullptr;
+        const uint64_t ticket = _wantedTicket;
+        _running = true;
+        _stop = false;
+
+        lock.unlock();
+        AIReply reply;
+        {
+            PROFILE_SCOPE("AIWorker job");
+            reply = job(_stop);
+        }
+        lock.lock();
+
+        _running = false;
+        // a newer post() or a cancel() since this job started means nobody wants this reply
+        const bool delivered = ticket != 0 && ticket == _wantedTicket && !_pending;
+        if (delivered) {
+            reply.ticket = ticket;
+            _reply = reply;
+            _hasReply = true;
+        }
+        _idle.notify_all();
+        if (delivered && _onReply) {
+            lock.unlock();
+            _onReply();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ChessSearch.h"
+#include "Negamax.h"
+#include "MnkSearch.h"
+
+//
+// runs AI searches on a background thread so the render loop never waits on them
+// the game posts a job, keeps drawing frames, and polls for the reply on a later frame
+// only the most recently posted job's reply is ever delivered
+//
+
+struct AIReply
+{
+    uint64_t        ticket = 0;         // which post() this answers
+    int             move = -1;          // a cell, or a ChessMove for the chess engine
+    SearchResult    search;             // stats when the 3x3 engine ran the job
+    MnkSearchResult mnkSearch;          // stats when the m,n,k engine ran the job
+    ChessSearchResult chessSearch;      // stats when the chess engine ran the job
+};
+
+class AIWorker
+{
+public:
+    // a job must copy everything it reads and should check stop regularly;
+    // when stop is set it should return its best answer so far as soon as it can
+    using Job = std::function<AIReply(const std::atomic<bool> &stop)>;
+
+    AIWorker();
+    ~AIWorker();
+
+    // queue a job, asking any running one to stop and dropping its reply; returns the job's ticket
+    uint64_t    post(Job job);
+
+    // true once, with the reply to the latest post(), when it is ready
+    bool        poll(AIReply &reply);
+
+    // ask the running job to answer now with what it has; the reply is still delivered
+    void        stop();
+
+    // drop the running and pending jobs without delivering a reply
+    void        cancel();
+
+    // block until no job is running or pending
+    void        wait();
+
+    // a job is pending or running
+    bool        busy() const;
+
+    // called on the worker thread each time a reply becomes ready, e.g. to wake a render loop
+    // waiting for events; set it before the first post()
+    void        setReplyCallback(std::function<void()> callback) { _onReply = std::move(callback); }
+
+private:
+    void        run();
+
+    std::thread                 _thread;
+    mutable std::mutex          _mutex;
+    std::condition_variable     _wake;          // signalled when a job is posted or on shutdown
+    std::condition_variable     _idle;          // signalled when the worker finishes a job
+    Job                         _pending;
+    bool                        _running;
+    bool                        _quit;
+    bool                        _hasReply;
+    uint64_t                    _nextTicket;
+    uint64_t                    _wantedTicket;  // the only ticket whose reply is kept, 0 = none
+    AIReply                     _reply;
+    std::atomic<bool>           _stop;
+    std::function<void()>       _onReply;
+};
@@ -0,0 +1,239 @@
+#include "BatchEval.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define BATCH_EVAL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BATCH_EVAL_NEON 1
+#include <arm_neon.h>
+#endif
+
+// the kernels load positions as packed pairs of 16-bit masks and store results as 4 bytes
+static_assert(sizeof(Bitboard) == 4, "batch kernels load Bitboards as two packed uint16_t");
+static_assert(sizeof(PositionEval) == 4, "batch kernels store one 32-bit word per position");
+
+static PositionEval EvaluateOne(const Bitboard &pos)
+{
+    const uint16_t x = pos.x & BOARD_MASK;
+    const uint16_t o = pos.o & BOARD_MASK;
+    PositionEval eval{};
+    eval.winner = (uint8_t)(HasLine(x) ? 1 : HasLine(o) ? 2 : 0);
+    const bool full = (x | o) == BOARD_MASK;
+    eval.flags = (uint8_t)((eval.winner || full) ? EVAL_TERMINAL : 0);
+    if (!eval.winner && full) eval.flags |= EVAL_DRAW;
+    int score = 0;
+    for (uint16_t line : WIN_MASKS) {
+        score += ((o & line) == 0) - ((x & line) == 0);
+    }
+    eval.score = (int8_t)score;
+    return eval;
+}
+
+static void EvaluateScalar(const Bitboard *positions, size_t count, PositionEval *out)
+{
+    for (size_t i = 0; i < count; ++i) out[i] = EvaluateOne(positions[i]);
+}
+
+#ifdef BATCH_EVAL_X86
+//
+// 8 positions per pass in 16-bit lanes: the x and o halves of each 32-bit Bitboard are split
+// and narrowed with a signed pack (the masks are under 512, so nothing saturates)
+//
+static void EvaluateSse2(const Bitboard *positions, size_t count, PositionEval *out)
+{
+    const __m128i board = _mm_set1_epi32(BOARD_MASK);
+    const __m128i boardMask = _mm_set1_epi16(BOARD_MASK);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(positions + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(positions + i + 4));
+        const __m128i x = _mm_packs_epi32(_mm_and_si128(a, board), _mm_and_si128(b, board));
+        const __m128i o = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), board), _mm_and_si128(_mm_srli_epi32(b, 16), board));
+        __m128i xWins = zero, oWins = zero, score = zero;
+        for (uint16_t mask : WIN_MASKS) {
+            const __m128i line = _mm_set1_epi16((short)mask);
+            const __m128i xLine = _mm_and_si128(x, line);
+            const __m128i oLine = _mm_and_si128(o, line);
+            xWins = _mm_or_si128(xWins, _mm_cmpeq_epi16(xLine, line));
+            oWins = _mm_or_si128(oWins, _mm_cmpeq_epi16(oLine, line));
+            // the compares give -1 for true
+            score = _mm_sub_epi16(score, _mm_cmpeq_epi16(oLine, zero));
+            score = _mm_add_epi16(score, _mm_cmpeq_epi16(xLine, zero));
+        }
+        const __m128i won = _mm_or_si128(xWins, oWins);
+        const __m128i full = _mm_cmpeq_epi16(_mm_or_si128(x, o), boardMask);
+        const __m128i winner = _mm_or_si128(_mm_and_si128(xWins, one), _mm_and_si128(_mm_andnot_si128(xWins, oWins), _mm_set1_epi16(2)));
+        const __m128i flags = _mm_or_si128(_mm_and_si128(_mm_or_si128(won, full), _mm_set1_epi16(EVAL_TERMINAL)),
+                                           _mm_and_si128(_mm_andnot_si128(won, full), _mm_set1_epi16(EVAL_DRAW)));
+        const __m128i low = _mm_or_si128(winner, _mm_slli_epi16(flags, 8));
+        const __m128i high = _mm_and_si128(score, _mm_set1_epi16(0xFF));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi16(low, high));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(low, high));
+    }
+    EvaluateScalar(positions + i, count - i, out + i);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BATCH_EVAL_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define BATCH_EVAL_AVX2_TARGET
+#endif
+
+// the same with 16 positions; packs and unpacks work within 128-bit halves, hence the permutes
+BATCH_EVAL_AVX2_TARGET static void EvaluateAvx2(const Bitboard *positions, size_t count, PositionEval *out)
+{
+    const __m256i board = _mm256_set1_epi32(BOARD_MASK);
+    const __m256i boardMask = _mm256_set1_epi16(BOARD_MASK);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(positions + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(positions + i + 8));
+        const __m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(a, board), _mm256_and_si256(b, board)), 0xD8);
+        const __m256i o = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(a, 16), board),
+                                                                      _mm256_and_si256(_mm256_srli_epi32(b, 16), board)), 0xD8);
+        __m256i xWins = zero, oWins = zero, score = zero;
+        for (uint16_t mask : WIN_MASKS) {
+            const __m256i line = _mm256_set1_epi16((short)mask);
+            const __m256i xLine = _mm256_and_si256(x, line);
+            const __m256i oLine = _mm256_and_si256(o, line);
+            xWins = _mm256_or_si256(xWins, _mm256_cmpeq_epi16(xLine, line));
+            oWins = _mm256_or_si256(oWins, _mm256_cmpeq_epi16(oLine, line));
+            score = _mm256_sub_epi16(score, _mm256_cmpeq_epi16(oLine, zero));
+            score = _mm256_add_epi16(score, _mm256_cmpeq_epi16(xLine, zero));
+        }
+        const __m256i won = _mm256_or_si256(xWins, oWins);
+        const __m256i full = _mm256_cmpeq_epi16(_mm256_or_si256(x, o), boardMask);
+        const __m256i winner = _mm256_or_si256(_mm256_and_si256(xWins, one), _mm256_and_si256(_mm256_andnot_si256(xWins, oWins), _mm256_set1_epi16(2)));
+        const __m256i flags = _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(won, full), _mm256_set1_epi16(EVAL_TERMINAL)),
+                                              _mm256_and_si256(_mm256_andnot_si256(won, full), _mm256_set1_epi16(EVAL_DRAW)));
+        const __m256i low = _mm256_or_si256(winner, _mm256_slli_epi16(flags, 8));
+        const __m256i high = _mm256_and_si256(score, _mm256_set1_epi16(0xFF));
+        const __m256i first = _mm256_unpacklo_epi16(low, high);     // positions 0-3 and 8-11
+        const __m256i second = _mm256_unpackhi_epi16(low, high);    // 4-7 and 12-15
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 8), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    EvaluateSse2(positions + i, count - i, out + i);
+}
+
+static bool CpuHasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;     // OSXSAVE, then XMM and YMM state
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+#endif
+
+#ifdef BATCH_EVAL_NEON
+// 8 positions per pass: vld2q splits the x and o halves, vst4 interleaves the result bytes
+static void EvaluateNeon(const Bitboard *positions, size_t count, PositionEval *out)
+{
+    const uint16x8_t boardMask = vdupq_n_u16(BOARD_MASK);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8x2_t masks = vld2q_u16(reinterpret_cast<const uint16_t *>(positions + i));
+        const uint16x8_t x = vandq_u16(masks.val[0], boardMask);
+        const uint16x8_t o = vandq_u16(masks.val[1], boardMask);
+        uint16x8_t xWins = vdupq_n_u16(0), oWins = vdupq_n_u16(0);
+        int16x8_t score = vdupq_n_s16(0);
+        for (uint16_t mask : WIN_MASKS) {
+            const uint16x8_t line = vdupq_n_u16(mask);
+            const uint16x8_t xLine = vandq_u16(x, line);
+            const uint16x8_t oLine = vandq_u16(o, line);
+            xWins = vorrq_u16(xWins, vceqq_u16(xLine, line));
+            oWins = vorrq_u16(oWins, vceqq_u16(oLine, line));
+            score = vsubq_s16(score, vreinterpretq_s16_u16(vceqzq_u16(oLine)));
+            score = vaddq_s16(score, vreinterpretq_s16_u16(vceqzq_u16(xLine)));
+        }
+        const uint16x8_t won = vorrq_u16(xWins, oWins);
+        const uint16x8_t full = vceqq_u16(vorrq_u16(x, o), boardMask);
+        const uint16x8_t winner = vorrq_u16(vandq_u16(xWins, vdupq_n_u16(1)), vandq_u16(vbicq_u16(oWins, xWins), vdupq_n_u16(2)));
+        const uint16x8_t flags = vorrq_u16(vandq_u16(vorrq_u16(won, full), vdupq_n_u16(EVAL_TERMINAL)),
+                                           vandq_u16(vbicq_u16(full, won), vdupq_n_u16(EVAL_DRAW)));
+        uint8x8x4_t bytes;
+        bytes.val[0] = vmovn_u16(winner);
+        bytes.val[1] = vmovn_u16(flags);
+        bytes.val[2] = vreinterpret_u8_s8(vmovn_s16(score));
+        bytes.val[3] = vdup_n_u8(0);
+        vst4_u8(reinterpret_cast<uint8_t *>(out + i), bytes);
+    }
+    EvaluateScalar(positions + i, count - i, out + i);
+}
+#endif
+
+bool BatchEvalSupported(BatchEvalBackend backend)
+{
+    switch (backend) {
+    case kBatchEvalScalar:  return true;
+#ifdef BATCH_EVAL_X86
+    case kBatchEvalSse2:    return true;
+    case kBatchEvalAvx2:
+    {
+        static const bool avx2 = CpuHasAvx2();
+        return avx2;
+    }
+#endif
+#ifdef BATCH_EVAL_NEON
+    case kBatchEvalNeon:    return true;
+#endif
+    default:                return false;
+    }
+}
+
+BatchEvalBackend BestBatchEvalBackend()
+{
+    static const BatchEvalBackend best = BatchEvalSupported(kBatchEvalAvx2) ? kBatchEvalAvx2
+                                       : BatchEvalSupported(kBatchEvalNeon) ? kBatchEvalNeon
+                                       : BatchEvalSupported(kBatchEvalSse2) ? kBatchEvalSse2
+                                                                            : kBatchEvalScalar;
+    return best;
+}
+
+const char *BatchEvalBackendName(BatchEvalBackend backend)
+{
+    switch (backend) {
+    case kBatchEvalScalar:  return "scalar";
+    case kBatchEvalSse2:    return "sse2";
+    case kBatchEvalAvx2:    return "avx2";
+    case kBatchEvalNeon:    return "neon";
+    }
+    return "?";
+}
+
+void EvaluateBatch(const Bitboard *positions, size_t count, PositionEval *out)
+{
+    EvaluateBatch(positions, count, out, BestBatchEvalBackend());
+}
+
+void EvaluateBatch(const Bitboard *positions, size_t count, PositionEval *out, BatchEvalBackend backend)
+{
+    if (!BatchEvalSupported(backend)) backend = kBatchEvalScalar;
+    switch (backend) {
+#ifdef BATCH_EVAL_X86
+    case kBatchEvalAvx2:    EvaluateAvx2(positions, count, out); return;
+    case kBatchEvalSse2:    EvaluateSse2(positions, count, out); return;
+#endif
+#ifdef BATCH_EVAL_NEON
+    case kBatchEvalNeon:    EvaluateNeon(positions, count, out); return;
+#endif
+    default:                EvaluateScalar(positions, count, out); return;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Bitboard.h"
+
+//
+// evaluates many independent 3x3 positions at once, for tools that look at every position
+// of thousands of games rather than searching one
+// every line mask is tested against 8 (SSE2, NEON) or 16 (AVX2) positions per instruction;
+// the widest kernel the CPU supports is picked at run time, with a scalar loop behind it
+// that gives the same answers on any machine
+//
+
+// PositionEval::flags
+constexpr uint8_t EVAL_TERMINAL = 1;        // somebody has won or the board is full
+constexpr uint8_t EVAL_DRAW     = 2;        // full with no winner
+
+struct PositionEval
+{
+    uint8_t     winner;         // 0 none, 1 X, 2 O (X if both have a line)
+    uint8_t     flags;
+    // lines X can still complete minus lines O can still complete, from X's point of view
+    int8_t      score;
+    uint8_t     reserved;
+};
+
+enum BatchEvalBackend
+{
+    kBatchEvalScalar,
+    kBatchEvalSse2,
+    kBatchEvalAvx2,
+    kBatchEvalNeon,
+};
+
+// the widest backend this CPU runs, decided once
+BatchEvalBackend    BestBatchEvalBackend();
+bool                BatchEvalSupported(BatchEvalBackend backend);
+const char         *BatchEvalBackendName(BatchEvalBackend backend);
+
+// out[i] for positions[i]; the second form forces a backend, and falls back to scalar for one
+// the CPU can't run
+void                EvaluateBatch(const Bitboard *positions, size_t count, PositionEval *out);
+void                EvaluateBatch(const Bitboard *positions, size_t count, PositionEval *out, BatchEvalBackend backend);
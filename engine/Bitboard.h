@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "StateString.h"
+
+//
+// a 3x3 tic tac toe position stored as two 9-bit masks, one per player
+// bit i is cell i, counted left-to-right, top-to-bottom (the same order as the state string)
+// this is the single copy of the rules shared by the search, the TicTacToe class and the tools
+//
+
+constexpr int      BOARD_CELLS = 9;
+constexpr uint16_t BOARD_MASK  = 0x1FF;
+
+// a 3x3 state string on the stack, see engine/StateString.h
+using BoardState = StateBuffer<BOARD_CELLS>;
+
+// all 8 winning triplets as cell masks
+constexpr uint16_t WIN_MASKS[8] = {
+    0x007, 0x038, 0x1C0,        // rows
+    0x049, 0x092, 0x124,        // columns
+    0x111, 0x054                // diagonals
+};
+
+// WIN_TABLE[mask] is true if the 9-bit mask contains any winning triplet
+constexpr std::array<bool, 512> WIN_TABLE = [] {
+    std::array<bool, 512> table{};
+    for (int mask = 0; mask < 512; ++mask) {
+        for (uint16_t line : WIN_MASKS) {
+            if ((mask & line) == line) table[mask] = true;
+        }
+    }
+    return table;
+}();
+
+constexpr bool HasLine(uint16_t mask) { return WIN_TABLE[mask & BOARD_MASK]; }
+
+struct Bitboard
+{
+    uint16_t x = 0;             // cells held by player 1 (X)
+    uint16_t o = 0;             // cells held by player 2 (O)
+
+    constexpr uint16_t  occupied() const { return x | o; }
+    constexpr uint16_t  emptyCells() const { return (uint16_t)(~(x | o) & BOARD_MASK); }
+    constexpr int       pieceCount() const { return std::popcount(occupied()); }
+    constexpr bool      full() const { return occupied() == BOARD_MASK; }
+
+    // 1 or 2; X always moves first so equal counts mean X to move
+    constexpr int       sideToMove() const { return (std::popcount(x) == std::popcount(o)) ? 1 : 2; }
+
+    // 0 empty, 1 = X, 2 = O
+    constexpr int cellAt(int index) const
+    {
+        const uint16_t bit = (uint16_t)(1u << index);
+        return (x & bit) ? 1 : (o & bit) ? 2 : 0;
+    }
+    constexpr void set(int index, int player)
+    {
+        const uint16_t bit = (uint16_t)(1u << index);
+        x &= ~bit;
+        o &= ~bit;
+        if (player == 1) x |= bit;
+        if (player == 2) o |= bit;
+    }
+    constexpr Bitboard withMove(int index, int player) const
+    {
+        Bitboard next = *this;
+        next.set(index, player);
+        return next;
+    }
+
+    // 0 none, 1 or 2 winner
+    constexpr int winner() const { return HasLine(x) ? 1 : HasLine(o) ? 2 : 0; }
+    constexpr bool gameOver() const { return winner() != 0 || full(); }
+
+    // both masks packed into 18 bits, unique per position
+    constexpr uint32_t key() const { return (uint32_t)x | ((uint32_t)o << 9); }
+
+    constexpr bool operator==(const Bitboard &other) const = default;
+
+    // "100020000" style strings, see TicTacToe::stateString(); missing cells are empty and
+    // anything but '1' or '2' is too
+    static constexpr Bitboard fromStateString(std::string_view s)
+    {
+        Bitboard board;
+        const int cells = (int)s.size() < BOARD_CELLS ? (int)s.size() : BOARD_CELLS;
+        for (int i = 0; i < cells; ++i) {
+            board.x |= (uint16_t)((s[i] == '1') << i);
+            board.o |= (uint16_t)((s[i] == '2') << i);
+        }
+        return board;
+    }
+    constexpr BoardState toState() const
+    {
+        BoardState state(BOARD_CELLS);
+        for (int i = 0; i < BOARD_CELLS; ++i) state.set(i, cellAt(i));
+        return state;
+    }
+    // a heap copy of toState(), for interfaces that keep the string
+    std::string toStateString() const { return toState().str(); }
+};
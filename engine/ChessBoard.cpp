@@ -0,0 +1,699 @@
+#include "ChessBoard.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+constexpr uint64_t RANK_1 = 0xFFull;
+constexpr uint64_t RANK_3 = RANK_1 << 16;
+constexpr uint64_t RANK_6 = RANK_1 << 40;
+constexpr uint64_t RANK_8 = RANK_1 << 56;
+constexpr uint64_t LIGHT_SQUARES = 0x55AA55AA55AA55AAull;
+
+constexpr uint64_t SquareBit(int square) { return 1ull << square; }
+
+// lowest set square, removing it from bits
+static int PopSquare(uint64_t &bits)
+{
+    const int square = std::countr_zero(bits);
+    bits &= bits - 1;
+    return square;
+}
+
+//
+// Zobrist keys: one per piece on each square, one per set of castling rights, one per en passant
+// file and one for black to move, from a fixed splitmix64 sequence so keys are the same every run
+//
+struct ZobristKeys
+{
+    uint64_t    pieces[12][64];
+    uint64_t    castling[16];
+    uint64_t    enPassant[8];
+    uint64_t    blackToMove;
+};
+
+static constexpr ZobristKeys MakeZobristKeys()
+{
+    ZobristKeys keys{};
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state] {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+    for (auto &piece : keys.pieces) {
+        for (uint64_t &square : piece) square = next();
+    }
+    // no rights hash to 0, so a position's key doesn't change with rights it never had
+    for (int rights = 1; rights < 16; ++rights) keys.castling[rights] = next();
+    for (uint64_t &file : keys.enPassant) file = next();
+    keys.blackToMove = next();
+    return keys;
+}
+
+static constexpr ZobristKeys ZOBRIST = MakeZobristKeys();
+
+// the rights left after a move from or to each square: a king or rook moving, or a rook taken
+static constexpr std::array<uint8_t, 64> CASTLING_KEPT = [] {
+    std::array<uint8_t, 64> kept{};
+    kept.fill(15);
+    kept[ChessSquare(0, 0)] = (uint8_t)~CASTLE_WHITE_QUEEN & 15;
+    kept[ChessSquare(4, 0)] = (uint8_t)~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN) & 15;
+    kept[ChessSquare(7, 0)] = (uint8_t)~CASTLE_WHITE_KING & 15;
+    kept[ChessSquare(0, 7)] = (uint8_t)~CASTLE_BLACK_QUEEN & 15;
+    kept[ChessSquare(4, 7)] = (uint8_t)~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN) & 15;
+    kept[ChessSquare(7, 7)] = (uint8_t)~CASTLE_BLACK_KING & 15;
+    return kept;
+}();
+
+//
+// attack tables
+// a slider's attacks depend only on the pieces on its lines, minus the edge squares (a piece
+// there blocks nothing further); each square's table is indexed by those relevant bits,
+// gathered by a magic multiply and shift, or by PEXT where the CPU has it
+// the magics are found by trial at startup from a fixed seed: a few thousand random sparse
+// candidates per square, which takes a few milliseconds and yields the same tables every run
+//
+
+struct SliderSquare
+{
+    uint64_t        mask = 0;           // relevant occupancy
+    uint64_t        magic = 0;
+    const uint64_t *attacks = nullptr;  // 1 << popcount(mask) entries
+    int             shift = 0;
+
+    size_t          index(uint64_t occupied) const
+    {
+#if defined(__BMI2__)
+        return (size_t)_pext_u64(occupied, mask);
+#else
+        return (size_t)(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+static const int ROOK_DIRECTIONS[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+static const int BISHOP_DIRECTIONS[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+static bool OnBoard(int file, int rank) { return file >= 0 && file < 8 && rank >= 0 && rank < 8; }
+
+// the slow way, walking each ray to the first blocker; relevantOnly leaves out each ray's last square
+static uint64_t WalkRays(int square, uint64_t occupied, const int (*directions)[2], bool relevantOnly)
+{
+    uint64_t attacks = 0;
+    for (int d = 0; d < 4; ++d) {
+        const int df = directions[d][0], dr = directions[d][1];
+        for (int f = ChessFile(square) + df, r = ChessRank(square) + dr; OnBoard(f, r); f += df, r += dr) {
+            if (relevantOnly && !OnBoard(f + df, r + dr)) break;
+            attacks |= SquareBit(ChessSquare(f, r));
+            if (occupied & SquareBit(ChessSquare(f, r))) break;
+        }
+    }
+    return attacks;
+}
+
+struct AttackTables
+{
+    uint64_t                knight[64];
+    uint64_t                king[64];
+    uint64_t                pawn[2][64];
+    SliderSquare            bishop[64];
+    SliderSquare            rook[64];
+    std::vector<uint64_t>   sliderAttacks;  // every square's bishop then rook table, 107648 entries
+
+    AttackTables();
+};
+
+static void FillSlider(SliderSquare (&squares)[64], const int (*directions)[2], size_t (&offsets)[64],
+                       std::vector<uint64_t> &table, uint64_t &seed)
+{
+#if !defined(__BMI2__)
+    auto random = [&seed] {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 0x2545F4914F6CDD1Dull;
+    };
+    std::vector<int> tried;
+#endif
+    std::vector<uint64_t> occupancies, references;
+    for (int square = 0; square < 64; ++square) {
+        SliderSquare &slider = squares[square];
+        slider.mask = WalkRays(square, 0, directions, true);
+        const int bits = std::popcount(slider.mask);
+        slider.shift = 64 - bits;
+        const size_t size = (size_t)1 << bits;
+        uint64_t *attacks = table.data() + offsets[square];
+
+        // every subset of the mask, by the carry-rippler trick, with its attacks
+        occupancies.clear();
+        references.clear();
+        uint64_t subset = 0;
+        do {
+            occupancies.push_back(subset);
+            references.push_back(WalkRays(square, subset, directions, false));
+            subset = (subset - slider.mask) & slider.mask;
+        } while (subset != 0);
+
+#if defined(__BMI2__)
+        for (size_t i = 0; i < size; ++i) {
+            attacks[slider.index(occupancies[i])] = references[i];
+        }
+#else
+        // a magic works if no two occupancies with different attacks share an index; tried[]
+        // marks which attempt last wrote an entry, so the table needn't be cleared between tries
+        tried.assign(size, 0);
+        for (int attempt = 1;; ++attempt) {
+            do {
+                slider.magic = random() & random() & random();
+            } while (std::popcount((slider.mask * slider.magic) >> 56) < 6);
+            size_t i = 0;
+            for (; i < size; ++i) {
+                const size_t index = slider.index(occupancies[i]);
+                if (tried[index] != attempt) {
+                    tried[index] = attempt;
+                    attacks[index] = references[i];
+                } else if (attacks[index] != references[i]) {
+                    break;
+                }
+            }
+            if (i == size) break;
+        }
+#endif
+        slider.attacks = attacks;
+    }
+}
+
+AttackTables::AttackTables()
+{
+    static const int KNIGHT_STEPS[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+    static const int KING_STEPS[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+    for (int square = 0; square < 64; ++square) {
+        const int file = ChessFile(square), rank = ChessRank(square);
+        knight[square] = king[square] = pawn[kWhite][square] = pawn[kBlack][square] = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (OnBoard(file + KNIGHT_STEPS[i][0], rank + KNIGHT_STEPS[i][1])) {
+                knight[square] |= SquareBit(ChessSquare(file + KNIGHT_STEPS[i][0], rank + KNIGHT_STEPS[i][1]));
+            }
+            if (OnBoard(file + KING_STEPS[i][0], rank + KING_STEPS[i][1])) {
+                king[square] |= SquareBit(ChessSquare(file + KING_STEPS[i][0], rank + KING_STEPS[i][1]));
+            }
+        }
+        for (int df = -1; df <= 1; df += 2) {
+            if (OnBoard(file + df, rank + 1)) pawn[kWhite][square] |= SquareBit(ChessSquare(file + df, rank + 1));
+            if (OnBoard(file + df, rank - 1)) pawn[kBlack][square] |= SquareBit(ChessSquare(file + df, rank - 1));
+        }
+    }
+
+    size_t bishopOffsets[64], rookOffsets[64];
+    size_t total = 0;
+    for (int square = 0; square < 64; ++square) {
+        bishopOffsets[square] = total;
+        total += (size_t)1 << std::popcount(WalkRays(square, 0, BISHOP_DIRECTIONS, true));
+    }
+    for (int square = 0; square < 64; ++square) {
+        rookOffsets[square] = total;
+        total += (size_t)1 << std::popcount(WalkRays(square, 0, ROOK_DIRECTIONS, true));
+    }
+    sliderAttacks.assign(total, 0);
+    uint64_t seed = 0x5EED0C4E55ull;
+    FillSlider(bishop, BISHOP_DIRECTIONS, bishopOffsets, sliderAttacks, seed);
+    FillSlider(rook, ROOK_DIRECTIONS, rookOffsets, sliderAttacks, seed);
+}
+
+static const AttackTables &Tables()
+{
+    static const AttackTables tables;
+    return tables;
+}
+
+uint64_t ChessKnightAttacks(int square) { return Tables().knight[square]; }
+uint64_t ChessKingAttacks(int square) { return Tables().king[square]; }
+uint64_t ChessPawnAttacks(int color, int square) { return Tables().pawn[color][square]; }
+
+uint64_t ChessBishopAttacks(int square, uint64_t occupied)
+{
+    const SliderSquare &slider = Tables().bishop[square];
+    return slider.attacks[slider.index(occupied)];
+}
+
+uint64_t ChessRookAttacks(int square, uint64_t occupied)
+{
+    const SliderSquare &slider = Tables().rook[square];
+    return slider.attacks[slider.index(occupied)];
+}
+
+//
+// ChessBoard
+//
+
+ChessBoard::ChessBoard()
+{
+    setFen(START_FEN);
+}
+
+void ChessBoard::clear()
+{
+    for (uint64_t &bits : _pieces) bits = 0;
+    _colors[kWhite] = _colors[kBlack] = 0;
+    for (uint8_t &piece : _mailbox) piece = CHESS_NO_PIECE;
+    _side = kWhite;
+    _castling = 0;
+    _enPassant = -1;
+    _halfmoveClock = 0;
+    _fullmove = 1;
+    _key = 0;
+    _history.clear();
+}
+
+void ChessBoard::put(int piece, int square)
+{
+    _pieces[piece] |= SquareBit(square);
+    _colors[ChessPieceColor(piece)] |= SquareBit(square);
+    _mailbox[square] = (uint8_t)piece;
+    _key ^= ZOBRIST.pieces[piece][square];
+}
+
+void ChessBoard::remove(int square)
+{
+    const int piece = _mailbox[square];
+    _pieces[piece] &= ~SquareBit(square);
+    _colors[ChessPieceColor(piece)] &= ~SquareBit(square);
+    _mailbox[square] = CHESS_NO_PIECE;
+    _key ^= ZOBRIST.pieces[piece][square];
+}
+
+void ChessBoard::relocate(int from, int to)
+{
+    const int piece = _mailbox[from];
+    const uint64_t both = SquareBit(from) | SquareBit(to);
+    _pieces[piece] ^= both;
+    _colors[ChessPieceColor(piece)] ^= both;
+    _mailbox[from] = CHESS_NO_PIECE;
+    _mailbox[to] = (uint8_t)piece;
+    _key ^= ZOBRIST.pieces[piece][from] ^ ZOBRIST.pieces[piece][to];
+}
+
+int ChessBoard::kingSquare(int color) const
+{
+    return std::countr_zero(_pieces[ChessPiece(color, kKing)]);
+}
+
+bool ChessBoard::setFen(std::string_view fen)
+{
+    static const char PIECE_LETTERS[] = "PNBRQKpnbrqk";
+    ChessBoard board = *this;
+    board.clear();
+
+    std::string_view fields[6];
+    int fieldCount = 0;
+    for (size_t start = 0; start < fen.size() && fieldCount < 6;) {
+        const size_t end = std::min(fen.find(' ', start), fen.size());
+        if (end > start) fields[fieldCount++] = fen.substr(start, end - start);
+        start = end + 1;
+    }
+    if (fieldCount < 4) {
+        return false;
+    }
+
+    // placement, from a8 across and down to h1
+    int file = 0, rank = 7;
+    for (char c : fields[0]) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) return false;
+            file = 0;
+            rank--;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return false;
+        } else {
+            const char *letter = std::char_traits<char>::find(PIECE_LETTERS, 12, c);
+            if (!letter || file > 7) return false;
+            const int piece = (int)(letter - PIECE_LETTERS);
+            if (ChessPieceTypeOf(piece) == kPawn && (rank == 0 || rank == 7)) return false;
+            board.put(piece, ChessSquare(file++, rank));
+        }
+    }
+    if (file != 8 || rank != 0) {
+        return false;
+    }
+    if (std::popcount(board.pieces(kWhite, kKing)) != 1 || std::popcount(board.pieces(kBlack, kKing)) != 1) {
+        return false;
+    }
+
+    if (fields[1] == "w") board._side = kWhite;
+    else if (fields[1] == "b") board._side = kBlack;
+    else return false;
+    if (board.attacked(board.kingSquare(board._side ^ 1), board._side)) {
+        return false;       // the side that just moved can't have left its king in check
+    }
+
+    if (fields[2] != "-") {
+        for (char c : fields[2]) {
+            if (c == 'K') board._castling |= CASTLE_WHITE_KING;
+            else if (c == 'Q') board._castling |= CASTLE_WHITE_QUEEN;
+            else if (c == 'k') board._castling |= CASTLE_BLACK_KING;
+            else if (c == 'q') board._castling |= CASTLE_BLACK_QUEEN;
+            else return false;
+        }
+    }
+    // rights only stand while the king and rook are on their squares
+    const auto onSquare = [&board](int piece, int square) { return board.pieceAt(square) == piece; };
+    if (!onSquare(ChessPiece(kWhite, kKing), ChessSquare(4, 0))) board._castling &= ~(CASTLE_WHITE_KING | CASTLE_WHITE_QUEEN);
+    if (!onSquare(ChessPiece(kWhite, kRook), ChessSquare(7, 0))) board._castling &= ~CASTLE_WHITE_KING;
+    if (!onSquare(ChessPiece(kWhite, kRook), ChessSquare(0, 0))) board._castling &= ~CASTLE_WHITE_QUEEN;
+    if (!onSquare(ChessPiece(kBlack, kKing), ChessSquare(4, 7))) board._castling &= ~(CASTLE_BLACK_KING | CASTLE_BLACK_QUEEN);
+    if (!onSquare(ChessPiece(kBlack, kRook), ChessSquare(7, 7))) board._castling &= ~CASTLE_BLACK_KING;
+    if (!onSquare(ChessPiece(kBlack, kRook), ChessSquare(0, 7))) board._castling &= ~CASTLE_BLACK_QUEEN;
+
+    if (fields[3] != "-") {
+        if (fields[3].size() != 2 || fields[3][0] < 'a' || fields[3][0] > 'h' || (fields[3][1] != '3' && fields[3][1] != '6')) {
+            return false;
+        }
+        const int square = ChessSquare(fields[3][0] - 'a', fields[3][1] - '1');
+        // kept only when a pawn could take there, as makeMove() does, so keys of equal positions match
+        if (ChessPawnAttacks(board._side ^ 1, square) & board.pieces(board._side, kPawn)) {
+            board._enPassant = square;
+        }
+    }
+    if (fieldCount > 4) board._halfmoveClock = std::max(0, atoi(std::string(fields[4]).c_str()));
+    if (fieldCount > 5) board._fullmove = std::max(1, atoi(std::string(fields[5]).c_str()));
+
+    board._key ^= ZOBRIST.castling[board._castling];
+    if (board._enPassant >= 0) board._key ^= ZOBRIST.enPassant[ChessFile(board._enPassant)];
+    if (board._side == kBlack) board._key ^= ZOBRIST.blackToMove;
+    *this = std::move(board);
+    return true;
+}
+
+std::string ChessBoard::fen() const
+{
+    static const char PIECE_LETTERS[] = "PNBRQKpnbrqk";
+    std::string fen;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            const int piece = _mailbox[ChessSquare(file, rank)];
+            if (piece == CHESS_NO_PIECE) {
+                empty++;
+                continue;
+            }
+            if (empty) fen += (char)('0' + empty);
+            empty = 0;
+            fen += PIECE_LETTERS[piece];
+        }
+        if (empty) fen += (char)('0' + empty);
+        if (rank) fen += '/';
+    }
+    fen += (_side == kWhite) ? " w " : " b ";
+    if (_castling & CASTLE_WHITE_KING) fen += 'K';
+    if (_castling & CASTLE_WHITE_QUEEN) fen += 'Q';
+    if (_castling & CASTLE_BLACK_KING) fen += 'k';
+    if (_castling & CASTLE_BLACK_QUEEN) fen += 'q';
+    if (!_castling) fen += '-';
+    fen += ' ';
+    fen += (_enPassant >= 0) ? ChessSquareName(_enPassant) : "-";
+    fen += ' ';
+    fen += std::to_string(_halfmoveClock);
+    fen += ' ';
+    fen += std::to_string(_fullmove);
+    return fen;
+}
+
+bool ChessBoard::attacked(int square, int byColor) const
+{
+    const uint64_t occupied = this->occupied();
+    const uint64_t queens = pieces(byColor, kQueen);
+    return (ChessPawnAttacks(byColor ^ 1, square) & pieces(byColor, kPawn)) ||
+           (ChessKnightAttacks(square) & pieces(byColor, kKnight)) ||
+           (ChessKingAttacks(square) & pieces(byColor, kKing)) ||
+           (ChessBishopAttacks(square, occupied) & (pieces(byColor, kBishop) | queens)) ||
+           (ChessRookAttacks(square, occupied) & (pieces(byColor, kRook) | queens));
+}
+
+static void AddPromotions(ChessMoveList &list, int from, int to, int flags)
+{
+    // queen first: the move ordering tries it before the underpromotions
+    for (int type = kQueen; type >= kKnight; --type) {
+        list.add(MakeChessMove(from, to, flags | (type - kKnight)));
+    }
+}
+
+void ChessBoard::generate(ChessMoveList &list, bool quietMoves) const
+{
+    const int us = _side, them = us ^ 1;
+    const uint64_t own = _colors[us], enemy = _colors[them], empty = ~(own | enemy);
+    const int forward = (us == kWhite) ? 8 : -8;
+    const uint64_t lastRank = (us == kWhite) ? RANK_8 : RANK_1;
+
+    // pawns: pushes as whole sets, then captures square by square
+    const uint64_t pawns = pieces(us, kPawn);
+    const uint64_t pushed = ((us == kWhite) ? pawns << 8 : pawns >> 8) & empty;
+    for (uint64_t targets = pushed; targets;) {
+        const int to = PopSquare(targets);
+        if (SquareBit(to) & lastRank) AddPromotions(list, to - forward, to, kMovePromotion);
+        else if (quietMoves) list.add(MakeChessMove(to - forward, to, kMoveQuiet));
+    }
+    if (quietMoves) {
+        const uint64_t pushedOnce = pushed & ((us == kWhite) ? RANK_3 : RANK_6);
+        for (uint64_t targets = ((us == kWhite) ? pushedOnce << 8 : pushedOnce >> 8) & empty; targets;) {
+            const int to = PopSquare(targets);
+            list.add(MakeChessMove(to - 2 * forward, to, kMoveDoublePush));
+        }
+    }
+    for (uint64_t from = pawns; from;) {
+        const int square = PopSquare(from);
+        for (uint64_t targets = ChessPawnAttacks(us, square) & enemy; targets;) {
+            const int to = PopSquare(targets);
+            if (SquareBit(to) & lastRank) AddPromotions(list, square, to, kMovePromotionCapture);
+            else list.add(MakeChessMove(square, to, kMoveCapture));
+        }
+    }
+    if (_enPassant >= 0) {
+        for (uint64_t from = ChessPawnAttacks(them, _enPassant) & pawns; from;) {
+            list.add(MakeChessMove(PopSquare(from), _enPassant, kMoveEnPassant));
+        }
+    }
+
+    // the other pieces, captures and quiet moves in one pass over the targets
+    const uint64_t occupied = own | enemy;
+    const uint64_t allowed = quietMoves ? ~own : enemy;
+    for (int type = kKnight; type <= kKing; ++type) {
+        for (uint64_t from = pieces(us, type); from;) {
+            const int square = PopSquare(from);
+            uint64_t targets;
+            switch (type) {
+            case kKnight: targets = ChessKnightAttacks(square); break;
+            case kBishop: targets = ChessBishopAttacks(square, occupied); break;
+            case kRook: targets = ChessRookAttacks(square, occupied); break;
+            case kQueen: targets = ChessBishopAttacks(square, occupied) | ChessRookAttacks(square, occupied); break;
+            default: targets = ChessKingAttacks(square); break;
+            }
+            for (targets &= allowed; targets;) {
+                const int to = PopSquare(targets);
+                list.add(MakeChessMove(square, to, (enemy & SquareBit(to)) ? kMoveCapture : kMoveQuiet));
+            }
+        }
+    }
+
+    // castling: the squares between king and rook empty and the king's path not attacked
+    if (quietMoves && _castling) {
+        const int home = (us == kWhite) ? 0 : 56;
+        const int kingRight = (us == kWhite) ? CASTLE_WHITE_KING : CASTLE_BLACK_KING;
+        const int queenRight = (us == kWhite) ? CASTLE_WHITE_QUEEN : CASTLE_BLACK_QUEEN;
+        if ((_castling & kingRight) && !(occupied & (SquareBit(home + 5) | SquareBit(home + 6))) &&
+            !attacked(home + 4, them) && !attacked(home + 5, them) && !attacked(home + 6, them)) {
+            list.add(MakeChessMove(home + 4, home + 6, kMoveCastleKing));
+        }
+        if ((_castling & queenRight) && !(occupied & (SquareBit(home + 1) | SquareBit(home + 2) | SquareBit(home + 3))) &&
+            !attacked(home + 4, them) && !attacked(home + 3, them) && !attacked(home + 2, them)) {
+            list.add(MakeChessMove(home + 4, home + 2, kMoveCastleQueen));
+        }
+    }
+}
+
+void ChessBoard::generateMoves(ChessMoveList &list) const
+{
+    list.count = 0;
+    generate(list, true);
+}
+
+void ChessBoard::generateCaptures(ChessMoveList &list) const
+{
+    list.count = 0;
+    generate(list, false);
+}
+
+void ChessBoard::legalMoves(ChessMoveList &list)
+{
+    ChessMoveList pseudo;
+    generateMoves(pseudo);
+    list.count = 0;
+    for (ChessMove move : pseudo) {
+        if (makeMove(move)) {
+            unmakeMove();
+            list.add(move);
+        }
+    }
+}
+
+ChessMove ChessBoard::parseMove(std::string_view text)
+{
+    ChessMoveList list;
+    legalMoves(list);
+    for (ChessMove move : list) {
+        if (ChessMoveText(move) == text) return move;
+    }
+    return CHESS_NULL_MOVE;
+}
+
+bool ChessBoard::makeMove(ChessMove move)
+{
+    const int from = ChessMoveFrom(move), to = ChessMoveTo(move), flags = ChessMoveFlags(move);
+    const int us = _side;
+    const int forward = (us == kWhite) ? 8 : -8;
+    Undo undo{ move, CHESS_NO_PIECE, (uint8_t)_castling, (int8_t)_enPassant, (uint16_t)_halfmoveClock, _key };
+
+    const bool pawnMove = ChessPieceTypeOf(_mailbox[from]) == kPawn;
+    if (_enPassant >= 0) {
+        _key ^= ZOBRIST.enPassant[ChessFile(_enPassant)];
+        _enPassant = -1;
+    }
+    if (flags == kMoveEnPassant) {
+        undo.captured = _mailbox[to - forward];
+        remove(to - forward);
+    } else if (flags & kMoveCapture) {
+        undo.captured = _mailbox[to];
+        remove(to);
+    }
+    if (flags & kMovePromotion) {
+        remove(from);
+        put(ChessPiece(us, ChessPromotionType(move)), to);
+    } else {
+        relocate(from, to);
+    }
+    if (flags == kMoveCastleKing) {
+        relocate(to + 1, to - 1);
+    } else if (flags == kMoveCastleQueen) {
+        relocate(to - 2, to + 1);
+    } else if (flags == kMoveDoublePush && (ChessPawnAttacks(us, from + forward) & pieces(us ^ 1, kPawn))) {
+        _enPassant = from + forward;
+        _key ^= ZOBRIST.enPassant[ChessFile(_enPassant)];
+    }
+
+    _halfmoveClock = (pawnMove || undo.captured != CHESS_NO_PIECE) ? 0 : _halfmoveClock + 1;
+    if (_castling) {
+        _key ^= ZOBRIST.castling[_castling];
+        _castling &= CASTLING_KEPT[from] & CASTLING_KEPT[to];
+        _key ^= ZOBRIST.castling[_castling];
+    }
+    _side ^= 1;
+    _key ^= ZOBRIST.blackToMove;
+    if (_side == kWhite) _fullmove++;
+    _history.push_back(undo);
+
+    if (attacked(kingSquare(us), _side)) {
+        unmakeMove();
+        return false;
+    }
+    return true;
+}
+
+void ChessBoard::unmakeMove()
+{
+    const Undo undo = _history.back();
+    _history.pop_back();
+    if (_side == kWhite) _fullmove--;
+    _side ^= 1;
+
+    const int from = ChessMoveFrom(undo.move), to = ChessMoveTo(undo.move), flags = ChessMoveFlags(undo.move);
+    const int us = _side;
+    if (flags & kMovePromotion) {
+        remove(to);
+        put(ChessPiece(us, kPawn), from);
+    } else {
+        relocate(to, from);
+    }
+    if (flags == kMoveCastleKing) {
+        relocate(to - 1, to + 1);
+    } else if (flags == kMoveCastleQueen) {
+        relocate(to + 1, to - 2);
+    }
+    if (undo.captured != CHESS_NO_PIECE) {
+        put(undo.captured, (flags == kMoveEnPassant) ? to - ((us == kWhite) ? 8 : -8) : to);
+    }
+    _castling = undo.castling;
+    _enPassant = undo.enPassant;
+    _halfmoveClock = undo.halfmoveClock;
+    _key = undo.key;
+}
+
+bool ChessBoard::repeated(int count) const
+{
+    // only positions with the same side to move, back to the last irreversible move
+    const int reach = std::min(_halfmoveClock, (int)_history.size());
+    int seen = 0;
+    for (int back = 4; back <= reach; back += 2) {
+        if (_history[_history.size() - back].key == _key && ++seen >= count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ChessBoard::insufficientMaterial() const
+{
+    for (int color = kWhite; color <= kBlack; ++color) {
+        if (pieces(color, kPawn) | pieces(color, kRook) | pieces(color, kQueen)) return false;
+    }
+    const uint64_t knights = pieces(kWhite, kKnight) | pieces(kBlack, kKnight);
+    const uint64_t bishops = pieces(kWhite, kBishop) | pieces(kBlack, kBishop);
+    // a lone minor piece, or bishops that all stand on one colour of square
+    if (std::popcount(knights | bishops) <= 1) return true;
+    return knights == 0 && ((bishops & LIGHT_SQUARES) == 0 || (bishops & ~LIGHT_SQUARES) == 0);
+}
+
+ChessStatus ChessBoard::status()
+{
+    ChessMoveList list;
+    legalMoves(list);
+    if (list.count == 0) return inCheck() ? kChessCheckmate : kChessStalemate;
+    if (_halfmoveClock >= 100) return kChessFiftyMoves;
+    if (repeated(2)) return kChessRepetition;
+    if (insufficientMaterial()) return kChessInsufficientMaterial;
+    return kChessPlaying;
+}
+
+std::string ChessSquareName(int square)
+{
+    return { (char)('a' + ChessFile(square)), (char)('1' + ChessRank(square)) };
+}
+
+std::string ChessMoveText(ChessMove move)
+{
+    std::string text = ChessSquareName(ChessMoveFrom(move)) + ChessSquareName(ChessMoveTo(move));
+    if (ChessMoveIsPromotion(move)) {
+        text += "nbrq"[ChessPromotionType(move) - kKnight];
+    }
+    return text;
+}
+
+uint64_t ChessPerft(ChessBoard &board, int depth)
+{
+    if (depth == 0) {
+        return 1;
+    }
+    ChessMoveList list;
+    board.generateMoves(list);
+    uint64_t leaves = 0;
+    for (ChessMove move : list) {
+        if (!board.makeMove(move)) continue;
+        leaves += (depth == 1) ? 1 : ChessPerft(board, depth - 1);
+        board.unmakeMove();
+    }
+    return leaves;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// chess position for the 8x8 demo game: one 64-bit bitboard per piece kind and colour, plus a
+// mailbox of what stands on each square, so move generation works on whole sets of squares and
+// "what is on e4" is still one load
+// squares run a1 = 0, b1 = 1, ... h8 = 63: bit s of a bitboard is square s
+// sliding attacks come from magic bitboard tables built the first time they are needed; a
+// build with BMI2 (-mbmi2) indexes the same tables with PEXT instead of a magic multiply
+// moves are made and unmade in place, with an undo stack whose entries also hold the position
+// keys that repetitions are detected from
+//
+
+enum ChessColor : int
+{
+    kWhite,
+    kBlack
+};
+
+enum ChessPieceType : int
+{
+    kPawn,
+    kKnight,
+    kBishop,
+    kRook,
+    kQueen,
+    kKing
+};
+
+// a piece is colour * 6 + type, CHESS_NO_PIECE an empty square
+constexpr int CHESS_NO_PIECE = 12;
+constexpr int ChessPiece(int color, int type) { return color * 6 + type; }
+constexpr int ChessPieceColor(int piece) { return piece / 6; }
+constexpr int ChessPieceTypeOf(int piece) { return piece % 6; }
+
+constexpr int ChessSquare(int file, int rank) { return rank * 8 + file; }
+constexpr int ChessFile(int square) { return square & 7; }
+constexpr int ChessRank(int square) { return square >> 3; }
+
+// castling rights
+constexpr int CASTLE_WHITE_KING = 1;
+constexpr int CASTLE_WHITE_QUEEN = 2;
+constexpr int CASTLE_BLACK_KING = 4;
+constexpr int CASTLE_BLACK_QUEEN = 8;
+
+//
+// a move in 16 bits: from square, to square, and four flag bits; flags 8-15 are promotions,
+// the low two bits picking knight, bishop, rook or queen and bit 2 marking a capture
+//
+using ChessMove = uint16_t;
+
+enum ChessMoveFlag : int
+{
+    kMoveQuiet = 0,
+    kMoveDoublePush = 1,
+    kMoveCastleKing = 2,
+    kMoveCastleQueen = 3,
+    kMoveCapture = 4,
+    kMoveEnPassant = 5,
+    kMovePromotion = 8,
+    kMovePromotionCapture = 12
+};
+
+constexpr ChessMove CHESS_NULL_MOVE = 0;       // a1 to a1, never a legal move
+constexpr int CHESS_MAX_MOVES = 256;           // no position has more than 218 legal moves
+
+constexpr ChessMove MakeChessMove(int from, int to, int flags) { return (ChessMove)(from | (to << 6) | (flags << 12)); }
+constexpr int ChessMoveFrom(ChessMove move) { return move & 63; }
+constexpr int ChessMoveTo(ChessMove move) { return (move >> 6) & 63; }
+constexpr int ChessMoveFlags(ChessMove move) { return move >> 12; }
+constexpr bool ChessMoveIsCapture(ChessMove move) { return (ChessMoveFlags(move) & kMoveCapture) != 0; }
+constexpr bool ChessMoveIsPromotion(ChessMove move) { return (ChessMoveFlags(move) & kMovePromotion) != 0; }
+// for a promotion, the piece type the pawn becomes
+constexpr int ChessPromotionType(ChessMove move) { return kKnight + (ChessMoveFlags(move) & 3); }
+
+struct ChessMoveList
+{
+    ChessMove   moves[CHESS_MAX_MOVES];
+    int         count = 0;
+
+    void        add(ChessMove move) { moves[count++] = move; }
+    const ChessMove *begin() const { return moves; }
+    const ChessMove *end() const { return moves + count; }
+};
+
+// how the game stands for the side to move
+enum ChessStatus
+{
+    kChessPlaying,
+    kChessCheckmate,        // the side to move has lost
+    kChessStalemate,
+    kChessFiftyMoves,       // 100 plies without a capture or a pawn move
+    kChessRepetition,       // the third time the same position arises
+    kChessInsufficientMaterial
+};
+
+// attacks from a square, for any occupancy; the tables are built on first use
+uint64_t        ChessKnightAttacks(int square);
+uint64_t        ChessKingAttacks(int square);
+uint64_t        ChessPawnAttacks(int color, int square);
+uint64_t        ChessBishopAttacks(int square, uint64_t occupied);
+uint64_t        ChessRookAttacks(int square, uint64_t occupied);
+
+class ChessBoard
+{
+public:
+    static constexpr const char *START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // the starting position
+    ChessBoard();
+
+    // false, with the board unchanged, if fen isn't a position this board can hold
+    bool            setFen(std::string_view fen);
+    std::string     fen() const;
+
+    int             pieceAt(int square) const { return _mailbox[square]; }
+    uint64_t        pieces(int piece) const { return _pieces[piece]; }
+    uint64_t        pieces(int color, int type) const { return _pieces[ChessPiece(color, type)]; }
+    uint64_t        colorPieces(int color) const { return _colors[color]; }
+    uint64_t        occupied() const { return _colors[kWhite] | _colors[kBlack]; }
+    int             sideToMove() const { return _side; }
+    int             castling() const { return _castling; }
+    int             enPassantSquare() const { return _enPassant; }     // -1 if none
+    int             halfmoveClock() const { return _halfmoveClock; }
+    int             fullmoveNumber() const { return _fullmove; }
+    int             kingSquare(int color) const;
+    // Zobrist key of the position: pieces, side, castling rights and en passant file
+    uint64_t        key() const { return _key; }
+
+    // moves by the side to move that may leave its own king in check; makeMove() rejects those
+    void            generateMoves(ChessMoveList &list) const;
+    // captures and promotions only, for the quiescence search
+    void            generateCaptures(ChessMoveList &list) const;
+    // the fully legal moves
+    void            legalMoves(ChessMoveList &list);
+    // the legal move written in UCI form ("e2e4", "e7e8q"), CHESS_NULL_MOVE if there is none
+    ChessMove       parseMove(std::string_view text);
+
+    // plays a move from generateMoves(); false, with the move already taken back, if it left
+    // the mover's king in check
+    bool            makeMove(ChessMove move);
+    void            unmakeMove();
+    size_t          plies() const { return _history.size(); }
+    ChessMove       lastMove() const { return _history.empty() ? CHESS_NULL_MOVE : _history.back().move; }
+
+    bool            attacked(int square, int byColor) const;
+    bool            inCheck() const { return attacked(kingSquare(_side), _side ^ 1); }
+    // the position occurred before since the last capture or pawn move: count 1 for the search,
+    // which scores the first repetition as a draw, 2 for the threefold rule
+    bool            repeated(int count = 1) const;
+    bool            insufficientMaterial() const;
+    ChessStatus     status();
+
+private:
+    struct Undo
+    {
+        ChessMove   move;
+        uint8_t     captured;
+        uint8_t     castling;
+        int8_t      enPassant;
+        uint16_t    halfmoveClock;
+        uint64_t    key;            // before the move
+    };
+
+    void            clear();
+    void            generate(ChessMoveList &list, bool quietMoves) const;
+    void            put(int piece, int square);
+    void            remove(int square);
+    void            relocate(int from, int to);
+
+    uint64_t        _pieces[12];
+    uint64_t        _colors[2];
+    uint8_t         _mailbox[64];
+    int             _side;
+    int             _castling;
+    int             _enPassant;
+    int             _halfmoveClock;
+    int             _fullmove;
+    uint64_t        _key;
+    std::vector<Undo> _history;
+};
+
+// UCI notation: from and to squares, then the promotion piece, e.g. "e7e8q"
+std::string     ChessMoveText(ChessMove move);
+// "e4" for square 28
+std::string     ChessSquareName(int square);
+
+// leaf count of the legal move tree, depth plies deep
+uint64_t        ChessPerft(ChessBoard &board, int depth);
@@ -0,0 +1,526 @@
+#include "ChessSearch.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+// how often (in nodes) the search looks at the clock
+constexpr uint64_t CHESS_CLOCK_INTERVAL = 1024;
+
+//
+// move-ordering keys, highest tried first: the table's move, captures and promotions by the
+// piece taken and then the piece taking it, the two killers, then history
+// history stays below the killers by halving every entry once one would pass HISTORY_LIMIT
+//
+constexpr int ORDER_TABLE_MOVE = 1 << 30;
+constexpr int ORDER_CAPTURE = 1 << 29;
+constexpr int ORDER_KILLER = 1 << 28;       // the second killer scores one less
+constexpr int HISTORY_LIMIT = 1 << 27;
+
+// centipawns, by ChessPieceType; the king's is never traded, so it only sizes the MVV-LVA keys
+static const int PIECE_VALUES[6] = { 100, 320, 330, 500, 900, 2000 };
+
+//
+// piece-square tables for white, a8 first as the board is printed, so white's square s reads
+// entry s ^ 56 and black's square s entry s; the king has one for the middlegame and one for
+// the endgame, blended by the material left
+//
+static const int8_t PAWN_TABLE[64] = {
+      0,  0,  0,  0,  0,  0,  0,  0,
+     50, 50, 50, 50, 50, 50, 50, 50,
+     10, 10, 20, 30, 30, 20, 10, 10,
+      5,  5, 10, 25, 25, 10,  5,  5,
+      0,  0,  0, 20, 20,  0,  0,  0,
+      5, -5,-10,  0,  0,-10, -5,  5,
+      5, 10, 10,-20,-20, 10, 10,  5,
+      0,  0,  0,  0,  0,  0,  0,  0,
+};
+static const int8_t KNIGHT_TABLE[64] = {
+    -50,-40,-30,-30,-30,-30,-40,-50,
+    -40,-20,  0,  0,  0,  0,-20,-40,
+    -30,  0, 10, 15, 15, 10,  0,-30,
+    -30,  5, 15, 20, 20, 15,  5,-30,
+    -30,  0, 15, 20, 20, 15,  0,-30,
+    -30,  5, 10, 15, 15, 10,  5,-30,
+    -40,-20,  0,  5,  5,  0,-20,-40,
+    -50,-40,-30,-30,-30,-30,-40,-50,
+};
+static const int8_t BISHOP_TABLE[64] = {
+    -20,-10,-10,-10,-10,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5, 10, 10,  5,  0,-10,
+    -10,  5,  5, 10, 10,  5,  5,-10,
+    -10,  0, 10, 10, 10, 10,  0,-10,
+    -10, 10, 10, 10, 10, 10, 10,-10,
+    -10,  5,  0,  0,  0,  0,  5,-10,
+    -20,-10,-10,-10,-10,-10,-10,-20,
+};
+static const int8_t ROOK_TABLE[64] = {
+      0,  0,  0,  0,  0,  0,  0,  0,
+      5, 10, 10, 10, 10, 10, 10,  5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+     -5,  0,  0,  0,  0,  0,  0, -5,
+      0,  0,  0,  5,  5,  0,  0,  0,
+};
+static const int8_t QUEEN_TABLE[64] = {
+    -20,-10,-10, -5, -5,-10,-10,-20,
+    -10,  0,  0,  0,  0,  0,  0,-10,
+    -10,  0,  5,  5,  5,  5,  0,-10,
+     -5,  0,  5,  5,  5,  5,  0, -5,
+      0,  0,  5,  5,  5,  5,  0, -5,
+    -10,  5,  5,  5,  5,  5,  0,-10,
+    -10,  0,  5,  0,  0,  0,  0,-10,
+    -20,-10,-10, -5, -5,-10,-10,-20,
+};
+static const int8_t KING_MIDDLEGAME_TABLE[64] = {
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -30,-40,-40,-50,-50,-40,-40,-30,
+    -20,-30,-30,-40,-40,-30,-30,-20,
+    -10,-20,-20,-20,-20,-20,-20,-10,
+     20, 20,  0,  0,  0,  0, 20, 20,
+     20, 30, 10,  0,  0, 10, 30, 20,
+};
+static const int8_t KING_ENDGAME_TABLE[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50,
+};
+static const int8_t *const PIECE_TABLES[5] = { PAWN_TABLE, KNIGHT_TABLE, BISHOP_TABLE, ROOK_TABLE, QUEEN_TABLE };
+
+// the game phase from the pieces left: 24 with every minor and major piece, 0 with none
+static const int PHASE_WEIGHTS[6] = { 0, 1, 1, 2, 4, 0 };
+constexpr int PHASE_FULL = 24;
+
+int ChessEvaluate(const ChessBoard &board)
+{
+    int score[2] = { 0, 0 };
+    int phase = 0;
+    for (int color = kWhite; color <= kBlack; ++color) {
+        const int flip = (color == kWhite) ? 56 : 0;
+        for (int type = kPawn; type <= kQueen; ++type) {
+            for (uint64_t bits = board.pieces(color, type); bits; bits &= bits - 1) {
+                score[color] += PIECE_VALUES[type] + PIECE_TABLES[type][std::countr_zero(bits) ^ flip];
+                phase += PHASE_WEIGHTS[type];
+            }
+        }
+        // two bishops cover both colours of square
+        if (std::popcount(board.pieces(color, kBishop)) >= 2) score[color] += 30;
+    }
+    phase = std::min(phase, PHASE_FULL);
+    for (int color = kWhite; color <= kBlack; ++color) {
+        const int square = board.kingSquare(color) ^ ((color == kWhite) ? 56 : 0);
+        score[color] += (KING_MIDDLEGAME_TABLE[square] * phase + KING_ENDGAME_TABLE[square] * (PHASE_FULL - phase)) / PHASE_FULL;
+    }
+    const int us = board.sideToMove();
+    return score[us] - score[us ^ 1];
+}
+
+//
+// ChessTranspositionTable
+//
+
+ChessTranspositionTable::ChessTranspositionTable(size_t bucketCount)
+{
+    size_t size = 1;
+    while (size < bucketCount) {
+        size <<= 1;
+    }
+    _buckets.resize(size);
+    _mask = size - 1;
+    _age = 0;
+}
+
+void ChessTranspositionTable::clear()
+{
+    for (ChessTTBucket &bucket : _buckets) {
+        bucket = ChessTTBucket();
+    }
+    _age = 0;
+    _hits.reset();
+    _misses.reset();
+    _stores.reset();
+}
+
+//
+// mate scores count plies from the root; in the table they count from the node that stored
+// them, so the same position reached at another ply or in a later search reads correctly
+//
+static int ValueToTable(int value, int ply)
+{
+    if (value >= CHESS_MATE_THRESHOLD) return value + ply;
+    if (value <= -CHESS_MATE_THRESHOLD) return value - ply;
+    return value;
+}
+
+static int ValueFromTable(int value, int ply)
+{
+    if (value >= CHESS_MATE_THRESHOLD) return value - ply;
+    if (value <= -CHESS_MATE_THRESHOLD) return value + ply;
+    return value;
+}
+
+class ChessSearcher
+{
+public:
+    ChessSearcher(const ChessBoard &board, ChessTranspositionTable &table) :
+        _board(board), _table(table), _nodes(0), _deadline(0), _stop(nullptr), _aborted(false),
+        _history(2 * 64 * 64, 0)
+    {
+        for (auto &killers : _killers) killers[0] = killers[1] = CHESS_NULL_MOVE;
+    }
+
+    ChessSearchResult run(const ChessSearchOptions &options)
+    {
+        ChessSearchResult result;
+        _start = std::chrono::steady_clock::now();
+        _deadline = options.timeBudget;
+        _stop = options.stop;
+        _table.newSearch();
+
+        ChessMoveList legal;
+        _board.legalMoves(legal);
+        if (legal.count == 0) {
+            result.value = _board.inCheck() ? -CHESS_SCORE_MATE : 0;
+            return result;
+        }
+        // something to play even if the first iteration is stopped before it finishes
+        result.move = legal.moves[0];
+
+        const int maxDepth = std::clamp(options.maxDepth, 1, CHESS_MAX_PLY - 1);
+        for (int depth = 1; depth <= maxDepth; ++depth) {
+            PROFILE_SCOPE("ChessSearch iteration");
+            const uint64_t startNodes = _nodes;
+            const int value = search(depth, -CHESS_SCORE_INF, CHESS_SCORE_INF, 0);
+            if (_aborted) {
+                result.timedOut = true;
+                break;
+            }
+            result.move = _pv[0][0];
+            result.value = value;
+            result.depth = depth;
+            result.pv.assign(_pv[0], _pv[0] + _pvLength[0]);
+
+            ChessIterationStats stats;
+            stats.depth = depth;
+            stats.move = result.move;
+            stats.value = value;
+            stats.nodes = _nodes - startNodes;
+            stats.elapsed = elapsed();
+            result.iterations.push_back(stats);
+
+            // a forced mate was found, or the only legal move is known: deeper won't change it
+            if (std::abs(value) >= CHESS_MATE_THRESHOLD || legal.count == 1) {
+                break;
+            }
+        }
+        result.nodes = _nodes;
+        result.counters = _counters.report();
+        result.elapsed = elapsed();
+        return result;
+    }
+
+private:
+    struct Counters
+    {
+        StatCounter tableProbes;
+        StatCounter tableHits;
+        StatCounter tableCutoffs;
+        StatCounter cutoffs;
+        StatCounter firstMoveCutoffs;
+        StatCounter quiescenceNodes;
+
+        ChessSearchCounters report() const
+        {
+            ChessSearchCounters counters;
+            counters.tableProbes = tableProbes.value();
+            counters.tableHits = tableHits.value();
+            counters.tableCutoffs = tableCutoffs.value();
+            counters.cutoffs = cutoffs.value();
+            counters.firstMoveCutoffs = firstMoveCutoffs.value();
+            counters.quiescenceNodes = quiescenceNodes.value();
+            return counters;
+        }
+    };
+
+    int64_t elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    // true once the time budget is spent or a stop was requested;
+    // only reads the clock and the stop flag every CHESS_CLOCK_INTERVAL nodes
+    bool outOfTime()
+    {
+        if (!_aborted && (_nodes % CHESS_CLOCK_INTERVAL) == 0) {
+            if ((_deadline > 0 && elapsed() >= _deadline) || (_stop && _stop->load(std::memory_order_relaxed))) {
+                _aborted = true;
+            }
+        }
+        return _aborted;
+    }
+
+    int &history(ChessMove move)
+    {
+        return _history[(size_t)_board.sideToMove() * 4096 + ChessMoveFrom(move) * 64 + ChessMoveTo(move)];
+    }
+
+    // ordering key of every move in list, see ORDER_TABLE_MOVE
+    void orderKeys(const ChessMoveList &list, int *keys, ChessMove tableMove, int ply)
+    {
+        for (int i = 0; i < list.count; ++i) {
+            const ChessMove move = list.moves[i];
+            int key;
+            if (move == tableMove) {
+                key = ORDER_TABLE_MOVE;
+            } else if (ChessMoveIsCapture(move) || ChessMoveIsPromotion(move)) {
+                const int victim = ChessMoveIsCapture(move) ?
+                    ((ChessMoveFlags(move) == kMoveEnPassant) ? kPawn : ChessPieceTypeOf(_board.pieceAt(ChessMoveTo(move)))) : kPawn;
+                const int attacker = ChessPieceTypeOf(_board.pieceAt(ChessMoveFrom(move)));
+                key = ORDER_CAPTURE + PIECE_VALUES[victim] * 16 - PIECE_VALUES[attacker] / 16;
+                if (ChessMoveIsPromotion(move)) key += PIECE_VALUES[ChessPromotionType(move)];
+            } else if (move == _killers[ply][0]) {
+                key = ORDER_KILLER;
+            } else if (move == _killers[ply][1]) {
+                key = ORDER_KILLER - 1;
+            } else {
+                key = history(move);
+            }
+            keys[i] = key;
+        }
+    }
+
+    // selection sort as we go: a cutoff usually comes before the tail needs ordering
+    static void pickNext(ChessMoveList &list, int *keys, int i)
+    {
+        int pick = i;
+        for (int j = i + 1; j < list.count; ++j) {
+            if (keys[j] > keys[pick]) pick = j;
+        }
+        std::swap(list.moves[i], list.moves[pick]);
+        std::swap(keys[i], keys[pick]);
+    }
+
+    // a quiet move that caused a cutoff becomes a killer at this ply and earns history
+    void recordCutoff(ChessMove move, int depth, int ply)
+    {
+        if (ChessMoveIsCapture(move) || ChessMoveIsPromotion(move)) {
+            return;
+        }
+        if (_killers[ply][0] != move) {
+            _killers[ply][1] = _killers[ply][0];
+            _killers[ply][0] = move;
+        }
+        int &entry = history(move);
+        entry += depth * depth;
+        if (entry >= HISTORY_LIMIT) {
+            for (int &h : _history) h /= 2;
+        }
+    }
+
+    // a move that raised alpha, followed by the line it was searched with
+    void setPv(int ply, ChessMove move)
+    {
+        _pv[ply][ply] = move;
+        for (int i = ply + 1; i < _pvLength[ply + 1]; ++i) _pv[ply][i] = _pv[ply + 1][i];
+        _pvLength[ply] = std::max(_pvLength[ply + 1], ply + 1);
+    }
+
+    int search(int depth, int alpha, int beta, int ply)
+    {
+        _nodes++;
+        _pvLength[ply] = ply;
+        if (outOfTime()) {
+            // the whole iteration is thrown away, so any value will do
+            return 0;
+        }
+        if (ply > 0 && (_board.halfmoveClock() >= 100 || _board.repeated() || _board.insufficientMaterial())) {
+            return 0;
+        }
+        const bool inCheck = _board.inCheck();
+        if (inCheck) {
+            depth++;        // a check is searched a ply deeper, so a mate behind it isn't cut off at the horizon
+        }
+        if (depth <= 0 || ply >= CHESS_MAX_PLY - 1) {
+            return quiescence(alpha, beta, ply);
+        }
+
+        const bool pvNode = beta - alpha > 1;
+        ChessMove tableMove = CHESS_NULL_MOVE;
+        ChessTTEntry entry;
+        ++_counters.tableProbes;
+        if (_table.probe(_board.key(), entry)) {
+            ++_counters.tableHits;
+            tableMove = entry.move;
+            const int value = ValueFromTable(entry.value, ply);
+            if (!pvNode && ply > 0 && entry.depth >= depth &&
+                (entry.bound == kBoundExact || (entry.bound == kBoundLower && value >= beta) ||
+                 (entry.bound == kBoundUpper && value <= alpha))) {
+                ++_counters.tableCutoffs;
+                return value;
+            }
+        }
+
+        ChessMoveList list;
+        _board.generateMoves(list);
+        int keys[CHESS_MAX_MOVES];
+        orderKeys(list, keys, tableMove, ply);
+
+        const int originalAlpha = alpha;
+        int best = -CHESS_SCORE_INF;
+        ChessMove bestMove = CHESS_NULL_MOVE;
+        int legal = 0;
+        for (int i = 0; i < list.count; ++i) {
+            pickNext(list, keys, i);
+            const ChessMove move = list.moves[i];
+            if (!_board.makeMove(move)) {
+                continue;
+            }
+            legal++;
+            int val;
+            if (legal == 1) {
+                val = -search(depth - 1, -beta, -alpha, ply + 1);
+            } else {
+                // late quiet moves are first searched a ply shallower; one that still beats
+                // alpha earns its full depth, then its full window
+                const bool quiet = !ChessMoveIsCapture(move) && !ChessMoveIsPromotion(move) && keys[i] < ORDER_KILLER - 1;
+                const int reduction = (depth >= 3 && legal > 3 && quiet && !inCheck && !_board.inCheck()) ? 1 : 0;
+                val = -search(depth - 1 - reduction, -alpha - 1, -alpha, ply + 1);
+                if (val > alpha && reduction) {
+                    val = -search(depth - 1, -alpha - 1, -alpha, ply + 1);
+                }
+                if (val > alpha && val < beta) {
+                    val = -search(depth - 1, -beta, -alpha, ply + 1);
+                }
+            }
+            _board.unmakeMove();
+            if (_aborted) {
+                return 0;
+            }
+            if (val > best) {
+                best = val;
+                bestMove = move;
+            }
+            if (val > alpha) {
+                alpha = val;
+                setPv(ply, move);
+            }
+            if (alpha >= beta) {
+                ++_counters.cutoffs;
+                if (legal == 1) ++_counters.firstMoveCutoffs;
+                recordCutoff(move, depth, ply);
+                break;
+            }
+        }
+        if (legal == 0) {
+            return inCheck ? -(CHESS_SCORE_MATE - ply) : 0;
+        }
+
+        const TTBound bound = (best >= beta) ? kBoundLower : (best > originalAlpha) ? kBoundExact : kBoundUpper;
+        _table.store(_board.key(), ValueToTable(best, ply), bound, bestMove, depth);
+        return best;
+    }
+
+    //
+    // below the depth limit only captures and promotions are searched, until the position is
+    // quiet, so the evaluation never sees a piece hanging mid-exchange; the side to move may
+    // stand pat on the static score instead of capturing, except in check, where every
+    // evasion is searched
+    //
+    int quiescence(int alpha, int beta, int ply)
+    {
+        _nodes++;
+        ++_counters.quiescenceNodes;
+        _pvLength[ply] = ply;
+        if (outOfTime()) {
+            return 0;
+        }
+        const bool inCheck = _board.inCheck();
+        if (ply >= CHESS_MAX_PLY - 1) {
+            return inCheck ? 0 : ChessEvaluate(_board);
+        }
+        int best = -CHESS_SCORE_INF;
+        if (!inCheck) {
+            best = ChessEvaluate(_board);
+            if (best >= beta) {
+                return best;
+            }
+            alpha = std::max(alpha, best);
+        }
+
+        ChessMoveList list;
+        if (inCheck) _board.generateMoves(list);
+        else _board.generateCaptures(list);
+        int keys[CHESS_MAX_MOVES];
+        orderKeys(list, keys, CHESS_NULL_MOVE, ply);
+
+        int legal = 0;
+        for (int i = 0; i < list.count; ++i) {
+            pickNext(list, keys, i);
+            const ChessMove move = list.moves[i];
+            if (!_board.makeMove(move)) {
+                continue;
+            }
+            legal++;
+            const int val = -quiescence(-beta, -alpha, ply + 1);
+            _board.unmakeMove();
+            if (_aborted) {
+                return 0;
+            }
+            if (val > best) {
+                best = val;
+            }
+            if (val > alpha) {
+                alpha = val;
+                setPv(ply, move);
+            }
+            if (alpha >= beta) {
+                break;
+            }
+        }
+        if (inCheck && legal == 0) {
+            return -(CHESS_SCORE_MATE - ply);
+        }
+        return best;
+    }
+
+    ChessBoard          _board;
+    ChessTranspositionTable &_table;
+    uint64_t            _nodes;
+    std::chrono::steady_clock::time_point _start;
+    int64_t             _deadline;          // microseconds after _start, 0 = none
+    const std::atomic<bool> *_stop;
+    bool                _aborted;
+    Counters            _counters;
+    // triangular principal variation: _pv[ply] holds the best line from the node in progress
+    // at that ply, in entries ply to _pvLength[ply] - 1
+    ChessMove           _pv[CHESS_MAX_PLY][CHESS_MAX_PLY];
+    int                 _pvLength[CHESS_MAX_PLY];
+    ChessMove           _killers[CHESS_MAX_PLY][2];
+    std::vector<int>    _history;           // [side * 4096 + from * 64 + to], depth^2 per cutoff
+};
+
+ChessSearchResult ChessSearchBestMove(const ChessBoard &board, const ChessSearchOptions &options)
+{
+    PROFILE_SCOPE("ChessSearchBestMove");
+    std::unique_ptr<ChessTranspositionTable> ownTable;
+    ChessTranspositionTable *table = options.table;
+    if (!table) {
+        ownTable = std::make_unique<ChessTranspositionTable>();
+        table = ownTable.get();
+    }
+    // the principal variation arrays make the searcher too big for a worker thread's stack
+    auto searcher = std::make_unique<ChessSearcher>(board, *table);
+    return searcher->run(options);
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ChessBoard.h"
+#include "SearchStats.h"
+#include "TranspositionTable.h"
+
+//
+// search for the chess game: iterative deepening principal variation search with a
+// transposition table, a quiescence search of captures below the depth limit, and moves
+// ordered by the table move, captures by victim and attacker, killers and history
+// the same shape as the m,n,k search (engine/MnkSearch.h): a depth limit, a microsecond time
+// budget and a stop flag, an iteration that runs out of time is abandoned and the move from
+// the last completed one returned
+// scores are centipawns from the side to move's point of view; mate in n plies scores
+// CHESS_SCORE_MATE - n
+//
+
+constexpr int CHESS_SCORE_MATE = 30000;
+constexpr int CHESS_SCORE_INF = 32000;
+constexpr int CHESS_MAX_PLY = 128;
+constexpr int CHESS_MATE_THRESHOLD = CHESS_SCORE_MATE - CHESS_MAX_PLY;     // any score beyond this is a forced mate
+
+//
+// transposition table for the chess search, laid out like TranspositionTable: entries in
+// 64-byte buckets so a probe touches one cache line, the bucket picked by the low bits of the
+// Zobrist key and the entry checked against its high 32 bits
+// values are stored as the search sees them at the node, with mate scores made relative to the
+// node (see ChessSearch.cpp), so a table kept across moves stays valid
+// the hit, miss and store counts read 0 in a build without TICTACTOE_SEARCH_STATS
+//
+struct ChessTTEntry
+{
+    uint32_t    key = 0;
+    int16_t     value = 0;
+    ChessMove   move = CHESS_NULL_MOVE;
+    uint8_t     depth = 0;
+    TTBound     bound = kBoundNone;
+    uint8_t     age = 0;            // the search that stored it, older entries are replaced first
+};
+
+constexpr int CHESS_TT_BUCKET_ENTRIES = 5;
+
+struct alignas(64) ChessTTBucket
+{
+    ChessTTEntry    entries[CHESS_TT_BUCKET_ENTRIES];
+};
+
+static_assert(sizeof(ChessTTBucket) == 64, "a chess TT bucket should fill one cache line");
+
+class ChessTranspositionTable
+{
+public:
+    // bucketCount is rounded up to a power of two; the default is 4 MB
+    explicit ChessTranspositionTable(size_t bucketCount = 1 << 16);
+
+    // true and fills entry if key is stored, counts a hit or a miss
+    bool        probe(uint64_t key, ChessTTEntry &entry)
+    {
+        const ChessTTBucket &bucket = _buckets[index(key)];
+        for (const ChessTTEntry &candidate : bucket.entries) {
+            if (candidate.bound != kBoundNone && candidate.key == (uint32_t)(key >> 32)) {
+                entry = candidate;
+                ++_hits;
+                return true;
+            }
+        }
+        ++_misses;
+        return false;
+    }
+
+    // overwrites the same key, else an empty slot, else the shallowest entry of an earlier
+    // search, else the shallowest entry; a store without a move keeps the one already there
+    void        store(uint64_t key, int value, TTBound bound, ChessMove move, int depth)
+    {
+        ChessTTBucket &bucket = _buckets[index(key)];
+        const uint32_t check = (uint32_t)(key >> 32);
+        ChessTTEntry *slot = &bucket.entries[0];
+        for (ChessTTEntry &candidate : bucket.entries) {
+            if (candidate.bound == kBoundNone || candidate.key == check) {
+                slot = &candidate;
+                break;
+            }
+            if (replaceScore(candidate) < replaceScore(*slot)) {
+                slot = &candidate;
+            }
+        }
+        if (move == CHESS_NULL_MOVE && slot->key == check && slot->bound != kBoundNone) {
+            move = slot->move;
+        }
+        slot->key = check;
+        slot->value = (int16_t)value;
+        slot->move = move;
+        slot->depth = (uint8_t)depth;
+        slot->bound = bound;
+        slot->age = _age;
+        ++_stores;
+    }
+
+    // a new search: what the earlier ones stored is kept, but replaced before its own entries
+    void        newSearch() { _age++; }
+
+    // empties every bucket and zeroes the counters
+    void        clear();
+
+    uint64_t    hits() const { return _hits.value(); }
+    uint64_t    misses() const { return _misses.value(); }
+    uint64_t    stores() const { return _stores.value(); }
+    size_t      bucketCount() const { return _buckets.size(); }
+    size_t      sizeInBytes() const { return _buckets.size() * sizeof(ChessTTBucket); }
+
+private:
+    size_t      index(uint64_t key) const { return (size_t)key & _mask; }
+    int         replaceScore(const ChessTTEntry &entry) const { return entry.depth + ((entry.age == _age) ? 256 : 0); }
+
+    std::vector<ChessTTBucket>  _buckets;
+    size_t                      _mask;
+    uint8_t                     _age;
+    StatCounter                 _hits;
+    StatCounter                 _misses;
+    StatCounter                 _stores;
+};
+
+struct ChessSearchOptions
+{
+    int         maxDepth = 64;              // plies of the main search, captures are searched past it
+    int64_t     timeBudget = 0;             // wall-clock microseconds, 0 = no limit
+    // set by another thread to end the search early, it then behaves as if out of time
+    const std::atomic<bool> *stop = nullptr;
+    // kept across moves by the caller, searched with a table of its own when nullptr; only
+    // one search may use a table at a time
+    ChessTranspositionTable *table = nullptr;
+};
+
+// one completed iteration of the iterative deepening
+struct ChessIterationStats
+{
+    int         depth = 0;
+    ChessMove   move = CHESS_NULL_MOVE;
+    int         value = 0;
+    uint64_t    nodes = 0;          // nodes in this iteration only, quiescence nodes included
+    int64_t     elapsed = 0;        // microseconds since the search started
+};
+
+// counted through StatCounter (engine/SearchStats.h), every field is 0 without TICTACTOE_SEARCH_STATS
+struct ChessSearchCounters
+{
+    uint64_t    tableProbes = 0;
+    uint64_t    tableHits = 0;
+    uint64_t    tableCutoffs = 0;       // nodes answered by a table bound without searching
+    uint64_t    cutoffs = 0;            // beta cutoffs in the main search
+    uint64_t    firstMoveCutoffs = 0;   // ... by the first move tried, a measure of the ordering
+    uint64_t    quiescenceNodes = 0;
+};
+
+struct ChessSearchResult
+{
+    ChessMove   move = CHESS_NULL_MOVE;     // CHESS_NULL_MOVE if there is no legal move
+    int         value = 0;
+    int         depth = 0;          // depth of the last completed iteration
+    uint64_t    nodes = 0;          // all nodes, including an abandoned last iteration
+    int64_t     elapsed = 0;        // microseconds
+    bool        timedOut = false;   // the time budget stopped an iteration part way
+    std::vector<ChessIterationStats> iterations;
+    // expected line of play from move on, from the last completed iteration
+    std::vector<ChessMove> pv;
+    ChessSearchCounters counters;
+};
+
+// static score of board for its side to move: material and piece-square tables, with the
+// king's square weighed between its middlegame and endgame tables by the material left
+int             ChessEvaluate(const ChessBoard &board);
+
+ChessSearchResult ChessSearchBestMove(const ChessBoard &board, const ChessSearchOptions &options = ChessSearchOptions());
@@ -0,0 +1,279 @@
+// off_t is 64 bits even on 32-bit Unix builds, for fseeko/ftello
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "GameRecord.h"
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GAME_RECORD_MMAP 1
+#endif
+
+static const char RECORD_MAGIC[4] = { 'T', 'T', 'T', 'R' };
+static const char INDEX_MAGIC[4] = { 'T', 'T', 'T', 'I' };
+constexpr size_t FILE_HEADER_SIZE = 8;
+constexpr size_t RECORD_FIXED_SIZE = 16;    // everything in a record but its length and moves
+
+// the files are little-endian whatever the machine
+static void PutU16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void PutU32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+static void PutU64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint16_t GetU16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const uint8_t *p) { uint32_t v = 0; for (int i = 3; i >= 0; --i) v = (v << 8) | p[i]; return v; }
+static uint64_t GetU64(const uint8_t *p) { uint64_t v = 0; for (int i = 7; i >= 0; --i) v = (v << 8) | p[i]; return v; }
+
+static void FileHeader(const char magic[4], uint8_t header[FILE_HEADER_SIZE])
+{
+    memcpy(header, magic, 4);
+    PutU16(header + 4, GAME_RECORD_VERSION);
+    PutU16(header + 6, (uint16_t)FILE_HEADER_SIZE);
+}
+
+static bool CheckHeader(const char magic[4], const uint8_t header[FILE_HEADER_SIZE])
+{
+    return memcmp(header, magic, 4) == 0 && GetU16(header + 4) == GAME_RECORD_VERSION &&
+           GetU16(header + 6) == FILE_HEADER_SIZE;
+}
+
+bool RecordFileSeek(FILE *file, uint64_t offset, int origin)
+{
+#ifdef _WIN32
+    return _fseeki64(file, (__int64)offset, origin) == 0;
+#else
+    return fseeko(file, (off_t)offset, origin) == 0;
+#endif
+}
+
+uint64_t RecordFileTell(FILE *file)
+{
+#ifdef _WIN32
+    return (uint64_t)_ftelli64(file);
+#else
+    return (uint64_t)ftello(file);
+#endif
+}
+
+std::string GameRecord::stateAfter(size_t plies) const
+{
+    std::string state(cellCount(), '0');
+    for (size_t ply = 0; ply < plies && ply < moves.size(); ++ply) {
+        const int cell = moves[ply];
+        if (cell >= 0 && cell < cellCount()) state[cell] = (ply % 2 == 0) ? '1' : '2';
+    }
+    return state;
+}
+
+// ---------------------------------------------------------------------------------------
+
+// opens path for appending and returns its size, writing a header into an empty file
+static FILE *OpenForAppend(const std::string &path, const char magic[4], uint64_t &size)
+{
+    FILE *file = fopen(path.c_str(), "ab");
+    if (!file) {
+        return nullptr;
+    }
+    RecordFileSeek(file, 0, SEEK_END);
+    size = RecordFileTell(file);
+    if (size == 0) {
+        uint8_t header[FILE_HEADER_SIZE];
+        FileHeader(magic, header);
+        if (fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+            fclose(file);
+            return nullptr;
+        }
+        size = FILE_HEADER_SIZE;
+    }
+    return file;
+}
+
+bool GameRecordWriter::open(const std::string &path)
+{
+    close();
+    uint64_t indexSize = 0;
+    _records = OpenForAppend(path, RECORD_MAGIC, _offset);
+    _index = _records ? OpenForAppend(path + ".idx", INDEX_MAGIC, indexSize) : nullptr;
+    if (!_index) {
+        close();
+        return false;
+    }
+    _count = (indexSize - FILE_HEADER_SIZE) / 8;
+    return true;
+}
+
+bool GameRecordWriter::write(const GameRecord &record)
+{
+    if (!isOpen()) {
+        return false;
+    }
+    const size_t moveBytes = (record.cellCount() <= 255) ? 1 : 2;
+    const size_t length = RECORD_FIXED_SIZE + record.moves.size() * moveBytes;
+    _buffer.resize(4 + length);
+    uint8_t *p = _buffer.data();
+    PutU32(p, (uint32_t)length);
+    p[4] = (uint8_t)record.width;
+    p[5] = (uint8_t)record.height;
+    p[6] = (uint8_t)record.winLength;
+    p[7] = (uint8_t)record.winner;
+    PutU16(p + 8, (uint16_t)record.moves.size());
+    PutU16(p + 10, 0);
+    PutU64(p + 12, record.gameNumber);
+    uint8_t *moves = p + 4 + RECORD_FIXED_SIZE;
+    for (size_t i = 0; i < record.moves.size(); ++i) {
+        if (moveBytes == 1) moves[i] = (uint8_t)record.moves[i];
+        else PutU16(moves + 2 * i, (uint16_t)record.moves[i]);
+    }
+
+    uint8_t entry[8];
+    PutU64(entry, _offset);
+    if (fwrite(_buffer.data(), 1, _buffer.size(), _records) != _buffer.size() ||
+        fwrite(entry, 1, sizeof(entry), _index) != sizeof(entry)) {
+        return false;
+    }
+    _offset += _buffer.size();
+    _count++;
+    return true;
+}
+
+void GameRecordWriter::close()
+{
+    if (_records) fclose(_records);
+    if (_index) fclose(_index);
+    _records = nullptr;
+    _index = nullptr;
+    _offset = 0;
+    _count = 0;
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool GameRecordReader::open(const std::string &path, bool mapped)
+{
+    close();
+#ifdef GAME_RECORD_MMAP
+    if (mapped) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+                _map = static_cast<const uint8_t *>(map);
+                _mapSize = (size_t)info.st_size;
+            }
+        }
+        if (fd >= 0) ::close(fd);
+    }
+#endif
+    if (!_map) {
+        _records = fopen(path.c_str(), "rb");
+        if (!_records) {
+            return false;
+        }
+    }
+    uint8_t header[FILE_HEADER_SIZE];
+    if (!read(header, sizeof(header)) || !CheckHeader(RECORD_MAGIC, header)) {
+        close();
+        return false;
+    }
+
+    _index = fopen((path + ".idx").c_str(), "rb");
+    if (_index) {
+        uint8_t indexHeader[FILE_HEADER_SIZE];
+        if (fread(indexHeader, 1, sizeof(indexHeader), _index) == sizeof(indexHeader) && CheckHeader(INDEX_MAGIC, indexHeader)) {
+            RecordFileSeek(_index, 0, SEEK_END);
+            _indexCount = (RecordFileTell(_index) - FILE_HEADER_SIZE) / 8;
+        } else {
+            fclose(_index);
+            _index = nullptr;
+        }
+    }
+    return true;
+}
+
+void GameRecordReader::close()
+{
+#ifdef GAME_RECORD_MMAP
+    if (_map) munmap(const_cast<uint8_t *>(_map), _mapSize);
+#endif
+    if (_records) fclose(_records);
+    if (_index) fclose(_index);
+    _map = nullptr;
+    _mapSize = 0;
+    _mapOffset = 0;
+    _records = nullptr;
+    _index = nullptr;
+    _indexCount = 0;
+}
+
+bool GameRecordReader::read(void *data, size_t size)
+{
+    if (_map) {
+        if (_mapOffset + size > _mapSize) return false;
+        memcpy(data, _map + _mapOffset, size);
+        _mapOffset += size;
+        return true;
+    }
+    return _records && fread(data, 1, size, _records) == size;
+}
+
+bool GameRecordReader::next(GameRecord &record)
+{
+    uint8_t prefix[4];
+    if (!read(prefix, sizeof(prefix))) {
+        return false;
+    }
+    const uint32_t length = GetU32(prefix);
+    if (length < RECORD_FIXED_SIZE) {
+        return false;
+    }
+    _buffer.resize(length);
+    if (!read(_buffer.data(), length)) {
+        return false;
+    }
+    const uint8_t *p = _buffer.data();
+    record.width = p[0];
+    record.height = p[1];
+    record.winLength = p[2];
+    record.winner = p[3];
+    const size_t plies = GetU16(p + 4);
+    record.gameNumber = GetU64(p + 8);
+    const size_t moveBytes = (record.cellCount() <= 255) ? 1 : 2;
+    if (RECORD_FIXED_SIZE + plies * moveBytes != length) {
+        return false;
+    }
+    const uint8_t *moves = p + RECORD_FIXED_SIZE;
+    record.moves.resize(plies);
+    for (size_t i = 0; i < plies; ++i) {
+        record.moves[i] = (int16_t)((moveBytes == 1) ? moves[i] : GetU16(moves + 2 * i));
+    }
+    return true;
+}
+
+bool GameRecordReader::readIndex(uint64_t game, uint64_t &offset)
+{
+    uint8_t entry[8];
+    if (!_index || game >= _indexCount ||
+        !RecordFileSeek(_index, FILE_HEADER_SIZE + game * 8) ||
+        fread(entry, 1, sizeof(entry), _index) != sizeof(entry)) {
+        return false;
+    }
+    offset = GetU64(entry);
+    return true;
+}
+
+bool GameRecordReader::seek(uint64_t game)
+{
+    uint64_t offset;
+    if (!readIndex(game, offset)) {
+        return false;
+    }
+    if (_map) {
+        if (offset >= _mapSize) return false;
+        _mapOffset = (size_t)offset;
+        return true;
+    }
+    return _records && RecordFileSeek(_records, offset);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//
+// append-only binary game records, e.g. written by the self-play runner
+// a record file is an 8-byte header ("TTTR", version, header size) followed by one
+// length-prefixed record per game: u32 length, then width, height, k, winner (u8 each),
+// plies (u16), reserved (u16), game number (u64) and one move per ply, a byte each on boards
+// of up to 255 cells and two bytes (little-endian) on bigger ones; a 3x3 game takes about 27 bytes
+// alongside it, <file>.idx holds an 8-byte header ("TTTI", version) and the u64 offset of
+// every record, so game K is found in O(1) without reading the games before it
+// readers stream the file (or map it where the platform allows) rather than loading it
+// a position is rebuilt as a state string ('0' empty, '1' X, '2' O per cell) by replaying moves
+//
+
+constexpr uint16_t GAME_RECORD_VERSION = 1;
+
+// 64-bit positions in a FILE: self-play runs write tens of GB, and fseek/ftell take a long,
+// which is 32 bits on Windows
+bool            RecordFileSeek(FILE *file, uint64_t offset, int origin = SEEK_SET);
+uint64_t        RecordFileTell(FILE *file);
+
+struct GameRecord
+{
+    int                     width = 3;
+    int                     height = 3;
+    int                     winLength = 3;
+    int                     winner = 0;         // 0 draw (or unfinished), 1 X, 2 O
+    uint64_t                gameNumber = 0;     // within the run that played it, which replays it from the seed
+    std::vector<int16_t>    moves;              // cell index per ply, X first
+
+    int                     cellCount() const { return width * height; }
+    // the board after the first `plies` moves
+    std::string             stateAfter(size_t plies) const;
+};
+
+class GameRecordWriter
+{
+public:
+    GameRecordWriter() = default;
+    ~GameRecordWriter() { close(); }
+    GameRecordWriter(const GameRecordWriter &) = delete;
+    GameRecordWriter &operator=(const GameRecordWriter &) = delete;
+
+    // opens path and path.idx for appending, creating them with their headers if needed
+    bool        open(const std::string &path);
+    bool        write(const GameRecord &record);
+    void        close();
+    bool        isOpen() const { return _records != nullptr; }
+    uint64_t    count() const { return _count; }        // games in the file, including earlier runs
+
+private:
+    FILE        *_records = nullptr;
+    FILE        *_index = nullptr;
+    uint64_t    _offset = 0;        // where the next record goes
+    uint64_t    _count = 0;
+    std::vector<uint8_t> _buffer;
+};
+
+class GameRecordReader
+{
+public:
+    GameRecordReader() = default;
+    ~GameRecordReader() { close(); }
+    GameRecordReader(const GameRecordReader &) = delete;
+    GameRecordReader &operator=(const GameRecordReader &) = delete;
+
+    // opens path, and path.idx if present; mapped chooses a memory map over buffered reads
+    bool        open(const std::string &path, bool mapped = true);
+    void        close();
+
+    // the next record in file order, false at the end or on a damaged record
+    bool        next(GameRecord &record);
+
+    // games listed in the index, 0 without one
+    uint64_t    indexedCount() const { return _indexCount; }
+    // positions the stream so next() returns game K; needs the index
+    bool        seek(uint64_t game);
+
+private:
+    bool        read(void *data, size_t size);
+    bool        readIndex(uint64_t game, uint64_t &offset);
+
+    FILE            *_records = nullptr;
+    FILE            *_index = nullptr;
+    const uint8_t   *_map = nullptr;            // the whole record file when mapped
+    size_t          _mapSize = 0;
+    size_t          _mapOffset = 0;
+    uint64_t        _indexCount = 0;
+    std::vector<uint8_t> _buffer;
+};
@@ -0,0 +1,198 @@
+#include "GameReplay.h"
+#include <algorithm>
+
+void GameReplay::clear()
+{
+    _stride = 0;
+    _changes.clear();
+    _turnStart.clear();
+    _checkpoints.clear();
+    _state.clear();
+    _cursor = 0;
+    _clock = 0.0;
+    _playing = false;
+}
+
+void GameReplay::begin(std::string_view start)
+{
+    clear();
+    _state.assign(start);
+    _stride = (start.size() + 3) / 4;
+    _turnStart.assign(2, 0);
+    _checkpoints.assign(_stride, 0);
+    for (size_t cell = 0; cell < _state.size(); ++cell) {
+        _checkpoints[cell / 4] |= (uint8_t)(((_state[cell] - '0') & 3) << (2 * (cell % 4)));
+    }
+}
+
+void GameReplay::change(int cell, int after)
+{
+    const int before = _state[cell] - '0';
+    if (before == after) {
+        return;
+    }
+    _changes.push_back({ (int16_t)cell, (uint8_t)before, (uint8_t)after });
+    _state[cell] = (char)('0' + after);
+}
+
+void GameReplay::endEntry()
+{
+    _turnStart.push_back((uint32_t)_changes.size());
+    const size_t entry = size() - 1;
+    if (entry % REPLAY_CHECKPOINT_INTERVAL == 0) {
+        const size_t offset = _checkpoints.size();
+        _checkpoints.resize(offset + _stride, 0);
+        for (size_t cell = 0; cell < _state.size(); ++cell) {
+            _checkpoints[offset + cell / 4] |= (uint8_t)(((_state[cell] - '0') & 3) << (2 * (cell % 4)));
+        }
+    }
+    _cursor = entry;
+}
+
+void GameReplay::load(const GameRecord &record)
+{
+    begin(std::string((size_t)record.cellCount(), '0'));
+    for (size_t ply = 0; ply < record.moves.size(); ++ply) {
+        const int cell = record.moves[ply];
+        // as GameRecord::stateAfter() reads it: a cell off the board is a turn that changed nothing
+        if (cell >= 0 && cell < record.cellCount()) {
+            change(cell, (ply % 2 == 0) ? 1 : 2);
+        }
+        endEntry();
+    }
+    seek(0);
+}
+
+void GameReplay::load(const MoveHistory &history)
+{
+    if (history.size() == 0) {
+        clear();
+        return;
+    }
+    std::string next;
+    history.stateAt(0, next);
+    begin(next);
+    for (size_t entry = 1; entry < history.size(); ++entry) {
+        history.stateAt(entry, next);
+        for (size_t cell = 0; cell < next.size(); ++cell) {
+            change((int)cell, next[cell] - '0');
+        }
+        endEntry();
+    }
+    seek(0);
+}
+
+int GameReplay::lastMove() const
+{
+    if (_cursor == 0 || _turnStart[_cursor] == _turnStart[_cursor + 1]) {
+        return -1;
+    }
+    return _changes[_turnStart[_cursor]].cell;
+}
+
+void GameReplay::applyForward(size_t entry)
+{
+    for (uint32_t i = _turnStart[entry]; i < _turnStart[entry + 1]; ++i) {
+        _state[_changes[i].cell] = (char)('0' + _changes[i].after);
+    }
+    _cursor = entry;
+}
+
+void GameReplay::applyBack(size_t entry)
+{
+    for (uint32_t i = _turnStart[entry + 1]; i-- > _turnStart[entry];) {
+        _state[_changes[i].cell] = (char)('0' + _changes[i].before);
+    }
+    _cursor = entry - 1;
+}
+
+void GameReplay::restoreCheckpoint(size_t checkpoint)
+{
+    const uint8_t *packed = &_checkpoints[checkpoint * _stride];
+    for (size_t cell = 0; cell < _state.size(); ++cell) {
+        _state[cell] = (char)('0' + ((packed[cell / 4] >> (2 * (cell % 4))) & 3));
+    }
+    _cursor = checkpoint * REPLAY_CHECKPOINT_INTERVAL;
+}
+
+//
+// whichever is fewer turns away: the cursor, or the checkpoint at or before entry
+//
+void GameReplay::seek(size_t entry)
+{
+    if (empty()) {
+        return;
+    }
+    entry = std::min(entry, size() - 1);
+    const size_t fromCheckpoint = entry % REPLAY_CHECKPOINT_INTERVAL;
+    if (entry < _cursor && _cursor - entry <= fromCheckpoint) {
+        while (_cursor > entry) applyBack(_cursor);
+        return;
+    }
+    if (entry < _cursor || entry - _cursor > fromCheckpoint) {
+        restoreCheckpoint(entry / REPLAY_CHECKPOINT_INTERVAL);
+    }
+    while (_cursor < entry) applyForward(_cursor + 1);
+}
+
+bool GameReplay::stepForward()
+{
+    if (empty() || _cursor + 1 >= size()) {
+        return false;
+    }
+    applyForward(_cursor + 1);
+    return true;
+}
+
+bool GameReplay::stepBack()
+{
+    if (_cursor == 0) {
+        return false;
+    }
+    applyBack(_cursor);
+    return true;
+}
+
+void GameReplay::play()
+{
+    if (empty()) {
+        return;
+    }
+    if (_cursor + 1 >= size()) {
+        seek(0);
+    }
+    _playing = true;
+    _clock = 0.0;
+}
+
+bool GameReplay::advance(double seconds)
+{
+    if (!_playing) {
+        return false;
+    }
+    const double step = 1.0 / _speed;
+    bool moved = false;
+    _clock += seconds;
+    while (_clock >= step) {
+        _clock -= step;
+        if (!stepForward()) {
+            break;
+        }
+        moved = true;
+    }
+    if (_cursor + 1 >= size()) {
+        _playing = false;
+        _clock = 0.0;
+    }
+    return moved;
+}
+
+double GameReplay::secondsToNextStep() const
+{
+    return _playing ? std::max(0.0, 1.0 / _speed - _clock) : -1.0;
+}
+
+size_t GameReplay::sizeInBytes() const
+{
+    return _changes.size() * sizeof(Change) + _turnStart.size() * sizeof(uint32_t) + _checkpoints.size();
+}
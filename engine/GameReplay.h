@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "GameRecord.h"
+#include "MoveHistory.h"
+
+//
+// a cursor for reviewing a finished or recorded game: seek to any turn, step either way, or
+// play it back at a chosen speed
+// a turn is stored as the cells it changed (cell, before, after), and every
+// REPLAY_CHECKPOINT_INTERVAL turns the whole board is kept packed at 2 bits per cell, so a
+// seek unpacks the nearest checkpoint at or before the target and applies at most
+// REPLAY_CHECKPOINT_INTERVAL - 1 turns, whatever the length of the game; a seek near the
+// cursor steps from it instead, backwards too, as each change remembers what it replaced
+// positions are state strings ('0' empty, '1' X, '2' O per cell), entry 0 the start position
+//
+
+constexpr size_t REPLAY_CHECKPOINT_INTERVAL = 16;
+
+class GameReplay
+{
+public:
+    GameReplay() = default;
+
+    // the plies of a record file's game, X first from an empty board
+    void        load(const GameRecord &record);
+    // every entry of a live game's history, whatever changed between them
+    void        load(const MoveHistory &history);
+    void        clear();
+
+    bool        empty() const { return _turnStart.empty(); }
+    // entries, the start position included; the last is size() - 1
+    size_t      size() const { return _turnStart.empty() ? 0 : _turnStart.size() - 1; }
+    size_t      cursor() const { return _cursor; }
+    int         cellCount() const { return (int)_state.size(); }
+
+    // the position at the cursor, valid until the cursor next moves
+    std::string_view state() const { return _state; }
+    int         cellAt(int cell) const { return _state[cell] - '0'; }
+    // the first cell changed by the turn that led to the cursor, -1 at the start or if none
+    int         lastMove() const;
+
+    // move the cursor to entry, clamped to the last one
+    void        seek(size_t entry);
+    bool        stepForward();
+    bool        stepBack();
+
+    // playback: entries per second, and whether advance() moves the cursor
+    void        setSpeed(double entriesPerSecond) { _speed = (entriesPerSecond > 0.0) ? entriesPerSecond : 1.0; }
+    double      speed() const { return _speed; }
+    // from the start again if the cursor is at the end
+    void        play();
+    void        pause() { _playing = false; }
+    bool        playing() const { return _playing; }
+    // advance the playback clock by seconds, stepping as many entries as are due; true if the
+    // cursor moved; playback pauses at the last entry
+    bool        advance(double seconds);
+    // how long until advance() next moves the cursor, < 0 if it won't
+    double      secondsToNextStep() const;
+
+    // checkpoints and changes, for comparing with a MoveHistory of the same game
+    size_t      sizeInBytes() const;
+
+private:
+    struct Change
+    {
+        int16_t     cell;
+        uint8_t     before;
+        uint8_t     after;
+    };
+
+    // loading: start from a position, record changes to _state, then close the entry
+    void        begin(std::string_view start);
+    void        change(int cell, int after);
+    void        endEntry();
+    void        applyForward(size_t entry);
+    void        applyBack(size_t entry);
+    void        restoreCheckpoint(size_t checkpoint);
+
+    size_t                  _stride = 0;        // bytes per packed checkpoint
+    std::vector<Change>     _changes;
+    // entry e's changes are _changes[_turnStart[e], _turnStart[e + 1]); entry 0 has none
+    std::vector<uint32_t>   _turnStart;
+    std::vector<uint8_t>    _checkpoints;       // entry i * REPLAY_CHECKPOINT_INTERVAL, packed
+    std::string             _state;
+    size_t                  _cursor = 0;
+
+    double                  _speed = 4.0;
+    double                  _clock = 0.0;       // seconds towards the next step
+    bool                    _playing = false;
+};
@@ -0,0 +1,64 @@
+#include "GameSession.h"
+#include <utility>
+
+GameSession::GameSession(uint64_t id, const GameSessionSettings &settings, std::shared_ptr<const MnkRules> rules, uint32_t seed)
+    : _id(id), _settings(settings), _rules(std::move(rules)), _board(*_rules), _rng(seed)
+{
+    _history.reset(_board.toState());
+}
+
+bool GameSession::play(int cell)
+{
+    if (gameOver() || _settings.ai[sideToMove() - 1] || cell < 0 || cell >= _rules->cellCount() || _board.cellAt(cell) != 0) {
+        return false;
+    }
+    place(cell);
+    return true;
+}
+
+void GameSession::reset()
+{
+    _board = MnkBoard(*_rules);
+    _history.reset(_board.toState());
+    _pendingTicket = 0;
+}
+
+GameSessionRequest GameSession::requestAIMove()
+{
+    GameSessionRequest request;
+    request.session = _id;
+    request.ticket = _pendingTicket = _nextTicket++;
+    request.rules = _rules;
+    request.state = _board.toStateString();
+    request.player = _settings.players[sideToMove() - 1];
+    if (_board.pieceCount() < _settings.randomPlies) {
+        request.player.engine = kEngineRandom;
+    }
+    request.seed = (uint32_t)_rng();
+    return request;
+}
+
+bool GameSession::applyAIMove(uint64_t ticket, int move, uint64_t nodes)
+{
+    if (ticket == 0 || ticket != _pendingTicket) {
+        return false;
+    }
+    _pendingTicket = 0;
+    _aiNodes += nodes;
+    if (gameOver() || move < 0 || move >= _rules->cellCount() || _board.cellAt(move) != 0) {
+        return false;
+    }
+    place(move);
+    return true;
+}
+
+void GameSession::place(int cell)
+{
+    _history.pushMove(cell, _board.sideToMove());
+    _board.makeMove(cell);
+    // the position moved on, so any request still out is for a position that's gone
+    _pendingTicket = 0;
+    if (gameOver()) {
+        _results[_board.winner()]++;
+    }
+}
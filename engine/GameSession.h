@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include "MnkBoard.h"
+#include "MoveHistory.h"
+#include "SelfPlay.h"
+
+//
+// one game with its own board, history and AI settings, so a process can host any number of
+// them; SessionManager (engine/SessionManager.h) owns the sessions and runs their AI moves
+// a session never searches itself: while an AI side is to move it hands out a request for the
+// current position, and takes the reply back through applyAIMove()
+// every request carries a ticket, and any move or reset since invalidates it, so a reply
+// that comes back after the position moved on is dropped
+// the rules are shared: thousands of sessions on one board size hold one MnkRules
+//
+
+struct GameSessionSettings
+{
+    int             width = 3;
+    int             height = 3;
+    int             winLength = 3;
+    bool            ai[2] = { false, true };    // [0] X, [1] O; a side that isn't waits for play()
+    SelfPlayPlayer  players[2];         // the engine each AI side uses
+    int             randomPlies = 0;    // opening plies the AI plays at random, so AI-vs-AI games differ
+    bool            rematch = false;    // start the next game as soon as one ends
+};
+
+// what a worker needs to pick the AI's move, copied out of the session
+struct GameSessionRequest
+{
+    uint64_t        session = 0;
+    uint64_t        ticket = 0;
+    std::shared_ptr<const MnkRules> rules;
+    std::string     state;              // MnkBoard::toStateString()
+    SelfPlayPlayer  player;
+    uint32_t        seed = 0;           // for a random engine
+};
+
+class GameSession
+{
+public:
+    GameSession(uint64_t id, const GameSessionSettings &settings, std::shared_ptr<const MnkRules> rules, uint32_t seed);
+    // the board points at the shared rules, and the manager hands out pointers to sessions
+    GameSession(const GameSession &) = delete;
+    GameSession &operator=(const GameSession &) = delete;
+
+    uint64_t        id() const { return _id; }
+    const GameSessionSettings &settings() const { return _settings; }
+    const MnkRules  &rules() const { return *_rules; }
+    const MnkBoard  &board() const { return _board; }
+    const MoveHistory &history() const { return _history; }
+    int             sideToMove() const { return _board.sideToMove(); }
+    bool            gameOver() const { return _board.gameOver(); }
+    int             winner() const { return _board.winner(); }
+
+    // a move by a player the AI doesn't control; false if it is the AI's turn, the game is
+    // over or the cell isn't empty
+    bool            play(int cell);
+    // a new game on the same settings; a request in flight is dropped when it comes back
+    void            reset();
+
+    // the side to move is the AI's and no request is out for this position
+    bool            wantsAIMove() const { return !gameOver() && _settings.ai[sideToMove() - 1] && _pendingTicket == 0; }
+    bool            aiThinking() const { return _pendingTicket != 0; }
+    // a request for the current position; only valid while wantsAIMove()
+    GameSessionRequest requestAIMove();
+    // plays the reply to a request; false if its ticket is stale or the move isn't legal
+    bool            applyAIMove(uint64_t ticket, int move, uint64_t nodes);
+
+    // finished games, counting rematches, by result: [0] draws, [1] X wins, [2] O wins
+    uint64_t        results(int winner) const { return _results[winner]; }
+    uint64_t        aiNodes() const { return _aiNodes; }
+
+private:
+    void            place(int cell);
+
+    uint64_t                        _id;
+    GameSessionSettings             _settings;
+    std::shared_ptr<const MnkRules> _rules;
+    MnkBoard                        _board;
+    MoveHistory                     _history;
+    std::mt19937                    _rng;
+    uint64_t                        _nextTicket = 1;
+    uint64_t                        _pendingTicket = 0;     // 0 = no request out
+    uint64_t                        _results[3] = {};
+    uint64_t                        _aiNodes = 0;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+//
+// latencies in microseconds, counted into log-linear buckets: every power of two is split into
+// LATENCY_SUB_BUCKETS even steps, so a percentile is read to within about 6% whatever the scale
+// and recording is a couple of shifts and an increment, with no allocation
+// one thread records; merge() adds another histogram's counts, e.g. to combine threads
+//
+
+constexpr int LATENCY_SUB_BITS = 4;
+constexpr int LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BITS;
+constexpr int LATENCY_BUCKETS = (64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_BUCKETS;
+
+class LatencyHistogram
+{
+public:
+    void            record(uint64_t micros)
+    {
+        _counts[bucketOf(micros)]++;
+        _count++;
+        _total += micros;
+        _max = std::max(_max, micros);
+    }
+
+    void            merge(const LatencyHistogram &other)
+    {
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) _counts[i] += other._counts[i];
+        _count += other._count;
+        _total += other._total;
+        _max = std::max(_max, other._max);
+    }
+
+    void            reset() { *this = LatencyHistogram(); }
+
+    uint64_t        count() const { return _count; }
+    uint64_t        max() const { return _max; }
+    double          mean() const { return _count ? (double)_total / (double)_count : 0.0; }
+
+    // the latency that fraction q (0..1) of the samples are at or below, as the top of its
+    // bucket; 0 with no samples
+    uint64_t        percentile(double q) const
+    {
+        if (_count == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, (uint64_t)(q * (double)_count + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += _counts[i];
+            if (seen >= rank) return std::min(bucketTop(i), _max);
+        }
+        return _max;
+    }
+
+private:
+    // values below LATENCY_SUB_BUCKETS get a bucket each; above, the top LATENCY_SUB_BITS bits
+    // after the leading one pick the step within the value's power of two
+    static int      bucketOf(uint64_t value)
+    {
+        if (value < (uint64_t)LATENCY_SUB_BUCKETS) {
+            return (int)value;
+        }
+        const int shift = (63 - std::countl_zero(value)) - LATENCY_SUB_BITS;
+        return (shift + 1) * LATENCY_SUB_BUCKETS + (int)((value >> shift) & (LATENCY_SUB_BUCKETS - 1));
+    }
+
+    static uint64_t bucketTop(int bucket)
+    {
+        if (bucket < LATENCY_SUB_BUCKETS) {
+            return (uint64_t)bucket;
+        }
+        const int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+        const uint64_t step = (uint64_t)(bucket % LATENCY_SUB_BUCKETS);
+        return ((((uint64_t)LATENCY_SUB_BUCKETS + step + 1) << shift) - 1);
+    }
+
+    uint64_t        _counts[LATENCY_BUCKETS] = {};
+    uint64_t        _count = 0;
+    uint64_t        _total = 0;
+    uint64_t        _max = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include "MnkBoard.h"
+
+//
+// static evaluation of open lines, specialised at compile time for one board size
+// LineTable<W, H, K> enumerates the k-long windows of a W x H board in constexpr, in the same
+// order as MnkRules, and LineEvaluate<W, H, K>() expands into one term per window: a lookup of
+// the two players' counts (which MnkBoard keeps per line) in a constexpr (K + 1)^2 score table,
+// with no loop, no branch and the line count and k as constants
+// MnkSearch picks the compiled kernel when one exists for the variant and falls back to a loop
+// over MnkRules::lines() otherwise
+//
+
+//
+// weight of an open line (no opposing stones) holding `count` of one player's stones:
+// each extra stone is worth 8x, so one k-1 line outweighs a handful of shorter ones
+//
+constexpr int LineWeight(int count)
+{
+    return (count <= 0) ? 0 : 1 << std::min(3 * (count - 1), 24);
+}
+
+template <int W, int H, int K>
+struct LineTable
+{
+    static_assert(W >= 1 && H >= 1 && W <= MNK_MAX_SIDE && H <= MNK_MAX_SIDE, "board sizes match MnkRules");
+    static_assert(K >= 1 && K <= (W > H ? W : H), "k has to fit on the board");
+
+    // the four line directions, in the same order as MnkRules
+    static constexpr int DIRECTIONS[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+
+    static constexpr bool fits(int x, int y, const int dir[2])
+    {
+        const int endX = x + dir[0] * (K - 1);
+        const int endY = y + dir[1] * (K - 1);
+        return endX >= 0 && endX < W && endY >= 0 && endY < H;
+    }
+
+    static constexpr int countLines()
+    {
+        int count = 0;
+        for (const auto &dir : DIRECTIONS) {
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) count += fits(x, y, dir) ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    static constexpr int COUNT = countLines();
+};
+
+namespace LineEvalDetail {
+
+// LineWeight of an open line as a function of both players' counts, (K + 1)^2 entries
+template <int K>
+constexpr std::array<int, (K + 1) * (K + 1)> ScoreTable()
+{
+    std::array<int, (K + 1) * (K + 1)> scores{};
+    for (int x = 0; x <= K; ++x) {
+        for (int o = 0; o <= K; ++o) {
+            scores[x * (K + 1) + o] = ((o == 0) ? LineWeight(x) : 0) - ((x == 0) ? LineWeight(o) : 0);
+        }
+    }
+    return scores;
+}
+
+template <int K, size_t... L>
+inline int SumLines(const MnkBoard &board, std::index_sequence<L...>)
+{
+    static constexpr std::array<int, (K + 1) * (K + 1)> SCORES = ScoreTable<K>();
+    return (0 + ... + SCORES[board.lineCount(1, (int)L) * (K + 1) + board.lineCount(2, (int)L)]);
+}
+
+}
+
+// sum over every window of its open-line weight, from X's point of view; board has to be a
+// W x H, k = K board, whose lines are numbered as in LineTable
+template <int W, int H, int K>
+int LineEvaluate(const MnkBoard &board)
+{
+    return LineEvalDetail::SumLines<K>(board, std::make_index_sequence<LineTable<W, H, K>::COUNT>());
+}
@@ -0,0 +1,117 @@
+#include "MappedFile.h"
+#include <cstdio>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP 1
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#define MAPPED_FILE_WIN32_MAP 1
+#endif
+
+bool MappedFile::open(const std::string &path, size_t minSize)
+{
+    close();
+#if defined(MAPPED_FILE_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0 && (size_t)info.st_size >= minSize) {
+        void *map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map != MAP_FAILED) {
+            // both formats are probed at scattered entries, so read-ahead would mostly fetch
+            // pages nobody wants
+            madvise(map, (size_t)info.st_size, MADV_RANDOM);
+            _map = map;
+            _data = static_cast<const uint8_t *>(map);
+            _size = (size_t)info.st_size;
+        }
+    }
+    if (fd >= 0) ::close(fd);
+#elif defined(MAPPED_FILE_WIN32_MAP)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 &&
+        (size_t)fileSize.QuadPart >= minSize) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            // the view keeps the mapping alive after its handle is closed
+            const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (view) {
+                _map = view;
+                _data = static_cast<const uint8_t *>(view);
+                _size = (size_t)fileSize.QuadPart;
+            }
+        }
+    }
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#endif
+    if (_data) {
+        return true;
+    }
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        _copy.insert(_copy.end(), buffer, buffer + count);
+    }
+    const bool ok = !ferror(file) && !_copy.empty() && _copy.size() >= minSize;
+    fclose(file);
+    if (!ok) {
+        _copy.clear();
+        return false;
+    }
+    _data = _copy.data();
+    _size = _copy.size();
+    return true;
+}
+
+void MappedFile::close()
+{
+#if defined(MAPPED_FILE_MMAP)
+    if (_map) munmap(const_cast<void *>(_map), _size);
+#elif defined(MAPPED_FILE_WIN32_MAP)
+    if (_map) UnmapViewOfFile(_map);
+#endif
+    _map = nullptr;
+    _data = nullptr;
+    _size = 0;
+    _copy.clear();
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool WriteFileReplacing(const std::string &path, std::initializer_list<FileChunk> chunks)
+{
+    const std::string temporary = path + ".tmp";
+    FILE *file = fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = true;
+    for (const FileChunk &chunk : chunks) {
+        ok = ok && fwrite(chunk.data, 1, chunk.size, file) == chunk.size;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (ok) {
+#if defined(_WIN32)
+        // rename() won't replace a file on Windows
+        ok = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        // replaces the old file in one step, so an open() never finds no file at all
+        ok = std::rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+    }
+    if (!ok) {
+        std::remove(temporary.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+//
+// a read-only file mapped whole into memory, for the solved-position files (opening books,
+// tablebases) that are read in place: the mapping is shared, so every process with the file
+// open uses the same page-cache pages; where the platform can't map files it is read into a
+// copy instead, and the data is used the same way
+//
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // maps path; false if it is missing, unreadable or shorter than minSize
+    bool            open(const std::string &path, size_t minSize = 0);
+    void            close();
+    bool            isOpen() const { return _data != nullptr; }
+
+    const uint8_t   *data() const { return _data; }
+    size_t          size() const { return _size; }
+
+private:
+    const uint8_t           *_data = nullptr;
+    size_t                  _size = 0;
+    const void              *_map = nullptr;
+    std::vector<uint8_t>    _copy;              // where the platform can't map files
+};
+
+struct FileChunk
+{
+    const void      *data;
+    size_t          size;
+};
+
+// writes the chunks one after another to path + ".tmp", then moves that over path in one step:
+// a process that has the old file mapped keeps reading it, and the new one appears whole
+bool            WriteFileReplacing(const std::string &path, std::initializer_list<FileChunk> chunks);
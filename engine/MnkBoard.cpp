@@ -0,0 +1,162 @@
+#include "MnkBoard.h"
+#include <algorithm>
+#include <cstdlib>
+
+MnkRules::MnkRules(int width, int height, int winLength)
+{
+    _width = std::clamp(width, 1, MNK_MAX_SIDE);
+    _height = std::clamp(height, 1, MNK_MAX_SIDE);
+    _winLength = std::clamp(winLength, 1, std::max(_width, _height));
+    // small boards consider every empty cell, big ones only cells near existing stones
+    _neighbourhoodRadius = (cellCount() <= 25) ? MNK_MAX_SIDE : 2;
+
+    for (int cell = 0; cell < cellCount(); ++cell) {
+        _boardMask.set(cell);
+    }
+
+    // generate every k-long window in the four line directions
+    const int directions[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+    for (const auto &dir : directions) {
+        for (int y = 0; y < _height; ++y) {
+            for (int x = 0; x < _width; ++x) {
+                const int endX = x + dir[0] * (_winLength - 1);
+                const int endY = y + dir[1] * (_winLength - 1);
+                if (endX < 0 || endX >= _width || endY < 0 || endY >= _height) continue;
+                CellMask line;
+                for (int i = 0; i < _winLength; ++i) {
+                    line.set(cellIndex(x + dir[0] * i, y + dir[1] * i));
+                }
+                _lines.push_back(line);
+            }
+        }
+    }
+
+    std::vector<int> perCell(cellCount() + 1, 0);
+    for (const CellMask &line : _lines) {
+        line.forEach([&](int cell) { perCell[cell + 1]++; });
+    }
+    _cellLineStart.assign(cellCount() + 1, 0);
+    for (int cell = 0; cell < cellCount(); ++cell) {
+        _cellLineStart[cell + 1] = _cellLineStart[cell] + perCell[cell + 1];
+    }
+    _cellLines.resize(_cellLineStart.back());
+    std::vector<int> fill(_cellLineStart.begin(), _cellLineStart.end() - 1);
+    for (int line = 0; line < (int)_lines.size(); ++line) {
+        _lines[line].forEach([&](int cell) { _cellLines[fill[cell]++] = (uint16_t)line; });
+    }
+
+    // splitmix64 from a fixed seed, so hashes are reproducible
+    uint64_t seed = 0x9E3779B97F4A7C15ull ^ ((uint64_t)_width << 16) ^ ((uint64_t)_height << 8) ^ (uint64_t)_winLength;
+    _zobrist.resize(2 * cellCount());
+    for (uint64_t &key : _zobrist) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        key = z ^ (z >> 31);
+    }
+
+    _neighbourhood.resize(cellCount());
+    for (int cell = 0; cell < cellCount(); ++cell) {
+        const int cx = cell % _width, cy = cell / _width;
+        for (int y = 0; y < _height; ++y) {
+            for (int x = 0; x < _width; ++x) {
+                if (std::abs(x - cx) <= _neighbourhoodRadius && std::abs(y - cy) <= _neighbourhoodRadius) {
+                    _neighbourhood[cell].set(cellIndex(x, y));
+                }
+            }
+        }
+    }
+}
+
+MnkBoard::MnkBoard(const MnkRules &rules)
+{
+    _rules = &rules;
+    _pieceCount[0] = 0;
+    _pieceCount[1] = 0;
+    _lineCounts.assign(2 * rules.lines().size(), 0);
+    _completeLines[0] = 0;
+    _completeLines[1] = 0;
+    _hash = 0;
+}
+
+void MnkBoard::place(int cell, int player)
+{
+    const int k = _rules->winLength();
+    const int p = player - 1;
+    _stones[p].set(cell);
+    _pieceCount[p]++;
+    _hash ^= _rules->zobristKey(cell, player);
+    for (uint16_t line : _rules->linesThrough(cell)) {
+        if (++_lineCounts[2 * line + p] == k) _completeLines[p]++;
+    }
+}
+
+void MnkBoard::lift(int cell, int player)
+{
+    const int k = _rules->winLength();
+    const int p = player - 1;
+    _stones[p].reset(cell);
+    _pieceCount[p]--;
+    _hash ^= _rules->zobristKey(cell, player);
+    for (uint16_t line : _rules->linesThrough(cell)) {
+        if (_lineCounts[2 * line + p]-- == k) _completeLines[p]--;
+    }
+}
+
+void MnkBoard::set(int cell, int player)
+{
+    _undo.clear();
+    const int current = cellAt(cell);
+    if (current == player) {
+        return;
+    }
+    if (current != 0) {
+        lift(cell, current);
+    }
+    if (player == 1 || player == 2) {
+        place(cell, player);
+    }
+}
+
+void MnkBoard::makeMove(int cell)
+{
+    const int side = sideToMove();
+    _undo.push_back({ (int16_t)cell, (uint8_t)side, _hash });
+    place(cell, side);
+}
+
+bool MnkBoard::unmakeMove()
+{
+    if (_undo.empty()) {
+        return false;
+    }
+    const Undo undo = _undo.back();
+    _undo.pop_back();
+    lift(undo.cell, undo.side);
+    _hash = undo.hash;
+    return true;
+}
+
+CellMask MnkBoard::emptyCells() const
+{
+    CellMask empty = _rules->boardMask();
+    empty &= ~_stones[0];
+    empty &= ~_stones[1];
+    return empty;
+}
+
+MnkState MnkBoard::toState() const
+{
+    MnkState state((size_t)_rules->cellCount());
+    for (int cell = 0; cell < _rules->cellCount(); ++cell) {
+        state.set(cell, cellAt(cell));
+    }
+    return state;
+}
+
+void MnkBoard::setStateString(std::string_view s)
+{
+    for (int cell = 0; cell < _rules->cellCount(); ++cell) {
+        set(cell, (cell < (int)s.size()) ? s[cell] - '0' : 0);
+    }
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "StateString.h"
+
+//
+// generalised m,n,k game: a width x height board, k in a row wins
+// (3,3,3 is tic tac toe, 15,15,5 is free-style Gomoku)
+// cells are numbered left-to-right, top-to-bottom like the 3x3 Bitboard and the state strings
+//
+
+constexpr int MNK_MAX_SIDE = 19;
+constexpr int MNK_MAX_CELLS = MNK_MAX_SIDE * MNK_MAX_SIDE;
+constexpr int MNK_MASK_WORDS = (MNK_MAX_CELLS + 63) / 64;
+static_assert(MNK_MAX_CELLS == STATE_MAX_CELLS, "state buffers have to hold the largest board");
+
+// a state string of any m,n,k board on the stack, see engine/StateString.h
+using MnkState = StateBuffer<MNK_MAX_CELLS>;
+
+//
+// one bit per cell, wide enough for the largest board
+//
+struct CellMask
+{
+    std::array<uint64_t, MNK_MASK_WORDS> words{};
+
+    bool    test(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1; }
+    void    set(int cell) { words[cell >> 6] |= (uint64_t)1 << (cell & 63); }
+    void    reset(int cell) { words[cell >> 6] &= ~((uint64_t)1 << (cell & 63)); }
+    bool    any() const
+    {
+        uint64_t bits = 0;
+        for (uint64_t word : words) bits |= word;
+        return bits != 0;
+    }
+    int     count() const
+    {
+        int n = 0;
+        for (uint64_t word : words) n += std::popcount(word);
+        return n;
+    }
+    // number of cells set in both masks
+    int     countAnd(const CellMask &other) const
+    {
+        int n = 0;
+        for (int i = 0; i < MNK_MASK_WORDS; ++i) n += std::popcount(words[i] & other.words[i]);
+        return n;
+    }
+    CellMask &operator|=(const CellMask &other)
+    {
+        for (int i = 0; i < MNK_MASK_WORDS; ++i) words[i] |= other.words[i];
+        return *this;
+    }
+    CellMask &operator&=(const CellMask &other)
+    {
+        for (int i = 0; i < MNK_MASK_WORDS; ++i) words[i] &= other.words[i];
+        return *this;
+    }
+    CellMask operator~() const
+    {
+        CellMask inverse;
+        for (int i = 0; i < MNK_MASK_WORDS; ++i) inverse.words[i] = ~words[i];
+        return inverse;
+    }
+    bool operator==(const CellMask &other) const = default;
+
+    // call fn(cell) for every set cell, lowest first
+    template <typename Fn> void forEach(Fn fn) const
+    {
+        for (int i = 0; i < MNK_MASK_WORDS; ++i) {
+            for (uint64_t bits = words[i]; bits; bits &= bits - 1) {
+                fn(i * 64 + std::countr_zero(bits));
+            }
+        }
+    }
+};
+
+//
+// the geometry of one m,n,k variant, built once and shared by every board of that size
+//
+class MnkRules
+{
+public:
+    MnkRules(int width, int height, int winLength);
+
+    int                 width() const { return _width; }
+    int                 height() const { return _height; }
+    int                 winLength() const { return _winLength; }
+    int                 cellCount() const { return _width * _height; }
+    int                 cellIndex(int x, int y) const { return y * _width + x; }
+
+    // a mask with every cell of the board set
+    const CellMask      &boardMask() const { return _boardMask; }
+
+    // every k-long window in a row, column or diagonal; holding all of one is a win
+    const std::vector<CellMask> &lines() const { return _lines; }
+    // random keys for Zobrist hashing, one per cell and player (1 or 2); the same for every
+    // board of this size, and from one run to the next
+    uint64_t            zobristKey(int cell, int player) const { return _zobrist[2 * cell + player - 1]; }
+
+    // indices into lines() of the windows through cell, at most 4 * k of them
+    std::span<const uint16_t> linesThrough(int cell) const
+    {
+        return std::span<const uint16_t>(_cellLines.data() + _cellLineStart[cell], _cellLineStart[cell + 1] - _cellLineStart[cell]);
+    }
+
+    // for each cell, the cells within `radius` (Chebyshev distance), used to limit move generation
+    const CellMask      &neighbourhood(int cell) const { return _neighbourhood[cell]; }
+    int                 neighbourhoodRadius() const { return _neighbourhoodRadius; }
+
+    // the same variant, e.g. for comparing two boards
+    bool                operator==(const MnkRules &other) const
+    {
+        return _width == other._width && _height == other._height && _winLength == other._winLength;
+    }
+
+private:
+    int                     _width;
+    int                     _height;
+    int                     _winLength;
+    int                     _neighbourhoodRadius;
+    CellMask                _boardMask;
+    std::vector<CellMask>   _lines;
+    std::vector<int>        _cellLineStart;     // cell c's lines are _cellLines[start[c] .. start[c + 1])
+    std::vector<uint16_t>   _cellLines;
+    std::vector<uint64_t>   _zobrist;
+    std::vector<CellMask>   _neighbourhood;
+};
+
+//
+// a position on an MnkRules board
+// every line keeps a count of each player's stones, updated by set() for only the lines
+// through that cell; a player owns a complete line once a count reaches k, so winner() and
+// the line queries the search makes are O(1) instead of a scan over every line
+// makeMove()/unmakeMove() play and take back moves for the side to move through an undo
+// stack; set() and setStateString() are edits rather than moves and empty the stack
+//
+class MnkBoard
+{
+public:
+    explicit MnkBoard(const MnkRules &rules);
+
+    const MnkRules  &rules() const { return *_rules; }
+
+    // 0 empty, 1 = first player (X), 2 = second player (O)
+    int             cellAt(int cell) const { return _stones[0].test(cell) ? 1 : _stones[1].test(cell) ? 2 : 0; }
+    void            set(int cell, int player);
+    const CellMask  &stones(int player) const { return _stones[player - 1]; }
+    CellMask        emptyCells() const;
+
+    int             pieceCount() const { return _pieceCount[0] + _pieceCount[1]; }
+    // 1 or 2, the first player always moves first
+    int             sideToMove() const { return (_pieceCount[0] == _pieceCount[1]) ? 1 : 2; }
+    bool            full() const { return pieceCount() == _rules->cellCount(); }
+
+    // the side to move plays cell, which must be empty
+    void            makeMove(int cell);
+    // takes back the last makeMove(); false if there is none
+    bool            unmakeMove();
+    // moves makeMove() has played that unmakeMove() can take back
+    size_t          undoDepth() const { return _undo.size(); }
+    int             lastMove() const { return _undo.empty() ? -1 : _undo.back().cell; }
+
+    // Zobrist hash of the stones, kept up to date by every change
+    uint64_t        hash() const { return _hash; }
+
+    // 0 none, 1 or 2 for a player holding a complete line
+    int             winner() const { return _completeLines[0] ? 1 : _completeLines[1] ? 2 : 0; }
+    // stones of player in rules().lines()[line]
+    int             lineCount(int player, int line) const { return _lineCounts[2 * line + player - 1]; }
+    bool            gameOver() const { return winner() != 0 || full(); }
+
+    // one character per cell, '0' empty, '1' X, '2' O, same order as TicTacToe::stateString()
+    MnkState        toState() const;
+    // a heap copy of toState(), for interfaces that keep the string
+    std::string     toStateString() const { return toState().str(); }
+    void            setStateString(std::string_view s);
+
+private:
+    const MnkRules  *_rules;
+    CellMask        _stones[2];
+    int             _pieceCount[2];
+    void            place(int cell, int player);
+    void            lift(int cell, int player);
+
+    // what unmakeMove() needs to put a position back without looking at the rest of the board
+    struct Undo
+    {
+        int16_t     cell;
+        uint8_t     side;
+        uint64_t    hash;           // before the move
+    };
+
+    std::vector<uint8_t> _lineCounts;       // [2 * line + player - 1]
+    int             _completeLines[2];      // lines with k stones, per player
+    uint64_t        _hash;
+    std::vector<Undo> _undo;
+};
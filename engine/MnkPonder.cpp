@@ -0,0 +1,143 @@
+#include "MnkPonder.h"
+#include <algorithm>
+
+void MnkPonder::start(const MnkBoard &board, int predicted, const MnkSearchOptions &options)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _generation++;
+    _position = board.toStateString();
+    _predicted = predicted;
+    _options = options;
+    _options.stop = nullptr;
+    _guessed = 0;
+    _answers.clear();
+    _searching.clear();
+    _played = false;
+}
+
+void MnkPonder::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _generation++;
+    _position.clear();
+    _guessed = 0;
+    _answers.clear();
+    _searching.clear();
+    _played = false;
+}
+
+bool MnkPonder::sameSearch(const MnkSearchOptions &a, const MnkSearchOptions &b)
+{
+    return a.maxDepth == b.maxDepth && a.timeBudget == b.timeBudget && a.nodeBudget == b.nodeBudget &&
+           a.book == b.book && a.tablebase == b.tablebase && a.dynamicOrdering == b.dynamicOrdering &&
+           a.threatNodes == b.threatNodes && a.temperature == b.temperature && a.moveTable == b.moveTable;
+}
+
+//
+// the guesses are made here, on the worker: the predicted reply, then the rest by the score
+// the opponent is left with after each, one static evaluation per empty cell
+//
+bool MnkPonder::run(const MnkRules &rules, const std::atomic<bool> &stop, MnkSearchResult &answer)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const uint64_t generation = _generation;
+    if (_position.empty()) {
+        return false;
+    }
+    MnkBoard board(rules);
+    board.setStateString(_position);
+    MnkSearchOptions options = _options;
+    options.stop = &stop;
+    const int predicted = _predicted;
+    lock.unlock();
+    if (board.gameOver()) {
+        return false;
+    }
+
+    // a reply that ends the game needs no answer
+    std::vector<std::pair<int, int>> ranked;    // (score for the opponent, cell)
+    board.emptyCells().forEach([&](int cell) {
+        if (cell == predicted) return;
+        board.makeMove(cell);
+        if (!board.gameOver()) ranked.emplace_back(-MnkEvaluate(board), cell);
+        board.unmakeMove();
+    });
+    const size_t guesses = std::min(ranked.size(), (size_t)MNK_PONDER_REPLIES - (predicted >= 0 ? 1 : 0));
+    std::partial_sort(ranked.begin(), ranked.begin() + guesses, ranked.end(),
+                      [](const auto &a, const auto &b) { return a.first > b.first; });
+    std::vector<int> replies;
+    if (predicted >= 0 && board.cellAt(predicted) == 0) replies.push_back(predicted);
+    for (size_t i = 0; i < guesses; ++i) replies.push_back(ranked[i].second);
+
+    for (int reply : replies) {
+        board.makeMove(reply);
+        const std::string position = board.toStateString();
+        if (board.gameOver()) {
+            board.unmakeMove();
+            continue;
+        }
+        lock.lock();
+        if (generation != _generation) {
+            return false;
+        }
+        _searching = position;
+        _played = false;
+        _guessed++;
+        lock.unlock();
+
+        MnkSearchResult result = MnkSearchBestMove(board, options);
+        board.unmakeMove();
+
+        lock.lock();
+        if (generation != _generation) {
+            return false;
+        }
+        _searching.clear();
+        if (_played) {
+            _played = false;
+            answer = std::move(result);
+            return true;
+        }
+        // a search cut short is no answer; the next job will want the worker
+        if (stop.load()) {
+            return false;
+        }
+        _answers.push_back({ position, std::move(result) });
+        lock.unlock();
+    }
+    return false;
+}
+
+MnkPonderHit MnkPonder::play(const MnkBoard &board, const MnkSearchOptions &options, MnkSearchResult &answer)
+{
+    const std::string position = board.toStateString();
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_position.empty() && sameSearch(options, _options)) {
+        for (const Answer &known : _answers) {
+            if (known.position == position) {
+                _hits++;
+                answer = known.result;
+                return kPonderAnswered;
+            }
+        }
+        if (_searching == position) {
+            _hits++;
+            _played = true;
+            return kPonderSearching;
+        }
+    }
+    if (!_position.empty()) _misses++;
+    return kPonderMiss;
+}
+
+int MnkPonder::guessed() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _guessed;
+}
+
+int MnkPonder::answered() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return (int)_answers.size();
+}
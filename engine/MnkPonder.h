@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MnkSearch.h"
+
+//
+// pondering for the m,n,k AI: while the opponent thinks, the AI's worker searches the
+// positions their likeliest replies lead to, the search's predicted reply first, then the
+// replies the open-line score rates highest; a reply it has answered is played at once, and
+// one it is still searching has that search's answer as the AI's
+// the game thread and the worker share an MnkPonder: start() and play() on the game thread,
+// run() as the worker's job; the searches use the options' best-move table, so even a reply
+// that wasn't guessed starts from the moves the ponder found
+//
+
+constexpr int MNK_PONDER_REPLIES = 4;
+
+enum MnkPonderHit
+{
+    kPonderMiss,            // not guessed, or guessed for other options: search as usual
+    kPonderAnswered,        // the answer is ready
+    kPonderSearching,       // the running ponder search is for this position; its answer is the reply
+};
+
+class MnkPonder
+{
+public:
+    MnkPonder() = default;
+
+    // board is the position after the AI's move, predicted the reply its search expects (-1 if
+    // none); forgets the answers to the previous position
+    void        start(const MnkBoard &board, int predicted, const MnkSearchOptions &options);
+    void        clear();
+
+    // the worker's job: answers the guessed replies in turn until stop; true with answer if the
+    // reply being searched was played meanwhile (the answer is then the AI's move, even if stop
+    // cut it short), false once there is nothing more to search or the ponder was replaced
+    bool        run(const MnkRules &rules, const std::atomic<bool> &stop, MnkSearchResult &answer);
+
+    // board is the position after the opponent's move, options those the AI would search with
+    MnkPonderHit play(const MnkBoard &board, const MnkSearchOptions &options, MnkSearchResult &answer);
+
+    // for the telemetry: replies guessed and answered so far, and the hit and miss counts
+    int         guessed() const;
+    int         answered() const;
+    uint64_t    hits() const { return _hits; }
+    uint64_t    misses() const { return _misses; }
+
+private:
+    struct Answer
+    {
+        std::string     position;       // state string after the reply
+        MnkSearchResult result;
+    };
+
+    // the options that change what a search answers
+    static bool sameSearch(const MnkSearchOptions &a, const MnkSearchOptions &b);
+
+    mutable std::mutex      _mutex;
+    uint64_t                _generation = 0;    // bumped by start() and clear(), so an old run() stops
+    std::string             _position;
+    int                     _predicted = -1;
+    MnkSearchOptions        _options;
+    int                     _guessed = 0;
+    std::vector<Answer>     _answers;
+    std::string             _searching;         // position the running search is for, empty if none
+    bool                    _played = false;    // ... and the opponent has played into it
+    uint64_t                _hits = 0;
+    uint64_t                _misses = 0;
+};
@@ -0,0 +1,735 @@
+#include "MnkSearch.h"
+#include "LineEval.h"
+#include "OpeningBook.h"
+#include "Tablebase.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "SearchStats.h"
+#include "ThreatSearch.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// how often (in nodes) the search looks at the clock
+constexpr uint64_t MNK_CLOCK_INTERVAL = 256;
+
+//
+// move-ordering keys, highest tried first: the table's best move, a move that completes a
+// line, one that stops the opponent completing one, the two killers, then history
+// history stays below the killers by halving every entry once one would pass HISTORY_LIMIT
+//
+constexpr int ORDER_TABLE_MOVE = 1 << 30;
+constexpr int ORDER_WIN = 1 << 29;
+constexpr int ORDER_BLOCK = 1 << 28;
+constexpr int ORDER_KILLER = 1 << 27;       // the second killer scores one less
+constexpr int HISTORY_LIMIT = 1 << 26;
+
+//
+// what one line adds to the evaluation, from X's point of view: an open line (no opposing
+// stones) is worth LineWeight of the stones in it
+//
+static int LineScore(const MnkBoard &board, int line)
+{
+    const int x = board.lineCount(1, line);
+    const int o = board.lineCount(2, line);
+    return ((o == 0) ? LineWeight(x) : 0) - ((x == 0) ? LineWeight(o) : 0);
+}
+
+// the sum over every line from the board's per-line counts, from X's point of view
+static int CountedBoardScore(const MnkBoard &board)
+{
+    int score = 0;
+    for (int line = 0; line < (int)board.rules().lines().size(); ++line) {
+        score += LineScore(board, line);
+    }
+    return score;
+}
+
+// compile-time specialised kernels (engine/LineEval.h) for the boards the demo offers
+using LineKernel = int (*)(const MnkBoard &board);
+
+struct CompiledLineKernel
+{
+    int         width, height, winLength;
+    int         lines;
+    LineKernel  evaluate;
+};
+
+#define LINE_KERNEL(w, h, k) { w, h, k, LineTable<w, h, k>::COUNT, &LineEvaluate<w, h, k> }
+static const CompiledLineKernel LINE_KERNELS[] = {
+    LINE_KERNEL(3, 3, 3),
+    LINE_KERNEL(4, 4, 4),
+    LINE_KERNEL(5, 5, 4),
+    LINE_KERNEL(15, 15, 5),
+};
+#undef LINE_KERNEL
+
+static LineKernel FindLineKernel(const MnkRules &rules)
+{
+    for (const CompiledLineKernel &kernel : LINE_KERNELS) {
+        if (kernel.width == rules.width() && kernel.height == rules.height() && kernel.winLength == rules.winLength() &&
+            kernel.lines == (int)rules.lines().size()) {
+            return kernel.evaluate;
+        }
+    }
+    return nullptr;
+}
+
+static int BoardScore(const MnkBoard &board)
+{
+    if (const LineKernel kernel = FindLineKernel(board.rules())) {
+        return kernel(board);
+    }
+    return CountedBoardScore(board);
+}
+
+bool MnkHasCompiledEvaluator(const MnkRules &rules)
+{
+    return FindLineKernel(rules) != nullptr;
+}
+
+int MnkEvaluateCounted(const MnkBoard &board)
+{
+    const int score = CountedBoardScore(board);
+    return (board.sideToMove() == 1) ? score : -score;
+}
+
+int MnkEvaluate(const MnkBoard &board)
+{
+    const int score = BoardScore(board);
+    return (board.sideToMove() == 1) ? score : -score;
+}
+
+class MnkSearcher
+{
+public:
+    MnkSearcher(const MnkBoard &board) : _board(board), _score(BoardScore(board)), _nodes(0), _hitHorizon(false), _deadline(0), _nodeBudget(0), _rootMargin(0), _stop(nullptr), _sharedAbort(nullptr), _aborted(false), _threads(1), _book(nullptr), _dynamicOrdering(false), _moveTable(nullptr)
+    {
+        // try cells nearest the center first
+        const MnkRules &rules = board.rules();
+        const int cx2 = rules.width() - 1, cy2 = rules.height() - 1;
+        for (int cell = 0; cell < rules.cellCount(); ++cell) {
+            _cellOrder.push_back(cell);
+        }
+        auto distance = [&](int cell) {
+            const int dx = std::abs(2 * (cell % rules.width()) - cx2);
+            const int dy = std::abs(2 * (cell / rules.width()) - cy2);
+            return std::max(dx, dy) * 64 + dx + dy;
+        };
+        std::stable_sort(_cellOrder.begin(), _cellOrder.end(), [&](int a, int b) { return distance(a) < distance(b); });
+    }
+
+    MnkSearchResult run(const MnkSearchOptions &options)
+    {
+        MnkSearchResult result;
+        _start = std::chrono::steady_clock::now();
+        _deadline = options.timeBudget;
+        _nodeBudget = options.nodeBudget;
+        _rootMargin = MNK_SOFTMAX_MARGIN * std::max(0, options.temperature);
+        _stop = options.stop;
+        _threads = SearchThreadCount(options.threads);
+        _book = (options.book && options.book->isOpen()) ? options.book : nullptr;
+        _dynamicOrdering = options.dynamicOrdering;
+        _pvLines.assign(_board.rules().cellCount() + 2, std::vector<int>());
+        // a node's ply is at most the depth, and the board fills up before the ply passes its cells
+        const int cells = _board.rules().cellCount();
+        const size_t plies = (size_t)std::min(std::max(1, options.maxDepth), cells) + 2;
+        _moveBuffer.assign(plies * cells, -1);
+        _keyBuffer.assign(plies * cells, 0);
+        if (_dynamicOrdering) {
+            _moveTable = options.moveTable;
+            if (!_moveTable) {
+                _ownTable = std::make_shared<MnkMoveTable>();
+                _moveTable = _ownTable.get();
+            }
+            _killers.assign(_board.rules().cellCount() + 1, { -1, -1 });
+            _history.assign(2 * _board.rules().cellCount(), 0);
+        }
+        if (generateMoves(-1, 0) == 0 || _board.winner() != 0) {
+            result.solved = true;
+            return result;
+        }
+        result.move = movesAt(0)[0];
+
+        if (options.tablebase && options.tablebase->isOpen()) {
+            TablebaseValue value;
+            const int move = options.tablebase->bestMove(_board, value);
+            if (move >= 0) {
+                result.move = move;
+                result.value = bookScore(value - kTablebaseDraw, 0);
+                result.solved = true;
+                result.fromTablebase = true;
+                result.pv.push_back(move);
+                result.counters = _counters.report();
+                result.elapsed = elapsed();
+                return result;
+            }
+        }
+
+        OpeningBookEntry entry;
+        if (_book) ++_counters.bookProbes;
+        if (_book && _book->lookup(_board, entry) && entry.move >= 0) {
+            ++_counters.bookHits;
+            result.move = entry.move;
+            result.value = bookScore(entry.value, 0);
+            result.solved = true;
+            result.fromBook = true;
+            result.pv.push_back(entry.move);
+            result.counters = _counters.report();
+            result.elapsed = elapsed();
+            return result;
+        }
+
+        if (options.threatNodes > 0) {
+            MnkThreatSearchOptions threatOptions;
+            threatOptions.nodeBudget = options.threatNodes;
+            const MnkThreatSearchResult threat = MnkThreatSearch(_board, threatOptions);
+            _nodes += threat.nodes;
+            if (threat.win) {
+                result.move = threat.move;
+                result.value = MNK_SCORE_WIN - threat.plies;
+                result.solved = true;
+                result.fromThreatSearch = true;
+                result.pv.push_back(threat.move);
+                result.nodes = _nodes;
+                result.counters = _counters.report();
+                result.elapsed = elapsed();
+                return result;
+            }
+        }
+
+        const int maxDepth = std::max(1, options.maxDepth);
+        for (int depth = 1; depth <= maxDepth; ++depth) {
+            PROFILE_SCOPE("MnkSearch iteration");
+            _hitHorizon = false;
+            const uint64_t startNodes = _nodes;
+            int bestMove = -1;
+            int value = (_threads > 1) ? searchRootParallel(depth, result.move, bestMove)
+                                       : searchRoot(depth, result.move, bestMove);
+            if (_aborted) {
+                result.timedOut = true;
+                break;
+            }
+            result.move = bestMove;
+            result.value = value;
+            result.depth = depth;
+
+            MnkIterationStats stats;
+            stats.depth = depth;
+            stats.move = bestMove;
+            stats.value = value;
+            stats.nodes = _nodes - startNodes;
+            stats.elapsed = elapsed();
+            result.iterations.push_back(stats);
+            result.rootMoves = _rootMoves;
+            result.pv = _rootPv;
+
+            // nothing was cut off by the depth limit, or a forced result was found: deeper won't change it
+            if (!_hitHorizon || std::abs(value) >= MNK_WIN_THRESHOLD) {
+                result.solved = true;
+                break;
+            }
+        }
+        if (options.temperature > 0 && !result.rootMoves.empty()) {
+            const MnkRootMoveStats &pick = sampleRootMove(result.rootMoves, result.value, options.temperature, options.seed);
+            if (pick.move != result.move) {
+                result.move = pick.move;
+                result.value = pick.value;
+                result.pv.assign(1, pick.move);
+                result.sampled = true;
+            }
+        }
+        result.nodes = _nodes;
+        result.counters = _counters.report();
+        result.elapsed = elapsed();
+        return result;
+    }
+
+private:
+    // StatCounters (engine/SearchStats.h), added up from the root-split threads like _nodes
+    struct Counters
+    {
+        StatCounter tableProbes;
+        StatCounter tableHits;
+        StatCounter bookProbes;
+        StatCounter bookHits;
+        StatCounter cutoffs;
+        StatCounter firstMoveCutoffs;
+
+        void merge(const Counters &other)
+        {
+            tableProbes.add(other.tableProbes.value());
+            tableHits.add(other.tableHits.value());
+            bookProbes.add(other.bookProbes.value());
+            bookHits.add(other.bookHits.value());
+            cutoffs.add(other.cutoffs.value());
+            firstMoveCutoffs.add(other.firstMoveCutoffs.value());
+        }
+
+        MnkSearchCounters report() const
+        {
+            MnkSearchCounters counters;
+            counters.tableProbes = tableProbes.value();
+            counters.tableHits = tableHits.value();
+            counters.bookProbes = bookProbes.value();
+            counters.bookHits = bookHits.value();
+            counters.cutoffs = cutoffs.value();
+            counters.firstMoveCutoffs = firstMoveCutoffs.value();
+            return counters;
+        }
+    };
+
+    int64_t elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    //
+    // softmax over the exact root values; the best move is exact, so there is always one
+    //
+    static const MnkRootMoveStats &sampleRootMove(const std::vector<MnkRootMoveStats> &moves, int best, int temperature,
+                                                  uint32_t seed)
+    {
+        std::vector<double> weights(moves.size(), 0.0);
+        for (size_t i = 0; i < moves.size(); ++i) {
+            if (moves[i].exact && moves[i].value >= best - MNK_SOFTMAX_MARGIN * temperature) {
+                weights[i] = std::exp((double)(moves[i].value - best) / temperature);
+            }
+        }
+        std::mt19937 rng(seed);
+        return moves[std::discrete_distribution<size_t>(weights.begin(), weights.end())(rng)];
+    }
+
+    // make and unmake a move, keeping _score up to date from the lines through it alone
+    void play(int cell)
+    {
+        for (uint16_t line : _board.rules().linesThrough(cell)) _score -= LineScore(_board, line);
+        _board.makeMove(cell);
+        for (uint16_t line : _board.rules().linesThrough(cell)) _score += LineScore(_board, line);
+    }
+
+    void takeBack()
+    {
+        const int cell = _board.lastMove();
+        for (uint16_t line : _board.rules().linesThrough(cell)) _score -= LineScore(_board, line);
+        _board.unmakeMove();
+        for (uint16_t line : _board.rules().linesThrough(cell)) _score += LineScore(_board, line);
+    }
+
+    //
+    // a book value as a search score: the book knows a win is forced but not how far away it is,
+    // so it scores as if it took every empty cell, below any win the search proves outright;
+    // value is +1, 0 or -1 for the side to move, and a tablebase's value scores the same way
+    //
+    int bookScore(int value, int ply) const
+    {
+        const int plies = ply + _board.rules().cellCount() - _board.pieceCount();
+        return (value > 0) ? MNK_SCORE_WIN - plies : (value < 0) ? -(MNK_SCORE_WIN - plies) : 0;
+    }
+
+    // true once the time budget is spent or a stop was requested;
+    // only reads the clock and the stop flag every MNK_CLOCK_INTERVAL nodes
+    bool outOfTime()
+    {
+        if (!_aborted && (_nodes % MNK_CLOCK_INTERVAL) == 0) {
+            if ((_deadline > 0 && elapsed() >= _deadline) || (_nodeBudget > 0 && _nodes >= _nodeBudget) ||
+                (_stop && _stop->load(std::memory_order_relaxed)) ||
+                (_sharedAbort && _sharedAbort->load(std::memory_order_relaxed))) {
+                _aborted = true;
+                // the other root-split threads give up too
+                if (_sharedAbort) _sharedAbort->store(true, std::memory_order_relaxed);
+            }
+        }
+        return _aborted;
+    }
+
+    // the slices of _moveBuffer and _keyBuffer that belong to the node in progress at ply; a
+    // node's children only use the slices after it, so nothing is allocated per node
+    int *movesAt(int ply) { return &_moveBuffer[(size_t)ply * _board.rules().cellCount()]; }
+    int *keysAt(int ply) { return &_keyBuffer[(size_t)ply * _board.rules().cellCount()]; }
+
+    // empty cells worth considering, firstMove (if legal) in front, into movesAt(ply); the count
+    int generateMoves(int firstMove, int ply)
+    {
+        const MnkRules &rules = _board.rules();
+        const CellMask empty = _board.emptyCells();
+        CellMask candidates;
+        if (_board.pieceCount() == 0 || rules.neighbourhoodRadius() >= MNK_MAX_SIDE) {
+            candidates = empty;
+        } else {
+            CellMask stones = _board.stones(1);
+            stones |= _board.stones(2);
+            stones.forEach([&](int cell) { candidates |= rules.neighbourhood(cell); });
+            candidates &= empty;
+        }
+
+        int *moves = movesAt(ply);
+        int count = 0;
+        if (firstMove >= 0 && candidates.test(firstMove)) {
+            moves[count++] = firstMove;
+        }
+        for (int cell : _cellOrder) {
+            if (cell != firstMove && candidates.test(cell)) moves[count++] = cell;
+        }
+        return count;
+    }
+
+    int searchRoot(int depth, int firstMove, int &bestMove)
+    {
+        _nodes++;
+        int alpha = -MNK_SCORE_INF;
+        const int beta = MNK_SCORE_INF;
+        int best = -MNK_SCORE_INF;
+        _rootMoves.clear();
+        const int count = generateMoves(firstMove, 0);
+        const int *moves = movesAt(0);
+        for (int i = 0; i < count; ++i) {
+            const int cell = moves[i];
+            const uint64_t startNodes = _nodes;
+            play(cell);
+            int val = -search(depth - 1, -beta, -alpha, 1);
+            takeBack();
+            if (_aborted) break;
+            MnkRootMoveStats stats;
+            stats.move = cell;
+            stats.value = val;
+            stats.exact = val > alpha;
+            stats.nodes = _nodes - startNodes;
+            _rootMoves.push_back(stats);
+            if (val > best) {
+                setPv(_rootPv, cell, _pvLines[1]);
+                best = val;
+                bestMove = cell;
+            }
+            // with a temperature, moves a little below the best are still scored exactly
+            if (best - _rootMargin > alpha) alpha = best - _rootMargin;
+        }
+        return best;
+    }
+
+    //
+    // root split: the root moves are shared out between threads, each with its own copy of the
+    // searcher; alpha is shared so a thread's cutoffs use the best value any thread has found
+    // a move searched against a shared alpha may come back as only an upper bound, so the
+    // results are walked in move order and a bound that ties the best exact value from an
+    // earlier move is searched again; that picks the same move and value as searchRoot()
+    //
+    int searchRootParallel(int depth, int firstMove, int &bestMove)
+    {
+        _nodes++;
+        const int count = generateMoves(firstMove, 0);
+        const int *moves = movesAt(0);
+        const int threads = std::min(_threads, count);
+
+        std::vector<int> values(count), alphas(count);
+        std::vector<uint64_t> nodes(count);
+        std::vector<std::vector<int>> pvs(count);
+        std::atomic<int> sharedAlpha = -MNK_SCORE_INF;
+        std::atomic<bool> sharedAbort = false;
+        std::vector<MnkSearcher> workers(threads, *this);
+        for (MnkSearcher &worker : workers) {
+            worker._nodes = 0;
+            worker._hitHorizon = false;
+            worker._sharedAbort = &sharedAbort;
+            worker._counters = Counters();
+            // the threads share what is left of the node budget
+            if (_nodeBudget > 0) worker._nodeBudget = std::max<uint64_t>(1, (_nodeBudget - std::min(_nodes, _nodeBudget)) / threads);
+        }
+        ParallelFor(count, threads, [&](int i, int thread) {
+            MnkSearcher &worker = workers[thread];
+            const int alpha = std::max(-MNK_SCORE_INF, sharedAlpha.load() - _rootMargin);
+            const uint64_t startNodes = worker._nodes;
+            worker.play(moves[i]);
+            const int val = -worker.search(depth - 1, -MNK_SCORE_INF, -alpha, 1);
+            worker.takeBack();
+            values[i] = val;
+            alphas[i] = alpha;
+            nodes[i] = worker._nodes - startNodes;
+            if (val > alpha) setPv(pvs[i], moves[i], worker._pvLines[1]);
+            int seen = sharedAlpha.load();
+            while (!worker._aborted && val > seen && !sharedAlpha.compare_exchange_weak(seen, val)) {}
+        });
+        for (const MnkSearcher &worker : workers) {
+            _nodes += worker._nodes;
+            _hitHorizon |= worker._hitHorizon;
+            _aborted |= worker._aborted;
+            _counters.merge(worker._counters);
+        }
+        if (_aborted) {
+            return 0;
+        }
+
+        // anything above the alpha it was searched against is exact
+        int best = -MNK_SCORE_INF;
+        int bestIndex = -1;
+        for (int i = 0; i < count; ++i) {
+            if (values[i] > alphas[i] && values[i] > best) {
+                best = values[i];
+                bestIndex = i;
+            }
+        }
+        _rootMoves.assign(count, MnkRootMoveStats());
+        for (int i = 0; i < count; ++i) {
+            _rootMoves[i].move = moves[i];
+            _rootMoves[i].value = values[i];
+            _rootMoves[i].exact = values[i] > alphas[i];
+            _rootMoves[i].nodes = nodes[i];
+        }
+        // an earlier move whose upper bound reaches best is at least as good if a null window says so
+        for (int i = 0; i < bestIndex; ++i) {
+            if (values[i] > alphas[i] || values[i] < best) continue;
+            play(moves[i]);
+            const uint64_t startNodes = _nodes;
+            const int val = -search(depth - 1, -best, -best + 1, 1);
+            takeBack();
+            if (_aborted) return 0;
+            _rootMoves[i].nodes += _nodes - startNodes;
+            if (val >= best) {
+                // its upper bound was no more than best, so its value is best exactly
+                _rootMoves[i].value = best;
+                _rootMoves[i].exact = true;
+                setPv(pvs[i], moves[i], _pvLines[1]);
+                bestIndex = i;
+                break;
+            }
+        }
+        bestMove = moves[bestIndex];
+        _rootPv = pvs[bestIndex];
+        return best;
+    }
+
+    int search(int depth, int alpha, int beta, int ply)
+    {
+        _nodes++;
+        _pvLines[ply].clear();
+        if (outOfTime()) {
+            // the whole iteration is thrown away, so any value will do
+            return 0;
+        }
+        if (_board.winner() != 0) {
+            // the previous move completed a line
+            return -(MNK_SCORE_WIN - ply);
+        }
+        if (_board.full()) {
+            return 0;
+        }
+        OpeningBookEntry entry;
+        if (_book && _board.pieceCount() <= _book->maxPly()) {
+            ++_counters.bookProbes;
+            if (_book->lookup(_board, entry)) {
+                ++_counters.bookHits;
+                return bookScore(entry.value, ply);
+            }
+        }
+        if (depth <= 0) {
+            _hitHorizon = true;
+            return (_board.sideToMove() == 1) ? _score : -_score;
+        }
+
+        const int count = generateMoves(-1, ply);
+        int *moves = movesAt(ply);
+        int *keys = keysAt(ply);
+        // one ply from the horizon a move costs little more to search than to order
+        const bool ordered = _dynamicOrdering && depth >= 2;
+        if (ordered) orderKeys(moves, count, ply, probeMoveTable(), keys);
+
+        int best = -MNK_SCORE_INF;
+        int bestMove = -1;
+        for (int i = 0; i < count; ++i) {
+            if (ordered) {
+                // selection sort as we go: a cutoff usually comes before the tail needs ordering
+                int pick = i;
+                for (int j = i + 1; j < count; ++j) {
+                    if (keys[j] > keys[pick]) pick = j;
+                }
+                std::swap(moves[i], moves[pick]);
+                std::swap(keys[i], keys[pick]);
+            }
+            const int cell = moves[i];
+            play(cell);
+            int val = -search(depth - 1, -beta, -alpha, ply + 1);
+            takeBack();
+            if (_aborted) break;
+            if (val > alpha) setPv(_pvLines[ply], cell, _pvLines[ply + 1]);
+            if (val > best) {
+                best = val;
+                bestMove = cell;
+            }
+            if (best > alpha) alpha = best;
+            if (alpha >= beta) {
+                ++_counters.cutoffs;
+                if (i == 0) ++_counters.firstMoveCutoffs;
+                if (ordered) recordCutoff(cell, depth, ply, keys[i]);
+                break;
+            }
+        }
+        if (_dynamicOrdering && bestMove >= 0 && !_aborted) {
+            _moveTable->store(_board.hash(), bestMove);
+        }
+        return best;
+    }
+
+    // the best-move table's move for this position, -1 if it has none
+    int probeMoveTable()
+    {
+        ++_counters.tableProbes;
+        const int move = _moveTable->probe(_board.hash());
+        if (move >= 0) ++_counters.tableHits;
+        return move;
+    }
+
+    // a move that raised alpha, followed by the line it was searched with; the lines keep
+    // their capacity, so after the first few iterations this doesn't allocate
+    static void setPv(std::vector<int> &pv, int move, const std::vector<int> &rest)
+    {
+        pv.clear();
+        pv.push_back(move);
+        pv.insert(pv.end(), rest.begin(), rest.end());
+    }
+
+    // ordering key of every move into keys, see ORDER_TABLE_MOVE
+    void orderKeys(const int *moves, int count, int ply, int tableMove, int *keys) const
+    {
+        const MnkRules &rules = _board.rules();
+        const int side = _board.sideToMove();
+        const int other = 3 - side;
+        const int need = rules.winLength() - 1;
+        const std::array<int16_t, 2> &killers = _killers[ply];
+
+        for (int i = 0; i < count; ++i) {
+            const int cell = moves[i];
+            int key = _history[2 * cell + side - 1];
+            if (cell == tableMove) {
+                key = ORDER_TABLE_MOVE;
+            } else {
+                bool wins = false, blocks = false;
+                for (uint16_t line : rules.linesThrough(cell)) {
+                    const int own = _board.lineCount(side, line);
+                    const int theirs = _board.lineCount(other, line);
+                    wins |= (own == need && theirs == 0);
+                    blocks |= (theirs == need && own == 0);
+                }
+                if (wins) key = ORDER_WIN;
+                else if (blocks) key = ORDER_BLOCK;
+                else if (cell == killers[0]) key = ORDER_KILLER;
+                else if (cell == killers[1]) key = ORDER_KILLER - 1;
+            }
+            keys[i] = key;
+        }
+    }
+
+    // a quiet move (not the table move or a threat) that caused a cutoff becomes a killer at
+    // this ply and earns history for its side
+    void recordCutoff(int cell, int depth, int ply, int key)
+    {
+        if (key >= ORDER_BLOCK) {
+            return;
+        }
+        std::array<int16_t, 2> &killers = _killers[ply];
+        if (killers[0] != cell) {
+            killers[1] = killers[0];
+            killers[0] = (int16_t)cell;
+        }
+        int &history = _history[2 * cell + _board.sideToMove() - 1];
+        history += depth * depth;
+        if (history >= HISTORY_LIMIT) {
+            for (int &h : _history) h /= 2;
+        }
+    }
+
+    MnkBoard            _board;
+    int                 _score;             // BoardScore(_board), kept up to date by place()
+    std::vector<int>    _cellOrder;
+    uint64_t            _nodes;
+    bool                _hitHorizon;
+    std::chrono::steady_clock::time_point _start;
+    int64_t             _deadline;          // microseconds after _start, 0 = none
+    uint64_t            _nodeBudget;        // 0 = none
+    int                 _rootMargin;        // below the best root value that is still scored exactly
+    const std::atomic<bool> *_stop;
+    std::atomic<bool>  *_sharedAbort;       // set by whichever root-split thread runs out of time first
+    bool                _aborted;
+    int                 _threads;
+    const OpeningBook   *_book;
+    Counters            _counters;
+    std::vector<MnkRootMoveStats> _rootMoves;   // of the iteration in progress
+    // triangular principal variation: _pvLines[ply] is the best line found from the node in
+    // progress at that ply, rebuilt from _pvLines[ply + 1] whenever a move raises alpha
+    std::vector<std::vector<int>> _pvLines;
+    std::vector<int>    _rootPv;
+    // a cell count of moves and of ordering keys per ply, see movesAt()
+    std::vector<int>    _moveBuffer;
+    std::vector<int>    _keyBuffer;
+
+    bool                _dynamicOrdering;
+    // best or cutoff move last seen in a position, ordering only; the root-split copies share it
+    MnkMoveTable        *_moveTable;
+    std::shared_ptr<MnkMoveTable> _ownTable;    // when the options give none
+    std::vector<std::array<int16_t, 2>> _killers;   // per ply
+    std::vector<int>    _history;               // [2 * cell + side - 1], depth^2 per cutoff
+};
+
+MnkMoveTable::MnkMoveTable(size_t entries)
+{
+    size_t size = 1;
+    while (size < entries) size <<= 1;
+    _entries = std::make_unique<std::atomic<uint64_t>[]>(size);
+    _mask = size - 1;
+    clear();
+}
+
+void MnkMoveTable::clear()
+{
+    for (uint64_t i = 0; i <= _mask; ++i) {
+        _entries[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+MnkSearchResult MnkSearchBestMove(const MnkBoard &board, const MnkSearchOptions &options)
+{
+    PROFILE_SCOPE("MnkSearchBestMove");
+    MnkSearcher searcher(board);
+    return searcher.run(options);
+}
+
+void MnkApplyStrength(MnkSearchOptions &options, MnkStrength strength)
+{
+    if (strength == kMnkStrengthHard) {
+        return;
+    }
+    const bool easy = strength == kMnkStrengthEasy;
+    options.maxDepth = std::min(options.maxDepth, easy ? 1 : 3);
+    options.nodeBudget = easy ? 2000 : 50000;
+    // open-line weights go 1, 8, 64, ... a stone, so easy often passes up a line one stone
+    // longer and medium seldom does
+    options.temperature = easy ? 48 : 12;
+    options.threatNodes = 0;
+    options.book = nullptr;
+    options.tablebase = nullptr;
+}
+
+const char *MnkStrengthName(MnkStrength strength)
+{
+    switch (strength) {
+    case kMnkStrengthEasy:      return "easy";
+    case kMnkStrengthMedium:    return "medium";
+    case kMnkStrengthHard:      return "hard";
+    }
+    return "unknown";
+}
+
+bool ParseMnkStrength(const char *name, MnkStrength &strength)
+{
+    for (int s = kMnkStrengthEasy; s <= kMnkStrengthHard; ++s) {
+        if (strcmp(name, MnkStrengthName((MnkStrength)s)) == 0) {
+            strength = (MnkStrength)s;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "MnkBoard.h"
+
+class OpeningBook;
+class Tablebase;
+
+//
+// search for the m,n,k engine: iterative deepening alpha-beta negamax
+// boards small enough are searched to the end of the game; otherwise the leaves are scored
+// by a static evaluation of open lines
+// below the root, moves are ordered by a best-move table, threats, killers and history
+// with a time budget, an iteration that runs out of time is abandoned and the move from the
+// last completed iteration is returned, which bounds the worst-case time per move
+// scores are from the side to move's point of view; forced wins score MNK_SCORE_WIN - plies
+//
+
+constexpr int MNK_SCORE_WIN = 1000000;
+constexpr int MNK_SCORE_INF = 2000000;
+constexpr int MNK_WIN_THRESHOLD = MNK_SCORE_WIN - MNK_MAX_CELLS - 1;   // any score beyond this is a forced result
+// with a temperature, root moves within this many temperatures of the best get exact values;
+// the rest fail low as usual and are never drawn (their weight would be below e^-4)
+constexpr int MNK_SOFTMAX_MARGIN = 4;
+
+// best-move table entries (a power of two), indexed by the low bits of the Zobrist hash
+constexpr size_t MNK_MOVE_TABLE_SIZE = 1 << 16;
+
+//
+// the search's best-move table, which only orders moves; a search makes its own unless given
+// one, which then carries over to the next search: it starts with the moves the last one found,
+// and pondering (engine/MnkPonder.h) fills it for the opponent's likely replies
+// an entry is one 64-bit atomic, the hash's high 48 bits over the move, so the root-split
+// threads share it without locks; a torn pair of stores can't happen, a lost one costs nothing
+//
+class MnkMoveTable
+{
+public:
+    // entries is rounded up to a power of two
+    explicit MnkMoveTable(size_t entries = MNK_MOVE_TABLE_SIZE);
+
+    // the move stored for hash, -1 if none
+    int         probe(uint64_t hash) const
+    {
+        const uint64_t entry = _entries[hash & _mask].load(std::memory_order_relaxed);
+        return ((entry ^ hash) >> 16) == 0 ? (int)(entry & 0xffff) - 1 : -1;
+    }
+    void        store(uint64_t hash, int move)
+    {
+        _entries[hash & _mask].store((hash & ~(uint64_t)0xffff) | (uint64_t)(move + 1), std::memory_order_relaxed);
+    }
+    void        clear();
+    size_t      sizeInBytes() const { return (_mask + 1) * sizeof(uint64_t); }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> _entries;
+    uint64_t    _mask;
+};
+
+// how well the AI plays; weaker levels search less, never more (MnkApplyStrength())
+enum MnkStrength
+{
+    kMnkStrengthEasy,
+    kMnkStrengthMedium,
+    kMnkStrengthHard,
+};
+
+struct MnkSearchOptions
+{
+    int         maxDepth = MNK_MAX_CELLS;   // plies, the search stops early once the game is solved
+    int64_t     timeBudget = 0;             // wall-clock microseconds, 0 = no limit
+    // the search stops as if out of time after this many nodes (to within a few hundred), the
+    // threat pre-check's included; unlike the time budget it plays the same on any machine
+    uint64_t    nodeBudget = 0;
+    // set by another thread to end the search early, it then behaves as if out of time
+    const std::atomic<bool> *stop = nullptr;
+    // threads that split the root moves, 0 = one per hardware thread; a search that runs to
+    // its depth limit picks the same move and value as with one thread
+    int         threads = 1;
+    // solved positions (engine/OpeningBook.h) for the same rules: a position in the book isn't
+    // searched, at the root or below it
+    const OpeningBook *book = nullptr;
+    // every position of the board solved (engine/Tablebase.h): the root's move is read from it
+    // and nothing is searched; it is only probed at the root, as a probe per node would cost
+    // more than the transposition table it replaces on boards this small
+    const Tablebase *tablebase = nullptr;
+    // below the root, try moves in the order a best-move table, threats (a win, then a block),
+    // two killer moves per ply and the history heuristic suggest; false keeps the fixed
+    // centre-out order, which searches the same tree to the same value with more nodes
+    bool        dynamicOrdering = true;
+    // the best-move table to use and keep filled, shared with later searches; nullptr = a table
+    // of the search's own; only one search may use a table at a time
+    MnkMoveTable *moveTable = nullptr;
+    // node budget of the threat-space pre-check (engine/ThreatSearch.h) run before the main
+    // search: a forced win by continuous fours is played without searching; 0 = off
+    uint64_t    threatNodes = 20000;
+    // softmax over the root moves' values: a move is drawn with weight
+    // exp((value - best) / temperature) from a generator seeded with seed, so a weaker move is
+    // played now and then and a much weaker one never; the root window is widened by
+    // MNK_SOFTMAX_MARGIN temperatures to score the close moves, in the same search; 0 = the best
+    int         temperature = 0;
+    uint32_t    seed = 0;
+};
+
+// one completed iteration of the iterative deepening
+struct MnkIterationStats
+{
+    int         depth = 0;
+    int         move = -1;
+    int         value = 0;
+    uint64_t    nodes = 0;          // nodes in this iteration only
+    int64_t     elapsed = 0;        // microseconds since the search started
+};
+
+// a root move of the last completed iteration; alpha-beta only proves the best move's value,
+// a move that failed low has exact = false and value is an upper bound
+struct MnkRootMoveStats
+{
+    int         move = -1;
+    int         value = 0;
+    bool        exact = false;
+    uint64_t    nodes = 0;          // nodes below this move in that iteration
+};
+
+//
+// what the search did, for the telemetry panel and the bench; counted through StatCounter
+// (engine/SearchStats.h), so every field is 0 in a build without TICTACTOE_SEARCH_STATS
+// the best-move table is the m,n,k engine's transposition table: it only keeps a move, so a
+// hit orders the move first rather than ending the search
+//
+struct MnkSearchCounters
+{
+    uint64_t    tableProbes = 0;
+    uint64_t    tableHits = 0;
+    uint64_t    bookProbes = 0;
+    uint64_t    bookHits = 0;
+    uint64_t    cutoffs = 0;            // beta cutoffs below the root
+    uint64_t    firstMoveCutoffs = 0;   // ... by the first move tried, a measure of the ordering
+};
+
+struct MnkSearchResult
+{
+    int         move = -1;          // cell index, -1 if there is no legal move
+    int         value = 0;
+    int         depth = 0;          // depth of the last completed iteration
+    uint64_t    nodes = 0;          // all nodes, including an abandoned last iteration
+    int64_t     elapsed = 0;        // microseconds
+    bool        timedOut = false;   // the time budget stopped an iteration part way
+    // value is exact: the game tree was exhausted or a forced result found
+    // (on boards that only search near existing stones, a forced result among those moves)
+    bool        solved = false;
+    bool        fromBook = false;   // the root position was in the opening book
+    bool        fromTablebase = false;  // the move was read from the tablebase
+    bool        fromThreatSearch = false;   // the threat-space pre-check found a forced win
+    bool        sampled = false;    // the temperature picked a move other than the best
+    std::vector<MnkIterationStats> iterations;
+    // expected line of play from move on, from the last completed iteration; it ends at the
+    // depth limit, the end of the game or a position the book answered
+    std::vector<int> pv;
+    std::vector<MnkRootMoveStats> rootMoves;    // in the order they were searched
+    MnkSearchCounters counters;
+};
+
+// heuristic score of a position for its side to move, without searching: LineWeight() of
+// every open line (engine/LineEval.h), through a compile-time kernel for the demo's boards
+int             MnkEvaluate(const MnkBoard &board);
+// the same from the board's per-line counts, which works for any size; the kernels must agree
+int             MnkEvaluateCounted(const MnkBoard &board);
+bool            MnkHasCompiledEvaluator(const MnkRules &rules);
+
+MnkSearchResult MnkSearchBestMove(const MnkBoard &board, const MnkSearchOptions &options = MnkSearchOptions());
+
+// limits options to a level: easy looks one ply ahead within 2,000 nodes and picks freely
+// among moves close to the best, medium 3 plies within 50,000 nodes and rarely strays; both
+// skip the book, the tablebase and the threat pre-check; hard leaves options as they are
+// on 3x3 against perfect play, easy loses about 80% of its games and medium about 6%
+void            MnkApplyStrength(MnkSearchOptions &options, MnkStrength strength);
+const char      *MnkStrengthName(MnkStrength strength);
+// false if name isn't one of MnkStrengthName()'s
+bool            ParseMnkStrength(const char *name, MnkStrength &strength);
@@ -0,0 +1,106 @@
+#include "MoveHistory.h"
+#include <algorithm>
+#include <bit>
+
+void MoveHistory::reset(std::string_view startState)
+{
+    _cellCount = (int)startState.size();
+    _stride = (size_t)(_cellCount + 3) / 4;
+    _moves.clear();
+    _boards.clear();
+    _cursor = 0;
+    _moves.push_back(-1);
+    _boards.resize(_stride, 0);
+    for (int cell = 0; cell < _cellCount; ++cell) {
+        _boards[cell / 4] |= (uint8_t)(((startState[cell] - '0') & 3) << (2 * (cell % 4)));
+    }
+}
+
+void MoveHistory::push(std::string_view state)
+{
+    if (_moves.empty()) {
+        reset(state);
+        return;
+    }
+    // a new turn after an undo replaces whatever could have been redone
+    _moves.resize(_cursor + 1);
+    _boards.resize((_cursor + 1) * _stride);
+
+    const size_t previous = _cursor;
+    const size_t offset = _boards.size();
+    _boards.resize(offset + _stride, 0);
+    int move = -1;
+    for (int cell = 0; cell < _cellCount; ++cell) {
+        const int value = (cell < (int)state.size()) ? ((state[cell] - '0') & 3) : 0;
+        if (move < 0 && value != cellAt(previous, cell)) move = cell;
+        _boards[offset + cell / 4] |= (uint8_t)(value << (2 * (cell % 4)));
+    }
+    _moves.push_back((int16_t)move);
+    _cursor = _moves.size() - 1;
+}
+
+void MoveHistory::pushMove(int cell, int player)
+{
+    if (_moves.empty() || cell < 0 || cell >= _cellCount) {
+        return;
+    }
+    _moves.resize(_cursor + 1);
+    _boards.resize((_cursor + 2) * _stride);
+    uint8_t *board = &_boards[(_cursor + 1) * _stride];
+    std::copy_n(&_boards[_cursor * _stride], _stride, board);
+    const int shift = 2 * (cell % 4);
+    board[cell / 4] = (uint8_t)((board[cell / 4] & ~(3 << shift)) | ((player & 3) << shift));
+    _moves.push_back((int16_t)cell);
+    _cursor = _moves.size() - 1;
+}
+
+bool MoveHistory::singleMoveAt(size_t entry) const
+{
+    if (entry == 0 || entry >= _moves.size() || _moves[entry] < 0) {
+        return false;
+    }
+    int changed = 0;
+    const uint8_t *board = &_boards[entry * _stride];
+    const uint8_t *previous = board - _stride;
+    for (size_t i = 0; i < _stride; ++i) {
+        const uint8_t diff = board[i] ^ previous[i];
+        // one bit per cell that changed, whichever of its two bits did
+        changed += std::popcount((unsigned)((diff | (diff >> 1)) & 0x55));
+    }
+    return changed == 1;
+}
+
+bool MoveHistory::undo()
+{
+    if (!canUndo()) return false;
+    _cursor--;
+    return true;
+}
+
+bool MoveHistory::redo()
+{
+    if (!canRedo()) return false;
+    _cursor++;
+    return true;
+}
+
+void MoveHistory::seek(size_t entry)
+{
+    if (_moves.empty()) return;
+    _cursor = std::min(entry, _moves.size() - 1);
+}
+
+void MoveHistory::stateAt(size_t entry, std::string &out) const
+{
+    out.resize(_cellCount);
+    for (int cell = 0; cell < _cellCount; ++cell) {
+        out[cell] = (char)('0' + cellAt(entry, cell));
+    }
+}
+
+std::string MoveHistory::stateAt(size_t entry) const
+{
+    std::string state;
+    stateAt(entry, state);
+    return state;
+}
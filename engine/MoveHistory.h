@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// compact turn history for any board that has a state string ('0' empty, '1' X, '2' O per cell)
+// each entry is the cell that changed plus the board packed at 2 bits per cell, all held in
+// two flat arrays, so recording a turn costs no allocation once the arrays have grown
+// (a 3x3 turn is 5 bytes, a 15x15 one 59); state strings are rebuilt on demand
+// entry 0 is the start position; undo/redo move a cursor, and recording a new turn after an
+// undo drops the turns that could have been redone
+//
+
+class MoveHistory
+{
+public:
+    MoveHistory() = default;
+
+    // forget everything and start from startState
+    void        reset(std::string_view startState);
+
+    // records the position after a turn; the move is the first cell that differs from the
+    // current entry, -1 if none does
+    void        push(std::string_view state);
+    // records a turn that put player (1 or 2, 0 to clear) into cell, without a state string
+    void        pushMove(int cell, int player);
+
+    size_t      size() const { return _moves.size(); }
+    size_t      cursor() const { return _cursor; }
+    // turns played to reach the current entry
+    size_t      turn() const { return _cursor; }
+
+    bool        canUndo() const { return _cursor > 0; }
+    bool        canRedo() const { return _cursor + 1 < _moves.size(); }
+    bool        undo();
+    bool        redo();
+    // jump to any recorded entry, clamped to the last one
+    void        seek(size_t entry);
+
+    // the cell changed by the turn that led to entry, -1 for the start position
+    int         moveAt(size_t entry) const { return _moves[entry]; }
+    // entry differs from the one before it in exactly moveAt(entry), so stepping between the
+    // two only has to touch that cell
+    bool        singleMoveAt(size_t entry) const;
+    std::string stateAt(size_t entry) const;
+    // writes into out so a replay loop can reuse one string
+    void        stateAt(size_t entry, std::string &out) const;
+    std::string currentState() const { return stateAt(_cursor); }
+
+    int         cellCount() const { return _cellCount; }
+    // 0 empty, 1 or 2, at entry
+    int         playerAt(size_t entry, int cell) const { return cellAt(entry, cell); }
+    size_t      sizeInBytes() const { return _moves.size() * sizeof(int16_t) + _boards.size(); }
+
+private:
+    int cellAt(size_t entry, int cell) const
+    {
+        return (_boards[entry * _stride + cell / 4] >> (2 * (cell % 4))) & 3;
+    }
+
+    int                     _cellCount = 0;
+    size_t                  _stride = 0;        // bytes per packed board
+    std::vector<int16_t>    _moves;
+    std::vector<uint8_t>    _boards;
+    size_t                  _cursor = 0;
+};
@@ -0,0 +1,375 @@
+#include "MoveServer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+MoveServer::MoveServer(const MoveServerConfig &config)
+    : _config(config), _service(std::make_unique<MoveService>(config.threads)), _listener(INVALID_SOCKET_HANDLE), _wakeup(INVALID_SOCKET_HANDLE)
+{
+    if (SocketStartup()) {
+        _wakeup = SocketWakeupPair();
+    }
+    // the service answers on its own threads; the loop is asleep in SocketPoll() until told
+    _service->setReplyCallback([this] { SocketSignal(_wakeup); });
+}
+
+MoveServer::~MoveServer()
+{
+    _service.reset();
+    for (const auto &entry : _connections) {
+        SocketClose(entry.second->socket);
+    }
+    if (_listener != INVALID_SOCKET_HANDLE) SocketClose(_listener);
+    if (_wakeup != INVALID_SOCKET_HANDLE) SocketClose(_wakeup);
+}
+
+bool MoveServer::listen(std::string &error)
+{
+    if (_wakeup == INVALID_SOCKET_HANDLE) {
+        error = "can't create the wake-up socket: " + SocketError();
+        return false;
+    }
+    _listener = SocketListen(_config.port, _config.anyAddress);
+    if (_listener == INVALID_SOCKET_HANDLE) {
+        error = "can't listen on port " + std::to_string(_config.port) + ": " + SocketError();
+        return false;
+    }
+    _port = SocketLocalPort(_listener);
+    return true;
+}
+
+void MoveServer::stop()
+{
+    _quit = true;
+    SocketSignal(_wakeup);
+}
+
+void MoveServer::run()
+{
+    if (_listener == INVALID_SOCKET_HANDLE) {
+        return;
+    }
+    ProfilerSetThreadName("move server");
+    std::vector<SocketPollEntry> entries;
+    std::vector<Connection *> polled;
+    while (!_quit) {
+        entries.clear();
+        polled.clear();
+        entries.push_back(SocketPollEntry{ _listener });
+        entries.push_back(SocketPollEntry{ _wakeup });
+        // lines left in a throttled connection's input are handled as soon as it drains, with or
+        // without anything new on its socket
+        bool linesWaiting = false;
+        for (const auto &entry : _connections) {
+            Connection &connection = *entry.second;
+            const bool over = backlogged(connection);
+            if (!over && hasLines(connection)) linesWaiting = true;
+            // a hung-up client polls as readable for good; its loop wake-ups come from the service
+            if (connection.closing && connection.output.empty()) {
+                continue;
+            }
+            SocketPollEntry poll{ connection.socket };
+            poll.wantRead = !connection.closing && !over;
+            poll.wantWrite = !connection.output.empty();
+            entries.push_back(poll);
+            polled.push_back(&connection);
+        }
+        if (SocketPoll(entries.data(), entries.size(), linesWaiting ? 0 : -1) < 0) {
+            fprintf(stderr, "move server: poll failed: %s\n", SocketError().c_str());
+            break;
+        }
+        PROFILE_SCOPE("MoveServer iteration");
+        if (entries[1].readable) {
+            SocketDrain(_wakeup);
+        }
+        if (linesWaiting) {
+            for (const auto &entry : _connections) {
+                handleInput(*entry.second);
+            }
+        }
+        for (size_t i = 0; i < polled.size(); ++i) {
+            if (entries[i + 2].readable && !polled[i]->closing && !backlogged(*polled[i])) readFrom(*polled[i]);
+        }
+        for (const auto &entry : _connections) {
+            Connection &connection = *entry.second;
+            const bool over = backlogged(connection);
+            if (over && !connection.throttled) _stats.throttled++;
+            connection.throttled = over;
+        }
+        // the requests of every connection read above go to the service as one batch
+        _service->submit(_batch);
+        deliverAnswers();
+        for (auto entry = _connections.begin(); entry != _connections.end();) {
+            if (flush(*entry->second)) {
+                ++entry;
+            } else {
+                SocketClose(entry->second->socket);
+                entry = _connections.erase(entry);
+            }
+        }
+        // after the others, so a connection is never polled before its first iteration
+        if (entries[0].readable) {
+            acceptAll();
+        }
+    }
+}
+
+void MoveServer::acceptAll()
+{
+    for (;;) {
+        const SocketHandle socket = SocketAccept(_listener);
+        if (socket == INVALID_SOCKET_HANDLE) {
+            return;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->socket = socket;
+        connection->id = _nextConnection++;
+        _connections.emplace(connection->id, std::move(connection));
+        _stats.connections++;
+    }
+}
+
+void MoveServer::readFrom(Connection &connection)
+{
+    char buffer[16384];
+    // past the caps the rest stays in the socket, and the client's sends block once it's full
+    while (!backlogged(connection)) {
+        const long received = SocketReceive(connection.socket, buffer, sizeof(buffer));
+        if (received == -2) {
+            return;
+        }
+        if (received <= 0) {
+            // the client is done sending: answer what it asked, then close
+            connection.closing = true;
+            return;
+        }
+        connection.input.append(buffer, (size_t)received);
+        handleInput(connection);
+    }
+}
+
+void MoveServer::handleInput(Connection &connection)
+{
+    size_t start = 0;
+    for (size_t end = connection.input.find('\n'); end != std::string::npos && !backlogged(connection);
+         end = connection.input.find('\n', start)) {
+        handleLine(connection, std::string_view(connection.input).substr(start, end - start));
+        start = end + 1;
+    }
+    connection.input.erase(0, start);
+    // whole lines wait in the input only while the connection is throttled; without them it's one unfinished line
+    if (connection.input.size() > _config.maxLine && !hasLines(connection)) {
+        Reply reply;
+        reply.ready = true;
+        reply.text = "ERR request line too long\n";
+        connection.replies.push_back(std::move(reply));
+        connection.input.clear();
+        connection.closing = true;
+    }
+}
+
+bool MoveServer::backlogged(const Connection &connection) const
+{
+    return connection.replies.size() >= _config.maxPending || connection.output.size() >= _config.maxOutput;
+}
+
+bool MoveServer::hasLines(const Connection &connection) const
+{
+    return connection.input.find('\n') != std::string::npos;
+}
+
+void MoveServer::handleLine(Connection &connection, std::string_view line)
+{
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.remove_suffix(1);
+    while (!line.empty() && line.front() == ' ') line.remove_prefix(1);
+    if (line.empty()) {
+        return;
+    }
+    const size_t space = line.find(' ');
+    const std::string_view command = line.substr(0, space);
+    const std::string_view arguments = (space == std::string_view::npos) ? std::string_view() : line.substr(space + 1);
+
+    Reply reply;
+    reply.received = ProfilerNow();
+    reply.ready = true;
+    if (command == "MOVE") {
+        reply.timed = true;
+        MoveQuery query;
+        std::string error;
+        if (parseMove(arguments, query, error)) {
+            query.tag = _nextTag++;
+            _waiting[query.tag] = Waiting{ connection.id, connection.firstSeq + connection.replies.size() };
+            _batch.push_back(std::move(query));
+            reply.ready = false;
+        } else {
+            reply.text = "ERR " + error + "\n";
+        }
+    } else if (command == "STATS") {
+        reply.stats = true;
+    } else if (command == "PING") {
+        reply.text = "PONG\n";
+    } else {
+        reply.text = "ERR unknown command, expected MOVE, STATS or PING\n";
+    }
+    connection.replies.push_back(std::move(reply));
+}
+
+bool MoveServer::parseMove(std::string_view arguments, MoveQuery &query, std::string &error)
+{
+    std::vector<std::string> tokens;
+    for (size_t start = 0; start < arguments.size();) {
+        const size_t end = std::min(arguments.find(' ', start), arguments.size());
+        if (end > start) tokens.emplace_back(arguments.substr(start, end - start));
+        start = end + 1;
+    }
+    if (tokens.empty() || tokens.size() > 3) {
+        error = "expected MOVE <state> [WxHxK] [ENGINE[:DEPTH][:LEVEL]]";
+        return false;
+    }
+
+    int width = 3, height = 3, winLength = 3;
+    bool engineGiven = false;
+    SelfPlayPlayer player;
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        char rest = 0;
+        if (sscanf(tokens[i].c_str(), "%dx%dx%d%c", &width, &height, &winLength, &rest) == 3) {
+            if (width < 1 || height < 1 || width > MNK_MAX_SIDE || height > MNK_MAX_SIDE || winLength < 1 ||
+                winLength > std::max(width, height)) {
+                error = "board sizes run from 1x1 to " + std::to_string(MNK_MAX_SIDE) + "x" + std::to_string(MNK_MAX_SIDE);
+                return false;
+            }
+            continue;
+        }
+        if (engineGiven || !ParseSelfPlayPlayer(tokens[i].c_str(), player)) {
+            error = "unknown engine " + tokens[i] + ", expected random, negamax, alphabeta, pvs, table or mnk, "
+                    "then :DEPTH or :easy, :medium or :hard";
+            return false;
+        }
+        engineGiven = true;
+    }
+
+    const std::string &state = tokens[0];
+    if ((int)state.size() != width * height) {
+        error = "the state has " + std::to_string(state.size()) + " cells, a " + std::to_string(width) + "x" +
+                std::to_string(height) + " board " + std::to_string(width * height);
+        return false;
+    }
+    int stones[3] = {};
+    for (char c : state) {
+        if (c < '0' || c > '2') {
+            error = "the state may only hold 0, 1 and 2";
+            return false;
+        }
+        stones[c - '0']++;
+    }
+    if (stones[1] != stones[2] && stones[1] != stones[2] + 1) {
+        error = "not a position from a game: X moves first and the sides alternate";
+        return false;
+    }
+
+    query.rules = rulesFor(width, height, winLength);
+    MnkBoard board(*query.rules);
+    board.setStateString(state);
+    if (board.gameOver()) {
+        error = "the game is over";
+        return false;
+    }
+    const bool classic = width == 3 && height == 3 && winLength == 3;
+    if (!engineGiven) {
+        player = classic ? _config.classicPlayer : _config.mnkPlayer;
+    }
+    // the 3x3 engines search other boards with the m,n,k search, so they get its depth limit too
+    if (player.engine == kEngineMnk || (!classic && player.engine != kEngineRandom)) {
+        player.depth = (player.depth == 0) ? _config.maxDepth : std::min(player.depth, _config.maxDepth);
+    }
+    player.timeBudget = 0;
+    query.state = state;
+    query.player = player;
+    return true;
+}
+
+std::shared_ptr<const MnkRules> MoveServer::rulesFor(int width, int height, int winLength)
+{
+    for (const std::shared_ptr<const MnkRules> &rules : _rules) {
+        if (rules->width() == width && rules->height() == height && rules->winLength() == winLength) {
+            return rules;
+        }
+    }
+    _rules.push_back(std::make_shared<const MnkRules>(width, height, winLength));
+    return _rules.back();
+}
+
+void MoveServer::deliverAnswers()
+{
+    _answers.clear();
+    if (!_service->collect(_answers)) {
+        return;
+    }
+    for (const MoveAnswer &answer : _answers) {
+        const auto waiting = _waiting.find(answer.tag);
+        if (waiting == _waiting.end()) {
+            continue;
+        }
+        const Waiting target = waiting->second;
+        _waiting.erase(waiting);
+        const auto connection = _connections.find(target.connection);
+        // the client hung up before its answer came
+        if (connection == _connections.end()) {
+            continue;
+        }
+        Reply &reply = connection->second->replies[target.seq - connection->second->firstSeq];
+        reply.text = (answer.move >= 0) ? "OK " + std::to_string(answer.move) + "\n" : "ERR no move\n";
+        reply.ready = true;
+    }
+}
+
+bool MoveServer::flush(Connection &connection)
+{
+    const uint64_t now = ProfilerNow();
+    while (!connection.replies.empty() && connection.replies.front().ready) {
+        Reply &reply = connection.replies.front();
+        if (reply.timed) {
+            _stats.requests++;
+            _stats.latency.record((now - reply.received) / 1000);
+        }
+        if (reply.stats) {
+            reply.text = "STATS " + statsJson() + "\n";
+        }
+        if (reply.text.compare(0, 4, "ERR ") == 0) {
+            _stats.errors++;
+        }
+        connection.output += reply.text;
+        connection.replies.pop_front();
+        connection.firstSeq++;
+    }
+    size_t sent = 0;
+    while (sent < connection.output.size()) {
+        const long count = SocketSend(connection.socket, connection.output.data() + sent, connection.output.size() - sent);
+        if (count == -2) {
+            break;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        sent += (size_t)count;
+    }
+    connection.output.erase(0, sent);
+    return !(connection.closing && connection.replies.empty() && connection.output.empty() && !hasLines(connection));
+}
+
+std::string MoveServer::statsJson() const
+{
+    const LatencyHistogram &latency = _stats.latency;
+    char json[512];
+    snprintf(json, sizeof(json),
+             "{\"connections\": %llu, \"open\": %zu, \"requests\": %llu, \"errors\": %llu, \"throttled\": %llu, \"searches\": %llu, "
+             "\"coalesced\": %llu, \"mean_us\": %.1f, \"p50_us\": %llu, \"p90_us\": %llu, \"p99_us\": %llu, "
+             "\"p999_us\": %llu, \"max_us\": %llu}",
+             (unsigned long long)_stats.connections, _connections.size(), (unsigned long long)_stats.requests,
+             (unsigned long long)_stats.errors, (unsigned long long)_stats.throttled, (unsigned long long)_service->searches(),
+             (unsigned long long)_service->coalesced(), latency.mean(), (unsigned long long)latency.percentile(0.5),
+             (unsigned long long)latency.percentile(0.9), (unsigned long long)latency.percentile(0.99),
+             (unsigned long long)latency.percentile(0.999), (unsigned long long)latency.max());
+    return json;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "MoveService.h"
+#include "Socket.h"
+
+//
+// a headless AI move server: clients connect over TCP and send one request per line, so a web
+// front end (through any WebSocket-to-TCP bridge) or a script can ask for a move without the demo
+//
+//   MOVE <state> [WxHxK] [ENGINE[:DEPTH][:LEVEL]]   ->  OK <cell>   or   ERR <reason>
+//   STATS                                           ->  STATS {"requests": ..., "p50_us": ..., ...}
+//   PING                                            ->  PONG
+//
+// <state> is a state string as TicTacToe::stateString() and MnkBoard::toStateString() write
+// it, one digit per cell (0 empty, 1 X, 2 O); the board defaults to 3x3, 3 in a row, and the
+// engine to the server's choice for that size; the reply is the cell, numbered like the string
+// requests may be pipelined: a connection's replies always come back in its request order
+//
+// one thread runs the event loop over non-blocking sockets; every MOVE read in an iteration is
+// handed to the MoveService in one batch, which coalesces the same position asked by several
+// clients into one search; the service wakes the loop when answers are ready
+// latency is measured from reading a request to queueing its reply, into a LatencyHistogram
+// a client that pipelines without reading its replies is throttled: once a connection holds
+// maxPending replies or maxOutput unsent bytes it isn't read again until it drains, and lines
+// already read past the cap wait in its input, so what a connection holds stays bounded
+//
+
+struct MoveServerConfig
+{
+    uint16_t        port = 7878;                // 0 picks a free port, see MoveServer::port()
+    bool            anyAddress = false;         // listen on every interface, not just 127.0.0.1
+    int             threads = 0;                // MoveService workers, 0 = one per hardware thread
+    SelfPlayPlayer  classicPlayer = { kEngineTable, 0, 0 };    // for 3x3 requests without an engine
+    SelfPlayPlayer  mnkPlayer = { kEngineMnk, 4, 0 };          // for other sizes
+    int             maxDepth = 6;               // a request can't ask for a deeper m,n,k search
+    size_t          maxLine = 4096;             // a longer request line closes the connection
+    size_t          maxPending = 256;           // replies queued per connection before it stops being read
+    size_t          maxOutput = 256 * 1024;     // unsent reply bytes per connection, likewise
+};
+
+struct MoveServerStats
+{
+    uint64_t        connections = 0;            // accepted since the start
+    uint64_t        requests = 0;               // MOVE lines answered, including errors
+    uint64_t        errors = 0;
+    uint64_t        throttled = 0;              // times a connection was left unread for its backlog
+    LatencyHistogram latency;                   // microseconds per MOVE, read to reply
+};
+
+class MoveServer
+{
+public:
+    explicit MoveServer(const MoveServerConfig &config);
+    ~MoveServer();
+    MoveServer(const MoveServer &) = delete;
+    MoveServer &operator=(const MoveServer &) = delete;
+
+    // binds the port; false with the reason in error
+    bool            listen(std::string &error);
+    uint16_t        port() const { return _port; }
+
+    // serves until stop(); returns at once if listen() didn't succeed
+    void            run();
+    // from any thread, e.g. a signal handler's flag watcher or a test
+    void            stop();
+
+    // only while run() isn't running, or from the thread running it
+    const MoveServerStats &stats() const { return _stats; }
+    std::string     statsJson() const;
+
+private:
+    struct Reply
+    {
+        uint64_t        received = 0;           // ProfilerNow() when the request was read
+        bool            ready = false;
+        bool            timed = false;          // a MOVE, counted in the latency
+        bool            stats = false;          // STATS: written when it's sent, so it counts the replies before it
+        std::string     text;
+    };
+
+    struct Connection
+    {
+        uint64_t            id = 0;
+        SocketHandle        socket;
+        std::string         input;              // bytes read but not yet handled as lines
+        std::string         output;             // replies not yet sent
+        std::deque<Reply>   replies;            // in request order; front is the oldest
+        uint64_t            firstSeq = 0;       // sequence number of replies.front()
+        bool                closing = false;    // read side finished: close once replies are sent
+        bool                throttled = false;  // over the backlog caps after the last read
+    };
+
+    void            acceptAll();
+    void            readFrom(Connection &connection);
+    // handles the complete lines in the input until the connection is over its backlog caps
+    void            handleInput(Connection &connection);
+    bool            backlogged(const Connection &connection) const;
+    bool            hasLines(const Connection &connection) const;
+    void            handleLine(Connection &connection, std::string_view line);
+    bool            parseMove(std::string_view arguments, MoveQuery &query, std::string &error);
+    std::shared_ptr<const MnkRules> rulesFor(int width, int height, int winLength);
+    void            deliverAnswers();
+    // moves finished replies to the output, in order, and sends what the socket takes; false
+    // if the connection is done with
+    bool            flush(Connection &connection);
+
+    MoveServerConfig                _config;
+    std::unique_ptr<MoveService>    _service;   // stopped first, while the wake-up socket is open
+    SocketHandle                    _listener;
+    SocketHandle                    _wakeup;
+    uint16_t                        _port = 0;
+    std::atomic<bool>               _quit = false;
+
+    uint64_t                        _nextConnection = 1;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> _connections;
+    struct Waiting { uint64_t connection; uint64_t seq; };
+    std::unordered_map<uint64_t, Waiting> _waiting;         // query tag -> whose reply it is
+    uint64_t                        _nextTag = 1;
+    std::vector<MoveQuery>          _batch;                 // this iteration's MOVE requests
+    std::vector<MoveAnswer>         _answers;
+    std::vector<std::shared_ptr<const MnkRules>> _rules;    // one per board size asked for
+    MoveServerStats                 _stats;
+};
@@ -0,0 +1,149 @@
+#include "MoveService.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <random>
+
+// most searches a worker takes at once; a short queue is split evenly so every thread gets some
+constexpr size_t MOVE_SERVICE_BATCH = 64;
+
+MoveService::MoveService(int threads) : _threadCount(SearchThreadCount(threads))
+{
+    for (int i = 0; i < _threadCount; ++i) {
+        _threads.emplace_back(&MoveService::run, this);
+    }
+}
+
+MoveService::~MoveService()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (std::thread &thread : _threads) {
+        thread.join();
+    }
+}
+
+std::string MoveService::keyOf(const MoveQuery &query)
+{
+    std::string key;
+    key.reserve(query.state.size() + 24);
+    key += std::to_string(query.rules->width()) + 'x' + std::to_string(query.rules->height()) + 'x' +
+           std::to_string(query.rules->winLength()) + ':' + std::to_string((int)query.player.engine) + ':' +
+           std::to_string(query.player.depth) + ':' + std::to_string(query.player.timeBudget) + ':' +
+           std::to_string((int)query.player.strength) + ':';
+    key += query.state;
+    return key;
+}
+
+void MoveService::submit(std::vector<MoveQuery> &queries)
+{
+    if (queries.empty()) {
+        return;
+    }
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (MoveQuery &query : queries) {
+            std::string key = keyOf(query);
+            const auto found = _unanswered.find(key);
+            if (found != _unanswered.end()) {
+                found->second->tags.push_back(query.tag);
+                _coalesced++;
+            } else {
+                auto search = std::make_unique<Search>();
+                search->key = key;
+                search->tags.push_back(query.tag);
+                search->query = std::move(query);
+                _queue.push_back(search.get());
+                _unanswered.emplace(std::move(key), std::move(search));
+                queued = true;
+            }
+            _pendingQueries++;
+        }
+    }
+    queries.clear();
+    if (queued) {
+        _wake.notify_all();
+    }
+}
+
+bool MoveService::collect(std::vector<MoveAnswer> &answers)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_answers.empty()) {
+        return false;
+    }
+    answers.insert(answers.end(), _answers.begin(), _answers.end());
+    _answers.clear();
+    return true;
+}
+
+size_t MoveService::pendingQueries() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pendingQueries;
+}
+
+uint64_t MoveService::searches() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _searches;
+}
+
+uint64_t MoveService::coalesced() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _coalesced;
+}
+
+void MoveService::run()
+{
+    ProfilerSetThreadName("move service worker");
+    // keys are whole positions, so the 3x3 entries from earlier queries are still right
+    TranspositionTable table;
+    std::mt19937 rng(std::random_device{}());
+    std::vector<Search *> batch;
+    std::vector<std::pair<int, uint64_t>> results;     // move and nodes, per search in batch
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _wake.wait(lock, [this] { return _quit || !_queue.empty(); });
+        if (_quit) {
+            break;
+        }
+        const size_t take = std::clamp(_queue.size() / (size_t)_threadCount, (size_t)1, MOVE_SERVICE_BATCH);
+        batch.assign(_queue.begin(), _queue.begin() + take);
+        _queue.erase(_queue.begin(), _queue.begin() + take);
+        lock.unlock();
+
+        // only the worker that took a search reads its query, so it needs no lock
+        results.clear();
+        {
+            PROFILE_SCOPE("MoveService batch");
+            for (const Search *search : batch) {
+                MnkBoard board(*search->query.rules);
+                board.setStateString(search->query.state);
+                uint64_t nodes = 0;
+                const int move = SelfPlayEngineMove(search->query.player, board, rng, &table, nodes);
+                results.emplace_back(move, nodes);
+            }
+        }
+
+        lock.lock();
+        for (size_t i = 0; i < batch.size(); ++i) {
+            for (uint64_t tag : batch[i]->tags) {
+                _answers.push_back(MoveAnswer{ tag, results[i].first, results[i].second });
+            }
+            _pendingQueries -= batch[i]->tags.size();
+            _searches++;
+            // later queries for this position start a search of their own
+            _unanswered.erase(_unanswered.find(batch[i]->key));
+        }
+        lock.unlock();
+        if (_onReply) _onReply();
+        lock.lock();
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "SelfPlay.h"
+
+//
+// answers "best move for this position" queries on a pool of worker threads, for callers such
+// as the move server (engine/MoveServer.h) that take queries from many clients at once
+// submit() queues a whole batch under one lock, and a query for a position that is already
+// queued or being searched (same rules, state, engine and depth) joins that search instead of
+// starting its own, so a burst of clients asking about the same opening costs one lookup
+// each worker takes a batch of searches at a time and keeps one transposition table across
+// them; the answers come back through collect(), also a batch at a time
+//
+
+struct MoveQuery
+{
+    uint64_t        tag = 0;            // the caller's, handed back with the answer
+    std::shared_ptr<const MnkRules> rules;
+    std::string     state;              // MnkBoard::toStateString(), not a finished game
+    SelfPlayPlayer  player;
+};
+
+struct MoveAnswer
+{
+    uint64_t        tag = 0;
+    int             move = -1;
+    uint64_t        nodes = 0;          // of the search, shared by every query it answered
+};
+
+class MoveService
+{
+public:
+    // threads = 0 starts one worker per hardware thread
+    explicit MoveService(int threads = 0);
+    ~MoveService();
+    MoveService(const MoveService &) = delete;
+    MoveService &operator=(const MoveService &) = delete;
+
+    // queues every query in queries and empties it
+    void            submit(std::vector<MoveQuery> &queries);
+    // appends every answer that has come back to answers; false if there were none
+    bool            collect(std::vector<MoveAnswer> &answers);
+
+    // queries not yet answered
+    size_t          pendingQueries() const;
+    int             threadCount() const { return _threadCount; }
+    // searches run, and queries answered by a search another query had already asked for
+    uint64_t        searches() const;
+    uint64_t        coalesced() const;
+
+    // called on a worker thread after it hands back answers, e.g. to wake an event loop; set it
+    // before the first submit()
+    void            setReplyCallback(std::function<void()> callback) { _onReply = std::move(callback); }
+
+private:
+    struct Search
+    {
+        std::string             key;
+        MoveQuery               query;
+        std::vector<uint64_t>   tags;   // every query waiting on it, guarded by _mutex
+    };
+
+    void            run();
+    static std::string keyOf(const MoveQuery &query);
+
+    int                             _threadCount;
+    std::vector<std::thread>        _threads;
+    mutable std::mutex              _mutex;
+    std::condition_variable         _wake;              // searches were queued, or shutdown
+    std::deque<Search *>            _queue;             // not yet taken by a worker
+    std::unordered_map<std::string, std::unique_ptr<Search>> _unanswered;   // queued or searching
+    std::vector<MoveAnswer>         _answers;
+    size_t                          _pendingQueries = 0;
+    uint64_t                        _searches = 0;
+    uint64_t                        _coalesced = 0;
+    bool                            _quit = false;
+    std::function<void()>           _onReply;
+};
@@ -0,0 +1,336 @@
+#include "Negamax.h"
+#include "PerfectPlay.h"
+#include "Parallel.h"
+#include <vector>
+
+//
+// score for a finished game, or SCORE_INF if the game is still going
+//
+static int TerminalScore(const Bitboard &pos, int side)
+{
+    int winner = pos.winner();
+    if (winner != 0) {
+        return (winner == side) ? SCORE_WIN : -SCORE_WIN;
+    }
+    if (pos.full()) {
+        return 0;
+    }
+    return SCORE_INF;
+}
+
+//
+// legal moves with the transposition table's best move (if any) tried first
+//
+struct MoveList
+{
+    int     moves[BOARD_CELLS];
+    int     count = 0;
+};
+
+static MoveList OrderedMoves(const Bitboard &pos, int firstMove)
+{
+    MoveList list;
+    if (firstMove >= 0 && pos.cellAt(firstMove) == 0) {
+        list.moves[list.count++] = firstMove;
+    }
+    for (int idx : MOVE_ORDER) {
+        if (idx != firstMove && pos.cellAt(idx) == 0) {
+            list.moves[list.count++] = idx;
+        }
+    }
+    return list;
+}
+
+//
+// drop moves that a symmetry of pos maps onto a move already in the list, they have the same value
+// e.g. on the empty board only the center, one corner and one edge are left
+//
+static void RemoveSymmetricMoves(const Bitboard &pos, MoveList &list)
+{
+    const uint8_t symmetries = Symmetries(pos);
+    if (symmetries == 1) {
+        return;
+    }
+    uint16_t covered = 0;
+    int count = 0;
+    for (int i = 0; i < list.count; ++i) {
+        const int idx = list.moves[i];
+        if (covered & (1 << idx)) continue;
+        for (int t = 0; t < SYMMETRY_COUNT; ++t) {
+            if (symmetries & (1 << t)) covered |= (uint16_t)(1 << TransformCell(t, idx));
+        }
+        list.moves[count++] = idx;
+    }
+    list.count = count;
+}
+
+//
+// narrow (alpha, beta) with a stored bound; returns true with value set if the entry alone decides the node
+//
+static bool ProbeTable(TranspositionTable &table, const Bitboard &pos, int &alpha, int &beta, int &ttMove, int &value)
+{
+    TTEntry entry;
+    if (!table.probe(pos, entry)) {
+        return false;
+    }
+    ttMove = entry.move;
+    if (entry.bound == kBoundExact) {
+        value = entry.value;
+        return true;
+    }
+    if (entry.bound == kBoundLower && entry.value > alpha) alpha = entry.value;
+    if (entry.bound == kBoundUpper && entry.value < beta) beta = entry.value;
+    if (alpha >= beta) {
+        value = entry.value;
+        return true;
+    }
+    return false;
+}
+
+static void StoreTable(TranspositionTable &table, const Bitboard &pos, int best, int alphaOrig, int beta, int bestMove)
+{
+    TTBound bound = (best <= alphaOrig) ? kBoundUpper : (best >= beta) ? kBoundLower : kBoundExact;
+    table.store(pos, best, bound, bestMove, BOARD_CELLS - pos.pieceCount());
+}
+
+//
+// plain negamax: score(state) = max over legal moves of ( -score(state') )
+// the only cutoff is an outright win, so from the empty board it visits nearly the full tree
+//
+int Negamax(const Bitboard &pos, uint64_t &nodes)
+{
+    nodes++;
+    const int side = pos.sideToMove();
+    const int terminal = TerminalScore(pos, side);
+    if (terminal != SCORE_INF) return terminal;
+
+    int best = -SCORE_INF;
+    for (int idx : MOVE_ORDER) {
+        if (pos.cellAt(idx) != 0) continue;
+        int val = -Negamax(pos.withMove(idx, side), nodes);
+        if (val > best) best = val;
+        // Early exit if we can force a win
+        if (best == SCORE_WIN) break;
+    }
+    return best;
+}
+
+//
+// fail-soft alpha-beta: the returned value may lie outside (alpha, beta),
+// in which case it is a bound rather than the exact score
+//
+int AlphaBeta(const Bitboard &pos, int alpha, int beta, uint64_t &nodes, TranspositionTable *table)
+{
+    nodes++;
+    const int side = pos.sideToMove();
+    const int terminal = TerminalScore(pos, side);
+    if (terminal != SCORE_INF) return terminal;
+
+    const int alphaOrig = alpha;
+    int ttMove = -1;
+    int ttValue;
+    if (table && ProbeTable(*table, pos, alpha, beta, ttMove, ttValue)) return ttValue;
+
+    int best = -SCORE_INF;
+    int bestMove = -1;
+    const MoveList list = OrderedMoves(pos, ttMove);
+    for (int i = 0; i < list.count; ++i) {
+        const int idx = list.moves[i];
+        int val = -AlphaBeta(pos.withMove(idx, side), -beta, -alpha, nodes, table);
+        if (val > best) {
+            best = val;
+            bestMove = idx;
+        }
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+    if (table) StoreTable(*table, pos, best, alphaOrig, beta, bestMove);
+    return best;
+}
+
+//
+// principal variation search: the first move gets the full window, every later move is
+// only asked "are you better than alpha?" with a null window and re-searched if it is
+//
+int NullWindowSearch(const Bitboard &pos, int alpha, int beta, uint64_t &nodes, TranspositionTable *table)
+{
+    nodes++;
+    const int side = pos.sideToMove();
+    const int terminal = TerminalScore(pos, side);
+    if (terminal != SCORE_INF) return terminal;
+
+    const int alphaOrig = alpha;
+    int ttMove = -1;
+    int ttValue;
+    if (table && ProbeTable(*table, pos, alpha, beta, ttMove, ttValue)) return ttValue;
+
+    int best = -SCORE_INF;
+    int bestMove = -1;
+    const MoveList list = OrderedMoves(pos, ttMove);
+    for (int i = 0; i < list.count; ++i) {
+        const int idx = list.moves[i];
+        const Bitboard child = pos.withMove(idx, side);
+        int val;
+        if (i == 0) {
+            val = -NullWindowSearch(child, -beta, -alpha, nodes, table);
+        } else {
+            val = -NullWindowSearch(child, -alpha - 1, -alpha, nodes, table);
+            if (val > alpha && val < beta) {
+                val = -NullWindowSearch(child, -beta, -alpha, nodes, table);
+            }
+        }
+        if (val > best) {
+            best = val;
+            bestMove = idx;
+        }
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+    if (table) StoreTable(*table, pos, best, alphaOrig, beta, bestMove);
+    return best;
+}
+
+//
+// value of one root move; i is the move's place in the root list, PVS gives the first one the full window
+//
+static int SearchRootMove(const Bitboard &child, SearchMode mode, int i, int alpha, int beta, uint64_t &nodes, TranspositionTable *table)
+{
+    switch (mode) {
+    case kSearchPlain:
+        return -Negamax(child, nodes);
+    case kSearchAlphaBeta:
+        return -AlphaBeta(child, -beta, -alpha, nodes, table);
+    case kSearchNullWindow:
+    default:
+        if (i == 0) {
+            return -NullWindowSearch(child, -beta, -alpha, nodes, table);
+        }
+        int val = -NullWindowSearch(child, -alpha - 1, -alpha, nodes, table);
+        if (val > alpha && val < beta) {
+            val = -NullWindowSearch(child, -beta, -alpha, nodes, table);
+        }
+        return val;
+    }
+}
+
+//
+// root split: every root move is searched with the root window on some thread, each thread
+// with its own copy of the table, then the values are walked in move order exactly as the
+// sequential loop would, so the move and value match the single-threaded search
+//
+static void SearchRootMovesParallel(const Bitboard &pos, SearchMode mode, const MoveList &list, int alpha, int beta,
+                                    int threads, uint64_t &nodes, TranspositionTable *table, int values[BOARD_CELLS])
+{
+    const int side = pos.sideToMove();
+    threads = std::min(threads, list.count);
+    std::vector<uint64_t> threadNodes(threads, 0);
+    std::vector<TranspositionTable> tables;
+    if (table) {
+        tables.assign(threads, *table);
+    }
+    ParallelFor(list.count, threads, [&](int i, int thread) {
+        TranspositionTable *threadTable = table ? &tables[thread] : nullptr;
+        // with the window fixed at the root's, PVS would null-window every move but the first
+        // alpha-beta gives each move its exact value inside the window instead
+        const SearchMode threadMode = (mode == kSearchNullWindow) ? kSearchAlphaBeta : mode;
+        values[i] = SearchRootMove(pos.withMove(list.moves[i], side), threadMode, i, alpha, beta, threadNodes[thread], threadTable);
+    });
+    for (uint64_t n : threadNodes) {
+        nodes += n;
+    }
+}
+
+static SearchResult SearchRoot(const Bitboard &pos, SearchMode mode, int alpha, int beta, bool symmetry, int threads,
+                               uint64_t &nodes, TranspositionTable *table)
+{
+    SearchResult result;
+    nodes++;
+    const int side = pos.sideToMove();
+    const int terminal = TerminalScore(pos, side);
+    if (terminal != SCORE_INF) {
+        result.value = terminal;
+        return result;
+    }
+
+    // the plain search ignores the window, the table and symmetry, and stops at the first winning move
+    if (mode == kSearchPlain) {
+        alpha = -SCORE_INF;
+        beta = SCORE_WIN;
+        symmetry = false;
+        table = nullptr;
+    }
+
+    // the root always searches every move, the table only supplies the first one to try
+    const int alphaOrig = alpha;
+    int ttMove = -1;
+    TTEntry entry;
+    if (table && table->probe(pos, entry)) {
+        ttMove = entry.move;
+    }
+
+    result.value = -SCORE_INF;
+    MoveList list = OrderedMoves(pos, ttMove);
+    if (symmetry) {
+        RemoveSymmetricMoves(pos, list);
+    }
+
+    int values[BOARD_CELLS];
+    const bool parallel = threads > 1 && list.count > 1;
+    if (parallel) {
+        SearchRootMovesParallel(pos, mode, list, alpha, beta, threads, nodes, table, values);
+    }
+    for (int i = 0; i < list.count; ++i) {
+        const int idx = list.moves[i];
+        const int val = parallel ? values[i] : SearchRootMove(pos.withMove(idx, side), mode, i, alpha, beta, nodes, table);
+        if (val > result.value) {
+            result.value = val;
+            result.move = idx;
+        }
+        if (val > alpha) alpha = val;
+        if (alpha >= beta) break;
+    }
+    if (table) StoreTable(*table, pos, result.value, alphaOrig, beta, result.move);
+    return result;
+}
+
+SearchResult SearchBestMove(const Bitboard &pos, const SearchOptions &options)
+{
+    SearchMode mode = options.mode;
+    if (mode == kSearchTable) {
+        const PerfectPlayEntry entry = LookupPerfectPlay(pos);
+        if (entry.solved) {
+            SearchResult result;
+            result.move = entry.move;
+            result.value = entry.value;
+            result.fromTable = true;
+            return result;
+        }
+        mode = kSearchAlphaBeta;
+    }
+
+    uint64_t nodes = 0;
+    const int threads = SearchThreadCount(options.threads);
+    SearchResult result = SearchRoot(pos, mode, options.alpha, options.beta, options.symmetry, threads, nodes, options.table);
+
+    // a narrowed (aspiration) window that the score fell outside of only gives a bound,
+    // so search again with the window open to get the exact value and a trustworthy move
+    const bool narrowed = options.alpha > -SCORE_INF || options.beta < SCORE_INF;
+    if (mode != kSearchPlain && narrowed && result.move != -1 &&
+        (result.value <= options.alpha || result.value >= options.beta)) {
+        result = SearchRoot(pos, mode, -SCORE_INF, SCORE_INF, options.symmetry, threads, nodes, options.table);
+        result.researches = 1;
+    }
+    result.nodes = nodes;
+    return result;
+}
+
+const char *SearchModeName(SearchMode mode)
+{
+    switch (mode) {
+    case kSearchPlain:      return "Plain Negamax";
+    case kSearchAlphaBeta:  return "Alpha-beta";
+    case kSearchNullWindow: return "Null window (PVS)";
+    case kSearchTable:      return "Perfect-play table";
+    }
+    return "Unknown";
+}
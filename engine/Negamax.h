@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include "Bitboard.h"
+#include "Symmetry.h"
+#include "TranspositionTable.h"
+
+//
+// Negamax search over the 3x3 Bitboard
+// scores are from the side to move's point of view: +1 win, 0 draw, -1 loss
+//
+
+constexpr int SCORE_WIN = 1;
+constexpr int SCORE_INF = 2;        // outside every real score, used for an open window
+
+// Preferred move order (center, corners, edges)
+constexpr int MOVE_ORDER[BOARD_CELLS] = {4, 0, 2, 6, 8, 1, 3, 5, 7};
+
+enum SearchMode
+{
+    kSearchPlain,           // the original search: only cuts off once a win is found
+    kSearchAlphaBeta,       // fail-soft alpha-beta
+    kSearchNullWindow,      // principal variation search: null windows after the first move
+    kSearchTable            // compile-time perfect-play table, alpha-beta for positions it doesn't cover
+};
+
+struct SearchOptions
+{
+    SearchMode  mode = kSearchAlphaBeta;
+    // root window, narrow it for an aspiration search; a result outside it is re-searched open
+    int         alpha = -SCORE_INF;
+    int         beta = SCORE_INF;
+    // consulted and filled by alpha-beta and null-window searches when set; owned by the caller
+    TranspositionTable *table = nullptr;
+    // search only one root move out of each set that a symmetry of the position makes equivalent
+    bool        symmetry = true;
+    // threads that split the root moves, 0 = one per hardware thread; the result is the same
+    // as with one thread, only the node count differs
+    int         threads = 1;
+};
+
+struct SearchResult
+{
+    int         move = -1;          // cell 0..8, -1 if there is no legal move
+    int         value = 0;          // score of move for the side to move
+    uint64_t    nodes = 0;          // positions visited, including re-searches
+    int         researches = 0;     // aspiration window failures
+    bool        fromTable = false;  // answered by the perfect-play table without searching
+};
+
+// full search of pos for its side to move
+SearchResult    SearchBestMove(const Bitboard &pos, const SearchOptions &options = SearchOptions());
+
+// the individual searches, nodes is incremented once per position visited
+int             Negamax(const Bitboard &pos, uint64_t &nodes);
+int             AlphaBeta(const Bitboard &pos, int alpha, int beta, uint64_t &nodes, TranspositionTable *table = nullptr);
+int             NullWindowSearch(const Bitboard &pos, int alpha, int beta, uint64_t &nodes, TranspositionTable *table = nullptr);
+
+const char     *SearchModeName(SearchMode mode);
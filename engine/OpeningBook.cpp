@@ -0,0 +1,253 @@
+#include "OpeningBook.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+// entries are used in place, which only works if the machine is little-endian like the file
+static_assert(std::endian::native == std::endian::little, "opening books are little-endian");
+
+static const char BOOK_MAGIC[4] = { 'T', 'T', 'T', 'B' };
+constexpr size_t BOOK_HEADER_SIZE = 32;
+
+struct OpeningBookHeader
+{
+    char        magic[4];
+    uint16_t    version;
+    uint16_t    headerSize;
+    uint8_t     width;
+    uint8_t     height;
+    uint8_t     winLength;
+    uint8_t     maxPly;
+    uint32_t    reserved32;
+    uint64_t    count;
+    uint64_t    reserved64;
+};
+static_assert(sizeof(OpeningBookHeader) == BOOK_HEADER_SIZE, "the header is read straight from the file");
+
+std::string OpeningBookName(const MnkRules &rules)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%dx%d.book", rules.width(), rules.height(), rules.winLength());
+    return name;
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool OpeningBook::open(const std::string &path, const MnkRules &rules)
+{
+    close();
+    if (!_file.open(path, BOOK_HEADER_SIZE)) {
+        return false;
+    }
+    OpeningBookHeader header;
+    memcpy(&header, _file.data(), sizeof(header));
+    const bool matches = memcmp(header.magic, BOOK_MAGIC, 4) == 0 && header.version == OPENING_BOOK_VERSION &&
+                         header.headerSize == BOOK_HEADER_SIZE && header.width == rules.width() &&
+                         header.height == rules.height() && header.winLength == rules.winLength();
+    const bool complete = (_file.size() - BOOK_HEADER_SIZE) / sizeof(OpeningBookEntry) >= header.count;
+    if (!matches || !complete) {
+        close();
+        return false;
+    }
+    _entries = reinterpret_cast<const OpeningBookEntry *>(_file.data() + BOOK_HEADER_SIZE);
+    _count = (size_t)header.count;
+    _maxPly = header.maxPly;
+    return true;
+}
+
+void OpeningBook::close()
+{
+    _file.close();
+    _entries = nullptr;
+    _count = 0;
+    _maxPly = -1;
+}
+
+bool OpeningBook::lookup(const MnkBoard &board, OpeningBookEntry &entry) const
+{
+    if (!_entries || board.pieceCount() > _maxPly) {
+        return false;
+    }
+    const uint64_t hash = board.hash();
+    const OpeningBookEntry *end = _entries + _count;
+    const OpeningBookEntry *found = std::lower_bound(_entries, end, hash,
+                                                     [](const OpeningBookEntry &e, uint64_t h) { return e.hash < h; });
+    if (found == end || found->hash != hash) {
+        return false;
+    }
+    entry = *found;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool WriteOpeningBook(const std::string &path, const MnkRules &rules, int maxPly, std::vector<OpeningBookEntry> entries)
+{
+    std::sort(entries.begin(), entries.end(), [](const OpeningBookEntry &a, const OpeningBookEntry &b) { return a.hash < b.hash; });
+
+    OpeningBookHeader header{};
+    memcpy(header.magic, BOOK_MAGIC, 4);
+    header.version = OPENING_BOOK_VERSION;
+    header.headerSize = (uint16_t)BOOK_HEADER_SIZE;
+    header.width = (uint8_t)rules.width();
+    header.height = (uint8_t)rules.height();
+    header.winLength = (uint8_t)rules.winLength();
+    header.maxPly = (uint8_t)maxPly;
+    header.count = entries.size();
+
+    return WriteFileReplacing(path, { { &header, sizeof(header) }, { entries.data(), entries.size() * sizeof(OpeningBookEntry) } });
+}
+
+// ---------------------------------------------------------------------------------------
+
+//
+// exact solver behind BuildOpeningBook
+// values are only -1, 0 or +1 for the side to move, so the table keeps a value and whether it
+// is exact or a bound from a cutoff; the move that was best (or cut off) is tried first on the
+// next visit, which is most of what keeps the tree small
+//
+class BookSolver
+{
+public:
+    explicit BookSolver(const MnkRules &rules) : _board(rules), _table((size_t)1 << TABLE_BITS) {}
+
+    MnkBoard &board() { return _board; }
+
+    // value of the current position for the side to move, and a move that gets it
+    int solve(int &move)
+    {
+        move = -1;
+        return search(-1, 1, &move);
+    }
+
+private:
+    static constexpr int TABLE_BITS = 22;       // 4M entries, 64 MB
+    enum Bound : uint8_t { kEmpty, kExact, kLower, kUpper };
+
+    struct Slot
+    {
+        uint64_t    hash = 0;
+        int16_t     move = -1;
+        int8_t      value = 0;
+        uint8_t     bound = kEmpty;
+    };
+
+    int search(int alpha, int beta, int *bestMoveOut)
+    {
+        Slot &slot = _table[_board.hash() & (_table.size() - 1)];
+        int ttMove = -1;
+        if (slot.bound != kEmpty && slot.hash == _board.hash()) {
+            ttMove = slot.move;
+            if (!bestMoveOut) {
+                if (slot.bound == kExact) return slot.value;
+                if (slot.bound == kLower && slot.value >= beta) return slot.value;
+                if (slot.bound == kUpper && slot.value <= alpha) return slot.value;
+            }
+        }
+
+        const CellMask empty = _board.emptyCells();
+        // a move that completes a line ends it; nothing else needs searching
+        int win = -1;
+        empty.forEach([&](int cell) {
+            if (win >= 0) return;
+            _board.makeMove(cell);
+            if (_board.winner() != 0) win = cell;
+            _board.unmakeMove();
+        });
+        if (win >= 0) {
+            if (bestMoveOut) *bestMoveOut = win;
+            store(slot, 1, kExact, win);
+            return 1;
+        }
+        if (empty.count() <= 1) {
+            // the last cell, and it doesn't win
+            int last = -1;
+            empty.forEach([&](int cell) { last = cell; });
+            if (bestMoveOut) *bestMoveOut = last;
+            return 0;
+        }
+
+        const int originalAlpha = alpha;
+        int best = -2;
+        int bestMove = -1;
+        auto tryMove = [&](int cell) {
+            _board.makeMove(cell);
+            const int value = -search(-beta, -alpha, nullptr);
+            _board.unmakeMove();
+            if (value > best) {
+                best = value;
+                bestMove = cell;
+            }
+            if (best > alpha) alpha = best;
+        };
+        if (ttMove >= 0 && empty.test(ttMove)) {
+            tryMove(ttMove);
+        }
+        for (int i = 0; i < MNK_MASK_WORDS && alpha < beta; ++i) {
+            for (uint64_t bits = empty.words[i]; bits && alpha < beta; bits &= bits - 1) {
+                const int cell = i * 64 + std::countr_zero(bits);
+                if (cell != ttMove) tryMove(cell);
+            }
+        }
+
+        const Bound bound = (best <= originalAlpha) ? kUpper : (best >= beta) ? kLower : kExact;
+        store(slot, best, bound, bestMove);
+        if (bestMoveOut) *bestMoveOut = bestMove;
+        return best;
+    }
+
+    void store(Slot &slot, int value, Bound bound, int move)
+    {
+        slot.hash = _board.hash();
+        slot.value = (int8_t)value;
+        slot.bound = bound;
+        slot.move = (int16_t)move;
+    }
+
+    MnkBoard            _board;
+    std::vector<Slot>   _table;
+};
+
+std::vector<OpeningBookEntry> BuildOpeningBook(const MnkRules &rules, int maxPly, OpeningBookProgress progress)
+{
+    // every position with up to maxPly stones that isn't over yet, each once however it was reached
+    std::vector<std::string> positions;
+    std::unordered_set<uint64_t> seen;
+    std::vector<std::string> layer = { MnkBoard(rules).toStateString() };
+    MnkBoard board(rules);
+    for (int ply = 0; ply <= maxPly && !layer.empty(); ++ply) {
+        std::vector<std::string> next;
+        for (const std::string &state : layer) {
+            positions.push_back(state);
+            if (ply == maxPly) continue;
+            board.setStateString(state);
+            board.emptyCells().forEach([&](int cell) {
+                board.makeMove(cell);
+                if (!board.gameOver() && seen.insert(board.hash()).second) {
+                    next.push_back(board.toStateString());
+                }
+                board.unmakeMove();
+            });
+        }
+        layer.swap(next);
+    }
+
+    BookSolver solver(rules);
+    std::vector<OpeningBookEntry> entries;
+    entries.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        solver.board().setStateString(positions[i]);
+        OpeningBookEntry entry{};
+        int move = -1;
+        entry.hash = solver.board().hash();
+        entry.value = (int8_t)solver.solve(move);
+        entry.move = (int16_t)move;
+        entries.push_back(entry);
+        if (progress && (i % 1024 == 0 || i + 1 == positions.size())) {
+            progress(i + 1, positions.size());
+        }
+    }
+    return entries;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MnkBoard.h"
+
+//
+// solved positions of one m,n,k variant, written once by build_book and memory-mapped by
+// every process that plays that variant, so a solve that takes minutes is paid for only once
+// the file is a 32-byte header ("TTTB", version, header size, width, height, k, deepest ply,
+// entry count) and then 16-byte entries sorted by MnkBoard::hash(), all little-endian; the
+// entries are read in place from a read-only shared mapping, so processes share the pages
+// a lookup is a binary search; an entry holds the game-theoretic value for the side to move
+// (+1 win, 0 draw, -1 loss) and a move that achieves it
+//
+
+constexpr uint16_t OPENING_BOOK_VERSION = 1;
+
+struct OpeningBookEntry
+{
+    uint64_t    hash;
+    int16_t     move;
+    int8_t      value;
+    uint8_t     reserved8;
+    uint32_t    reserved32;
+};
+static_assert(sizeof(OpeningBookEntry) == 16, "book entries are read straight from the file");
+
+class OpeningBook
+{
+public:
+    OpeningBook() = default;
+    ~OpeningBook() { close(); }
+    OpeningBook(const OpeningBook &) = delete;
+    OpeningBook &operator=(const OpeningBook &) = delete;
+
+    // maps path; false if it is missing, damaged, another version or for other rules
+    bool        open(const std::string &path, const MnkRules &rules);
+    void        close();
+    bool        isOpen() const { return _entries != nullptr; }
+
+    size_t      size() const { return _count; }
+    // positions with more stones than this are never in the book
+    int         maxPly() const { return _maxPly; }
+
+    bool        lookup(const MnkBoard &board, OpeningBookEntry &entry) const;
+
+private:
+    const OpeningBookEntry  *_entries = nullptr;
+    size_t                  _count = 0;
+    int                     _maxPly = -1;
+    MappedFile              _file;
+};
+
+// the file name a variant's book goes by, e.g. "4x4x4.book"
+std::string     OpeningBookName(const MnkRules &rules);
+
+// sorts entries by hash and writes them to path, replacing it only once the file is complete
+bool            WriteOpeningBook(const std::string &path, const MnkRules &rules, int maxPly, std::vector<OpeningBookEntry> entries);
+
+//
+// solves every position reachable in up to maxPly moves that isn't already over
+// single-threaded alpha-beta over game-theoretic values with a transposition table shared by
+// all the positions, so each one mostly re-reads what the earlier solves stored
+// progress, if set, is called with (solved, total) now and then
+//
+using OpeningBookProgress = void (*)(size_t solved, size_t total);
+
+std::vector<OpeningBookEntry> BuildOpeningBook(const MnkRules &rules, int maxPly, OpeningBookProgress progress = nullptr);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//
+// splits a search's root moves across threads
+// each thread claims the next unclaimed index from a shared counter, so a thread that drew
+// quick moves simply goes on to take more of them; the calling thread works as one of them
+// with one thread the items run in order on the calling thread and no thread is started
+//
+
+// threads for a requested count: 0 means one per hardware thread
+inline int SearchThreadCount(int requested)
+{
+    if (requested > 0) {
+        return requested;
+    }
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? (int)hardware : 1;
+}
+
+// calls fn(index, thread) once for every index in [0, count), thread is in [0, threads)
+template <typename Fn>
+void ParallelFor(int count, int threads, Fn &&fn)
+{
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        for (int i = 0; i < count; ++i) fn(i, 0);
+        return;
+    }
+    std::atomic<int> next = 0;
+    auto work = [&](int thread) {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i, thread);
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (int thread = 1; thread < threads; ++thread) {
+        pool.emplace_back(work, thread);
+    }
+    work(0);
+    for (std::thread &t : pool) {
+        t.join();
+    }
+}
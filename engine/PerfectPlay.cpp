@@ -0,0 +1,80 @@
+#include "PerfectPlay.h"
+#include "Negamax.h"
+#include <array>
+
+//
+// each entry packs (value + 1) into bits 0-1 and (move + 1) into bits 2-5
+// unreachable positions keep PERFECT_PLAY_UNSOLVED
+//
+constexpr uint8_t PERFECT_PLAY_UNSOLVED = 0xFF;
+
+using PerfectPlayTable = std::array<uint8_t, TERNARY_POSITIONS>;
+
+//
+// full negamax over the game tree with the table as memo; every child is visited
+// (no cutoffs) so that every reachable position ends up in the table
+//
+static constexpr int SolvePosition(PerfectPlayTable &table, const Bitboard &pos, int index)
+{
+    if (table[index] != PERFECT_PLAY_UNSOLVED) {
+        return (table[index] & 3) - 1;
+    }
+    const int side = pos.sideToMove();
+    const int winner = pos.winner();
+    int value = -SCORE_INF;
+    int move = -1;
+    if (winner != 0) {
+        value = (winner == side) ? SCORE_WIN : -SCORE_WIN;
+    } else if (pos.full()) {
+        value = 0;
+    } else {
+        for (int idx : MOVE_ORDER) {
+            if (pos.cellAt(idx) != 0) continue;
+            int val = -SolvePosition(table, pos.withMove(idx, side), index + side * POW3[idx]);
+            if (val > value) {
+                value = val;
+                move = idx;
+            }
+        }
+    }
+    table[index] = (uint8_t)((value + 1) | ((move + 1) << 2));
+    return value;
+}
+
+static constexpr PerfectPlayTable PERFECT_PLAY = [] {
+    PerfectPlayTable table{};
+    for (uint8_t &entry : table) entry = PERFECT_PLAY_UNSOLVED;
+    SolvePosition(table, Bitboard(), 0);
+    return table;
+}();
+
+static constexpr int PERFECT_PLAY_POSITIONS = [] {
+    int count = 0;
+    for (uint8_t entry : PERFECT_PLAY) {
+        if (entry != PERFECT_PLAY_UNSOLVED) count++;
+    }
+    return count;
+}();
+
+static_assert(PERFECT_PLAY_POSITIONS == 5478, "3x3 tic tac toe has 5478 reachable positions");
+static_assert((PERFECT_PLAY[0] & 3) == 1, "perfect play from the empty board is a draw");
+static_assert(Bitboard::fromStateString("120021001").toState().ternaryKey() == (uint64_t)TernaryIndex(Bitboard::fromStateString("120021001")),
+              "state buffers key positions the way the table indexes them");
+
+PerfectPlayEntry LookupPerfectPlay(const Bitboard &board)
+{
+    PerfectPlayEntry entry;
+    const uint8_t packed = PERFECT_PLAY[TernaryIndex(board)];
+    if (packed == PERFECT_PLAY_UNSOLVED) {
+        return entry;
+    }
+    entry.solved = true;
+    entry.value = (packed & 3) - 1;
+    entry.move = (packed >> 2) - 1;
+    return entry;
+}
+
+int PerfectPlayPositionCount()
+{
+    return PERFECT_PLAY_POSITIONS;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include "Bitboard.h"
+
+//
+// the whole 3x3 game solved at compile time (engine/PerfectPlay.cpp)
+// every position reachable from the empty board has its Negamax value and a best move,
+// so the AI reply is a single table read with no search
+//
+
+constexpr int TERNARY_POSITIONS = 19683;        // 3^9, every way of writing 0/1/2 into 9 cells
+
+constexpr int POW3[BOARD_CELLS] = {1, 3, 9, 27, 81, 243, 729, 2187, 6561};
+
+// base-3 index of the state string read right-to-left: cell i contributes cellAt(i) * 3^i
+constexpr int TernaryIndex(const Bitboard &board)
+{
+    int index = 0;
+    for (int i = 0; i < BOARD_CELLS; ++i) index += board.cellAt(i) * POW3[i];
+    return index;
+}
+
+struct PerfectPlayEntry
+{
+    bool    solved = false;     // false for positions that can't arise in a legal game
+    int     value = 0;          // +1 win, 0 draw, -1 loss for the side to move
+    int     move = -1;          // a best move, -1 if the game is already over
+};
+
+PerfectPlayEntry    LookupPerfectPlay(const Bitboard &board);
+
+// number of solved (reachable) positions in the table, 5478 for the 3x3 game
+int                 PerfectPlayPositionCount();
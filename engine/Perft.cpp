@@ -0,0 +1,105 @@
+#include "Perft.h"
+#include <vector>
+
+PerftCounts &PerftCounts::operator+=(const PerftCounts &other)
+{
+    nodes += other.nodes;
+    leaves += other.leaves;
+    xWins += other.xWins;
+    oWins += other.oWins;
+    draws += other.draws;
+    return *this;
+}
+
+static void CountOutcome(PerftCounts &counts, int winner)
+{
+    if (winner == 1) counts.xWins++;
+    else if (winner == 2) counts.oWins++;
+    else counts.draws++;
+}
+
+//
+// the masks stay in registers: a move adds one bit, and only the mover can have just won
+//
+static void PerftBits(uint16_t mover, uint16_t other, int side, int depth, PerftCounts &counts)
+{
+    uint16_t empty = (uint16_t)(BOARD_MASK & ~(mover | other));
+    while (empty) {
+        const uint16_t bit = empty & (uint16_t)-empty;
+        empty &= (uint16_t)(empty - 1);
+        const uint16_t moved = mover | bit;
+        counts.nodes++;
+        if (HasLine(moved)) {
+            CountOutcome(counts, side);
+        } else if ((moved | other) == BOARD_MASK) {
+            CountOutcome(counts, 0);
+        } else if (depth == 1) {
+            counts.leaves++;
+        } else {
+            PerftBits(other, moved, 3 - side, depth - 1, counts);
+        }
+    }
+}
+
+PerftCounts Perft(const Bitboard &pos, int depth)
+{
+    PerftCounts counts;
+    counts.nodes = 1;
+    if (pos.gameOver()) {
+        CountOutcome(counts, pos.winner());
+    } else if (depth <= 0) {
+        counts.leaves = 1;
+    } else {
+        const int side = pos.sideToMove();
+        const uint16_t mover = (side == 1) ? pos.x : pos.o;
+        const uint16_t other = (side == 1) ? pos.o : pos.x;
+        PerftBits(mover, other, side, depth, counts);
+    }
+    return counts;
+}
+
+//
+// the m,n,k walk; the board's line counters make the win test after each move O(1)
+//
+class MnkPerfter
+{
+public:
+    explicit MnkPerfter(const MnkBoard &board) : _board(board) {}
+
+    void run(int depth, PerftCounts &counts)
+    {
+        const int side = _board.sideToMove();
+        _board.emptyCells().forEach([&](int cell) {
+            _board.makeMove(cell);
+            counts.nodes++;
+            if (_board.winner() != 0) {
+                CountOutcome(counts, side);
+            } else if (_board.full()) {
+                CountOutcome(counts, 0);
+            } else if (depth == 1) {
+                counts.leaves++;
+            } else {
+                run(depth - 1, counts);
+            }
+            _board.unmakeMove();
+        });
+    }
+
+private:
+    MnkBoard        _board;
+};
+
+PerftCounts MnkPerft(const MnkBoard &board, int depth)
+{
+    PerftCounts counts;
+    counts.nodes = 1;
+    if (board.gameOver()) {
+        CountOutcome(counts, board.winner());
+    } else if (depth <= 0) {
+        counts.leaves = 1;
+    } else {
+        MnkPerfter perfter(board);
+        perfter.run(depth, counts);
+    }
+    return counts;
+}
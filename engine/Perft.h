@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include "Bitboard.h"
+#include "MnkBoard.h"
+
+//
+// perft: walks every move sequence up to a depth and counts what it reaches
+// a finished game stops its line and is counted by outcome; an unfinished position at the
+// depth limit is a leaf. From the empty 3x3 board to depth 9 there are 255,168 games,
+// which makes it a correctness check for move generation and win detection as well as a
+// throughput benchmark
+//
+
+struct PerftCounts
+{
+    uint64_t    nodes = 0;          // positions visited, the start position included
+    uint64_t    leaves = 0;         // unfinished positions at the depth limit
+    uint64_t    xWins = 0;
+    uint64_t    oWins = 0;
+    uint64_t    draws = 0;
+
+    uint64_t    games() const { return xWins + oWins + draws; }
+    PerftCounts &operator+=(const PerftCounts &other);
+    bool        operator==(const PerftCounts &other) const = default;
+};
+
+// from pos on the 3x3 board, depth in plies
+PerftCounts     Perft(const Bitboard &pos, int depth);
+
+// from board on any m,n,k board; must agree with Perft() on 3x3 with k = 3
+PerftCounts     MnkPerft(const MnkBoard &board, int depth);
@@ -0,0 +1,217 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// an event as the ring stores it: relaxed atomics cost a plain store on the owner's side and
+// make reading a slot the owner is overwriting a stale value rather than a data race
+struct RingSlot
+{
+    std::atomic<const char *>   name = nullptr;
+    std::atomic<uint64_t>       start = 0;
+    std::atomic<uint64_t>       duration = 0;
+    std::atomic<uint32_t>       thread = 0;
+};
+
+//
+// one thread's events: only the owner writes them and then publishes the new count, so a dump
+// knows which slots hold finished events; a slot the owner overwrites while a dump copies it
+// is recognised from the count afterwards and left out
+//
+struct ProfileRing
+{
+    RingSlot                events[PROFILER_RING_EVENTS];
+    std::atomic<uint64_t>   written = 0;        // events ever recorded, stored by the owner only
+    std::atomic<uint64_t>   clearedAt = 0;      // events before this count were cleared
+    std::atomic<bool>       owned = false;
+};
+
+struct ProfileRegistry
+{
+    std::mutex                                  mutex;
+    std::vector<std::unique_ptr<ProfileRing>>   rings;
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+};
+
+// never destroyed: threads can still exit and give back their ring during static destruction
+ProfileRegistry &Registry()
+{
+    static ProfileRegistry *registry = new ProfileRegistry();
+    return *registry;
+}
+
+std::atomic<bool>       g_enabled = true;
+std::atomic<uint32_t>   g_nextThread = 0;
+
+// the calling thread's ring, claimed on its first event and given back when it exits
+struct ThreadRing
+{
+    ProfileRing    *ring = nullptr;
+
+    ~ThreadRing()
+    {
+        if (ring) ring->owned.store(false, std::memory_order_release);
+    }
+
+    ProfileRing &get()
+    {
+        if (!ring) {
+            ProfileRegistry &registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const std::unique_ptr<ProfileRing> &candidate : registry.rings) {
+                bool expected = false;
+                if (candidate->owned.compare_exchange_strong(expected, true)) {
+                    ring = candidate.get();
+                    break;
+                }
+            }
+            if (!ring) {
+                registry.rings.push_back(std::make_unique<ProfileRing>());
+                ring = registry.rings.back().get();
+                ring->owned.store(true);
+            }
+        }
+        return *ring;
+    }
+};
+
+thread_local ThreadRing t_ring;
+
+uint32_t ThreadId()
+{
+    static thread_local uint32_t id = g_nextThread.fetch_add(1);
+    return id;
+}
+
+void WriteJsonString(std::FILE *file, const char *text)
+{
+    std::fputc('"', file);
+    for (const char *c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', file);
+        if ((unsigned char)*c >= 0x20) std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+
+}
+
+uint64_t ProfilerNow()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void ProfilerRecord(const char *name, uint64_t start, uint64_t duration)
+{
+    if (!g_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ProfileRing &ring = t_ring.get();
+    const uint64_t count = ring.written.load(std::memory_order_relaxed);
+    RingSlot &slot = ring.events[count & (PROFILER_RING_EVENTS - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.thread.store(ThreadId(), std::memory_order_relaxed);
+    ring.written.store(count + 1, std::memory_order_release);
+}
+
+void ProfilerSetEnabled(bool enabled)
+{
+    g_enabled.store(enabled);
+}
+
+bool ProfilerEnabled()
+{
+    return g_enabled.load();
+}
+
+void ProfilerSetThreadName(const char *name)
+{
+    ProfileRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const uint32_t id = ThreadId();
+    for (auto &entry : registry.threadNames) {
+        if (entry.first == id) {
+            entry.second = name;
+            return;
+        }
+    }
+    registry.threadNames.emplace_back(id, name);
+}
+
+int ProfilerWriteChromeTrace(const std::string &path)
+{
+    std::vector<ProfileEvent> events;
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+    {
+        ProfileRegistry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        threadNames = registry.threadNames;
+        for (const std::unique_ptr<ProfileRing> &ring : registry.rings) {
+            const uint64_t end = ring->written.load(std::memory_order_acquire);
+            const uint64_t begin = std::max(end - std::min<uint64_t>(end, PROFILER_RING_EVENTS), ring->clearedAt.load());
+            const size_t first = events.size();
+            for (uint64_t i = begin; i < end; ++i) {
+                const RingSlot &slot = ring->events[i & (PROFILER_RING_EVENTS - 1)];
+                ProfileEvent event;
+                event.name = slot.name.load(std::memory_order_relaxed);
+                event.start = slot.start.load(std::memory_order_relaxed);
+                event.duration = slot.duration.load(std::memory_order_relaxed);
+                event.thread = slot.thread.load(std::memory_order_relaxed);
+                events.push_back(event);
+            }
+            // the owner kept recording meanwhile: drop the slots it may have been writing over
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = ring->written.load(std::memory_order_relaxed);
+            const uint64_t safe = (after > PROFILER_RING_EVENTS) ? after - PROFILER_RING_EVENTS : 0;
+            if (safe > begin) {
+                events.erase(events.begin() + first, events.begin() + first + (size_t)std::min(safe - begin, end - begin));
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const ProfileEvent &a, const ProfileEvent &b) { return a.start < b.start; });
+
+    const std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return -1;
+    }
+    std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    for (const auto &thread : threadNames) {
+        std::fprintf(file, "%s  {\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", first ? "" : ",\n", thread.first);
+        WriteJsonString(file, thread.second.c_str());
+        std::fprintf(file, "}}");
+        first = false;
+    }
+    for (const ProfileEvent &event : events) {
+        std::fprintf(file, "%s  {\"ph\": \"X\", \"name\": ", first ? "" : ",\n");
+        WriteJsonString(file, event.name);
+        std::fprintf(file, ", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", event.thread, event.start / 1000.0, event.duration / 1000.0);
+        first = false;
+    }
+    std::fprintf(file, "\n]}\n");
+    const bool written = std::fclose(file) == 0;
+    std::remove(path.c_str());
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return -1;
+    }
+    return (int)events.size();
+}
+
+void ProfilerClear()
+{
+    ProfileRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const std::unique_ptr<ProfileRing> &ring : registry.rings) {
+        ring->clearedAt.store(ring->written.load());
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//
+// scoped profiler: PROFILE_SCOPE("name") records when the enclosing block started and how long
+// it took, into a ring buffer owned by the calling thread
+// each thread writes only its own ring and publishes it with one atomic store, so recording
+// takes no lock and never waits for a dump; a ring keeps its last PROFILER_RING_EVENTS scopes
+// and overwrites the oldest, and the ring of a thread that exits is handed to the next one
+// ProfilerWriteChromeTrace() writes every ring as Chrome trace_event JSON, which
+// chrome://tracing and https://ui.perfetto.dev open
+// building with TICTACTOE_PROFILER=0 (the CMake option of the same name) makes PROFILE_SCOPE
+// expand to nothing; the functions stay, and a dump is then an empty trace
+//
+
+#ifndef TICTACTOE_PROFILER
+#define TICTACTOE_PROFILER 1
+#endif
+
+constexpr size_t PROFILER_RING_EVENTS = 4096;      // per thread, a power of two
+
+// names have to be string literals, or outlive every dump: only the pointer is stored
+struct ProfileEvent
+{
+    const char *name = nullptr;
+    uint64_t    start = 0;          // nanoseconds since the profiler's epoch
+    uint64_t    duration = 0;       // nanoseconds
+    uint32_t    thread = 0;         // small id, in the order threads first recorded a scope
+};
+
+// a monotonic clock in nanoseconds since the first call
+uint64_t        ProfilerNow();
+// append an event to the calling thread's ring; what ProfileScope calls on the way out
+void            ProfilerRecord(const char *name, uint64_t start, uint64_t duration);
+
+// labels the calling thread's events in the trace, e.g. "main" or "AI worker"
+void            ProfilerSetThreadName(const char *name);
+
+// recording can be paused at run time; a paused ProfileScope still reads the clock
+void            ProfilerSetEnabled(bool enabled);
+bool            ProfilerEnabled();
+
+// every event still in a ring, as {"traceEvents": [...]} with complete ("X") events in
+// microseconds; returns the number of events written, or -1 if the file couldn't be written
+int             ProfilerWriteChromeTrace(const std::string &path);
+// drops every recorded event
+void            ProfilerClear();
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name) : _name(name), _start(ProfilerNow()) {}
+    ~ProfileScope() { ProfilerRecord(_name, _start, ProfilerNow() - _start); }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *_name;
+    uint64_t    _start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#if TICTACTOE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+//
+// counters the searches keep for the demo's telemetry panel and the bench tools
+// building with TICTACTOE_SEARCH_STATS=0 (the CMake option of the same name) turns StatCounter
+// into an empty struct whose operations do nothing and whose value() is always 0, so the
+// counting compiles away and the search loops are the same code as without it
+//
+
+#ifndef TICTACTOE_SEARCH_STATS
+#define TICTACTOE_SEARCH_STATS 1
+#endif
+
+constexpr bool SEARCH_STATS_ENABLED = TICTACTOE_SEARCH_STATS != 0;
+
+#if TICTACTOE_SEARCH_STATS
+
+class StatCounter
+{
+public:
+    void        operator++() { _value++; }
+    void        add(uint64_t count) { _value += count; }
+    void        reset() { _value = 0; }
+    uint64_t    value() const { return _value; }
+
+private:
+    uint64_t    _value = 0;
+};
+
+#else
+
+class StatCounter
+{
+public:
+    void        operator++() {}
+    void        add(uint64_t) {}
+    void        reset() {}
+    constexpr uint64_t value() const { return 0; }
+};
+
+#endif
+
+// part of a count, 0 when nothing was counted
+inline double StatRatio(uint64_t part, uint64_t whole)
+{
+    return (whole == 0) ? 0.0 : (double)part / (double)whole;
+}
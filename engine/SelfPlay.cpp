@@ -0,0 +1,184 @@
+#include "SelfPlay.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+SelfPlayStats &SelfPlayStats::operator+=(const SelfPlayGame &game)
+{
+    games++;
+    if (game.winner == 1) xWins++;
+    else if (game.winner == 2) oWins++;
+    else draws++;
+    plies += game.plies;
+    nodes += game.nodes;
+    return *this;
+}
+
+static int RandomMove(const MnkBoard &board, std::mt19937 &rng)
+{
+    const CellMask empty = board.emptyCells();
+    const int count = empty.count();
+    if (count == 0) {
+        return -1;
+    }
+    int pick = std::uniform_int_distribution<int>(0, count - 1)(rng);
+    int move = -1;
+    empty.forEach([&](int cell) {
+        if (pick-- == 0) move = cell;
+    });
+    return move;
+}
+
+static bool ClassicRules(const MnkRules &rules)
+{
+    return rules.width() == 3 && rules.height() == 3 && rules.winLength() == 3;
+}
+
+int SelfPlayEngineMove(const SelfPlayPlayer &player, const MnkBoard &board, std::mt19937 &rng,
+                       TranspositionTable *table, uint64_t &nodes)
+{
+    SelfPlayEngine engine = player.engine;
+    // the 3x3 engines only know the classic board
+    if (engine != kEngineRandom && engine != kEngineMnk && !ClassicRules(board.rules())) {
+        engine = kEngineMnk;
+    }
+    // only the m,n,k search has levels
+    if (engine != kEngineRandom && player.strength != kMnkStrengthHard) {
+        engine = kEngineMnk;
+    }
+
+    if (engine == kEngineRandom) {
+        return RandomMove(board, rng);
+    }
+    if (engine == kEngineMnk) {
+        MnkSearchOptions options;
+        if (player.depth > 0) options.maxDepth = player.depth;
+        options.timeBudget = player.timeBudget;
+        MnkApplyStrength(options, player.strength);
+        // drawn only when it is used, so a game between hard engines plays as it always has
+        if (options.temperature > 0) options.seed = (uint32_t)rng();
+        const MnkSearchResult result = MnkSearchBestMove(board, options);
+        nodes += result.nodes;
+        return result.move;
+    }
+
+    SearchOptions options;
+    options.mode = (engine == kEngineNegamax) ? kSearchPlain :
+                   (engine == kEngineNullWindow) ? kSearchNullWindow :
+                   (engine == kEngineTable) ? kSearchTable : kSearchAlphaBeta;
+    options.table = table;
+    const SearchResult result = SearchBestMove(Bitboard::fromStateString(board.toState()), options);
+    nodes += result.nodes;
+    return result.move;
+}
+
+SelfPlayGame PlaySelfPlayGame(const SelfPlayConfig &config, uint64_t gameIndex, TranspositionTable *table)
+{
+    const MnkRules rules(config.width, config.height, config.winLength);
+    MnkBoard board(rules);
+    // one generator per game, so the openings don't depend on which thread plays which game
+    std::seed_seq seeds = { config.seed, (uint32_t)gameIndex, (uint32_t)(gameIndex >> 32) };
+    std::mt19937 rng(seeds);
+    if (table) {
+        table->clear();
+    }
+
+    SelfPlayGame game;
+    while (!board.gameOver()) {
+        const int side = board.sideToMove();
+        const int move = (game.plies < config.randomPlies) ? RandomMove(board, rng)
+                                                           : SelfPlayEngineMove(config.players[side - 1], board, rng, table, game.nodes);
+        if (move < 0 || board.cellAt(move) != 0) {
+            break;
+        }
+        board.makeMove(move);
+        game.moves.push_back((int16_t)move);
+        game.plies++;
+    }
+    game.winner = board.winner();
+    return game;
+}
+
+// games played between two writes to the record file
+constexpr int SELF_PLAY_BATCH = 4096;
+
+SelfPlayStats RunSelfPlay(const SelfPlayConfig &config, int games, int threads, GameRecordWriter *record)
+{
+    threads = SearchThreadCount(threads);
+    std::vector<TranspositionTable> tables(threads);
+    std::vector<SelfPlayGame> batch;
+    SelfPlayStats stats;
+    const auto start = std::chrono::steady_clock::now();
+    // the threads fill a batch, then this thread writes it out in game order and tallies it,
+    // so the record file is the same whatever the thread count
+    for (int first = 0; first < games; first += SELF_PLAY_BATCH) {
+        batch.assign(std::min(SELF_PLAY_BATCH, games - first), SelfPlayGame());
+        ParallelFor((int)batch.size(), threads, [&](int i, int thread) {
+            batch[i] = PlaySelfPlayGame(config, (uint64_t)(first + i), &tables[thread]);
+        });
+        for (size_t i = 0; i < batch.size(); ++i) {
+            stats += batch[i];
+            if (record) {
+                GameRecord game;
+                game.width = config.width;
+                game.height = config.height;
+                game.winLength = config.winLength;
+                game.winner = batch[i].winner;
+                game.gameNumber = (uint64_t)first + i;
+                game.moves = std::move(batch[i].moves);
+                record->write(game);
+            }
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+const char *SelfPlayEngineName(SelfPlayEngine engine)
+{
+    switch (engine) {
+    case kEngineRandom:     return "random";
+    case kEngineNegamax:    return "negamax";
+    case kEngineAlphaBeta:  return "alphabeta";
+    case kEngineNullWindow: return "pvs";
+    case kEngineTable:      return "table";
+    case kEngineMnk:        return "mnk";
+    }
+    return "unknown";
+}
+
+bool ParseSelfPlayEngine(const char *name, SelfPlayEngine &engine)
+{
+    for (int e = kEngineRandom; e <= kEngineMnk; ++e) {
+        if (strcmp(name, SelfPlayEngineName((SelfPlayEngine)e)) == 0) {
+            engine = (SelfPlayEngine)e;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseSelfPlayPlayer(const char *spec, SelfPlayPlayer &player)
+{
+    const std::string text = spec;
+    size_t end = text.find(':');
+    if (!ParseSelfPlayEngine(text.substr(0, end).c_str(), player.engine)) {
+        return false;
+    }
+    while (end != std::string::npos) {
+        const size_t start = end + 1;
+        end = text.find(':', start);
+        const std::string part = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (!part.empty() && part.find_first_not_of("0123456789") == std::string::npos) {
+            player.depth = atoi(part.c_str());
+        } else if (!ParseMnkStrength(part.c_str(), player.strength)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include "Negamax.h"
+#include "MnkSearch.h"
+#include "GameRecord.h"
+
+//
+// headless AI-vs-AI games, for regression-testing the engines without the UI
+// each game may open with a few random plies, drawn from a generator seeded by the run's seed
+// and the game's number, so a game plays out the same whichever thread runs it
+// the 3x3 board can use any engine; other sizes use the m,n,k search (or random moves)
+//
+
+enum SelfPlayEngine
+{
+    kEngineRandom,          // a uniformly random empty cell
+    kEngineNegamax,         // 3x3 only: plain negamax
+    kEngineAlphaBeta,       // 3x3 only: alpha-beta with a transposition table
+    kEngineNullWindow,      // 3x3 only: PVS with a transposition table
+    kEngineTable,           // 3x3 only: the perfect-play table
+    kEngineMnk              // any board: iterative deepening m,n,k search
+};
+
+struct SelfPlayPlayer
+{
+    SelfPlayEngine  engine = kEngineTable;
+    int             depth = 0;          // m,n,k depth limit, 0 = none
+    int64_t         timeBudget = 0;     // m,n,k microseconds per move, 0 = none
+    // below hard, every engine but random plays the m,n,k search at that level
+    MnkStrength     strength = kMnkStrengthHard;
+};
+
+struct SelfPlayConfig
+{
+    int             width = 3;
+    int             height = 3;
+    int             winLength = 3;
+    SelfPlayPlayer  players[2];         // [0] plays X and moves first, [1] plays O
+    int             randomPlies = 0;    // opening plies played at random before the engines take over
+    uint32_t        seed = 1;
+};
+
+struct SelfPlayGame
+{
+    int             winner = 0;         // 0 draw, 1 X, 2 O
+    int             plies = 0;
+    uint64_t        nodes = 0;          // searched by both engines
+    std::vector<int16_t> moves;         // cell per ply, X first
+};
+
+struct SelfPlayStats
+{
+    uint64_t        games = 0;
+    uint64_t        xWins = 0;
+    uint64_t        oWins = 0;
+    uint64_t        draws = 0;
+    uint64_t        plies = 0;
+    uint64_t        nodes = 0;
+    double          seconds = 0;        // wall-clock for the whole run
+
+    SelfPlayStats   &operator+=(const SelfPlayGame &game);
+};
+
+// the move player picks for board's side to move, -1 if there is none; random engines draw from
+// rng, the 3x3 searches use table if given, and the nodes searched are added to nodes
+int             SelfPlayEngineMove(const SelfPlayPlayer &player, const MnkBoard &board, std::mt19937 &rng,
+                                   TranspositionTable *table, uint64_t &nodes);
+
+// plays game number gameIndex of the run; table, if given, is cleared and used by the 3x3 searches
+SelfPlayGame    PlaySelfPlayGame(const SelfPlayConfig &config, uint64_t gameIndex, TranspositionTable *table = nullptr);
+
+// plays games 0..games-1 spread over threads (0 = one per hardware thread)
+// with a record writer, every game is appended to it in game order, a batch at a time
+SelfPlayStats   RunSelfPlay(const SelfPlayConfig &config, int games, int threads, GameRecordWriter *record = nullptr);
+
+const char      *SelfPlayEngineName(SelfPlayEngine engine);
+// false if name isn't one of SelfPlayEngineName()'s
+bool            ParseSelfPlayEngine(const char *name, SelfPlayEngine &engine);
+// "ENGINE[:DEPTH][:LEVEL]", e.g. "mnk:4" or "mnk:easy"; false if a part isn't recognised
+bool            ParseSelfPlayPlayer(const char *spec, SelfPlayPlayer &player);
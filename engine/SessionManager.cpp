@@ -0,0 +1,198 @@
+#include "SessionManager.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <random>
+
+// most requests a worker takes at once; a short queue is split evenly so every thread gets some
+constexpr size_t SESSION_BATCH = 64;
+
+SessionManager::SessionManager(int threads, uint32_t seed) : _seed(seed), _threadCount(SearchThreadCount(threads))
+{
+    for (int i = 0; i < _threadCount; ++i) {
+        _threads.emplace_back(&SessionManager::run, this);
+    }
+}
+
+SessionManager::~SessionManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+        _requests.clear();
+    }
+    _wake.notify_all();
+    for (std::thread &thread : _threads) {
+        thread.join();
+    }
+}
+
+std::shared_ptr<const MnkRules> SessionManager::rulesFor(const GameSessionSettings &settings)
+{
+    for (const std::shared_ptr<const MnkRules> &rules : _rules) {
+        if (rules->width() == settings.width && rules->height() == settings.height && rules->winLength() == settings.winLength) {
+            return rules;
+        }
+    }
+    _rules.push_back(std::make_shared<const MnkRules>(settings.width, settings.height, settings.winLength));
+    return _rules.back();
+}
+
+uint64_t SessionManager::open(const GameSessionSettings &settings)
+{
+    const uint64_t id = _nextId++;
+    std::seed_seq seeds = { _seed, (uint32_t)id, (uint32_t)(id >> 32) };
+    std::mt19937 rng(seeds);
+    _index[id] = _sessions.size();
+    _sessions.push_back(std::make_unique<GameSession>(id, settings, rulesFor(settings), (uint32_t)rng()));
+    return id;
+}
+
+bool SessionManager::close(uint64_t id)
+{
+    const auto found = _index.find(id);
+    if (found == _index.end()) {
+        return false;
+    }
+    const size_t position = found->second;
+    addResults(*_sessions[position], _closedResults);
+    _sessions.erase(_sessions.begin() + position);
+    _index.erase(found);
+    for (size_t i = position; i < _sessions.size(); ++i) {
+        _index[_sessions[i]->id()] = i;
+    }
+    return true;
+}
+
+void SessionManager::closeAll()
+{
+    for (const std::unique_ptr<GameSession> &session : _sessions) {
+        addResults(*session, _closedResults);
+    }
+    _sessions.clear();
+    _index.clear();
+    // nobody is left to play these; one a worker has already taken is dropped when it comes back
+    std::lock_guard<std::mutex> lock(_mutex);
+    _requests.clear();
+}
+
+GameSession *SessionManager::find(uint64_t id)
+{
+    const auto found = _index.find(id);
+    return (found == _index.end()) ? nullptr : _sessions[found->second].get();
+}
+
+int SessionManager::update()
+{
+    PROFILE_SCOPE("SessionManager::update");
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _received.swap(_replies);
+    }
+    int played = 0;
+    for (const GameSessionReply &reply : _received) {
+        GameSession *session = find(reply.session);
+        if (session && session->applyAIMove(reply.ticket, reply.move, reply.nodes)) {
+            played++;
+        }
+    }
+    _received.clear();
+    _aiMoves += played;
+
+    for (const std::unique_ptr<GameSession> &session : _sessions) {
+        if (session->gameOver() && session->settings().rematch) {
+            session->reset();
+        }
+        if (session->wantsAIMove()) {
+            _outgoing.push_back(session->requestAIMove());
+        }
+    }
+    if (!_outgoing.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (GameSessionRequest &request : _outgoing) {
+                _requests.push_back(std::move(request));
+            }
+        }
+        _outgoing.clear();
+        _wake.notify_all();
+    }
+    return played;
+}
+
+bool SessionManager::waitForReplies(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _ready.wait_for(lock, timeout, [this] { return !_replies.empty(); });
+}
+
+size_t SessionManager::pendingRequests() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests.size() + _searching;
+}
+
+void SessionManager::addResults(const GameSession &session, SessionResults &results) const
+{
+    results.draws += session.results(0);
+    results.xWins += session.results(1);
+    results.oWins += session.results(2);
+    results.games += session.results(0) + session.results(1) + session.results(2);
+}
+
+SessionResults SessionManager::results() const
+{
+    SessionResults results = _closedResults;
+    for (const std::unique_ptr<GameSession> &session : _sessions) {
+        addResults(*session, results);
+    }
+    return results;
+}
+
+void SessionManager::run()
+{
+    ProfilerSetThreadName("session worker");
+    // the 3x3 searches keep their table across requests: keys are whole positions, so entries
+    // from other sessions' games are still right
+    TranspositionTable table;
+    std::mt19937 rng;
+    std::vector<GameSessionRequest> batch;
+    std::vector<GameSessionReply> replies;
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _wake.wait(lock, [this] { return _quit || !_requests.empty(); });
+        if (_quit) {
+            break;
+        }
+        const size_t take = std::clamp(_requests.size() / (size_t)_threadCount, (size_t)1, SESSION_BATCH);
+        batch.assign(std::make_move_iterator(_requests.begin()), std::make_move_iterator(_requests.begin() + take));
+        _requests.erase(_requests.begin(), _requests.begin() + take);
+        _searching += take;
+        lock.unlock();
+
+        replies.clear();
+        {
+            PROFILE_SCOPE("SessionManager batch");
+            for (const GameSessionRequest &request : batch) {
+                MnkBoard board(*request.rules);
+                board.setStateString(request.state);
+                // seeding a generator costs more than a table move, so only random moves pay for it
+                if (request.player.engine == kEngineRandom) rng.seed(request.seed);
+                GameSessionReply reply;
+                reply.session = request.session;
+                reply.ticket = request.ticket;
+                reply.move = SelfPlayEngineMove(request.player, board, rng, &table, reply.nodes);
+                replies.push_back(reply);
+            }
+        }
+
+        lock.lock();
+        _searching -= take;
+        _replies.insert(_replies.end(), replies.begin(), replies.end());
+        lock.unlock();
+        _ready.notify_all();
+        if (_onReply) _onReply();
+        lock.lock();
+    }
+}
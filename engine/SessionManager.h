@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "GameSession.h"
+
+//
+// hosts any number of GameSessions in one process and runs their AI moves on a shared pool
+// of worker threads; the sessions themselves belong to the thread that calls update(), which
+// is the only one that touches them
+// update() gathers one request from every session whose AI is to move and queues them under
+// a single lock; each worker takes a batch off the queue, searches it and hands the replies
+// back in one go, so locking and wake-ups are per batch rather than per move
+// sessions on the same board size share one MnkRules, so a thousand Gomoku games hold one
+// set of line masks
+//
+
+struct GameSessionReply
+{
+    uint64_t        session = 0;
+    uint64_t        ticket = 0;
+    int             move = -1;
+    uint64_t        nodes = 0;
+};
+
+// finished games across every session, including closed ones
+struct SessionResults
+{
+    uint64_t        games = 0;
+    uint64_t        xWins = 0;
+    uint64_t        oWins = 0;
+    uint64_t        draws = 0;
+};
+
+class SessionManager
+{
+public:
+    // threads = 0 starts one worker per hardware thread; each session's random openings are
+    // drawn from seed and its id, so a run with the same seed plays the same games
+    explicit SessionManager(int threads = 0, uint32_t seed = 1);
+    ~SessionManager();
+    SessionManager(const SessionManager &) = delete;
+    SessionManager &operator=(const SessionManager &) = delete;
+
+    // a new session, started on the next update(); returns its id, never 0
+    uint64_t        open(const GameSessionSettings &settings);
+    // false if there is no such session; a reply still out for it is dropped
+    bool            close(uint64_t id);
+    void            closeAll();
+
+    GameSession     *find(uint64_t id);
+    size_t          size() const { return _sessions.size(); }
+    // in the order they were opened
+    GameSession     &at(size_t index) { return *_sessions[index]; }
+
+    //
+    // plays every reply that has come back, starts a rematch in every finished session that
+    // wants one, and queues a request for every session whose AI is to move
+    // returns the number of AI moves played
+    //
+    int             update();
+    // block until a reply is ready or timeout passes; true if one is
+    bool            waitForReplies(std::chrono::milliseconds timeout);
+
+    // requests queued or being searched
+    size_t          pendingRequests() const;
+    int             threadCount() const { return _threadCount; }
+    SessionResults  results() const;
+    uint64_t        aiMoves() const { return _aiMoves; }
+
+    // called on a worker thread after it hands back a batch, e.g. to wake a render loop;
+    // set it before the first update()
+    void            setReplyCallback(std::function<void()> callback) { _onReply = std::move(callback); }
+
+private:
+    void            run();
+    std::shared_ptr<const MnkRules> rulesFor(const GameSessionSettings &settings);
+    void            addResults(const GameSession &session, SessionResults &results) const;
+
+    std::vector<std::unique_ptr<GameSession>>   _sessions;
+    std::unordered_map<uint64_t, size_t>        _index;         // session id -> position in _sessions
+    std::vector<std::shared_ptr<const MnkRules>> _rules;        // one per board size in use
+    uint64_t                        _nextId = 1;
+    uint32_t                        _seed;
+    SessionResults                  _closedResults;             // of sessions that were closed
+    uint64_t                        _aiMoves = 0;
+
+    std::vector<GameSessionReply>   _received;      // update()'s buffers, kept to reuse their memory
+    std::vector<GameSessionRequest> _outgoing;
+
+    int                             _threadCount;
+    std::vector<std::thread>        _threads;
+    mutable std::mutex              _mutex;
+    std::condition_variable         _wake;          // requests were queued, or shutdown
+    std::condition_variable         _ready;         // replies were handed back
+    std::deque<GameSessionRequest>  _requests;
+    std::vector<GameSessionReply>   _replies;
+    size_t                          _searching = 0; // requests a worker has taken and not answered
+    bool                            _quit = false;
+    std::function<void()>           _onReply;
+};
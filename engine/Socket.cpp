@@ -0,0 +1,239 @@
+#include "Socket.h"
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socklen_t = int;
+const SocketHandle INVALID_SOCKET_HANDLE = (SocketHandle)INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+const SocketHandle INVALID_SOCKET_HANDLE = -1;
+#endif
+
+static bool SetNonBlocking(SocketHandle socket)
+{
+#ifdef _WIN32
+    u_long on = 1;
+    return ioctlsocket((SOCKET)socket, FIONBIO, &on) == 0;
+#else
+    const int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static void SetNoDelay(SocketHandle socket)
+{
+    // replies are a few bytes each: without this, Nagle holds them back for the client's ack
+    int on = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+}
+
+static bool WouldBlock()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+static sockaddr_in Address(uint32_t host, uint16_t port)
+{
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(host);
+    address.sin_port = htons(port);
+    return address;
+}
+
+bool SocketStartup()
+{
+#ifdef _WIN32
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+#else
+    // a client that hangs up mid-reply must not kill the server with SIGPIPE
+    static const bool started = [] {
+        signal(SIGPIPE, SIG_IGN);
+        return true;
+    }();
+    return started;
+#endif
+}
+
+SocketHandle SocketListen(uint16_t port, bool anyAddress)
+{
+    const SocketHandle listener = (SocketHandle)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+    int on = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on));
+    const sockaddr_in address = Address(anyAddress ? INADDR_ANY : INADDR_LOOPBACK, port);
+    if (bind(listener, (const sockaddr *)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0 ||
+        !SetNonBlocking(listener)) {
+        SocketClose(listener);
+        return INVALID_SOCKET_HANDLE;
+    }
+    return listener;
+}
+
+uint16_t SocketLocalPort(SocketHandle socket)
+{
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (getsockname(socket, (sockaddr *)&address, &length) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+SocketHandle SocketAccept(SocketHandle listener)
+{
+    const SocketHandle client = (SocketHandle)accept(listener, nullptr, nullptr);
+    if (client == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+    if (!SetNonBlocking(client)) {
+        SocketClose(client);
+        return INVALID_SOCKET_HANDLE;
+    }
+    SetNoDelay(client);
+    return client;
+}
+
+SocketHandle SocketConnect(const char *host, uint16_t port)
+{
+    in_addr parsed;
+    if (inet_pton(AF_INET, host, &parsed) != 1) {
+        return INVALID_SOCKET_HANDLE;
+    }
+    const SocketHandle client = (SocketHandle)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (client == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+    const sockaddr_in address = Address(ntohl(parsed.s_addr), port);
+    if (connect(client, (const sockaddr *)&address, sizeof(address)) != 0) {
+        SocketClose(client);
+        return INVALID_SOCKET_HANDLE;
+    }
+    SetNoDelay(client);
+    return client;
+}
+
+SocketHandle SocketWakeupPair()
+{
+    const SocketHandle wakeup = (SocketHandle)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wakeup == INVALID_SOCKET_HANDLE) {
+        return INVALID_SOCKET_HANDLE;
+    }
+    // connected to itself, so a send lands in its own receive queue
+    sockaddr_in address = Address(INADDR_LOOPBACK, 0);
+    socklen_t length = sizeof(address);
+    if (bind(wakeup, (const sockaddr *)&address, sizeof(address)) != 0 ||
+        getsockname(wakeup, (sockaddr *)&address, &length) != 0 ||
+        connect(wakeup, (const sockaddr *)&address, sizeof(address)) != 0 || !SetNonBlocking(wakeup)) {
+        SocketClose(wakeup);
+        return INVALID_SOCKET_HANDLE;
+    }
+    return wakeup;
+}
+
+void SocketSignal(SocketHandle wakeup)
+{
+    const char byte = 0;
+    // a full queue already holds a wake-up, so a failed send loses nothing
+    send(wakeup, &byte, 1, 0);
+}
+
+void SocketDrain(SocketHandle wakeup)
+{
+    char bytes[64];
+    while (recv(wakeup, bytes, sizeof(bytes), 0) > 0) {
+    }
+}
+
+long SocketSend(SocketHandle socket, const char *data, size_t size)
+{
+#ifdef _WIN32
+    const long sent = send((SOCKET)socket, data, (int)size, 0);
+#else
+#ifdef MSG_NOSIGNAL
+    const long sent = (long)send(socket, data, size, MSG_NOSIGNAL);
+#else
+    const long sent = (long)send(socket, data, size, 0);
+#endif
+#endif
+    return (sent < 0) ? (WouldBlock() ? -2 : -1) : sent;
+}
+
+long SocketReceive(SocketHandle socket, char *data, size_t size)
+{
+#ifdef _WIN32
+    const long received = recv((SOCKET)socket, data, (int)size, 0);
+#else
+    const long received = (long)recv(socket, data, size, 0);
+#endif
+    return (received < 0) ? (WouldBlock() ? -2 : -1) : received;
+}
+
+void SocketClose(SocketHandle socket)
+{
+#ifdef _WIN32
+    closesocket((SOCKET)socket);
+#else
+    close(socket);
+#endif
+}
+
+int SocketPoll(SocketPollEntry *entries, size_t count, int timeoutMs)
+{
+    // kept across calls: the event loop polls every iteration
+    static thread_local std::vector<pollfd> fds;
+    fds.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        fds[i].fd = (decltype(fds[i].fd))entries[i].socket;
+        fds[i].events = (short)((entries[i].wantRead ? POLLIN : 0) | (entries[i].wantWrite ? POLLOUT : 0));
+        fds[i].revents = 0;
+    }
+#ifdef _WIN32
+    const int ready = WSAPoll(fds.data(), (ULONG)count, timeoutMs);
+#else
+    const int ready = poll(fds.data(), (nfds_t)count, timeoutMs);
+    // a signal cut the wait short: nothing is ready, the caller polls again
+    if (ready < 0 && errno == EINTR) {
+        return 0;
+    }
+#endif
+    if (ready < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        entries[i].readable = (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+        entries[i].writable = (fds[i].revents & POLLOUT) != 0;
+    }
+    return ready;
+}
+
+std::string SocketError()
+{
+#ifdef _WIN32
+    return "Winsock error " + std::to_string(WSAGetLastError());
+#else
+    return std::strerror(errno);
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//
+// the few socket calls the move server and its clients need, over BSD sockets or Winsock
+// every handle here is a TCP or UDP socket on IPv4; errors come back as -1 / false with the
+// reason from SocketError(), nothing throws
+//
+
+#ifdef _WIN32
+using SocketHandle = uintptr_t;
+#else
+using SocketHandle = int;
+#endif
+extern const SocketHandle INVALID_SOCKET_HANDLE;
+
+// Winsock has to be started once per process; elsewhere this does nothing
+bool            SocketStartup();
+
+// a non-blocking TCP socket listening on port (0 picks a free one), on 127.0.0.1 only unless
+// anyAddress; INVALID_SOCKET_HANDLE on failure
+SocketHandle    SocketListen(uint16_t port, bool anyAddress);
+// the port a socket is bound to, 0 on failure
+uint16_t        SocketLocalPort(SocketHandle socket);
+// the next pending connection, non-blocking and with Nagle off; INVALID_SOCKET_HANDLE if none
+SocketHandle    SocketAccept(SocketHandle listener);
+// a blocking TCP connection to host:port (a dotted IPv4 address), with Nagle off
+SocketHandle    SocketConnect(const char *host, uint16_t port);
+
+// a non-blocking UDP socket bound to a loopback port, that SocketSignal() sends a byte to:
+// a thread outside an event loop uses it to wake the loop's SocketPoll()
+SocketHandle    SocketWakeupPair();
+void            SocketSignal(SocketHandle wakeup);
+void            SocketDrain(SocketHandle wakeup);
+
+// bytes moved, 0 if the peer closed, -1 on error, and -2 if a non-blocking socket would block
+long            SocketSend(SocketHandle socket, const char *data, size_t size);
+long            SocketReceive(SocketHandle socket, char *data, size_t size);
+void            SocketClose(SocketHandle socket);
+
+// the iteration's events per socket, like poll()'s: set wantWrite to wait for room to send
+struct SocketPollEntry
+{
+    SocketHandle    socket;
+    bool            wantRead = true;
+    bool            wantWrite = false;
+    bool            readable = false;   // also set on a hang-up or an error, so a receive sees it
+    bool            writable = false;
+};
+
+// blocks until any entry is ready or timeoutMs passes (-1 = no limit); the number ready, -1 on error
+int             SocketPoll(SocketPollEntry *entries, size_t count, int timeoutMs);
+
+std::string     SocketError();
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//
+// a state string ('0' empty, '1' X, '2' O per cell, left-to-right, top-to-bottom) held in a
+// fixed-size buffer, so encoding a position costs no allocation: view() is what the state-string
+// interfaces take, and str() makes a heap copy only where a std::string has to leave the
+// program, e.g. a save file or another thread's job
+// ternaryKey() reads the same cells as one integer, cell i contributing its digit * 3^i, the
+// order the perfect-play table (engine/PerfectPlay.h) indexes 3x3 positions in
+//
+
+constexpr size_t STATE_MAX_CELLS = 19 * 19;     // the largest board, MNK_MAX_CELLS
+constexpr size_t STATE_KEY_MAX_CELLS = 40;      // 3^40 still fits in 64 bits
+
+template <size_t Capacity>
+class StateBuffer
+{
+public:
+    constexpr StateBuffer() = default;
+    // cells empty cells, at most Capacity
+    constexpr explicit StateBuffer(size_t cells) : _size(cells < Capacity ? cells : Capacity)
+    {
+        for (size_t i = 0; i < _size; ++i) _chars[i] = '0';
+    }
+    // a copy of s, cut to Capacity
+    static constexpr StateBuffer fromView(std::string_view s)
+    {
+        StateBuffer state;
+        state._size = s.size() < Capacity ? s.size() : Capacity;
+        for (size_t i = 0; i < state._size; ++i) state._chars[i] = s[i];
+        return state;
+    }
+
+    constexpr size_t            size() const { return _size; }
+    // 0 empty, 1 or 2
+    constexpr int               at(size_t cell) const { return _chars[cell] - '0'; }
+    constexpr void              set(size_t cell, int player) { _chars[cell] = (char)('0' + player); }
+
+    constexpr std::string_view  view() const { return std::string_view(_chars.data(), _size); }
+    constexpr                   operator std::string_view() const { return view(); }
+    std::string                 str() const { return std::string(view()); }
+
+    constexpr uint64_t          ternaryKey() const
+    {
+        static_assert(Capacity <= STATE_KEY_MAX_CELLS, "a base-3 key of this many cells overflows 64 bits");
+        uint64_t key = 0;
+        for (size_t i = _size; i-- > 0;) key = key * 3 + (uint64_t)at(i);
+        return key;
+    }
+
+    constexpr bool operator==(const StateBuffer &other) const { return view() == other.view(); }
+
+private:
+    std::array<char, Capacity>  _chars{};
+    size_t                      _size = 0;
+};
+
+// s holds exactly cells digits, each 0, 1 or 2
+constexpr bool IsStateString(std::string_view s, size_t cells)
+{
+    if (s.size() != cells) {
+        return false;
+    }
+    for (char c : s) {
+        if (c < '0' || c > '2') return false;
+    }
+    return true;
+}
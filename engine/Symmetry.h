@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Bitboard.h"
+
+//
+// the 8 rotations and reflections of the 3x3 board (the dihedral group D4)
+// a position and its 7 images always have the same value, so the search and the
+// transposition table work on one canonical representative: the image with the smallest key()
+//
+
+constexpr int SYMMETRY_COUNT = 8;
+
+enum SymmetryTransform
+{
+    kIdentity,
+    kRotate90,              // clockwise
+    kRotate180,
+    kRotate270,
+    kFlipHorizontal,        // mirror left <-> right
+    kFlipVertical,          // mirror top <-> bottom
+    kTranspose,             // mirror on the main diagonal
+    kAntiTranspose          // mirror on the other diagonal
+};
+
+// TRANSFORM_CELL[t][i] is where cell i ends up under transform t
+constexpr std::array<std::array<int8_t, BOARD_CELLS>, SYMMETRY_COUNT> TRANSFORM_CELL = [] {
+    std::array<std::array<int8_t, BOARD_CELLS>, SYMMETRY_COUNT> table{};
+    for (int i = 0; i < BOARD_CELLS; ++i) {
+        const int r = i / 3, c = i % 3;
+        table[kIdentity][i]       = (int8_t)(r * 3 + c);
+        table[kRotate90][i]       = (int8_t)(c * 3 + (2 - r));
+        table[kRotate180][i]      = (int8_t)((2 - r) * 3 + (2 - c));
+        table[kRotate270][i]      = (int8_t)((2 - c) * 3 + r);
+        table[kFlipHorizontal][i] = (int8_t)(r * 3 + (2 - c));
+        table[kFlipVertical][i]   = (int8_t)((2 - r) * 3 + c);
+        table[kTranspose][i]      = (int8_t)(c * 3 + r);
+        table[kAntiTranspose][i]  = (int8_t)((2 - c) * 3 + (2 - r));
+    }
+    return table;
+}();
+
+// INVERSE_TRANSFORM[t] undoes t
+constexpr std::array<int8_t, SYMMETRY_COUNT> INVERSE_TRANSFORM = [] {
+    std::array<int8_t, SYMMETRY_COUNT> inverse{};
+    for (int t = 0; t < SYMMETRY_COUNT; ++t) {
+        for (int u = 0; u < SYMMETRY_COUNT; ++u) {
+            bool identity = true;
+            for (int i = 0; i < BOARD_CELLS; ++i) {
+                if (TRANSFORM_CELL[u][TRANSFORM_CELL[t][i]] != i) identity = false;
+            }
+            if (identity) inverse[t] = (int8_t)u;
+        }
+    }
+    return inverse;
+}();
+
+// TRANSFORM_MASK[t][mask] is the 9-bit mask with every cell moved by t, 8 KB in total
+constexpr std::array<std::array<uint16_t, 512>, SYMMETRY_COUNT> TRANSFORM_MASK = [] {
+    std::array<std::array<uint16_t, 512>, SYMMETRY_COUNT> table{};
+    for (int t = 0; t < SYMMETRY_COUNT; ++t) {
+        for (int mask = 0; mask < 512; ++mask) {
+            uint16_t image = 0;
+            for (int i = 0; i < BOARD_CELLS; ++i) {
+                if (mask & (1 << i)) image |= (uint16_t)(1 << TRANSFORM_CELL[t][i]);
+            }
+            table[t][mask] = image;
+        }
+    }
+    return table;
+}();
+
+constexpr int TransformCell(int transform, int cell) { return TRANSFORM_CELL[transform][cell]; }
+constexpr int InverseTransformCell(int transform, int cell) { return TRANSFORM_CELL[INVERSE_TRANSFORM[transform]][cell]; }
+
+constexpr Bitboard TransformBoard(int transform, const Bitboard &board)
+{
+    Bitboard image;
+    image.x = TRANSFORM_MASK[transform][board.x];
+    image.o = TRANSFORM_MASK[transform][board.o];
+    return image;
+}
+
+struct CanonicalPosition
+{
+    Bitboard    board;          // TransformBoard(transform, original)
+    int         transform;      // maps the original onto board, cells map with TransformCell()
+};
+
+//
+// branch-free: all 8 images are looked up and the smallest (key, transform) pair wins
+//
+constexpr CanonicalPosition Canonicalize(const Bitboard &board)
+{
+    uint32_t best = UINT32_MAX;
+    for (int t = 0; t < SYMMETRY_COUNT; ++t) {
+        const uint32_t key = (uint32_t)TRANSFORM_MASK[t][board.x] | ((uint32_t)TRANSFORM_MASK[t][board.o] << 9);
+        best = std::min(best, (key << 3) | (uint32_t)t);
+    }
+    CanonicalPosition canonical;
+    canonical.transform = (int)(best & 7);
+    canonical.board.x = (uint16_t)((best >> 3) & BOARD_MASK);
+    canonical.board.o = (uint16_t)((best >> 12) & BOARD_MASK);
+    return canonical;
+}
+
+// bit t is set if transform t leaves board unchanged (bit 0, the identity, is always set)
+constexpr uint8_t Symmetries(const Bitboard &board)
+{
+    uint8_t symmetries = 0;
+    for (int t = 0; t < SYMMETRY_COUNT; ++t) {
+        if (TransformBoard(t, board) == board) symmetries |= (uint8_t)(1 << t);
+    }
+    return symmetries;
+}
+
+static_assert(Canonicalize(Bitboard{0x004, 0}).board == Bitboard{0x001, 0}, "corners canonicalise to the top-left");
+static_assert(Symmetries(Bitboard()) == 0xFF, "the empty board has every symmetry");
@@ -0,0 +1,312 @@
+#include "Tablebase.h"
+#include "Parallel.h"
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "tablebases are little-endian");
+
+static const char TABLEBASE_MAGIC[4] = { 'T', 'T', 'T', 'E' };
+constexpr size_t TABLEBASE_HEADER_SIZE = 32;
+
+struct TablebaseHeader
+{
+    char        magic[4];
+    uint16_t    version;
+    uint16_t    headerSize;
+    uint8_t     width;
+    uint8_t     height;
+    uint8_t     winLength;
+    uint8_t     reserved8;
+    uint32_t    reserved32;
+    uint64_t    entries;
+    uint64_t    reserved64;
+};
+static_assert(sizeof(TablebaseHeader) == TABLEBASE_HEADER_SIZE, "the header is read straight from the file");
+
+std::string TablebaseName(const MnkRules &rules)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%dx%d.tb", rules.width(), rules.height(), rules.winLength());
+    return name;
+}
+
+// ---------------------------------------------------------------------------------------
+
+// the bits of stones that lie in cells, packed down to the low bits, and back
+static uint32_t Compress(uint32_t stones, uint32_t cells)
+{
+#if defined(__BMI2__)
+    return _pext_u32(stones, cells);
+#else
+    uint32_t packed = 0;
+    for (uint32_t bit = 1; cells; cells &= cells - 1, bit <<= 1) {
+        if (stones & cells & (0u - cells)) packed |= bit;
+    }
+    return packed;
+#endif
+}
+
+static uint32_t Expand(uint32_t packed, uint32_t cells)
+{
+#if defined(__BMI2__)
+    return _pdep_u32(packed, cells);
+#else
+    uint32_t stones = 0;
+    for (uint32_t bit = 1; cells; cells &= cells - 1, bit <<= 1) {
+        if (packed & bit) stones |= cells & (0u - cells);
+    }
+    return stones;
+#endif
+}
+
+// the next larger mask with as many bits set, which is the next set in rank order
+static uint32_t NextCombination(uint32_t set)
+{
+    const uint32_t filled = set | (set - 1);
+    return (filled + 1) | (((~filled & (filled + 1)) - 1) >> (std::countr_zero(set) + 1));
+}
+
+//
+// colex rank in the combinatorial number system: the i-th lowest cell c adds C(c, i + 1)
+//
+static uint64_t RankSet(uint32_t set, const uint64_t binomial[][TABLEBASE_MAX_CELLS + 1])
+{
+    uint64_t rank = 0;
+    for (int i = 1; set; set &= set - 1, ++i) {
+        rank += binomial[std::countr_zero(set)][i];
+    }
+    return rank;
+}
+
+static uint32_t UnrankSet(uint64_t rank, int size, int cells, const uint64_t binomial[][TABLEBASE_MAX_CELLS + 1])
+{
+    uint32_t set = 0;
+    int cell = cells - 1;
+    for (int i = size; i > 0; --i) {
+        while (binomial[cell][i] > rank) --cell;
+        set |= 1u << cell;
+        rank -= binomial[cell][i];
+        --cell;
+    }
+    return set;
+}
+
+bool Tablebase::setRules(const MnkRules &rules)
+{
+    if (rules.cellCount() > TABLEBASE_MAX_CELLS) {
+        return false;
+    }
+    _width = rules.width();
+    _height = rules.height();
+    _winLength = rules.winLength();
+    _cells = rules.cellCount();
+    _boardMask = (uint32_t)rules.boardMask().words[0];
+    _lines.clear();
+    for (const CellMask &line : rules.lines()) {
+        _lines.push_back((uint32_t)line.words[0]);
+    }
+    for (int n = 0; n <= TABLEBASE_MAX_CELLS; ++n) {
+        for (int k = 0; k <= TABLEBASE_MAX_CELLS; ++k) {
+            _binomial[n][k] = (k == 0) ? 1 : (n == 0) ? 0 : _binomial[n - 1][k - 1] + _binomial[n - 1][k];
+        }
+    }
+    _groupStart.assign(_cells + 2, 0);
+    _positions = 0;
+    for (int stones = 0; stones <= _cells; ++stones) {
+        const int x = (stones + 1) / 2, o = stones / 2;
+        const uint64_t size = _binomial[_cells][x] * _binomial[_cells - x][o];
+        _positions += size;
+        _groupStart[stones + 1] = (_groupStart[stones] + size + 3) & ~(uint64_t)3;
+    }
+    _entries = _groupStart[_cells + 1];
+    return true;
+}
+
+uint64_t Tablebase::index(uint32_t x, uint32_t o) const
+{
+    const int xCount = std::popcount(x), oCount = std::popcount(o);
+    return _groupStart[xCount + oCount] + RankSet(x, _binomial) * _binomial[_cells - xCount][oCount] +
+           RankSet(Compress(o, ~x & _boardMask), _binomial);
+}
+
+bool Tablebase::hasLine(uint32_t stones) const
+{
+    for (uint32_t line : _lines) {
+        if ((stones & line) == line) return true;
+    }
+    return false;
+}
+
+TablebaseValue Tablebase::probeMasks(uint32_t x, uint32_t o) const
+{
+    const int xCount = std::popcount(x), oCount = std::popcount(o);
+    if ((x & o) || (xCount != oCount && xCount != oCount + 1)) {
+        return kTablebaseUnknown;
+    }
+    return valueAt(index(x, o));
+}
+
+TablebaseValue Tablebase::probe(const MnkBoard &board) const
+{
+    const MnkRules &rules = board.rules();
+    if (!_values || rules.width() != _width || rules.height() != _height || rules.winLength() != _winLength) {
+        return kTablebaseUnknown;
+    }
+    return probeMasks((uint32_t)board.stones(1).words[0], (uint32_t)board.stones(2).words[0]);
+}
+
+int Tablebase::bestMove(const MnkBoard &board, TablebaseValue &value) const
+{
+    value = probe(board);
+    if (value == kTablebaseUnknown || board.gameOver()) {
+        return -1;
+    }
+    uint32_t x = (uint32_t)board.stones(1).words[0], o = (uint32_t)board.stones(2).words[0];
+    const bool xToMove = board.sideToMove() == 1;
+    uint32_t &mover = xToMove ? x : o;
+    const uint32_t before = mover;
+    const uint32_t empty = ~(x | o) & _boardMask;
+    // what the reply has to leave the opponent with; a lost position takes any move
+    const TablebaseValue wanted = (value == kTablebaseWin) ? kTablebaseLoss : (value == kTablebaseDraw) ? kTablebaseDraw : kTablebaseUnknown;
+    for (uint32_t cells = empty; cells; cells &= cells - 1) {
+        mover = before | (cells & (0u - cells));
+        if (wanted == kTablebaseUnknown || (value == kTablebaseWin && hasLine(mover)) || probeMasks(x, o) == wanted) {
+            return std::countr_zero(cells);
+        }
+    }
+    return std::countr_zero(empty);
+}
+
+// ---------------------------------------------------------------------------------------
+
+//
+// the side that moved last holding a line has lost; the side to move holding one, or both
+// sides, can't happen in a game; otherwise the best of the moves, read from the group above
+//
+TablebaseValue Tablebase::solve(uint32_t x, uint32_t o, int stones) const
+{
+    const bool xToMove = (stones % 2) == 0;
+    const uint32_t mover = xToMove ? x : o, last = xToMove ? o : x;
+    const bool moverLine = hasLine(mover);
+    if (hasLine(last)) {
+        return moverLine ? kTablebaseUnknown : kTablebaseLoss;
+    }
+    if (moverLine) {
+        return kTablebaseUnknown;
+    }
+    if (stones == _cells) {
+        return kTablebaseDraw;
+    }
+    TablebaseValue best = kTablebaseLoss;
+    for (uint32_t empty = ~(x | o) & _boardMask; empty; empty &= empty - 1) {
+        const uint32_t moved = mover | (empty & (0u - empty));
+        if (hasLine(moved)) {
+            return kTablebaseWin;
+        }
+        const TablebaseValue reply = valueAt(index(xToMove ? moved : x, xToMove ? o : moved));
+        if (reply == kTablebaseLoss) {
+            return kTablebaseWin;
+        }
+        if (reply == kTablebaseDraw) {
+            best = kTablebaseDraw;
+        }
+    }
+    return best;
+}
+
+//
+// the threads take X's sets four at a time; a group starts on a byte, so four sets' positions
+// end on one too, and no two threads write the same byte
+//
+void Tablebase::solveGroup(int stones, int threads)
+{
+    const int xCount = (stones + 1) / 2, oCount = stones / 2;
+    const uint64_t xSets = _binomial[_cells][xCount];
+    const uint64_t oSets = _binomial[_cells - xCount][oCount];
+    uint8_t *values = _copy.data();
+    ParallelFor((int)((xSets + 3) / 4), threads, [&](int chunk, int) {
+        uint64_t rank = (uint64_t)chunk * 4;
+        uint32_t x = UnrankSet(rank, xCount, _cells, _binomial);
+        for (int i = 0; i < 4 && rank < xSets; ++i, ++rank) {
+            const uint32_t free = ~x & _boardMask;
+            uint64_t entry = _groupStart[stones] + rank * oSets;
+            uint32_t packed = (oCount > 0) ? (1u << oCount) - 1 : 0;
+            for (uint64_t r = 0; r < oSets; ++r, ++entry) {
+                const TablebaseValue value = solve(x, Expand(packed, free), stones);
+                values[entry >> 2] |= (uint8_t)(value << (2 * (entry & 3)));
+                if (packed) packed = NextCombination(packed);
+            }
+            if (x) x = NextCombination(x);
+        }
+    });
+}
+
+bool Tablebase::build(const MnkRules &rules, int threads, TablebaseProgress progress)
+{
+    close();
+    if (!setRules(rules)) {
+        return false;
+    }
+    threads = SearchThreadCount(threads);
+    _copy.assign(sizeInBytes(), 0);
+    _values = _copy.data();
+    for (int stones = _cells; stones >= 0; --stones) {
+        solveGroup(stones, threads);
+        const int x = (stones + 1) / 2;
+        if (progress) progress(stones, _binomial[_cells][x] * _binomial[_cells - x][stones / 2]);
+    }
+    return true;
+}
+
+bool Tablebase::write(const std::string &path) const
+{
+    if (!_values) {
+        return false;
+    }
+    TablebaseHeader header{};
+    memcpy(header.magic, TABLEBASE_MAGIC, 4);
+    header.version = TABLEBASE_VERSION;
+    header.headerSize = (uint16_t)TABLEBASE_HEADER_SIZE;
+    header.width = (uint8_t)_width;
+    header.height = (uint8_t)_height;
+    header.winLength = (uint8_t)_winLength;
+    header.entries = _entries;
+
+    return WriteFileReplacing(path, { { &header, sizeof(header) }, { _values, sizeInBytes() } });
+}
+
+// ---------------------------------------------------------------------------------------
+
+bool Tablebase::open(const std::string &path, const MnkRules &rules)
+{
+    close();
+    if (!setRules(rules)) {
+        return false;
+    }
+    if (!_file.open(path, TABLEBASE_HEADER_SIZE)) {
+        return false;
+    }
+    TablebaseHeader header;
+    memcpy(&header, _file.data(), sizeof(header));
+    const bool matches = memcmp(header.magic, TABLEBASE_MAGIC, 4) == 0 && header.version == TABLEBASE_VERSION &&
+                         header.headerSize == TABLEBASE_HEADER_SIZE && header.width == _width &&
+                         header.height == _height && header.winLength == _winLength && header.entries == _entries;
+    const bool complete = _file.size() - TABLEBASE_HEADER_SIZE >= sizeInBytes();
+    if (!matches || !complete) {
+        close();
+        return false;
+    }
+    _values = _file.data() + TABLEBASE_HEADER_SIZE;
+    return true;
+}
+
+void Tablebase::close()
+{
+    _file.close();
+    _copy.clear();
+    _values = nullptr;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "MnkBoard.h"
+
+//
+// every position of a small m,n,k board solved by retrograde analysis, written once by
+// build_tablebase and memory-mapped like an opening book, so the search (engine/MnkSearch.h)
+// plays those boards perfectly with a table read per candidate move and no search
+// positions are grouped by their number of stones; inside a group the index is a perfect hash
+// of the board: the rank of X's cells among every set of that size, times the number of sets
+// O can take, plus the rank of O's cells among the cells X left free
+// a position takes 2 bits: its value for the side to move, or unknown for one no game reaches
+// the solve starts from the full board and works back: a group only reads the group with one
+// stone more, so each group is a single sweep split across threads
+// the file is a 32-byte header ("TTTE", version, header size, width, height, k, entry count)
+// and the packed values, four entries a byte from the lowest bits, little-endian; the entries
+// are the positions plus the few unused ones that start each group on a byte
+//
+
+constexpr uint16_t TABLEBASE_VERSION = 1;
+// a 5x4 board: 741 million positions, 185 MB; the index works on 32-bit masks
+constexpr int TABLEBASE_MAX_CELLS = 20;
+
+enum TablebaseValue : uint8_t
+{
+    kTablebaseUnknown = 0,      // no legal game gets here, e.g. both sides have a line
+    kTablebaseLoss = 1,
+    kTablebaseDraw = 2,
+    kTablebaseWin = 3,
+};
+
+// called with the stone count of each group as it is solved, from the full board down
+using TablebaseProgress = void (*)(int stones, uint64_t positions);
+
+class Tablebase
+{
+public:
+    Tablebase() = default;
+    ~Tablebase() { close(); }
+    Tablebase(const Tablebase &) = delete;
+    Tablebase &operator=(const Tablebase &) = delete;
+
+    // maps path; false if it is missing, damaged, another version or for other rules
+    bool        open(const std::string &path, const MnkRules &rules);
+    // solves rules in memory on threads threads, 0 = one per hardware thread; false if the
+    // board has more than TABLEBASE_MAX_CELLS cells
+    bool        build(const MnkRules &rules, int threads = 0, TablebaseProgress progress = nullptr);
+    // writes what build() solved, replacing path only once the file is complete
+    bool        write(const std::string &path) const;
+    void        close();
+    bool        isOpen() const { return _values != nullptr; }
+
+    uint64_t    positionCount() const { return _positions; }
+    size_t      sizeInBytes() const { return (size_t)((_entries + 3) / 4); }
+
+    // the value of board for its side to move
+    TablebaseValue probe(const MnkBoard &board) const;
+    // a move that keeps board's value, which is written to value; -1 if the game is over or
+    // the position unknown
+    int         bestMove(const MnkBoard &board, TablebaseValue &value) const;
+
+private:
+    // the index and lines of rules, false if it is too big
+    bool        setRules(const MnkRules &rules);
+    uint64_t    index(uint32_t x, uint32_t o) const;
+    TablebaseValue valueAt(uint64_t index) const { return (TablebaseValue)((_values[index >> 2] >> (2 * (index & 3))) & 3); }
+    TablebaseValue probeMasks(uint32_t x, uint32_t o) const;
+    bool        hasLine(uint32_t stones) const;
+    // the value of one position, from the solved group above it
+    TablebaseValue solve(uint32_t x, uint32_t o, int stones) const;
+    void        solveGroup(int stones, int threads);
+
+    int                     _width = 0;
+    int                     _height = 0;
+    int                     _winLength = 0;
+    int                     _cells = 0;
+    uint32_t                _boardMask = 0;
+    std::vector<uint32_t>   _lines;
+    uint64_t                _binomial[TABLEBASE_MAX_CELLS + 1][TABLEBASE_MAX_CELLS + 1] = {};
+    // where each stone count's group starts, rounded up to 4 so a group starts on a byte
+    std::vector<uint64_t>   _groupStart;
+    uint64_t                _positions = 0;
+    uint64_t                _entries = 0;       // the positions and the padding between groups
+
+    const uint8_t           *_values = nullptr;
+    MappedFile              _file;              // the opened table
+    std::vector<uint8_t>    _copy;              // the built one
+};
+
+// the file name a variant's tablebase goes by, e.g. "4x4x4.tb"
+std::string     TablebaseName(const MnkRules &rules);
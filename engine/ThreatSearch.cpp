@@ -0,0 +1,160 @@
+#include "ThreatSearch.h"
+#include "Profiler.h"
+#include <climits>
+#include <vector>
+
+class ThreatSearcher
+{
+public:
+    ThreatSearcher(const MnkBoard &board, const MnkThreatSearchOptions &options)
+        : _board(board), _budget(options.nodeBudget), _table((size_t)1 << options.tableBits), _attacker(board.sideToMove())
+    {
+    }
+
+    MnkThreatSearchResult run(int maxFours)
+    {
+        MnkThreatSearchResult result;
+        if (_board.gameOver()) {
+            return result;
+        }
+        // one more attacking move per pass, so the first sequence found is the shortest
+        for (int fours = 1; fours <= maxFours && !_exhausted; ++fours) {
+            _grew = false;
+            int move = -1, plies = 0;
+            if (attack(fours, move, plies)) {
+                result.win = true;
+                result.move = move;
+                result.plies = plies;
+                break;
+            }
+            if (!_grew) break;          // no sequence was cut short, a longer limit finds nothing new
+        }
+        result.nodes = _nodes;
+        result.exhausted = _exhausted && !result.win;
+        return result;
+    }
+
+private:
+    // a position that failed with this many attacker moves left, or with any number (INT_MAX)
+    // when no sequence through it was cut short
+    struct Failure
+    {
+        uint64_t    hash = 0;
+        int         fours = -1;
+    };
+
+    // cells that complete a line for player: lines one stone short with none of the opponent's
+    CellMask winningCells(int player) const
+    {
+        const int need = _board.rules().winLength() - 1;
+        const std::vector<CellMask> &lines = _board.rules().lines();
+        const CellMask empty = _board.emptyCells();
+        CellMask cells;
+        for (int line = 0; line < (int)lines.size(); ++line) {
+            if (_board.lineCount(player, line) == need && _board.lineCount(3 - player, line) == 0) {
+                CellMask gap = lines[line];
+                gap &= empty;
+                cells |= gap;
+            }
+        }
+        return cells;
+    }
+
+    // cells that make a four for player: empty cells of lines two short with none of the opponent's
+    CellMask fourMoves(int player) const
+    {
+        const int need = _board.rules().winLength() - 2;
+        const std::vector<CellMask> &lines = _board.rules().lines();
+        const CellMask empty = _board.emptyCells();
+        CellMask cells;
+        for (int line = 0; line < (int)lines.size(); ++line) {
+            if (_board.lineCount(player, line) == need && _board.lineCount(3 - player, line) == 0) {
+                CellMask gaps = lines[line];
+                gaps &= empty;
+                cells |= gaps;
+            }
+        }
+        return cells;
+    }
+
+    // the attacker is to move with `fours` moves left; plies counts to the completed line
+    bool attack(int fours, int &move, int &plies)
+    {
+        if (++_nodes > _budget) {
+            _exhausted = true;
+            return false;
+        }
+        const int defender = 3 - _attacker;
+        const CellMask wins = winningCells(_attacker);
+        if (wins.any()) {
+            wins.forEach([&](int cell) { if (move < 0) move = cell; });
+            plies = 1;
+            return true;
+        }
+        if (fours == 0) {
+            _grew = true;
+            return false;
+        }
+        // the defender's four has to be blocked, and the block has to be a four as well
+        const CellMask threats = winningCells(defender);
+        if (threats.count() > 1) {
+            return false;
+        }
+        Failure &failure = _table[_board.hash() & (_table.size() - 1)];
+        if (failure.hash == _board.hash() && failure.fours >= fours) {
+            if (failure.fours != INT_MAX) _grew = true;
+            return false;
+        }
+
+        CellMask candidates = fourMoves(_attacker);
+        if (threats.any()) candidates &= threats;
+        const bool grewBefore = _grew;
+        _grew = false;
+        bool found = false;
+        candidates.forEach([&](int cell) {
+            if (found || _exhausted) return;
+            _board.makeMove(cell);
+            const CellMask replies = winningCells(_attacker);
+            if (replies.count() > 1) {
+                // the defender can only block one of them
+                found = true;
+                move = cell;
+                plies = 3;
+            } else if (replies.any()) {
+                int block = -1;
+                replies.forEach([&](int c) { block = c; });
+                _board.makeMove(block);
+                int next = -1, rest = 0;
+                // a block that completes the defender's own line ends the game
+                if (_board.winner() == 0 && attack(fours - 1, next, rest)) {
+                    found = true;
+                    move = cell;
+                    plies = 2 + rest;
+                }
+                _board.unmakeMove();
+            }
+            _board.unmakeMove();
+        });
+        if (!found && !_exhausted) {
+            failure.hash = _board.hash();
+            failure.fours = _grew ? fours : INT_MAX;
+        }
+        _grew |= grewBefore;
+        return found;
+    }
+
+    MnkBoard                _board;
+    uint64_t                _nodes = 0;
+    uint64_t                _budget;
+    bool                    _exhausted = false;
+    bool                    _grew = false;      // some sequence ran out of moves this pass
+    std::vector<Failure>    _table;
+    int                     _attacker;
+};
+
+MnkThreatSearchResult MnkThreatSearch(const MnkBoard &board, const MnkThreatSearchOptions &options)
+{
+    PROFILE_SCOPE("MnkThreatSearch");
+    ThreatSearcher searcher(board, options);
+    return searcher.run(options.maxFours);
+}
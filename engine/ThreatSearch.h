@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include "MnkBoard.h"
+
+//
+// threat-space search for forced wins on boards too big to search to the end, e.g. Gomoku
+// the side to move only plays "fours": moves that leave a line one stone short of k with no
+// opposing stone in it, so the opponent's reply is forced onto the one cell that completes it
+// (victory by continuous fours); two such cells at once, or a line already one short, win
+// the opponent's own fours are respected: with one pending, the attacker must block it
+// because every reply is forced, a win it finds is a proven win, whatever the board size;
+// not finding one within the budget proves nothing
+// failed positions go into a fixed-size table (MnkThreatSearchOptions::tableBits), so memory
+// stays bounded however many nodes are searched, and repeats across transpositions are cut
+//
+
+struct MnkThreatSearchOptions
+{
+    uint64_t    nodeBudget = 20000;     // the search gives up after this many nodes
+    int         maxFours = 16;          // attacker moves in a sequence, searched shortest first
+    int         tableBits = 14;         // failed-position table of 2^tableBits entries
+};
+
+struct MnkThreatSearchResult
+{
+    bool        win = false;            // the side to move forces a win
+    int         move = -1;              // its first move
+    int         plies = 0;              // plies until the winning line is complete
+    uint64_t    nodes = 0;
+    bool        exhausted = false;      // stopped by the node budget before trying every sequence
+};
+
+MnkThreatSearchResult MnkThreatSearch(const MnkBoard &board, const MnkThreatSearchOptions &options = MnkThreatSearchOptions());
@@ -0,0 +1,25 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t bucketCount, bool symmetric)
+{
+    size_t size = 1;
+    while (size < bucketCount) {
+        size <<= 1;
+    }
+    _buckets.resize(size);
+    _mask = size - 1;
+    _symmetric = symmetric;
+    _hits.reset();
+    _misses.reset();
+    _stores.reset();
+}
+
+void TranspositionTable::clear()
+{
+    for (TTBucket &bucket : _buckets) {
+        bucket = TTBucket();
+    }
+    _hits.reset();
+    _misses.reset();
+    _stores.reset();
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Bitboard.h"
+#include "SearchStats.h"
+#include "Symmetry.h"
+
+//
+// fixed-size transposition table for the Negamax search
+// entries are grouped into 64-byte buckets so a probe touches exactly one cache line
+// keys are Bitboard::key(), which is unique per position, so a key match is never a false hit
+// when symmetric, the key is that of the canonical image (see Symmetry.h) so all 8 images share
+// one entry, and best moves are stored in canonical coordinates and mapped back on probe
+// the hit, miss and store counts read 0 in a build without TICTACTOE_SEARCH_STATS
+//
+
+enum TTBound : uint8_t
+{
+    kBoundNone,
+    kBoundExact,            // value is the exact score
+    kBoundLower,            // search failed high, score >= value
+    kBoundUpper             // search failed low, score <= value
+};
+
+struct TTEntry
+{
+    uint32_t    key = 0;
+    int8_t      value = 0;
+    TTBound     bound = kBoundNone;
+    int8_t      move = -1;          // best move found, -1 if none
+    uint8_t     depth = 0;          // remaining depth the entry was searched to
+};
+
+constexpr int TT_BUCKET_ENTRIES = 8;
+
+struct alignas(64) TTBucket
+{
+    TTEntry     entries[TT_BUCKET_ENTRIES];
+};
+
+static_assert(sizeof(TTBucket) == 64, "a TT bucket should fill one cache line");
+
+class TranspositionTable
+{
+public:
+    // bucketCount is rounded up to a power of two
+    explicit TranspositionTable(size_t bucketCount = 1024, bool symmetric = true);
+
+    // true and fills entry if pos is stored, counts a hit or a miss
+    // entry.move is always in pos's own coordinates
+    bool        probe(const Bitboard &pos, TTEntry &entry)
+    {
+        int transform = kIdentity;
+        const uint32_t key = keyFor(pos, transform);
+        const TTBucket &bucket = _buckets[index(key)];
+        for (const TTEntry &candidate : bucket.entries) {
+            if (candidate.bound != kBoundNone && candidate.key == key) {
+                entry = candidate;
+                if (entry.move >= 0) {
+                    entry.move = (int8_t)InverseTransformCell(transform, entry.move);
+                }
+                ++_hits;
+                return true;
+            }
+        }
+        ++_misses;
+        return false;
+    }
+
+    // overwrites the same key, else an empty slot, else the shallowest entry in the bucket
+    void        store(const Bitboard &pos, int value, TTBound bound, int move, int depth)
+    {
+        int transform = kIdentity;
+        const uint32_t key = keyFor(pos, transform);
+        if (move >= 0) {
+            move = TransformCell(transform, move);
+        }
+        TTBucket &bucket = _buckets[index(key)];
+        TTEntry *slot = &bucket.entries[0];
+        for (TTEntry &candidate : bucket.entries) {
+            if (candidate.bound == kBoundNone || candidate.key == key) {
+                slot = &candidate;
+                break;
+            }
+            if (candidate.depth < slot->depth) {
+                slot = &candidate;
+            }
+        }
+        slot->key = key;
+        slot->value = (int8_t)value;
+        slot->bound = bound;
+        slot->move = (int8_t)move;
+        slot->depth = (uint8_t)depth;
+        ++_stores;
+    }
+
+    // empties every bucket and zeroes the counters
+    void        clear();
+
+    // safe to change at any time: an entry is always keyed and oriented by the position it describes
+    void        setSymmetric(bool symmetric) { _symmetric = symmetric; }
+    bool        symmetric() const { return _symmetric; }
+
+    uint64_t    hits() const { return _hits.value(); }
+    uint64_t    misses() const { return _misses.value(); }
+    uint64_t    stores() const { return _stores.value(); }
+    size_t      bucketCount() const { return _buckets.size(); }
+    size_t      sizeInBytes() const { return _buckets.size() * sizeof(TTBucket); }
+
+private:
+    uint32_t    keyFor(const Bitboard &pos, int &transform) const
+    {
+        if (!_symmetric) {
+            return pos.key();
+        }
+        const CanonicalPosition canonical = Canonicalize(pos);
+        transform = canonical.transform;
+        return canonical.board.key();
+    }
+    size_t      index(uint32_t key) const { return (size_t)((key * 0x9E3779B1u) >> 8) & _mask; }
+
+    std::vector<TTBucket>   _buckets;
+    size_t                  _mask;
+    bool                    _symmetric;
+    StatCounter             _hits;
+    StatCounter             _misses;
+    StatCounter             _stores;
+};
@@ -0,0 +1,298 @@
+//
+// game-record analyser: streams a file written by `selfplay --record` and summarises it
+// usage: analyse_records file [--game K] [--buffered] [--evaluate] [--replay] [--expect-games N]
+//                        [--large-offsets]
+// the file is read one record at a time (memory-mapped where possible, --buffered forces
+// plain reads), so its size doesn't matter; --game K jumps straight to game K through the
+// index and prints the board after every ply
+// --evaluate rebuilds every position of every 3x3 game and scores them in batches
+// (engine/BatchEval.h), checking the vector kernel against the scalar one and each game's last
+// position against its recorded winner
+// --replay loads every game into a GameReplay (engine/GameReplay.h), seeks each of its positions
+// in a scattered order and checks them against a replay of the moves from the start
+// --expect-games exits non-zero unless the file holds exactly N readable games
+// --large-offsets writes file as a test: one game, a sparse gap to past 4 GB, then a second
+// game, and checks both reads (buffered and mapped) seek to the second through the index; the
+// file is removed afterwards
+//
+
+#include "../engine/BatchEval.h"
+#include "../engine/GameRecord.h"
+#include "../engine/GameReplay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s file [--game K] [--buffered] [--evaluate] [--replay] [--expect-games N]\n"
+                    "       [--large-offsets]\n", program);
+    return 2;
+}
+
+static int PrintGame(GameRecordReader &reader, uint64_t game)
+{
+    GameRecord record;
+    if (!reader.seek(game) || !reader.next(record)) {
+        fprintf(stderr, "analyse_records: no game %llu (%llu indexed)\n", (unsigned long long)game,
+                (unsigned long long)reader.indexedCount());
+        return 1;
+    }
+    printf("game %llu: %dx%d k=%d, %zu plies, %s\n", (unsigned long long)record.gameNumber, record.width,
+           record.height, record.winLength, record.moves.size(),
+           record.winner == 1 ? "X wins" : record.winner == 2 ? "O wins" : "draw");
+    GameReplay replay;
+    replay.load(record);
+    for (size_t ply = 0; ply <= record.moves.size(); ++ply, replay.stepForward()) {
+        const std::string state(replay.state());
+        if (ply == 0) printf("  %3zu        %s\n", ply, state.c_str());
+        else printf("  %3zu  %c %3d  %s\n", ply, (ply % 2) ? 'X' : 'O', record.moves[ply - 1], state.c_str());
+    }
+    return 0;
+}
+
+// where --large-offsets puts its second game: past what both a 32-bit long and a 32-bit
+// unsigned offset reach
+constexpr uint64_t LARGE_RECORD_OFFSET = 5ull << 30;
+
+static int CheckLargeOffsets(const std::string &path)
+{
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+    GameRecord record;
+    record.moves = { 4, 0, 2 };
+    GameRecordWriter writer;
+    bool ok = writer.open(path) && writer.write(record);
+    writer.close();
+    // grown without the record code, so a wrong offset there can't agree with itself; the gap
+    // is never written, and on a file system with sparse files it takes no space
+    std::error_code error;
+    if (ok) std::filesystem::resize_file(path, LARGE_RECORD_OFFSET, error);
+    ok = ok && !error;
+    record.gameNumber = 1;
+    record.moves = { 4, 0, 2, 6, 3 };
+    ok = ok && writer.open(path) && writer.write(record);
+    writer.close();
+    if (!ok) {
+        fprintf(stderr, "analyse_records: can't write %s past %llu bytes\n", path.c_str(),
+                (unsigned long long)LARGE_RECORD_OFFSET);
+    }
+
+    int failures = ok ? 0 : 1;
+    for (int mapped = 0; ok && mapped < 2; ++mapped) {
+        GameRecordReader reader;
+        GameRecord read;
+        if (!reader.open(path, mapped != 0) || reader.indexedCount() != 2 || !reader.seek(1) || !reader.next(read) ||
+            read.gameNumber != 1 || read.moves != record.moves) {
+            fprintf(stderr, "analyse_records: %s read can't seek to the game at %llu\n", mapped ? "a mapped" : "a buffered",
+                    (unsigned long long)LARGE_RECORD_OFFSET);
+            failures++;
+        }
+    }
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+    if (failures == 0) printf("seeked to a game at %llu bytes, buffered and mapped\n", (unsigned long long)LARGE_RECORD_OFFSET);
+    return failures ? 1 : 0;
+}
+
+// positions evaluated per EvaluateBatch() call
+constexpr size_t EVALUATE_BATCH = 4096;
+
+//
+// every position of the 3x3 games, queued and scored a batch at a time
+// lastWinner[i] is the recorded winner when position i ends its game, -1 otherwise
+//
+struct PositionStats
+{
+    std::vector<Bitboard>       positions;
+    std::vector<int8_t>         lastWinner;
+    std::vector<PositionEval>   evals;
+    std::vector<PositionEval>   scalar;
+    uint64_t    count = 0;
+    uint64_t    terminal = 0;
+    int64_t     scoreSum = 0;
+    uint64_t    kernelMismatches = 0;       // the vector kernel disagreed with the scalar one
+    uint64_t    winnerMismatches = 0;       // a game's last position disagreed with its record
+    double      seconds = 0;                // in EvaluateBatch() with the best backend
+
+    void add(const GameRecord &record)
+    {
+        if (record.width != 3 || record.height != 3 || record.winLength != 3) return;
+        Bitboard pos;
+        for (size_t ply = 0; ply <= record.moves.size(); ++ply) {
+            if (ply > 0) pos.set(record.moves[ply - 1], (ply % 2) ? 1 : 2);
+            positions.push_back(pos);
+            lastWinner.push_back((int8_t)(ply == record.moves.size() ? record.winner : -1));
+            if (positions.size() == EVALUATE_BATCH) flush();
+        }
+    }
+
+    void flush()
+    {
+        const size_t n = positions.size();
+        evals.resize(n);
+        scalar.resize(n);
+        const auto start = std::chrono::steady_clock::now();
+        EvaluateBatch(positions.data(), n, evals.data());
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        EvaluateBatch(positions.data(), n, scalar.data(), kBatchEvalScalar);
+        for (size_t i = 0; i < n; ++i) {
+            const PositionEval &eval = evals[i];
+            if (memcmp(&eval, &scalar[i], sizeof(eval)) != 0) kernelMismatches++;
+            if (lastWinner[i] >= 0 && eval.winner != lastWinner[i]) winnerMismatches++;
+            terminal += (eval.flags & EVAL_TERMINAL) != 0;
+            scoreSum += eval.score;
+        }
+        count += n;
+        positions.clear();
+        lastWinner.clear();
+    }
+};
+
+//
+// every position of every game reached by GameReplay::seek(), against GameRecord::stateAfter()
+// the seeks jump about the game so both the checkpoints and the steps from the cursor are used
+//
+struct ReplayStats
+{
+    GameReplay  replay;
+    uint64_t    seeks = 0;
+    uint64_t    mismatches = 0;
+    size_t      longest = 0;
+    size_t      replayBytes = 0;
+    double      seconds = 0;
+
+    void add(const GameRecord &record)
+    {
+        replay.load(record);
+        const size_t entries = replay.size();
+        longest = std::max(longest, entries - 1);
+        replayBytes += replay.sizeInBytes();
+        // a stride coprime to the entry count visits every one of them once
+        size_t stride = entries / 2 + 1;
+        while (std::gcd(stride, entries) != 1) stride++;
+        std::string expected;
+        for (size_t i = 0, entry = 0; i < entries; ++i, entry = (entry + stride) % entries) {
+            const auto start = std::chrono::steady_clock::now();
+            replay.seek(entry);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            seeks++;
+            expected = record.stateAfter(entry);
+            if (replay.state() != expected) mismatches++;
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    long long game = -1;
+    long long expectGames = -1;
+    bool mapped = true;
+    bool evaluate = false;
+    bool replay = false;
+    bool largeOffsets = false;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--game") == 0 && hasValue) {
+            game = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--expect-games") == 0 && hasValue) {
+            expectGames = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--buffered") == 0) {
+            mapped = false;
+        } else if (strcmp(argv[i], "--evaluate") == 0) {
+            evaluate = true;
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            replay = true;
+        } else if (strcmp(argv[i], "--large-offsets") == 0) {
+            largeOffsets = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (!path) {
+        return Usage(argv[0]);
+    }
+    if (largeOffsets) {
+        return CheckLargeOffsets(path);
+    }
+
+    GameRecordReader reader;
+    if (!reader.open(path, mapped)) {
+        fprintf(stderr, "analyse_records: %s is not a version %d record file\n", path, GAME_RECORD_VERSION);
+        return 1;
+    }
+    if (game >= 0) {
+        return PrintGame(reader, (uint64_t)game);
+    }
+
+    uint64_t games = 0, xWins = 0, oWins = 0, draws = 0, plies = 0;
+    const auto start = std::chrono::steady_clock::now();
+    GameRecord record;
+    PositionStats positions;
+    ReplayStats replays;
+    while (reader.next(record)) {
+        games++;
+        if (evaluate) positions.add(record);
+        if (replay) replays.add(record);
+        if (record.winner == 1) xWins++;
+        else if (record.winner == 2) oWins++;
+        else draws++;
+        plies += record.moves.size();
+    }
+    if (evaluate) positions.flush();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    FILE *file = fopen(path, "rb");
+    uint64_t bytes = 0;
+    if (file) {
+        RecordFileSeek(file, 0, SEEK_END);
+        bytes = RecordFileTell(file);
+        fclose(file);
+    }
+    const double percent = games ? 100.0 / games : 0.0;
+    printf("%s: %llu games (%llu indexed), %llu bytes, %.1f bytes/game\n", path, (unsigned long long)games,
+           (unsigned long long)reader.indexedCount(), (unsigned long long)bytes, games ? (double)bytes / games : 0.0);
+    printf("read in %.3f s (%.0f games/s, %s), %.2f plies/game\n", seconds, seconds > 0 ? games / seconds : 0.0,
+           mapped ? "mapped" : "buffered", games ? (double)plies / games : 0.0);
+    printf("X wins %llu (%.1f%%), O wins %llu (%.1f%%), draws %llu (%.1f%%)\n",
+           (unsigned long long)xWins, xWins * percent, (unsigned long long)oWins, oWins * percent,
+           (unsigned long long)draws, draws * percent);
+
+    if (evaluate) {
+        printf("evaluated %llu positions with %s in %.3f ms (%.0f Mpositions/s), %llu terminal, mean score %+.2f\n",
+               (unsigned long long)positions.count, BatchEvalBackendName(BestBatchEvalBackend()), positions.seconds * 1e3,
+               positions.seconds > 0 ? positions.count / positions.seconds / 1e6 : 0.0, (unsigned long long)positions.terminal,
+               positions.count ? (double)positions.scoreSum / positions.count : 0.0);
+        if (positions.kernelMismatches || positions.winnerMismatches) {
+            fprintf(stderr, "analyse_records: %llu positions differ from the scalar evaluation, %llu games from their recorded winner\n",
+                    (unsigned long long)positions.kernelMismatches, (unsigned long long)positions.winnerMismatches);
+            return 1;
+        }
+    }
+
+    if (replay) {
+        printf("replayed %llu seeks in %.3f ms (%.0f ns/seek), longest game %zu plies, %.1f bytes/game of checkpoints and changes\n",
+               (unsigned long long)replays.seeks, replays.seconds * 1e3, replays.seeks ? replays.seconds * 1e9 / replays.seeks : 0.0,
+               replays.longest, games ? (double)replays.replayBytes / games : 0.0);
+        if (replays.mismatches) {
+            fprintf(stderr, "analyse_records: %llu seeks differ from replaying the moves\n", (unsigned long long)replays.mismatches);
+            return 1;
+        }
+    }
+
+    if (expectGames >= 0 && (games != (uint64_t)expectGames || reader.indexedCount() != games)) {
+        fprintf(stderr, "analyse_records: expected %lld games, read %llu, indexed %llu\n", expectGames,
+                (unsigned long long)games, (unsigned long long)reader.indexedCount());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,495 @@
+//
+// search benchmark: runs every search variant over a fixed corpus of 3x3 positions and
+// reports nodes, nodes per second, time to move and table memory as JSON, so two commits
+// can be compared by diffing their output
+// the corpus is the empty board, every 1-ply and 2-ply opening, and a few tactical midgames
+// every reply is also checked against the perfect-play table; a wrong value exits non-zero
+// the m,n,k engine is benchmarked on 4x4, 5x5 and 15x15 openings at a fixed depth with its
+// static centre-out move order and with dynamic ordering; both must agree on every value
+// and the threat-space search has to find the forced win in a few Gomoku midgames; the
+// compile-time evaluation kernels have to match the generic one on random positions
+// the chess search runs a few openings and middlegames at a fixed depth, and has to find the
+// mate in a few mating positions
+// pondering is run on the 5x5 openings: after the AI's reply, the predicted answer is played while
+// the ponder is searching it, and the pondered answer has to match a fresh search's value; its
+// time to move is from that answer being played to the reply
+// --trace writes the profiler's scopes (engine/Profiler.h) of the m,n,k searches as a Chrome trace
+//
+// usage: bench_search [--repetitions N] [--out file.json] [--trace trace.json]
+//
+
+#include "../engine/ChessSearch.h"
+#include "../engine/MnkPonder.h"
+#include "../engine/MnkSearch.h"
+#include "../engine/Negamax.h"
+#include "../engine/Parallel.h"
+#include "../engine/PerfectPlay.h"
+#include "../engine/Profiler.h"
+#include "../engine/ThreatSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// midgames with a forced win, a forced block or a fork to avoid
+static const char *TACTICAL_POSITIONS[] = {
+    "110020000",        // O must block the top row
+    "120010000",        // O must block the diagonal at 8
+    "100020001",        // O must play an edge, a corner loses to a fork
+    "102010200",        // X wins at 8
+    "210120000",        // X can fork
+    "112200000",        // X to move, the top row already blocked
+};
+
+struct BenchVariant
+{
+    const char     *name;
+    SearchOptions   options;
+    bool            useTable;
+};
+
+static std::vector<BenchVariant> Variants()
+{
+    std::vector<BenchVariant> variants;
+    SearchOptions options;
+    options.symmetry = false;
+
+    options.mode = kSearchPlain;
+    variants.push_back({ "negamax", options, false });
+    options.mode = kSearchAlphaBeta;
+    variants.push_back({ "alphabeta", options, false });
+    variants.push_back({ "alphabeta_tt", options, true });
+    options.symmetry = true;
+    variants.push_back({ "alphabeta_tt_symmetry", options, true });
+    options.mode = kSearchNullWindow;
+    variants.push_back({ "pvs_tt_symmetry", options, true });
+    options.mode = kSearchAlphaBeta;
+    options.threads = 0;
+    variants.push_back({ "parallel_alphabeta_tt_symmetry", options, true });
+    options.threads = 1;
+    options.mode = kSearchTable;
+    variants.push_back({ "perfect_play_table", options, false });
+    return variants;
+}
+
+static std::vector<Bitboard> Corpus()
+{
+    std::vector<Bitboard> corpus;
+    const Bitboard empty;
+    corpus.push_back(empty);
+    for (int a = 0; a < BOARD_CELLS; ++a) {
+        corpus.push_back(empty.withMove(a, 1));
+    }
+    for (int a = 0; a < BOARD_CELLS; ++a) {
+        for (int b = 0; b < BOARD_CELLS; ++b) {
+            if (a != b) corpus.push_back(empty.withMove(a, 1).withMove(b, 2));
+        }
+    }
+    for (const char *state : TACTICAL_POSITIONS) {
+        corpus.push_back(Bitboard::fromStateString(state));
+    }
+    return corpus;
+}
+
+struct BenchRun
+{
+    uint64_t    nodes = 0;
+    int64_t     totalTime = 0;          // nanoseconds over the whole corpus
+    int64_t     maxTime = 0;            // slowest single move, nanoseconds
+    int         wrongValues = 0;
+};
+
+// one pass over the corpus, each position searched with an empty table
+static BenchRun RunCorpus(const BenchVariant &variant, const std::vector<Bitboard> &corpus, TranspositionTable &table)
+{
+    BenchRun run;
+    for (const Bitboard &pos : corpus) {
+        SearchOptions options = variant.options;
+        if (variant.useTable) {
+            table.clear();
+            options.table = &table;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const SearchResult result = SearchBestMove(pos, options);
+        const int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        run.nodes += result.nodes;
+        run.totalTime += time;
+        run.maxTime = std::max(run.maxTime, time);
+        if (result.value != LookupPerfectPlay(pos).value) {
+            run.wrongValues++;
+        }
+    }
+    return run;
+}
+
+// an m,n,k board searched to a fixed depth from the empty board and every opening move near the centre
+struct MnkBenchBoard
+{
+    int         width, height, winLength;
+    int         depth;
+    int         openingRadius;      // first moves within this many cells of the centre
+};
+
+static const MnkBenchBoard MNK_BENCH_BOARDS[] = {
+    { 4, 4, 4, 6, 2 },
+    { 5, 5, 4, 4, 1 },
+    { 15, 15, 5, 3, 1 },
+};
+
+static std::vector<std::string> MnkCorpus(const MnkBenchBoard &bench)
+{
+    const int cells = bench.width * bench.height;
+    std::vector<std::string> corpus = { std::string(cells, '0') };
+    for (int cell = 0; cell < cells; ++cell) {
+        const int dx = std::abs(2 * (cell % bench.width) - (bench.width - 1));
+        const int dy = std::abs(2 * (cell / bench.width) - (bench.height - 1));
+        if (std::max(dx, dy) > 2 * bench.openingRadius) continue;
+        std::string state(cells, '0');
+        state[cell] = '1';
+        corpus.push_back(state);
+    }
+    return corpus;
+}
+
+// one pass over the corpus; values[i] is filled in, or compared with it if already there
+static BenchRun RunMnkCorpus(const MnkBenchBoard &bench, bool dynamicOrdering, const std::vector<std::string> &corpus,
+                             std::vector<int> &values)
+{
+    BenchRun run;
+    const MnkRules rules(bench.width, bench.height, bench.winLength);
+    MnkBoard board(rules);
+    const bool reference = values.empty();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        board.setStateString(corpus[i]);
+        MnkSearchOptions options;
+        options.maxDepth = bench.depth;
+        options.dynamicOrdering = dynamicOrdering;
+        const MnkSearchResult result = MnkSearchBestMove(board, options);
+        const int64_t time = result.elapsed * 1000;
+        run.nodes += result.nodes;
+        run.totalTime += time;
+        run.maxTime = std::max(run.maxTime, time);
+        if (reference) values.push_back(result.value);
+        else if (values[i] != result.value) run.wrongValues++;
+    }
+    return run;
+}
+
+//
+// each opening: the AI replies, ponders on its own thread, and the predicted answer is played as
+// soon as the ponder has started on it, so the reply is usually taken over mid-search
+//
+static BenchRun RunPonderCorpus(const MnkBenchBoard &bench, const std::vector<std::string> &corpus, int &hits)
+{
+    BenchRun run;
+    const MnkRules rules(bench.width, bench.height, bench.winLength);
+    MnkBoard board(rules);
+    for (const std::string &state : corpus) {
+        board.setStateString(state);
+        MnkMoveTable table;
+        MnkSearchOptions options;
+        options.maxDepth = bench.depth;
+        options.moveTable = &table;
+        const MnkSearchResult reply = MnkSearchBestMove(board, options);
+        if (reply.pv.size() < 2) continue;
+        board.makeMove(reply.move);
+
+        MnkPonder ponder;
+        ponder.start(board, reply.pv[1], options);
+        std::atomic<bool> stop = false;
+        MnkSearchResult pondered;
+        bool answered = false;
+        std::thread worker([&] { answered = ponder.run(rules, stop, pondered); });
+        while (ponder.guessed() == 0) std::this_thread::yield();
+
+        board.makeMove(reply.pv[1]);
+        const auto start = std::chrono::steady_clock::now();
+        MnkSearchResult answer;
+        const MnkPonderHit hit = ponder.play(board, options, answer);
+        if (hit == kPonderAnswered) stop = true;
+        worker.join();
+        if (hit == kPonderSearching && answered) answer = pondered;
+        const int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+        MnkSearchOptions fresh;
+        fresh.maxDepth = bench.depth;
+        const MnkSearchResult expected = MnkSearchBestMove(board, fresh);
+        if (hit == kPonderMiss || answer.value != expected.value) run.wrongValues++;
+        hits += hit != kPonderMiss;
+        run.nodes += answer.nodes;
+        run.totalTime += time;
+        run.maxTime = std::max(run.maxTime, time);
+    }
+    return run;
+}
+
+//
+// Gomoku midgames drawn as the 7x7 centre of the 15x15 board (rows 4-10, columns 4-10), with
+// the plies to the forced win by continuous fours, 0 for none
+//
+struct ThreatPosition
+{
+    const char *rows[7];
+    int         plies;
+};
+
+static const ThreatPosition THREAT_POSITIONS[] = {
+    // an open three becomes an open four
+    { { ".......", ".......", "...O...", "..XXX..", "...O...", ".......", "O......" }, 3 },
+    // four, block, four, block, then two fours at once
+    { { ".......", ".XX...O", "..XOXO.", "O.....O", "XO..XX.", ".X.X.O.", "O....O." }, 7 },
+    { { ".XO...O", "X.X..XX", ".O...O.", "X..O...", "X.XOXXO", "O.X..OO", "O......" }, 7 },
+    // nothing forcing yet
+    { { ".......", ".......", ".......", "...XO..", "...X...", "....O..", "......." }, 0 },
+};
+
+static std::string ThreatState(const ThreatPosition &position)
+{
+    std::string state(15 * 15, '0');
+    for (int y = 0; y < 7; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            const char c = position.rows[y][x];
+            state[(y + 4) * 15 + x + 4] = (c == 'X') ? '1' : (c == 'O') ? '2' : '0';
+        }
+    }
+    return state;
+}
+
+// the threat search finds each win at its expected length, and the m,n,k search plays it
+static BenchRun RunThreatCorpus()
+{
+    BenchRun run;
+    const MnkRules rules(15, 15, 5);
+    MnkBoard board(rules);
+    for (const ThreatPosition &position : THREAT_POSITIONS) {
+        board.setStateString(ThreatState(position));
+        const auto start = std::chrono::steady_clock::now();
+        const MnkThreatSearchResult threat = MnkThreatSearch(board);
+        const int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        run.nodes += threat.nodes;
+        run.totalTime += time;
+        run.maxTime = std::max(run.maxTime, time);
+        MnkSearchOptions options;
+        options.maxDepth = 1;
+        const MnkSearchResult search = MnkSearchBestMove(board, options);
+        if (threat.win != (position.plies > 0) || threat.plies != position.plies ||
+            search.fromThreatSearch != threat.win || (threat.win && search.move != threat.move)) {
+            run.wrongValues++;
+        }
+    }
+    return run;
+}
+
+// positions where MnkEvaluate() (a compiled kernel where one exists) and the per-line loop differ
+static int CheckEvaluators(const MnkBenchBoard &bench)
+{
+    const MnkRules rules(bench.width, bench.height, bench.winLength);
+    std::mt19937 rng(bench.width * 100 + bench.winLength);
+    int wrong = 0;
+    for (int game = 0; game < 200; ++game) {
+        MnkBoard board(rules);
+        const int stones = (int)(rng() % (rules.cellCount() + 1));
+        for (int i = 0; i < stones; ++i) {
+            const int cell = (int)(rng() % rules.cellCount());
+            if (board.cellAt(cell) == 0) board.makeMove(cell);
+        }
+        if (MnkEvaluate(board) != MnkEvaluateCounted(board)) wrong++;
+    }
+    return wrong;
+}
+
+//
+// chess positions with the move the search must play and the plies to the mate it must see,
+// 0 where only the node count matters
+//
+struct ChessBenchPosition
+{
+    const char *fen;
+    const char *move;
+    int         matePlies;
+};
+
+constexpr int CHESS_BENCH_DEPTH = 5;
+
+static const ChessBenchPosition CHESS_BENCH_POSITIONS[] = {
+    { ChessBoard::START_FEN, nullptr, 0 },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", nullptr, 0 },
+    { "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", "h5f7", 1 },
+    { "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", "d1d8", 1 },
+    { "r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 10", "d5f6", 3 },
+};
+
+static BenchRun RunChessCorpus()
+{
+    BenchRun run;
+    ChessBoard board;
+    for (const ChessBenchPosition &position : CHESS_BENCH_POSITIONS) {
+        board.setFen(position.fen);
+        ChessSearchOptions options;
+        options.maxDepth = CHESS_BENCH_DEPTH;
+        const ChessSearchResult result = ChessSearchBestMove(board, options);
+        const int64_t time = result.elapsed * 1000;
+        run.nodes += result.nodes;
+        run.totalTime += time;
+        run.maxTime = std::max(run.maxTime, time);
+        if (position.move && (ChessMoveText(result.move) != position.move || result.value != CHESS_SCORE_MATE - position.matePlies)) {
+            fprintf(stderr, "bench_search: chess %s played %s, value %d\n", position.fen, ChessMoveText(result.move).c_str(),
+                    result.value);
+            run.wrongValues++;
+        }
+    }
+    return run;
+}
+
+static std::string JsonLine(const char *name, const BenchRun &run, size_t positions, size_t tableBytes, bool last)
+{
+    const double seconds = run.totalTime / 1e9;
+    const double nodesPerSecond = seconds > 0 ? run.nodes / seconds : 0.0;
+    char line[512];
+    snprintf(line, sizeof(line),
+             "    { \"name\": \"%s\", \"nodes\": %llu, \"nodes_per_second\": %.0f, "
+             "\"mean_time_to_move_us\": %.3f, \"max_time_to_move_us\": %.3f, \"table_bytes\": %zu }%s\n",
+             name, (unsigned long long)run.nodes, nodesPerSecond, run.totalTime / 1e3 / positions, run.maxTime / 1e3,
+             tableBytes, last ? "" : ",");
+    return line;
+}
+
+int main(int argc, char **argv)
+{
+    int repetitions = 5;
+    const char *outPath = nullptr;
+    const char *tracePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--repetitions N] [--out file.json] [--trace trace.json]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const std::vector<Bitboard> corpus = Corpus();
+    TranspositionTable table;
+    std::string json = "{\n";
+    json += "  \"context\": {\n";
+    json += "    \"positions\": " + std::to_string(corpus.size()) + ",\n";
+    json += "    \"repetitions\": " + std::to_string(repetitions) + ",\n";
+    json += "    \"hardware_threads\": " + std::to_string(SearchThreadCount(0)) + "\n";
+    json += "  },\n";
+    json += "  \"benchmarks\": [\n";
+
+    bool ok = true;
+    const std::vector<BenchVariant> variants = Variants();
+    for (size_t v = 0; v < variants.size(); ++v) {
+        const BenchVariant &variant = variants[v];
+        // node counts are the same on every pass, times keep the fastest pass
+        BenchRun best;
+        for (int r = 0; r < repetitions; ++r) {
+            const BenchRun run = RunCorpus(variant, corpus, table);
+            if (r == 0 || run.totalTime < best.totalTime) best = run;
+        }
+        if (best.wrongValues) {
+            fprintf(stderr, "bench_search: %s got %d values wrong\n", variant.name, best.wrongValues);
+            ok = false;
+        }
+
+        // a root split gives every thread its own copy of the caller's table
+        const int threads = SearchThreadCount(variant.options.threads);
+        const size_t tables = variant.useTable ? (threads > 1 ? threads + 1 : 1) : 0;
+        json += JsonLine(variant.name, best, corpus.size(), tables * table.sizeInBytes(), false);
+    }
+
+    for (size_t b = 0; b < std::size(MNK_BENCH_BOARDS); ++b) {
+        const MnkBenchBoard &bench = MNK_BENCH_BOARDS[b];
+        const std::vector<std::string> mnkCorpus = MnkCorpus(bench);
+        if (const int wrong = CheckEvaluators(bench)) {
+            fprintf(stderr, "bench_search: the %dx%d k=%d evaluation kernel differs on %d positions\n", bench.width,
+                    bench.height, bench.winLength, wrong);
+            ok = false;
+        }
+        std::vector<int> values;
+        for (int dynamic = 0; dynamic < 2; ++dynamic) {
+            BenchRun best;
+            for (int r = 0; r < repetitions; ++r) {
+                const BenchRun run = RunMnkCorpus(bench, dynamic != 0, mnkCorpus, values);
+                if (r == 0 || run.totalTime < best.totalTime) best = run;
+            }
+            char name[64];
+            snprintf(name, sizeof(name), "mnk_%dx%dx%d_depth%d_%s_order", bench.width, bench.height, bench.winLength,
+                     bench.depth, dynamic ? "dynamic" : "static");
+            if (best.wrongValues) {
+                fprintf(stderr, "bench_search: %s disagrees with the static order on %d values\n", name, best.wrongValues);
+                ok = false;
+            }
+            json += JsonLine(name, best, mnkCorpus.size(), 0, false);
+        }
+    }
+
+    const MnkBenchBoard &ponderBoard = MNK_BENCH_BOARDS[1];
+    const std::vector<std::string> ponderCorpus = MnkCorpus(ponderBoard);
+    BenchRun ponder;
+    int ponderHits = 0;
+    for (int r = 0; r < repetitions; ++r) {
+        const BenchRun run = RunPonderCorpus(ponderBoard, ponderCorpus, ponderHits);
+        if (r == 0 || run.totalTime < ponder.totalTime) ponder = run;
+    }
+    if (ponder.wrongValues) {
+        fprintf(stderr, "bench_search: %d pondered replies missed or disagree with a fresh search\n", ponder.wrongValues);
+        ok = false;
+    }
+    char ponderName[64];
+    snprintf(ponderName, sizeof(ponderName), "mnk_%dx%dx%d_depth%d_ponder_hit", ponderBoard.width, ponderBoard.height,
+             ponderBoard.winLength, ponderBoard.depth);
+    json += JsonLine(ponderName, ponder, ponderCorpus.size(), MnkMoveTable().sizeInBytes(), false);
+
+    BenchRun threats;
+    for (int r = 0; r < repetitions; ++r) {
+        const BenchRun run = RunThreatCorpus();
+        if (r == 0 || run.totalTime < threats.totalTime) threats = run;
+    }
+    if (threats.wrongValues) {
+        fprintf(stderr, "bench_search: the threat search got %d positions wrong\n", threats.wrongValues);
+        ok = false;
+    }
+    json += JsonLine("mnk_15x15x5_threat_search", threats, std::size(THREAT_POSITIONS), 0, false);
+
+    BenchRun chess;
+    for (int r = 0; r < repetitions; ++r) {
+        const BenchRun run = RunChessCorpus();
+        if (r == 0 || run.totalTime < chess.totalTime) chess = run;
+    }
+    if (chess.wrongValues) {
+        fprintf(stderr, "bench_search: the chess search got %d positions wrong\n", chess.wrongValues);
+        ok = false;
+    }
+    char chessName[32];
+    snprintf(chessName, sizeof(chessName), "chess_depth%d", CHESS_BENCH_DEPTH);
+    json += JsonLine(chessName, chess, std::size(CHESS_BENCH_POSITIONS), ChessTranspositionTable().sizeInBytes(), true);
+    json += "  ]\n}\n";
+
+    if (outPath) {
+        FILE *out = fopen(outPath, "w");
+        if (!out) {
+            fprintf(stderr, "bench_search: cannot write %s\n", outPath);
+            return 1;
+        }
+        fputs(json.c_str(), out);
+        fclose(out);
+    }
+    fputs(json.c_str(), stdout);
+    if (tracePath && ProfilerWriteChromeTrace(tracePath) < 0) {
+        fprintf(stderr, "bench_search: cannot write %s\n", tracePath);
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
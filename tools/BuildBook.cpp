@@ -0,0 +1,133 @@
+//
+// opening-book builder: solves every position up to a ply and writes them as a book that the
+// demo and the m,n,k search map at startup (engine/OpeningBook.h)
+// usage: build_book [--board WxHxK] [--plies P] [--out file] [--verify]
+// the default file name is the variant's own, e.g. 4x4x4.book; the demo looks for it in
+// resources/books/
+// --verify reopens the written book and, on the 3x3 board, checks every entry against the
+// compile-time perfect-play table, exiting non-zero on a mismatch
+//
+
+#include "../engine/OpeningBook.h"
+#include "../engine/PerfectPlay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--board WxHxK] [--plies P] [--out file] [--verify]\n", program);
+    return 2;
+}
+
+static void Progress(size_t solved, size_t total)
+{
+    fprintf(stderr, "\rbuild_book: %zu / %zu positions", solved, total);
+    if (solved == total) fprintf(stderr, "\n");
+}
+
+// every book entry agrees with the perfect-play table on value, and its move keeps that value
+static bool VerifyClassic(const OpeningBook &book, const std::vector<OpeningBookEntry> &entries, const MnkRules &rules,
+                          int plies)
+{
+    size_t checked = 0;
+    bool ok = true;
+    MnkBoard board(rules);
+    std::unordered_set<uint64_t> seen;
+    // walk the same positions the builder did; the book is keyed by hash, so look each one up
+    std::vector<std::string> layer = { board.toStateString() };
+    for (int ply = 0; ply <= plies && !layer.empty(); ++ply) {
+        std::vector<std::string> next;
+        for (const std::string &state : layer) {
+            board.setStateString(state);
+            const Bitboard bits = Bitboard::fromStateString(state);
+            const PerfectPlayEntry expected = LookupPerfectPlay(bits);
+            OpeningBookEntry entry;
+            if (!book.lookup(board, entry) || entry.value != expected.value) {
+                fprintf(stderr, "build_book: %s is %s, perfect play says %d\n", state.c_str(),
+                        book.lookup(board, entry) ? std::to_string(entry.value).c_str() : "missing", expected.value);
+                ok = false;
+                continue;
+            }
+            const Bitboard after = bits.withMove(entry.move, bits.sideToMove());
+            const int kept = after.winner() ? 1 : after.full() ? 0 : -LookupPerfectPlay(after).value;
+            if (kept != entry.value) {
+                fprintf(stderr, "build_book: %s, move %d gives %d, not %d\n", state.c_str(), entry.move, kept, entry.value);
+                ok = false;
+            }
+            checked++;
+            if (ply == plies) continue;
+            board.emptyCells().forEach([&](int cell) {
+                board.makeMove(cell);
+                if (!board.gameOver() && seen.insert(board.hash()).second) next.push_back(board.toStateString());
+                board.unmakeMove();
+            });
+        }
+        layer.swap(next);
+    }
+    if (ok) {
+        printf("build_book: %zu positions agree with the perfect-play table (%zu entries)\n", checked, entries.size());
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 3, height = 3, winLength = 3;
+    int plies = -1;
+    std::string out;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%dx%d", &width, &height, &winLength) != 3) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--plies") == 0 && hasValue) {
+            plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (width < 1 || height < 1 || width > MNK_MAX_SIDE || height > MNK_MAX_SIDE || winLength < 1) {
+        fprintf(stderr, "build_book: boards go up to %dx%d\n", MNK_MAX_SIDE, MNK_MAX_SIDE);
+        return 2;
+    }
+    const MnkRules rules(width, height, winLength);
+    if (plies < 0 || plies > rules.cellCount()) plies = rules.cellCount();
+    plies = std::min(plies, 255);
+    if (out.empty()) out = OpeningBookName(rules);
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<OpeningBookEntry> entries = BuildOpeningBook(rules, plies, Progress);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!WriteOpeningBook(out, rules, plies, entries)) {
+        fprintf(stderr, "build_book: cannot write %s\n", out.c_str());
+        return 1;
+    }
+    int wins = 0, draws = 0, losses = 0;
+    for (const OpeningBookEntry &entry : entries) {
+        (entry.value > 0 ? wins : entry.value < 0 ? losses : draws)++;
+    }
+    printf("%dx%d k=%d, up to ply %d: %zu positions in %.3f s (%d wins, %d draws, %d losses for the side to move)\n",
+           width, height, winLength, plies, entries.size(), seconds, wins, draws, losses);
+    printf("wrote %s, %zu bytes\n", out.c_str(), 32 + entries.size() * sizeof(OpeningBookEntry));
+
+    if (verify) {
+        OpeningBook book;
+        if (!book.open(out, rules) || book.size() != entries.size()) {
+            fprintf(stderr, "build_book: %s doesn't read back\n", out.c_str());
+            return 1;
+        }
+        if (width == 3 && height == 3 && winLength == 3 && !VerifyClassic(book, entries, rules, plies)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+//
+// tablebase builder: solves every position of a small board by retrograde analysis and writes
+// the table that the demo and the m,n,k search map at startup (engine/Tablebase.h)
+// usage: build_tablebase [--board WxHxK] [--threads T] [--out file] [--verify]
+// the default file name is the variant's own, e.g. 4x4x4.tb; the demo looks for it in
+// resources/tablebases/
+// --verify reopens the written table and walks the positions games reach, up to 6 stones on
+// boards past 3x3: each value has to follow from its moves' values, the table's move has to
+// keep it, and on the 3x3 board it has to match the compile-time perfect-play table
+//
+
+#include "../engine/PerfectPlay.h"
+#include "../engine/Tablebase.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--board WxHxK] [--threads T] [--out file] [--verify]\n", program);
+    return 2;
+}
+
+static void Progress(int stones, uint64_t positions)
+{
+    fprintf(stderr, "\rbuild_tablebase: solved %2d stones (%llu positions)", stones, (unsigned long long)positions);
+    if (stones == 0) fprintf(stderr, "\n");
+}
+
+static const char *ValueName(int value)
+{
+    static const char *const names[] = { "unknown", "loss", "draw", "win" };
+    return names[value & 3];
+}
+
+static bool Verify(const Tablebase &table, const MnkRules &rules)
+{
+    const bool classic = rules.width() == 3 && rules.height() == 3 && rules.winLength() == 3;
+    const int maxStones = (rules.cellCount() <= 9) ? rules.cellCount() : 6;
+    MnkBoard board(rules);
+    std::unordered_set<uint64_t> seen;
+    size_t checked = 0;
+    bool ok = true;
+    std::vector<std::string> layer = { board.toStateString() };
+    for (int stones = 0; stones <= maxStones && !layer.empty(); ++stones) {
+        std::vector<std::string> next;
+        for (const std::string &state : layer) {
+            board.setStateString(state);
+            const TablebaseValue value = table.probe(board);
+            // the value the moves give: a line or a lost reply wins, a drawn one draws
+            TablebaseValue expected = board.full() ? kTablebaseDraw : kTablebaseLoss;
+            board.emptyCells().forEach([&](int cell) {
+                board.makeMove(cell);
+                const TablebaseValue reply = (board.winner() != 0) ? kTablebaseLoss : table.probe(board);
+                if (reply == kTablebaseLoss) expected = kTablebaseWin;
+                else if (reply == kTablebaseDraw && expected == kTablebaseLoss) expected = kTablebaseDraw;
+                if (stones < maxStones && !board.gameOver() && seen.insert(board.hash()).second) {
+                    next.push_back(board.toStateString());
+                }
+                board.unmakeMove();
+            });
+            if (classic) {
+                const int perfect = LookupPerfectPlay(Bitboard::fromStateString(state)).value;
+                if (value != (perfect > 0 ? kTablebaseWin : perfect < 0 ? kTablebaseLoss : kTablebaseDraw)) {
+                    fprintf(stderr, "build_tablebase: %s is a %s, perfect play says %d\n", state.c_str(), ValueName(value), perfect);
+                    ok = false;
+                }
+            }
+            TablebaseValue moveValue;
+            const int move = table.bestMove(board, moveValue);
+            bool kept = move >= 0;
+            if (kept) {
+                board.makeMove(move);
+                const TablebaseValue reply = (board.winner() != 0) ? kTablebaseLoss : table.probe(board);
+                kept = (value == kTablebaseWin) ? reply == kTablebaseLoss : (value == kTablebaseDraw) ? reply == kTablebaseDraw : true;
+                board.unmakeMove();
+            }
+            if (value != expected || !kept) {
+                fprintf(stderr, "build_tablebase: %s is a %s, its moves give a %s, move %d %s it\n", state.c_str(),
+                        ValueName(value), ValueName(expected), move, kept ? "keeps" : "doesn't keep");
+                ok = false;
+            }
+            checked++;
+        }
+        layer.swap(next);
+    }
+    if (ok) {
+        printf("build_tablebase: %zu positions up to %d stones agree with their moves%s\n", checked, maxStones,
+               classic ? " and the perfect-play table" : "");
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 3, height = 3, winLength = 3;
+    int threads = 0;
+    std::string out;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%dx%d", &width, &height, &winLength) != 3) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && hasValue) {
+            out = argv[++i];
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (width < 1 || height < 1 || width * height > TABLEBASE_MAX_CELLS || winLength < 1) {
+        fprintf(stderr, "build_tablebase: boards go up to %d cells\n", TABLEBASE_MAX_CELLS);
+        return 2;
+    }
+    const MnkRules rules(width, height, winLength);
+    if (out.empty()) out = TablebaseName(rules);
+
+    Tablebase table;
+    const auto start = std::chrono::steady_clock::now();
+    table.build(rules, threads, Progress);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!table.write(out)) {
+        fprintf(stderr, "build_tablebase: cannot write %s\n", out.c_str());
+        return 1;
+    }
+    const MnkBoard empty(rules);
+    printf("%dx%d k=%d: %llu positions in %.3f s, the empty board is a %s for X\n", width, height, winLength,
+           (unsigned long long)table.positionCount(), seconds, ValueName(table.probe(empty)));
+    printf("wrote %s, %zu bytes\n", out.c_str(), 32 + table.sizeInBytes());
+
+    if (verify) {
+        Tablebase written;
+        if (!written.open(out, rules)) {
+            fprintf(stderr, "build_tablebase: %s doesn't read back\n", out.c_str());
+            return 1;
+        }
+        if (!Verify(written, rules)) {
+            return 1;
+        }
+    }
+    return 0;
+}
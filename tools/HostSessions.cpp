@@ -0,0 +1,96 @@
+//
+// hosts many concurrent AI-vs-AI games in one process through SessionManager, the way a
+// tournament display or a bot server does, and reports moves/s and the results
+// usage: host_sessions [--sessions N] [--games G] [--threads T] [--board WxHxK] [--x ENGINE[:DEPTH][:LEVEL]]
+//                      [--o ENGINE[:DEPTH][:LEVEL]] [--random-plies P] [--seed S] [--expect-unbeaten x|o]
+// every session plays rematches until G games have finished across all of them
+// --expect-unbeaten exits non-zero if that side lost a game
+//
+
+#include "../engine/SessionManager.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--sessions N] [--games G] [--threads T] [--board WxHxK] [--x ENGINE[:DEPTH][:LEVEL]]\n"
+                    "       [--o ENGINE[:DEPTH][:LEVEL]] [--random-plies P] [--seed S] [--expect-unbeaten x|o]\n"
+                    "engines: random, negamax, alphabeta, pvs, table, mnk; levels: easy, medium, hard\n", program);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    GameSessionSettings settings;
+    settings.ai[0] = settings.ai[1] = true;
+    settings.rematch = true;
+    settings.randomPlies = 2;
+    int sessions = 1000;
+    uint64_t games = 10000;
+    int threads = 0;
+    uint32_t seed = 1;
+    int unbeaten = 0;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--sessions") == 0 && hasValue) {
+            sessions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--games") == 0 && hasValue) {
+            games = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%dx%d", &settings.width, &settings.height, &settings.winLength) != 3) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--x") == 0 && hasValue) {
+            if (!ParseSelfPlayPlayer(argv[++i], settings.players[0])) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--o") == 0 && hasValue) {
+            if (!ParseSelfPlayPlayer(argv[++i], settings.players[1])) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--random-plies") == 0 && hasValue) {
+            settings.randomPlies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--expect-unbeaten") == 0 && hasValue) {
+            const char *side = argv[++i];
+            unbeaten = (strcmp(side, "x") == 0) ? 1 : (strcmp(side, "o") == 0) ? 2 : 0;
+            if (!unbeaten) return Usage(argv[0]);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (sessions < 1 || settings.width < 1 || settings.height < 1 || settings.width > MNK_MAX_SIDE ||
+        settings.height > MNK_MAX_SIDE || settings.winLength < 1) {
+        return Usage(argv[0]);
+    }
+
+    SessionManager manager(threads, seed);
+    for (int i = 0; i < sessions; ++i) {
+        manager.open(settings);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    manager.update();
+    while (manager.results().games < games) {
+        manager.waitForReplies(std::chrono::milliseconds(100));
+        manager.update();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const SessionResults results = manager.results();
+    printf("%d sessions on %dx%d k=%d, X %s vs O %s, %d random plies, %d worker threads\n", sessions, settings.width,
+           settings.height, settings.winLength, SelfPlayEngineName(settings.players[0].engine),
+           SelfPlayEngineName(settings.players[1].engine), settings.randomPlies, manager.threadCount());
+    printf("%llu games, %llu AI moves in %.3f s (%.0f moves/s)\n", (unsigned long long)results.games,
+           (unsigned long long)manager.aiMoves(), seconds, seconds > 0 ? manager.aiMoves() / seconds : 0.0);
+    const double percent = results.games ? 100.0 / results.games : 0.0;
+    printf("X wins %llu (%.1f%%), O wins %llu (%.1f%%), draws %llu (%.1f%%)\n",
+           (unsigned long long)results.xWins, results.xWins * percent, (unsigned long long)results.oWins, results.oWins * percent,
+           (unsigned long long)results.draws, results.draws * percent);
+
+    const uint64_t losses = (unbeaten == 1) ? results.oWins : (unbeaten == 2) ? results.xWins : 0;
+    if (losses) {
+        fprintf(stderr, "host_sessions: %s lost %llu games\n", unbeaten == 1 ? "X" : "O", (unsigned long long)losses);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,278 @@
+//
+// headless AI move server (engine/MoveServer.h): answers "MOVE <state>" lines over TCP
+// usage: move_server [--port P] [--any-address] [--threads T] [--engine ENGINE[:DEPTH][:LEVEL]]
+//                    [--max-depth D] [--stats-out file.json] [--self-test N [--connections C]]
+// --engine is the default for boards other than 3x3, which use the perfect-play table
+// Ctrl-C stops the server and prints the request count and latency percentiles as JSON
+// --self-test serves on a free loopback port and sends it N requests from C clients at once,
+// checking every 3x3 answer against the perfect-play table, then pipelines a burst of PINGs
+// that has to be throttled and still answered in full; it exits non-zero on a wrong one
+//
+
+#include "../engine/MoveServer.h"
+#include "../engine/PerfectPlay.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static MoveServer *g_server = nullptr;
+
+static void OnInterrupt(int)
+{
+    if (g_server) g_server->stop();
+}
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--port P] [--any-address] [--threads T] [--engine ENGINE[:DEPTH][:LEVEL]]\n"
+                    "       [--max-depth D] [--stats-out file.json] [--self-test N [--connections C]]\n"
+                    "engines: random, negamax, alphabeta, pvs, table, mnk; levels: easy, medium, hard\n", program);
+    return 2;
+}
+
+// a position from a random 3x3 game, not yet over
+static std::string RandomPosition(std::mt19937 &rng)
+{
+    const MnkRules &rules = [] () -> const MnkRules & {
+        static const MnkRules classic(3, 3, 3);
+        return classic;
+    }();
+    MnkBoard board(rules);
+    const int plies = std::uniform_int_distribution<int>(0, 7)(rng);
+    for (int ply = 0; ply < plies; ++ply) {
+        std::vector<int> empty;
+        board.emptyCells().forEach([&](int cell) { empty.push_back(cell); });
+        board.makeMove(empty[std::uniform_int_distribution<size_t>(0, empty.size() - 1)(rng)]);
+        if (board.gameOver()) {
+            board.unmakeMove();
+            break;
+        }
+    }
+    return board.toStateString();
+}
+
+// one client: sends its requests a pipelined chunk at a time and checks each answer; returns
+// the number of wrong ones, or -1 if the connection failed
+static int RunClient(uint16_t port, int requests, uint32_t seed)
+{
+    const SocketHandle socket = SocketConnect("127.0.0.1", port);
+    if (socket == INVALID_SOCKET_HANDLE) {
+        return -1;
+    }
+    constexpr int CHUNK = 16;
+    std::mt19937 rng(seed);
+    std::vector<std::string> states;
+    std::string out, in;
+    char buffer[4096];
+    int wrong = 0;
+    for (int sent = 0; sent < requests;) {
+        const int chunk = std::min(CHUNK, requests - sent);
+        states.clear();
+        out.clear();
+        for (int i = 0; i < chunk; ++i) {
+            states.push_back(RandomPosition(rng));
+            out += "MOVE " + states.back() + "\n";
+        }
+        // one malformed request per chunk, whose ERR has to come back in its place
+        out += "MOVE 12\n";
+        for (size_t done = 0; done < out.size();) {
+            const long count = SocketSend(socket, out.data() + done, out.size() - done);
+            if (count <= 0) {
+                SocketClose(socket);
+                return -1;
+            }
+            done += (size_t)count;
+        }
+        for (int answered = 0; answered <= chunk;) {
+            const size_t newline = in.find('\n');
+            if (newline == std::string::npos) {
+                const long count = SocketReceive(socket, buffer, sizeof(buffer));
+                if (count <= 0) {
+                    SocketClose(socket);
+                    return -1;
+                }
+                in.append(buffer, (size_t)count);
+                continue;
+            }
+            const std::string line = in.substr(0, newline);
+            in.erase(0, newline + 1);
+            if (answered == chunk) {
+                if (line.compare(0, 4, "ERR ") != 0) wrong++;
+            } else {
+                const Bitboard board = Bitboard::fromStateString(states[answered]);
+                const PerfectPlayEntry entry = LookupPerfectPlay(board);
+                int move = -1;
+                if (sscanf(line.c_str(), "OK %d", &move) != 1 || move < 0 || move >= BOARD_CELLS || board.cellAt(move) != 0) {
+                    wrong++;
+                } else {
+                    // any move that keeps the position's value is a perfect one
+                    std::string after = states[answered];
+                    after[move] = (char)('0' + board.sideToMove());
+                    const PerfectPlayEntry next = LookupPerfectPlay(Bitboard::fromStateString(after));
+                    if (!next.solved || -next.value != entry.value) wrong++;
+                }
+            }
+            answered++;
+        }
+        sent += chunk;
+    }
+    SocketClose(socket);
+    return wrong;
+}
+
+// sends PINGs from one thread while another reads the PONGs; false unless every one comes back
+static bool RunFloodClient(uint16_t port, int pings)
+{
+    const SocketHandle socket = SocketConnect("127.0.0.1", port);
+    if (socket == INVALID_SOCKET_HANDLE) {
+        return false;
+    }
+    std::string out;
+    for (int i = 0; i < pings; ++i) {
+        out += "PING\n";
+    }
+    bool sentAll = true;
+    std::thread sender([&] {
+        for (size_t done = 0; done < out.size();) {
+            const long count = SocketSend(socket, out.data() + done, out.size() - done);
+            if (count <= 0) {
+                sentAll = false;
+                return;
+            }
+            done += (size_t)count;
+        }
+    });
+    std::string in;
+    char buffer[4096];
+    int pongs = 0;
+    while (pongs < pings) {
+        const long count = SocketReceive(socket, buffer, sizeof(buffer));
+        if (count <= 0) {
+            break;
+        }
+        in.append(buffer, (size_t)count);
+        size_t start = 0;
+        for (size_t end = in.find('\n'); end != std::string::npos; end = in.find('\n', start)) {
+            if (in.compare(start, end - start, "PONG") != 0) break;
+            pongs++;
+            start = end + 1;
+        }
+        in.erase(0, start);
+    }
+    sender.join();
+    SocketClose(socket);
+    return sentAll && pongs == pings;
+}
+
+static int SelfTest(MoveServer &server, int requests, int connections)
+{
+    std::thread serving(&MoveServer::run, &server);
+    std::vector<int> wrong(connections, 0);
+    const auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int i = 0; i < connections; ++i) {
+        const int share = requests / connections + (i < requests % connections ? 1 : 0);
+        clients.emplace_back([&, i, share] { wrong[i] = RunClient(server.port(), share, 1234u + (uint32_t)i); });
+    }
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    // far more than MoveServerConfig::maxPending in a read or two, so the connection is throttled
+    const bool flooded = RunFloodClient(server.port(), 20000);
+    server.stop();
+    serving.join();
+
+    int failed = 0, mistakes = 0;
+    for (int count : wrong) {
+        if (count < 0) failed++;
+        else mistakes += count;
+    }
+    printf("%d requests from %d clients in %.3f s: %.0f requests/sec\n", requests, connections, seconds,
+           seconds > 0 ? requests / seconds : 0.0);
+    printf("%s\n", server.statsJson().c_str());
+    if (failed || mistakes) {
+        fprintf(stderr, "self-test failed: %d connections dropped, %d wrong answers\n", failed, mistakes);
+        return 1;
+    }
+    if (!flooded || server.stats().throttled == 0) {
+        fprintf(stderr, "self-test failed: the pipelined PINGs were %s\n", flooded ? "never throttled" : "not all answered");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    MoveServerConfig config;
+    const char *statsOut = nullptr;
+    int selfTest = 0;
+    int connections = 8;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            config.port = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--any-address") == 0) {
+            config.anyAddress = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            config.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--engine") == 0 && hasValue) {
+            if (!ParseSelfPlayPlayer(argv[++i], config.mnkPlayer)) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--max-depth") == 0 && hasValue) {
+            config.maxDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats-out") == 0 && hasValue) {
+            statsOut = argv[++i];
+        } else if (strcmp(argv[i], "--self-test") == 0 && hasValue) {
+            selfTest = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--connections") == 0 && hasValue) {
+            connections = atoi(argv[++i]);
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    if (config.maxDepth < 1 || connections < 1 || selfTest < 0) {
+        return Usage(argv[0]);
+    }
+    if (selfTest > 0) {
+        config.port = 0;
+        config.anyAddress = false;
+    }
+
+    MoveServer server(config);
+    std::string error;
+    if (!server.listen(error)) {
+        fprintf(stderr, "move_server: %s\n", error.c_str());
+        return 1;
+    }
+
+    int status = 0;
+    if (selfTest > 0) {
+        status = SelfTest(server, selfTest, connections);
+    } else {
+        printf("serving moves on %s:%u\n", config.anyAddress ? "0.0.0.0" : "127.0.0.1", server.port());
+        fflush(stdout);
+        g_server = &server;
+        std::signal(SIGINT, OnInterrupt);
+        std::signal(SIGTERM, OnInterrupt);
+        server.run();
+        g_server = nullptr;
+        printf("%s\n", server.statsJson().c_str());
+    }
+
+    if (statsOut) {
+        FILE *file = fopen(statsOut, "w");
+        if (!file) {
+            fprintf(stderr, "move_server: can't write %s\n", statsOut);
+            return 1;
+        }
+        fprintf(file, "%s\n", server.statsJson().c_str());
+        fclose(file);
+    }
+    return status;
+}
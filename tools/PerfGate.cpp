@@ -0,0 +1,537 @@
+//
+// performance gate: runs a fixed search corpus and a headless render loop, and fails if any
+// measure is worse than the checked-in baseline by more than a threshold, so the searches and
+// Game::drawFrame can't get slower from one release to the next without anyone noticing
+// the searches are the 5x5 and 15x15 m,n,k openings and a few chess positions at a fixed depth
+// on one thread: nodes per CPU second, nodes, and heap allocations per move, counted by
+// replacing the global operator new
+// the render loop draws the tic-tac-toe and chess boards for N frames through ImGui with no
+// platform or renderer backend (textures get ids, the draw lists are built and never submitted):
+// CPU time, allocations and vertices per frame; the mouse follows a fixed path and a move is made
+// every few frames, so hovering, rebuilding the cached board and glides are all in the loop
+// times depend on the machine, so a run first times a fixed integer kernel and scales the
+// baseline's times by how much faster or slower that ran here; counts are compared as they are
+// run from the source directory, where resources/ and perf/baseline.json are; after a change
+// that is meant to cost more, --write-baseline records the new figures
+//
+// usage: perf_gate [--baseline file.json] [--write-baseline] [--out file.json] [--frames N]
+//                  [--repetitions N] [--threshold PERCENT]
+//
+
+#include "../Application.h"
+#include "../classes/Chess.h"
+#include "../classes/TextureCache.h"
+#include "../classes/TicTacToe.h"
+#include "../engine/ChessSearch.h"
+#include "../engine/MnkSearch.h"
+#include "../imgui/imgui.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <new>
+#include <string>
+#include <vector>
+
+//
+// every heap allocation in the process is counted; a search or a frame's share is the change
+// across it
+//
+static std::atomic<uint64_t> allocations{ 0 };
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const size_t alignment = std::max((size_t)align, sizeof(void *));
+#ifdef _WIN32
+    void *p = _aligned_malloc(size ? size : 1, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    void *p = std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment);
+#endif
+    if (p) return p;
+    throw std::bad_alloc();
+}
+
+static void AlignedFree(void *p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { ::operator delete(p); }
+void operator delete(void *p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void *p, size_t, std::align_val_t align) noexcept { ::operator delete(p, align); }
+
+// the demo's main loop, which the game classes call into
+namespace ClassGame {
+    void EndOfTurn() {}
+    void RequestRedraw(int frames) {}
+}
+
+static double CpuSeconds()
+{
+    return (double)std::clock() / CLOCKS_PER_SEC;
+}
+
+enum PerfKind
+{
+    kPerfTime,          // lower is better, scaled by the calibration
+    kPerfRate,          // higher is better, scaled by the calibration
+    kPerfCount,         // lower is better, the same on any machine
+};
+
+static const char *PERF_KIND_NAMES[] = { "time", "rate", "count" };
+
+struct PerfMetric
+{
+    std::string name;
+    PerfKind    kind;
+    double      value;
+};
+
+struct PerfBaseline
+{
+    double                  calibration = 0.0;     // seconds
+    std::vector<PerfMetric> metrics;
+};
+
+constexpr int CALIBRATION_STEPS = 5000000;
+constexpr int CALIBRATION_RUNS = 5;
+static volatile uint64_t calibrationSink;
+// the fastest calibration run of the process, which every pass's time is scaled to
+static double referenceCalibration = 0.0;
+
+//
+// xorshift steps, a table lookup and a data-dependent branch each: the mix the searches and
+// the draw loop run, in a loop no compiler can fold away; seconds for one run
+//
+static double Calibrate()
+{
+    static uint16_t table[1 << 14];
+    for (size_t i = 0; i < std::size(table); ++i) {
+        table[i] = (uint16_t)(i * 40503u);
+    }
+    const double start = CpuSeconds();
+    uint64_t x = 88172645463325252ull;
+    uint64_t sum = 0;
+    for (int i = 0; i < CALIBRATION_STEPS; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        sum += table[x & (std::size(table) - 1)];
+        if (sum & 1) sum += std::popcount(x);
+    }
+    calibrationSink = sum;
+    return CpuSeconds() - start;
+}
+
+// a shared machine runs slow for a while now and then: each pass times the kernel first and
+// counts its own time at the rate the kernel ran at its fastest, so a slow spell scales both
+static double PassScale()
+{
+    return referenceCalibration / Calibrate();
+}
+
+//
+// searches: pass 0 only warms up (tables built on first use, buffers grown to size), then each
+// corpus is run repetitions times; node and allocation counts are the same on every pass, the
+// time is the fastest pass's
+//
+struct SearchRun
+{
+    uint64_t    nodes = 0;
+    uint64_t    allocations = 0;
+    double      seconds = 0.0;
+    int         moves = 0;
+};
+
+static void AddSearchMetrics(std::vector<PerfMetric> &metrics, const char *name, const SearchRun &run)
+{
+    const std::string prefix = std::string("search_") + name;
+    metrics.push_back({ prefix + "_nodes_per_second", kPerfRate, run.seconds > 0 ? run.nodes / run.seconds : 0.0 });
+    metrics.push_back({ prefix + "_nodes", kPerfCount, (double)run.nodes });
+    metrics.push_back({ prefix + "_allocations_per_move", kPerfCount, (double)run.allocations / run.moves });
+}
+
+struct MnkGateBoard
+{
+    const char *name;
+    int         width, height, winLength;
+    int         depth;
+};
+
+static const MnkGateBoard MNK_GATE_BOARDS[] = {
+    { "mnk_5x5x4", 5, 5, 4, 5 },
+    { "mnk_15x15x5", 15, 15, 5, 4 },
+};
+
+// the empty board and every first move in the 3x3 block at the centre
+static std::vector<std::string> MnkGateCorpus(const MnkGateBoard &gate)
+{
+    const int cells = gate.width * gate.height;
+    std::vector<std::string> corpus = { std::string(cells, '0') };
+    for (int y = gate.height / 2 - 1; y <= gate.height / 2 + 1; ++y) {
+        for (int x = gate.width / 2 - 1; x <= gate.width / 2 + 1; ++x) {
+            std::string state(cells, '0');
+            state[y * gate.width + x] = '1';
+            corpus.push_back(state);
+        }
+    }
+    return corpus;
+}
+
+static SearchRun RunMnkGate(const MnkGateBoard &gate, int repetitions)
+{
+    const MnkRules rules(gate.width, gate.height, gate.winLength);
+    const std::vector<std::string> corpus = MnkGateCorpus(gate);
+    MnkBoard board(rules);
+    SearchRun best;
+    for (int r = 0; r <= repetitions; ++r) {
+        SearchRun run;
+        const double scale = PassScale();
+        for (const std::string &state : corpus) {
+            board.setStateString(state);
+            MnkSearchOptions options;
+            options.maxDepth = gate.depth;
+            const uint64_t allocated = allocations.load();
+            const double start = CpuSeconds();
+            const MnkSearchResult result = MnkSearchBestMove(board, options);
+            run.seconds += CpuSeconds() - start;
+            run.allocations += allocations.load() - allocated;
+            run.nodes += result.nodes;
+            run.moves++;
+        }
+        run.seconds *= scale;
+        if (r == 1 || (r > 1 && run.seconds < best.seconds)) best = run;
+    }
+    return best;
+}
+
+constexpr int CHESS_GATE_DEPTH = 6;
+
+static const char *CHESS_GATE_POSITIONS[] = {
+    ChessBoard::START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+};
+
+static SearchRun RunChessGate(int repetitions)
+{
+    ChessBoard board;
+    SearchRun best;
+    for (int r = 0; r <= repetitions; ++r) {
+        SearchRun run;
+        const double scale = PassScale();
+        for (const char *fen : CHESS_GATE_POSITIONS) {
+            board.setFen(fen);
+            ChessSearchOptions options;
+            options.maxDepth = CHESS_GATE_DEPTH;
+            const uint64_t allocated = allocations.load();
+            const double start = CpuSeconds();
+            const ChessSearchResult result = ChessSearchBestMove(board, options);
+            run.seconds += CpuSeconds() - start;
+            run.allocations += allocations.load() - allocated;
+            run.nodes += result.nodes;
+            run.moves++;
+        }
+        run.seconds *= scale;
+        if (r == 1 || (r > 1 && run.seconds < best.seconds)) best = run;
+    }
+    return best;
+}
+
+//
+// the render loop: one ImGui frame with the board in a window filling the display, as the demo
+// draws it, and the draw data built but sent nowhere
+//
+constexpr float PERF_DISPLAY_SIZE = 800.0f;
+constexpr int PERF_WARMUP_FRAMES = 60;      // drawn untimed after each pass resets the board
+constexpr int PERF_MOVE_FRAMES = 15;        // frames between moves, long enough for most of a glide
+
+static void DrawFrame(Game &game, int frame)
+{
+    ImGuiIO &io = ImGui::GetIO();
+    io.DeltaTime = 1.0f / 60.0f;
+    // a slow loop over the whole display, crossing every holder of either board
+    const float half = PERF_DISPLAY_SIZE / 2;
+    io.AddMousePosEvent(half + 0.8f * half * sinf(frame * 0.05f), half + 0.8f * half * sinf(frame * 0.07f));
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Board", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings);
+    game.drawFrame();
+    ImGui::End();
+    ImGui::Render();
+}
+
+// a drawn game of tic-tac-toe, played over and over
+static const int TICTACTOE_GATE_MOVES[] = { 4, 0, 2, 6, 3, 5, 1, 7, 8 };
+
+static void PlayTicTacToeMove(TicTacToe &game, int move)
+{
+    const int ply = move % (int)std::size(TICTACTOE_GATE_MOVES);
+    if (ply == 0) {
+        game.setStateString(std::string(BOARD_CELLS, '0'));
+    }
+    game.makeMove(TICTACTOE_GATE_MOVES[ply], ply % 2 + 1);
+}
+
+// an opening with a capture and both castles, then a new game
+static const char *CHESS_GATE_MOVES[] = {
+    "e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "g8f6", "d2d4", "e5d4", "e1g1", "f8c5", "f3d4", "e8g8",
+};
+
+static void PlayChessMove(Chess &game, int move)
+{
+    const int ply = move % (int)std::size(CHESS_GATE_MOVES);
+    if (ply == 0) {
+        game.newGame();
+    }
+    ChessBoard board = game.board();
+    game.playMove(board.parseMove(CHESS_GATE_MOVES[ply]));
+}
+
+struct RenderRun
+{
+    double      seconds = 0.0;
+    uint64_t    allocations = 0;
+    uint64_t    vertices = 0;
+};
+
+template <typename GameType>
+static RenderRun RunRenderGate(GameType &game, void (*move)(GameType &, int), int frames, int repetitions)
+{
+    RenderRun best;
+    for (int r = 0; r <= repetitions; ++r) {
+        // the same frames every pass, from the same position; pass 0 warms up as for the searches
+        const double scale = PassScale();
+        move(game, 0);
+        for (int frame = 0; frame < PERF_WARMUP_FRAMES; ++frame) {
+            DrawFrame(game, frame);
+        }
+        RenderRun run;
+        for (int frame = 0; frame < frames; ++frame) {
+            if (frame % PERF_MOVE_FRAMES == 0) {
+                move(game, 1 + frame / PERF_MOVE_FRAMES);
+            }
+            const uint64_t allocated = allocations.load();
+            const double start = CpuSeconds();
+            DrawFrame(game, frame);
+            run.seconds += CpuSeconds() - start;
+            run.allocations += allocations.load() - allocated;
+            run.vertices += ImGui::GetDrawData()->TotalVtxCount;
+        }
+        run.seconds *= scale;
+        if (r == 1 || (r > 1 && run.seconds < best.seconds)) best = run;
+    }
+    return best;
+}
+
+static void AddRenderMetrics(std::vector<PerfMetric> &metrics, const char *name, const RenderRun &run, int frames)
+{
+    const std::string prefix = std::string("render_") + name;
+    metrics.push_back({ prefix + "_cpu_us_per_frame", kPerfTime, run.seconds * 1e6 / frames });
+    metrics.push_back({ prefix + "_allocations_per_frame", kPerfCount, (double)run.allocations / frames });
+    metrics.push_back({ prefix + "_vertices_per_frame", kPerfCount, (double)run.vertices / frames });
+}
+
+static void RunRenderGates(std::vector<PerfMetric> &metrics, int frames, int repetitions)
+{
+    ImGui::CreateContext();
+    ImGuiIO &io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(PERF_DISPLAY_SIZE, PERF_DISPLAY_SIZE);
+    unsigned char *pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    // one texture for every sprite, as the demo sets it up
+    TextureCache::instance().buildResourceAtlas();
+
+    {
+        TicTacToe ticTacToe;
+        ticTacToe.setUpBoard();
+        AddRenderMetrics(metrics, "tictactoe", RunRenderGate(ticTacToe, PlayTicTacToeMove, frames, repetitions), frames);
+        ticTacToe.stopGame();
+    }
+    {
+        Chess chess;
+        chess.setAIColor(kBlack, false);
+        chess.setUpBoard();
+        AddRenderMetrics(metrics, "chess", RunRenderGate(chess, PlayChessMove, frames, repetitions), frames);
+        chess.stopGame();
+    }
+
+    ImGui::DestroyContext();
+}
+
+//
+// the baseline is JSON with one metric a line, read back line by line; what --out writes is a
+// baseline too
+//
+static bool ReadBaseline(const char *path, PerfBaseline &baseline)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char name[128];
+        char kind[16];
+        double value = 0.0;
+        if (sscanf(line, " \"calibration_seconds\": %lf", &value) == 1) {
+            baseline.calibration = value;
+        } else if (sscanf(line, " { \"name\": \"%127[^\"]\", \"kind\": \"%15[^\"]\", \"value\": %lf", name, kind, &value) == 3) {
+            for (int k = kPerfTime; k <= kPerfCount; ++k) {
+                if (strcmp(kind, PERF_KIND_NAMES[k]) == 0) baseline.metrics.push_back({ name, (PerfKind)k, value });
+            }
+        }
+    }
+    fclose(file);
+    return baseline.calibration > 0.0 && !baseline.metrics.empty();
+}
+
+static bool WriteBaseline(const char *path, const PerfBaseline &baseline)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"calibration_seconds\": %.6f,\n  \"metrics\": [\n", baseline.calibration);
+    for (size_t i = 0; i < baseline.metrics.size(); ++i) {
+        const PerfMetric &metric = baseline.metrics[i];
+        fprintf(file, "    { \"name\": \"%s\", \"kind\": \"%s\", \"value\": %.3f }%s\n", metric.name.c_str(),
+                PERF_KIND_NAMES[metric.kind], metric.value, i + 1 < baseline.metrics.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+//
+// prints every metric against its limit; false if any is past it
+//
+static bool Compare(const PerfBaseline &now, const PerfBaseline &baseline, double threshold)
+{
+    // above 1 when this machine is slower than the one the baseline was recorded on
+    const double slowdown = now.calibration / baseline.calibration;
+    printf("calibration: %.3f s here, %.3f s in the baseline\n", now.calibration, baseline.calibration);
+    printf("%-46s %14s %14s %14s\n", "metric", "baseline", "limit", "now");
+    bool ok = true;
+    for (const PerfMetric &metric : now.metrics) {
+        const auto found = std::find_if(baseline.metrics.begin(), baseline.metrics.end(),
+                                        [&](const PerfMetric &b) { return b.name == metric.name; });
+        if (found == baseline.metrics.end()) {
+            printf("%-46s %14s %14s %14.3f  new\n", metric.name.c_str(), "-", "-", metric.value);
+            continue;
+        }
+        double limit = 0.0;
+        bool regressed = false;
+        switch (metric.kind) {
+            case kPerfTime:
+                limit = found->value * slowdown * (1.0 + threshold);
+                regressed = metric.value > limit;
+                break;
+            case kPerfRate:
+                limit = found->value / slowdown / (1.0 + threshold);
+                regressed = metric.value < limit;
+                break;
+            case kPerfCount:
+                limit = found->value * (1.0 + threshold);
+                regressed = metric.value > limit;
+                break;
+        }
+        printf("%-46s %14.3f %14.3f %14.3f  %s\n", metric.name.c_str(), found->value, limit, metric.value,
+               regressed ? "REGRESSED" : "ok");
+        if (regressed) ok = false;
+    }
+    for (const PerfMetric &metric : baseline.metrics) {
+        const bool measured = std::any_of(now.metrics.begin(), now.metrics.end(),
+                                          [&](const PerfMetric &m) { return m.name == metric.name; });
+        if (!measured) printf("%-46s no longer measured\n", metric.name.c_str());
+    }
+    return ok;
+}
+
+static void Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--baseline file.json] [--write-baseline] [--out file.json] [--frames N]\n"
+                    "       [--repetitions N] [--threshold PERCENT]\n", program);
+}
+
+int main(int argc, char **argv)
+{
+    const char *baselinePath = "perf/baseline.json";
+    const char *outPath = nullptr;
+    bool writeBaseline = false;
+    int frames = 2000;
+    int repetitions = 5;
+    double threshold = 0.25;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--write-baseline") == 0) {
+            writeBaseline = true;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::max(0.0, atof(argv[++i]) / 100.0);
+        } else {
+            Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    for (int r = 0; r < CALIBRATION_RUNS; ++r) {
+        const double seconds = Calibrate();
+        if (r == 0 || seconds < referenceCalibration) referenceCalibration = seconds;
+    }
+    PerfBaseline now;
+    now.calibration = referenceCalibration;
+    for (const MnkGateBoard &gate : MNK_GATE_BOARDS) {
+        AddSearchMetrics(now.metrics, gate.name, RunMnkGate(gate, repetitions));
+    }
+    AddSearchMetrics(now.metrics, "chess", RunChessGate(repetitions));
+    RunRenderGates(now.metrics, frames, repetitions);
+
+    if (outPath && !WriteBaseline(outPath, now)) {
+        fprintf(stderr, "perf_gate: can't write %s\n", outPath);
+        return 1;
+    }
+    if (writeBaseline) {
+        if (!WriteBaseline(baselinePath, now)) {
+            fprintf(stderr, "perf_gate: can't write %s\n", baselinePath);
+            return 1;
+        }
+        printf("perf_gate: wrote %zu metrics to %s\n", now.metrics.size(), baselinePath);
+        return 0;
+    }
+
+    PerfBaseline baseline;
+    if (!ReadBaseline(baselinePath, baseline)) {
+        fprintf(stderr, "perf_gate: can't read a baseline from %s\n", baselinePath);
+        return 1;
+    }
+    if (!Compare(now, baseline, threshold)) {
+        fflush(stdout);
+        fprintf(stderr, "perf_gate: regressed by more than %.0f%% against %s\n", threshold * 100.0, baselinePath);
+        return 1;
+    }
+    return 0;
+}
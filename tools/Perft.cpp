@@ -0,0 +1,192 @@
+//
+// perft: counts positions, depth-limit leaves and game outcomes from a state string
+// usage: perft [--board WxHxK] [--depth N] [state]
+//        perft --verify
+//        perft --chess [--depth N] [fen] | perft --chess --verify
+// without --board the 3x3 bitboard is used; the state string is one character per cell
+// ('0' empty, '1' X, '2' O) as in TicTacToe::stateString(), default the empty board
+// --verify checks the known 3x3 totals for both engines and exits non-zero on a mismatch
+// --chess counts legal chess move trees (engine/ChessBoard.h) from a FEN, default the start
+// position; with --verify it checks the published counts of the standard perft positions
+//
+
+#include "../engine/ChessBoard.h"
+#include "../engine/Perft.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// games of tic-tac-toe, by the ply they end on and by outcome
+static const uint64_t GAMES_ENDING_AT_PLY[BOARD_CELLS + 1] = { 0, 0, 0, 0, 0, 1440, 5328, 47952, 72576, 127872 };
+constexpr uint64_t TOTAL_GAMES = 255168;
+constexpr uint64_t TOTAL_X_WINS = 131184;
+constexpr uint64_t TOTAL_O_WINS = 77904;
+constexpr uint64_t TOTAL_DRAWS = 46080;
+
+static void Print(int depth, const PerftCounts &counts, double seconds)
+{
+    printf("depth %d: %llu nodes, %llu leaves, %llu games (X %llu, O %llu, draw %llu), %.3f ms, %.1f Mnodes/s\n",
+           depth, (unsigned long long)counts.nodes, (unsigned long long)counts.leaves, (unsigned long long)counts.games(),
+           (unsigned long long)counts.xWins, (unsigned long long)counts.oWins, (unsigned long long)counts.draws,
+           seconds * 1e3, seconds > 0 ? counts.nodes / seconds / 1e6 : 0.0);
+}
+
+static bool Verify()
+{
+    bool ok = true;
+    const MnkRules rules(3, 3, 3);
+    const MnkBoard empty(rules);
+    uint64_t previousGames = 0;
+    for (int depth = 0; depth <= BOARD_CELLS; ++depth) {
+        const PerftCounts bits = Perft(Bitboard(), depth);
+        const PerftCounts mnk = MnkPerft(empty, depth);
+        if (!(bits == mnk)) {
+            fprintf(stderr, "perft: depth %d, the bitboard and m,n,k counts differ\n", depth);
+            ok = false;
+        }
+        if (bits.games() - previousGames != GAMES_ENDING_AT_PLY[depth]) {
+            fprintf(stderr, "perft: depth %d, %llu games end at this ply, expected %llu\n", depth,
+                    (unsigned long long)(bits.games() - previousGames), (unsigned long long)GAMES_ENDING_AT_PLY[depth]);
+            ok = false;
+        }
+        previousGames = bits.games();
+    }
+    const PerftCounts full = Perft(Bitboard(), BOARD_CELLS);
+    if (full.games() != TOTAL_GAMES || full.xWins != TOTAL_X_WINS || full.oWins != TOTAL_O_WINS ||
+        full.draws != TOTAL_DRAWS || full.leaves != 0) {
+        fprintf(stderr, "perft: full game tree has %llu games (X %llu, O %llu, draw %llu), expected %llu (%llu, %llu, %llu)\n",
+                (unsigned long long)full.games(), (unsigned long long)full.xWins, (unsigned long long)full.oWins,
+                (unsigned long long)full.draws, (unsigned long long)TOTAL_GAMES, (unsigned long long)TOTAL_X_WINS,
+                (unsigned long long)TOTAL_O_WINS, (unsigned long long)TOTAL_DRAWS);
+        ok = false;
+    }
+    if (ok) {
+        printf("perft: %llu games from the empty board, bitboard and m,n,k engines agree\n", (unsigned long long)full.games());
+    }
+    return ok;
+}
+
+//
+// the usual perft test positions with their published leaf counts, which between them reach
+// castling through and out of check, en passant, discovered checks and every promotion
+//
+struct ChessPerftPosition
+{
+    const char *fen;
+    uint64_t    leaves[4];          // depth 1 to 4, 0 past what the check runs
+};
+
+static const ChessPerftPosition CHESS_POSITIONS[] = {
+    { ChessBoard::START_FEN, { 20, 400, 8902, 197281 } },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 48, 2039, 97862, 0 } },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 14, 191, 2812, 43238 } },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 6, 264, 9467, 0 } },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 44, 1486, 62379, 0 } },
+};
+
+static bool VerifyChess()
+{
+    bool ok = true;
+    uint64_t total = 0;
+    for (const ChessPerftPosition &position : CHESS_POSITIONS) {
+        ChessBoard board;
+        if (!board.setFen(position.fen)) {
+            fprintf(stderr, "perft: can't read %s\n", position.fen);
+            ok = false;
+            continue;
+        }
+        for (int depth = 1; depth <= 4 && position.leaves[depth - 1]; ++depth) {
+            const uint64_t leaves = ChessPerft(board, depth);
+            total += leaves;
+            if (leaves != position.leaves[depth - 1]) {
+                fprintf(stderr, "perft: %s depth %d has %llu leaves, expected %llu\n", position.fen, depth,
+                        (unsigned long long)leaves, (unsigned long long)position.leaves[depth - 1]);
+                ok = false;
+            }
+        }
+        if (board.fen() != position.fen) {
+            fprintf(stderr, "perft: %s came back as %s\n", position.fen, board.fen().c_str());
+            ok = false;
+        }
+    }
+    if (ok) {
+        printf("perft: %llu chess leaves over %zu positions match the published counts\n", (unsigned long long)total,
+               sizeof(CHESS_POSITIONS) / sizeof(CHESS_POSITIONS[0]));
+    }
+    return ok;
+}
+
+static int RunChess(const std::string &fen, int depth, bool verify)
+{
+    if (verify) {
+        return VerifyChess() ? 0 : 1;
+    }
+    ChessBoard board;
+    if (!fen.empty() && !board.setFen(fen)) {
+        fprintf(stderr, "perft: not a FEN position: %s\n", fen.c_str());
+        return 2;
+    }
+    for (int d = 1; d <= (depth < 0 ? 5 : depth); ++d) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t leaves = ChessPerft(board, d);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("depth %d: %llu leaves, %.3f ms, %.1f Mleaves/s\n", d, (unsigned long long)leaves, seconds * 1e3,
+               seconds > 0 ? leaves / seconds / 1e6 : 0.0);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int width = 0, height = 0, winLength = 0;
+    int depth = -1;
+    bool chess = false, verify = false;
+    std::string state;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "--chess") == 0) {
+            chess = true;
+        } else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%dx%d", &width, &height, &winLength) != 3) {
+                fprintf(stderr, "perft: --board expects WxHxK, e.g. 4x4x4\n");
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            // a FEN has spaces, so it may come as one quoted argument or as several
+            if (!state.empty()) state += ' ';
+            state += argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [--board WxHxK] [--depth N] [state] | --verify\n"
+                            "       %s --chess [--depth N] [fen] | --chess --verify\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (chess) {
+        return RunChess(state, depth, verify);
+    }
+    if (verify) {
+        return Verify() ? 0 : 1;
+    }
+
+    const bool mnk = width > 0;
+    const MnkRules rules = mnk ? MnkRules(width, height, winLength) : MnkRules(3, 3, 3);
+    MnkBoard board(rules);
+    board.setStateString(state);
+    const Bitboard pos = Bitboard::fromStateString(state);
+    if (depth < 0) {
+        depth = rules.cellCount() - board.pieceCount();
+    }
+
+    // one line per depth, the way perft is usually reported
+    for (int d = 1; d <= depth; ++d) {
+        const auto start = std::chrono::steady_clock::now();
+        const PerftCounts counts = mnk ? MnkPerft(board, d) : Perft(pos, d);
+        Print(d, counts, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+//
+// headless self-play: plays AI-vs-AI games on a thread pool and reports the results
+// usage: selfplay [--games N] [--threads T] [--board WxHxK] [--x ENGINE[:DEPTH][:LEVEL]] [--o ENGINE[:DEPTH][:LEVEL]]
+//                 [--time-ms MS] [--random-plies P] [--seed S] [--expect-unbeaten x|o]
+//                 [--expect-wins x|o PERCENT] [--record file]
+// engines: random, negamax, alphabeta, pvs, table (3x3 only) and mnk (any board); a level
+// (easy, medium, hard) weakens the engine to the m,n,k search at that level
+// --expect-unbeaten exits non-zero if that side lost a game, e.g. the perfect-play table
+// against random openings, which makes the run a regression test; --expect-wins does the same if
+// that side won less than PERCENT of the games, e.g. to check a level is as weak as it should be
+// --record appends every game to a binary record file (engine/GameRecord.h) for analyse_records
+//
+
+#include "../engine/SelfPlay.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static int Usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--games N] [--threads T] [--board WxHxK] [--x ENGINE[:DEPTH][:LEVEL]] [--o ENGINE[:DEPTH][:LEVEL]]\n"
+                    "       [--time-ms MS] [--random-plies P] [--seed S] [--expect-unbeaten x|o]\n"
+                    "       [--expect-wins x|o PERCENT] [--record file]\n"
+                    "engines: random, negamax, alphabeta, pvs, table, mnk; levels: easy, medium, hard\n", program);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    SelfPlayConfig config;
+    config.randomPlies = 2;
+    int games = 1000;
+    int threads = 0;
+    int64_t timeBudget = 0;
+    int unbeaten = 0;
+    int winner = 0;
+    double winPercent = 0.0;
+    const char *recordPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && hasValue) {
+            games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (sscanf(argv[++i], "%dx%dx%d", &config.width, &config.height, &config.winLength) != 3) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--x") == 0 && hasValue) {
+            if (!ParseSelfPlayPlayer(argv[++i], config.players[0])) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--o") == 0 && hasValue) {
+            if (!ParseSelfPlayPlayer(argv[++i], config.players[1])) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--time-ms") == 0 && hasValue) {
+            timeBudget = (int64_t)atoi(argv[++i]) * 1000;
+        } else if (strcmp(argv[i], "--random-plies") == 0 && hasValue) {
+            config.randomPlies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--expect-unbeaten") == 0 && hasValue) {
+            const char *side = argv[++i];
+            unbeaten = (strcmp(side, "x") == 0) ? 1 : (strcmp(side, "o") == 0) ? 2 : 0;
+            if (!unbeaten) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--expect-wins") == 0 && i + 2 < argc) {
+            const char *side = argv[++i];
+            winner = (strcmp(side, "x") == 0) ? 1 : (strcmp(side, "o") == 0) ? 2 : 0;
+            winPercent = atof(argv[++i]);
+            if (!winner) return Usage(argv[0]);
+        } else if (strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else {
+            return Usage(argv[0]);
+        }
+    }
+    config.players[0].timeBudget = timeBudget;
+    config.players[1].timeBudget = timeBudget;
+
+    GameRecordWriter record;
+    if (recordPath && !record.open(recordPath)) {
+        fprintf(stderr, "selfplay: cannot write %s\n", recordPath);
+        return 1;
+    }
+    const SelfPlayStats stats = RunSelfPlay(config, games, threads, recordPath ? &record : nullptr);
+    printf("%dx%d k=%d, X %s vs O %s, %d random plies, seed %u\n", config.width, config.height, config.winLength,
+           SelfPlayEngineName(config.players[0].engine), SelfPlayEngineName(config.players[1].engine),
+           config.randomPlies, config.seed);
+    printf("%llu games in %.3f s (%.0f games/s), %.1f plies/game, %llu nodes\n",
+           (unsigned long long)stats.games, stats.seconds, stats.seconds > 0 ? stats.games / stats.seconds : 0.0,
+           stats.games ? (double)stats.plies / stats.games : 0.0, (unsigned long long)stats.nodes);
+    const double percent = stats.games ? 100.0 / stats.games : 0.0;
+    printf("X wins %llu (%.1f%%), O wins %llu (%.1f%%), draws %llu (%.1f%%)\n",
+           (unsigned long long)stats.xWins, stats.xWins * percent, (unsigned long long)stats.oWins, stats.oWins * percent,
+           (unsigned long long)stats.draws, stats.draws * percent);
+    if (recordPath) {
+        printf("recorded to %s, %llu games in the file\n", recordPath, (unsigned long long)record.count());
+    }
+
+    const uint64_t losses = (unbeaten == 1) ? stats.oWins : (unbeaten == 2) ? stats.xWins : 0;
+    if (losses) {
+        fprintf(stderr, "selfplay: %s lost %llu games\n", unbeaten == 1 ? "X" : "O", (unsigned long long)losses);
+        return 1;
+    }
+    const uint64_t wins = (winner == 1) ? stats.xWins : stats.oWins;
+    if (winner && wins * percent < winPercent) {
+        fprintf(stderr, "selfplay: %s won %.1f%% of the games, not %.1f%%\n", winner == 1 ? "X" : "O", wins * percent, winPercent);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,76 @@
+//
+// build-time self-check for the compile-time perfect-play table
+// walks every position reachable from the empty board and checks that the table
+// agrees with the live search: same value, and its move is legal and achieves that value
+// exits non-zero on the first disagreement so the build fails
+//
+
+#include "../engine/Negamax.h"
+#include "../engine/PerfectPlay.h"
+#include <cstdio>
+#include <vector>
+
+static std::vector<bool> visited(TERNARY_POSITIONS, false);
+static TranspositionTable table;
+static int checked = 0;
+
+static bool Verify(const Bitboard &pos)
+{
+    const int index = TernaryIndex(pos);
+    if (visited[index]) {
+        return true;
+    }
+    visited[index] = true;
+    checked++;
+
+    const PerfectPlayEntry entry = LookupPerfectPlay(pos);
+    SearchOptions plain;
+    plain.mode = kSearchPlain;
+    SearchOptions alphaBeta;
+    alphaBeta.table = &table;
+    const SearchResult reference = SearchBestMove(pos, plain);
+    const SearchResult pruned = SearchBestMove(pos, alphaBeta);
+
+    if (!entry.solved || entry.value != reference.value || entry.value != pruned.value) {
+        fprintf(stderr, "perfect-play table: %s has value %d, search says %d (alpha-beta %d)\n",
+                pos.toStateString().c_str(), entry.value, reference.value, pruned.value);
+        return false;
+    }
+    if (pos.gameOver()) {
+        if (entry.move != -1) {
+            fprintf(stderr, "perfect-play table: finished game %s has move %d\n", pos.toStateString().c_str(), entry.move);
+            return false;
+        }
+        return true;
+    }
+    if (entry.move < 0 || entry.move >= BOARD_CELLS || pos.cellAt(entry.move) != 0) {
+        fprintf(stderr, "perfect-play table: %s has illegal move %d\n", pos.toStateString().c_str(), entry.move);
+        return false;
+    }
+    const Bitboard next = pos.withMove(entry.move, pos.sideToMove());
+    if (-SearchBestMove(next, plain).value != entry.value) {
+        fprintf(stderr, "perfect-play table: %s move %d does not achieve value %d\n",
+                pos.toStateString().c_str(), entry.move, entry.value);
+        return false;
+    }
+
+    for (int idx = 0; idx < BOARD_CELLS; ++idx) {
+        if (pos.cellAt(idx) == 0 && !Verify(pos.withMove(idx, pos.sideToMove()))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int, char**)
+{
+    if (!Verify(Bitboard())) {
+        return 1;
+    }
+    if (checked != PerfectPlayPositionCount()) {
+        fprintf(stderr, "perfect-play table: %d reachable positions but the table has %d\n", checked, PerfectPlayPositionCount());
+        return 1;
+    }
+    printf("perfect-play table: %d positions agree with the search\n", checked);
+    return 0;
+}